@@ -27,6 +27,11 @@
 #define GENERIC_INTERRUPT_HANDLERS_COUNT (256 - IRQ_VECTOR_BASE)
 #define PAGE_MASK ((FlatPtr)0xfffff000u)
 
+// With PAE, a page directory entry can map 2 MiB directly instead of pointing to a page table.
+#define LARGE_PAGE_SIZE 0x200000
+#define LARGE_PAGE_MASK ((FlatPtr)0xffe00000u)
+#define PAGES_PER_LARGE_PAGE (LARGE_PAGE_SIZE / PAGE_SIZE)
+
 namespace Kernel {
 
 class MemoryManager;
@@ -232,4 +232,14 @@ UNMAP_AFTER_INIT size_t CommandLine::switch_to_tty() const
     }
     PANIC("Invalid default tty value: {}", default_tty);
 }
+
+size_t CommandLine::disk_cache_size() const
+{
+    // NOTE: The size is given in MiB. 0 means the size scales with physical memory.
+    const auto value = lookup("disk_cache_size"sv).value_or("0"sv);
+    auto size_in_mib = value.to_uint();
+    if (!size_in_mib.has_value())
+        PANIC("Invalid disk_cache_size value: {}", value);
+    return size_in_mib.value();
+}
 }
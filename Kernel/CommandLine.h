@@ -73,6 +73,7 @@ public:
     [[nodiscard]] Vector<String> userspace_init_args() const;
     [[nodiscard]] String root_device() const;
     [[nodiscard]] size_t switch_to_tty() const;
+    [[nodiscard]] size_t disk_cache_size() const;
 
 private:
     CommandLine(const String&);
@@ -61,6 +61,16 @@ auto AsyncDeviceRequest::wait(Time* timeout) -> RequestWaitResult
     return { get_request_result(), wait_result };
 }
 
+auto AsyncDeviceRequest::wait_uninterruptibly() -> RequestWaitResult
+{
+    VERIFY(!m_parent_request);
+    auto request_result = get_request_result();
+    if (is_completed_result(request_result))
+        return { request_result, Thread::BlockResult::NotBlocked };
+    auto wait_result = m_queue.wait_on({}, name(), false);
+    return { get_request_result(), wait_result };
+}
+
 auto AsyncDeviceRequest::get_request_result() const -> RequestResult
 {
     ScopedSpinLock lock(m_lock);
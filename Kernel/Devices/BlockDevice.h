@@ -62,6 +62,9 @@ public:
 
     virtual void start_request(AsyncBlockDeviceRequest&) = 0;
 
+    // Drivers only have to handle a page worth of blocks per request (e.g. PATA DMA uses a single page).
+    virtual size_t max_blocks_per_request() const { return max(PAGE_SIZE / m_block_size, (size_t)1); }
+
 protected:
     BlockDevice(unsigned major, unsigned minor, size_t block_size = PAGE_SIZE)
         : Device(major, minor)
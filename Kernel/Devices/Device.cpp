@@ -63,12 +63,24 @@ String Device::absolute_path(const FileDescription&) const
 void Device::process_next_queued_request(Badge<AsyncDeviceRequest>, const AsyncDeviceRequest& completed_request)
 {
     ScopedSpinLock lock(m_requests_lock);
-    VERIFY(!m_requests.is_empty());
-    VERIFY(m_requests.first().ptr() == &completed_request);
-    m_requests.remove(m_requests.begin());
-    if (!m_requests.is_empty()) {
-        auto* next_request = m_requests.first().ptr();
-        next_request->do_start(move(lock));
+    VERIFY(m_requests_in_flight > 0);
+    auto it = m_requests.begin();
+    for (size_t i = 0; i < m_requests_in_flight; ++i, ++it) {
+        VERIFY(it != m_requests.end());
+        if ((*it).ptr() == &completed_request)
+            break;
+    }
+    VERIFY(it != m_requests.end() && (*it).ptr() == &completed_request);
+    m_requests.remove(it);
+    m_requests_in_flight--;
+
+    // Completing one request makes room for exactly one more.
+    auto next = m_requests.begin();
+    for (size_t i = 0; i < m_requests_in_flight; ++i)
+        ++next;
+    if (next != m_requests.end()) {
+        m_requests_in_flight++;
+        (*next)->do_start(move(lock));
     }
 
     evaluate_block_conditions();
@@ -46,6 +46,10 @@ public:
     static void for_each(Function<void(Device&)>);
     static Device* get_device(unsigned major, unsigned minor);
 
+    // Devices that can work on several requests at once start queued requests
+    // without waiting for the ones before them to complete.
+    virtual size_t max_requests_in_flight() const { return 1; }
+
     void process_next_queued_request(Badge<AsyncDeviceRequest>, const AsyncDeviceRequest&);
 
     template<typename AsyncRequestType, typename... Args>
@@ -53,10 +57,11 @@ public:
     {
         auto request = adopt_ref(*new AsyncRequestType(*this, forward<Args>(args)...));
         ScopedSpinLock lock(m_requests_lock);
-        bool was_empty = m_requests.is_empty();
         m_requests.append(request);
-        if (was_empty)
+        if (m_requests_in_flight < max_requests_in_flight()) {
+            m_requests_in_flight++;
             request->do_start(move(lock));
+        }
         return request;
     }
 
@@ -74,7 +79,9 @@ private:
     gid_t m_gid { 0 };
 
     SpinLock<u8> m_requests_lock;
+    // The requests that have been started are always the first m_requests_in_flight ones.
     DoublyLinkedList<RefPtr<AsyncDeviceRequest>> m_requests;
+    size_t m_requests_in_flight { 0 };
 };
 
 }
@@ -4,64 +4,131 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/IntrusiveList.h>
+#include <Kernel/CommandLine.h>
 #include <Kernel/Debug.h>
+#include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
 #include <Kernel/Process.h>
+#include <Kernel/VM/MemoryManager.h>
 
 namespace Kernel {
 
+// Contiguous blocks that miss in the cache are read from the device together, up to this much at a time.
+static constexpr size_t max_coalesced_read_size = 256 * KiB;
+
+// Once reads look sequential, we read ahead of them. The window starts out small and doubles
+// with every sequential read, up to the maximum.
+static constexpr size_t initial_readahead_size = 32 * KiB;
+static constexpr size_t max_readahead_size = 512 * KiB;
+
+// A sequential stream survives this many unrelated reads in between, e.g. of inode tables or indirect blocks.
+static constexpr size_t max_non_sequential_reads_in_stream = 2;
+
 struct CacheEntry {
     IntrusiveListNode<CacheEntry> list_node;
     BlockBasedFS::BlockIndex block_index { 0 };
     u8* data { nullptr };
     bool has_data { false };
+    bool is_dirty { false };
+};
+
+// Blocks that are being read ahead of a sequential reader, and the device requests reading them.
+struct Readahead {
+    BlockBasedFS::BlockIndex next_block { 0 };
+    size_t size { 0 };
+    size_t non_sequential_reads { 0 };
+
+    BlockBasedFS::BlockIndex first_block_in_flight { 0 };
+    size_t block_count_in_flight { 0 };
+    OwnPtr<KBuffer> buffer;
+    NonnullRefPtrVector<AsyncBlockDeviceRequest> requests;
+
+    bool is_in_flight() const { return block_count_in_flight != 0; }
+    bool overlaps(BlockBasedFS::BlockIndex index, size_t count) const
+    {
+        return is_in_flight() && index.value() < first_block_in_flight.value() + block_count_in_flight && first_block_in_flight.value() < index.value() + count;
+    }
 };
 
+// The cache grows by this much at a time as blocks get read, so a filesystem that sees little use doesn't pin much memory.
+// It's also the least a cache gets, as reading multiple blocks at once needs room for them.
+static constexpr size_t disk_cache_chunk_size = 2 * max_coalesced_read_size;
+
+// Memory held by the caches of all filesystems together.
+static Atomic<size_t> s_total_disk_cache_size;
+
+static size_t max_total_disk_cache_size()
+{
+    // All filesystems together get to cache up to an 8th of physical memory.
+    size_t physical_memory = (size_t)MM.user_physical_pages() * PAGE_SIZE;
+    return max(physical_memory / 8, disk_cache_chunk_size);
+}
+
 class DiskCache {
 public:
-    explicit DiskCache(BlockBasedFS& fs)
+    DiskCache(BlockBasedFS& fs, size_t entry_count)
         : m_fs(fs)
-        , m_cached_block_data(KBuffer::create_with_size(m_entry_count * m_fs.block_size()))
-        , m_entries(KBuffer::create_with_size(m_entry_count * sizeof(CacheEntry)))
+        , m_entry_count(entry_count)
     {
-        for (size_t i = 0; i < m_entry_count; ++i) {
-            entries()[i].data = m_cached_block_data.data() + i * m_fs.block_size();
-            m_clean_list.append(entries()[i]);
-        }
     }
 
-    ~DiskCache() = default;
+    ~DiskCache()
+    {
+        s_total_disk_cache_size.fetch_sub(m_chunks.size() * chunk_size());
+    }
+
+    size_t entry_count() const { return m_entry_count; }
 
     bool is_dirty() const { return m_dirty; }
     void set_dirty(bool b) { m_dirty = b; }
 
     void mark_all_clean()
     {
-        while (auto* entry = m_dirty_list.first())
+        while (auto* entry = m_dirty_list.first()) {
+            entry->is_dirty = false;
             m_clean_list.prepend(*entry);
+        }
         m_dirty = false;
     }
 
     void mark_dirty(CacheEntry& entry)
     {
+        entry.is_dirty = true;
         m_dirty_list.prepend(entry);
         m_dirty = true;
     }
 
     void mark_clean(CacheEntry& entry)
     {
+        entry.is_dirty = false;
         m_clean_list.prepend(entry);
     }
 
+    CacheEntry* find(BlockBasedFS::BlockIndex block_index) const
+    {
+        auto it = m_hash.find(block_index);
+        if (it == m_hash.end())
+            return nullptr;
+        VERIFY(it->value->block_index == block_index);
+        return it->value;
+    }
+
     CacheEntry& get(BlockBasedFS::BlockIndex block_index) const
     {
-        if (auto it = m_hash.find(block_index); it != m_hash.end()) {
-            auto& entry = const_cast<CacheEntry&>(*it->value);
-            VERIFY(entry.block_index == block_index);
-            return entry;
+        if (auto* entry = find(block_index)) {
+            // Keep the clean list in least-recently-used order, so that's what gets evicted first.
+            if (!entry->is_dirty)
+                m_clean_list.prepend(*entry);
+            return *entry;
         }
 
+        // Unused entries sit at the end of the clean list, so only grow once we'd have to evict something.
+        if (m_clean_list.is_empty() || m_clean_list.last()->has_data)
+            grow();
+        VERIFY(!m_chunks.is_empty());
+
         if (m_clean_list.is_empty()) {
             // Not a single clean entry! Flush writes and try again.
             // NOTE: We want to make sure we only call FileBackedFS flush here,
@@ -74,7 +141,9 @@ public:
         auto& new_entry = *m_clean_list.last();
         m_clean_list.prepend(new_entry);
 
-        m_hash.remove(new_entry.block_index);
+        // An entry that was never used doesn't own the hash slot for its block index.
+        if (auto it = m_hash.find(new_entry.block_index); it != m_hash.end() && it->value == &new_entry)
+            m_hash.remove(it);
         m_hash.set(block_index, &new_entry);
 
         new_entry.block_index = block_index;
@@ -83,9 +152,6 @@ public:
         return new_entry;
     }
 
-    const CacheEntry* entries() const { return (const CacheEntry*)m_entries.data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries.data(); }
-
     template<typename Callback>
     void for_each_dirty_entry(Callback callback)
     {
@@ -93,17 +159,80 @@ public:
             callback(entry);
     }
 
+    Readahead& readahead() { return m_readahead; }
+
+    KBuffer* coalesced_read_buffer()
+    {
+        if (!m_coalesced_read_buffer)
+            m_coalesced_read_buffer = KBuffer::try_create_with_size(max_coalesced_read_size, Region::Access::Read | Region::Access::Write, "BlockBasedFS coalesced read");
+        return m_coalesced_read_buffer.ptr();
+    }
+
 private:
+    struct Chunk {
+        NonnullOwnPtr<KBuffer> block_data;
+        NonnullOwnPtr<KBuffer> entries;
+    };
+
+    size_t entries_per_chunk() const { return disk_cache_chunk_size / m_fs.block_size(); }
+    size_t chunk_size() const { return entries_per_chunk() * (m_fs.block_size() + sizeof(CacheEntry)); }
+
+    void grow() const
+    {
+        if ((m_chunks.size() + 1) * entries_per_chunk() > m_entry_count)
+            return;
+
+        // Every cache gets its first chunk, but past that, all caches share one limit.
+        auto size = chunk_size();
+        auto total_size = s_total_disk_cache_size.fetch_add(size) + size;
+        if (!m_chunks.is_empty() && total_size > max_total_disk_cache_size()) {
+            s_total_disk_cache_size.fetch_sub(size);
+            return;
+        }
+
+        auto block_data = KBuffer::try_create_with_size(entries_per_chunk() * m_fs.block_size(), Region::Access::Read | Region::Access::Write, "BlockBasedFS cache");
+        auto entries = KBuffer::try_create_with_size(entries_per_chunk() * sizeof(CacheEntry), Region::Access::Read | Region::Access::Write, "BlockBasedFS cache entries");
+        if (!block_data || !entries) {
+            s_total_disk_cache_size.fetch_sub(size);
+            return;
+        }
+
+        auto* chunk_entries = (CacheEntry*)entries->data();
+        for (size_t i = 0; i < entries_per_chunk(); ++i) {
+            chunk_entries[i].data = block_data->data() + i * m_fs.block_size();
+            m_clean_list.append(chunk_entries[i]);
+        }
+        m_chunks.append({ block_data.release_nonnull(), entries.release_nonnull() });
+    }
+
     BlockBasedFS& m_fs;
-    size_t m_entry_count { 10000 };
+    size_t m_entry_count { 0 };
     mutable HashMap<BlockBasedFS::BlockIndex, CacheEntry*> m_hash;
     mutable IntrusiveList<CacheEntry, RawPtr<CacheEntry>, &CacheEntry::list_node> m_clean_list;
     mutable IntrusiveList<CacheEntry, RawPtr<CacheEntry>, &CacheEntry::list_node> m_dirty_list;
-    KBuffer m_cached_block_data;
-    KBuffer m_entries;
+    mutable Vector<Chunk> m_chunks;
     bool m_dirty { false };
+    Readahead m_readahead;
+    OwnPtr<KBuffer> m_coalesced_read_buffer;
 };
 
+static size_t disk_cache_size()
+{
+    if (auto size_in_mib = kernel_command_line().disk_cache_size())
+        return size_in_mib * MiB;
+    // By default, every filesystem gets to cache up to a 16th of physical memory.
+    size_t physical_memory = (size_t)MM.user_physical_pages() * PAGE_SIZE;
+    return clamp(physical_memory / 16, 4 * MiB, 128 * MiB);
+}
+
+// Device requests can't be abandoned while they're in flight, as they'd keep writing into cache memory
+// that may already belong to another block. So signals don't interrupt the wait, only a dying thread
+// gets woken up early, and then sees the request as failed.
+static AsyncDeviceRequest::RequestResult wait_for_completion(AsyncBlockDeviceRequest& request)
+{
+    return request.wait_uninterruptibly().request_result();
+}
+
 BlockBasedFS::BlockBasedFS(FileDescription& file_description)
     : FileBackedFS(file_description)
 {
@@ -112,6 +241,8 @@ BlockBasedFS::BlockBasedFS(FileDescription& file_description)
 
 BlockBasedFS::~BlockBasedFS()
 {
+    if (m_cache)
+        finish_readahead(true);
 }
 
 KResult BlockBasedFS::write_block(BlockIndex index, const UserOrKernelBuffer& data, size_t count, size_t offset, bool allow_cache)
@@ -121,6 +252,10 @@ KResult BlockBasedFS::write_block(BlockIndex index, const UserOrKernelBuffer& da
     VERIFY(offset + count <= block_size());
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::write_block {}, size={}", index, count);
 
+    // Make sure an older copy of the block that's still being read ahead doesn't end up in the cache.
+    if (cache().readahead().overlaps(index, 1))
+        finish_readahead(true);
+
     if (!allow_cache) {
         flush_specific_block_if_needed(index);
         u32 base_offset = index.value() * block_size() + offset;
@@ -210,6 +345,150 @@ KResult BlockBasedFS::write_blocks(BlockIndex index, unsigned count, const UserO
     return KSuccess;
 }
 
+bool BlockBasedFS::start_device_reads(BlockIndex index, size_t count, UserOrKernelBuffer buffer, NonnullRefPtrVector<AsyncBlockDeviceRequest>& requests) const
+{
+    auto& file = file_description().file();
+    if (!file.is_block_device())
+        return false;
+    auto& device = static_cast<BlockDevice&>(file);
+    if (block_size() % device.block_size() != 0)
+        return false;
+
+    auto device_blocks_per_block = block_size() / device.block_size();
+    auto max_device_blocks_per_request = max(device.max_blocks_per_request(), (size_t)1);
+    u64 device_block_index = index.value() * device_blocks_per_block;
+    size_t remaining_device_blocks = count * device_blocks_per_block;
+    size_t buffer_offset = 0;
+    // NOTE: The device works through its queue without waiting for us, so all requests are in flight at once.
+    while (remaining_device_blocks > 0) {
+        auto device_blocks = min(remaining_device_blocks, max_device_blocks_per_request);
+        auto request_size = device_blocks * device.block_size();
+        requests.append(device.make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Read, device_block_index, device_blocks, buffer.offset(buffer_offset), request_size));
+        device_block_index += device_blocks;
+        remaining_device_blocks -= device_blocks;
+        buffer_offset += request_size;
+    }
+    return true;
+}
+
+KResult BlockBasedFS::read_from_device(BlockIndex index, size_t count, UserOrKernelBuffer& buffer) const
+{
+    NonnullRefPtrVector<AsyncBlockDeviceRequest> requests;
+    if (start_device_reads(index, count, buffer, requests)) {
+        KResult result = KSuccess;
+        for (auto& request : requests) {
+            switch (wait_for_completion(request)) {
+            case AsyncDeviceRequest::Success:
+                break;
+            case AsyncDeviceRequest::MemoryFault:
+                result = EFAULT;
+                break;
+            default:
+                result = EIO;
+                break;
+            }
+        }
+        return result;
+    }
+
+    auto seek_result = file_description().seek(index.value() * block_size(), SEEK_SET);
+    if (seek_result.is_error())
+        return seek_result.error();
+    size_t total_size = count * block_size();
+    size_t nread = 0;
+    while (nread < total_size) {
+        auto chunk_buffer = buffer.offset(nread);
+        auto result = file_description().read(chunk_buffer, total_size - nread);
+        if (result.is_error())
+            return result.error();
+        if (result.value() == 0)
+            return EIO;
+        nread += result.value();
+    }
+    return KSuccess;
+}
+
+void BlockBasedFS::finish_readahead(bool wait) const
+{
+    auto& readahead = cache().readahead();
+    if (!readahead.is_in_flight())
+        return;
+
+    bool succeeded = true;
+    for (auto& request : readahead.requests) {
+        if (!wait && !request.is_completed())
+            return;
+        if (wait_for_completion(request) != AsyncDeviceRequest::Success)
+            succeeded = false;
+    }
+
+    // Anything that made it into the cache in the meantime is at least as recent as what we read.
+    for (size_t i = 0; succeeded && i < readahead.block_count_in_flight; ++i) {
+        BlockIndex block_index { readahead.first_block_in_flight.value() + i };
+        if (auto* entry = cache().find(block_index); entry && entry->has_data)
+            continue;
+        auto& entry = cache().get(block_index);
+        memcpy(entry.data, readahead.buffer->data() + i * block_size(), block_size());
+        entry.has_data = true;
+    }
+
+    readahead.requests.clear();
+    readahead.block_count_in_flight = 0;
+}
+
+void BlockBasedFS::update_readahead(BlockIndex index, size_t count) const
+{
+    auto& readahead = cache().readahead();
+    if (index.value() + 1 == readahead.next_block.value() && count == 1) {
+        // Another part of the block we just read.
+        return;
+    }
+
+    if (index != readahead.next_block) {
+        if (readahead.size && ++readahead.non_sequential_reads <= max_non_sequential_reads_in_stream)
+            return;
+        readahead.next_block = index.value() + count;
+        readahead.size = 0;
+        readahead.non_sequential_reads = 0;
+        return;
+    }
+
+    readahead.next_block = index.value() + count;
+    readahead.non_sequential_reads = 0;
+    readahead.size = readahead.size ? min(readahead.size * 2, max_readahead_size) : initial_readahead_size;
+
+    finish_readahead(false);
+    if (readahead.is_in_flight())
+        return;
+
+    // Don't bother reading what's already in the cache, or what's past the end of the filesystem.
+    u64 first_block = readahead.next_block.value();
+    u64 end_block = first_block + max(readahead.size / block_size(), (size_t)1);
+    if (auto total_blocks = total_block_count())
+        end_block = min(end_block, (u64)total_blocks);
+    while (first_block < end_block) {
+        auto* entry = cache().find(first_block);
+        if (!entry || !entry->has_data)
+            break;
+        ++first_block;
+    }
+    if (first_block >= end_block)
+        return;
+
+    if (!readahead.buffer) {
+        readahead.buffer = KBuffer::try_create_with_size(max_readahead_size, Region::Access::Read | Region::Access::Write, "BlockBasedFS readahead");
+        if (!readahead.buffer)
+            return;
+    }
+
+    size_t block_count = end_block - first_block;
+    if (!start_device_reads(first_block, block_count, UserOrKernelBuffer::for_kernel_buffer(readahead.buffer->data()), readahead.requests))
+        return;
+    dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem: Reading ahead {} blocks from {}", block_count, first_block);
+    readahead.first_block_in_flight = first_block;
+    readahead.block_count_in_flight = block_count;
+}
+
 KResult BlockBasedFS::read_block(BlockIndex index, UserOrKernelBuffer* buffer, size_t count, size_t offset, bool allow_cache) const
 {
     Locker locker(m_lock);
@@ -217,6 +496,9 @@ KResult BlockBasedFS::read_block(BlockIndex index, UserOrKernelBuffer* buffer, s
     VERIFY(offset + count <= block_size());
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_block {}", index);
 
+    if (cache().readahead().overlaps(index, 1))
+        finish_readahead(true);
+
     if (!allow_cache) {
         const_cast<BlockBasedFS*>(this)->flush_specific_block_if_needed(index);
         auto base_offset = index.value() * block_size() + offset;
@@ -232,19 +514,15 @@ KResult BlockBasedFS::read_block(BlockIndex index, UserOrKernelBuffer* buffer, s
 
     auto& entry = cache().get(index);
     if (!entry.has_data) {
-        auto base_offset = index.value() * block_size();
-        auto seek_result = file_description().seek(base_offset, SEEK_SET);
-        if (seek_result.is_error())
-            return seek_result.error();
         auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-        auto nread = file_description().read(entry_data_buffer, block_size());
-        if (nread.is_error())
-            return nread.error();
-        VERIFY(nread.value() == block_size());
+        if (auto result = read_from_device(index, 1, entry_data_buffer); result.is_error())
+            return result;
         entry.has_data = true;
     }
     if (buffer && !buffer->write(entry.data + offset, count))
         return EFAULT;
+    if (buffer)
+        update_readahead(index, 1);
     return KSuccess;
 }
 
@@ -256,14 +534,54 @@ KResult BlockBasedFS::read_blocks(BlockIndex index, unsigned count, UserOrKernel
         return EINVAL;
     if (count == 1)
         return read_block(index, &buffer, block_size(), 0, allow_cache);
-    auto out = buffer;
-    for (unsigned i = 0; i < count; ++i) {
-        auto result = read_block(BlockIndex { index.value() + i }, &out, block_size(), 0, allow_cache);
-        if (result.is_error())
+
+    if (cache().readahead().overlaps(index, count))
+        finish_readahead(true);
+
+    if (!allow_cache) {
+        for (unsigned i = 0; i < count; ++i)
+            const_cast<BlockBasedFS*>(this)->flush_specific_block_if_needed(index.value() + i);
+        return read_from_device(index, count, buffer);
+    }
+
+    auto* coalesced_read_buffer = cache().coalesced_read_buffer();
+    if (!coalesced_read_buffer)
+        return ENOMEM;
+    size_t max_blocks_per_read = min(max_coalesced_read_size / block_size(), cache().entry_count() / 2);
+    unsigned i = 0;
+    while (i < count) {
+        BlockIndex block_index { index.value() + i };
+        auto out = buffer.offset(i * block_size());
+        if (auto* entry = cache().find(block_index); entry && entry->has_data) {
+            cache().get(block_index);
+            if (!out.write(entry->data, block_size()))
+                return EFAULT;
+            ++i;
+            continue;
+        }
+
+        // Gather up the run of blocks that aren't cached, and read them in one go.
+        size_t run_length = 1;
+        while (i + run_length < count && run_length < max_blocks_per_read) {
+            auto* entry = cache().find(block_index.value() + run_length);
+            if (entry && entry->has_data)
+                break;
+            ++run_length;
+        }
+        auto run_buffer = UserOrKernelBuffer::for_kernel_buffer(coalesced_read_buffer->data());
+        if (auto result = read_from_device(block_index, run_length, run_buffer); result.is_error())
             return result;
-        out = out.offset(block_size());
+        for (size_t j = 0; j < run_length; ++j) {
+            auto& entry = cache().get(block_index.value() + j);
+            memcpy(entry.data, coalesced_read_buffer->data() + j * block_size(), block_size());
+            entry.has_data = true;
+        }
+        if (!out.write(coalesced_read_buffer->data(), run_length * block_size()))
+            return EFAULT;
+        i += run_length;
     }
 
+    update_readahead(index, count);
     return KSuccess;
 }
 
@@ -316,8 +634,11 @@ void BlockBasedFS::flush_writes()
 
 DiskCache& BlockBasedFS::cache() const
 {
-    if (!m_cache)
-        m_cache = make<DiskCache>(const_cast<BlockBasedFS&>(*this));
+    if (!m_cache) {
+        auto entry_count = max(disk_cache_size(), disk_cache_chunk_size) / block_size();
+        dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem: Caching up to {} blocks of {} bytes", entry_count, block_size());
+        m_cache = make<DiskCache>(const_cast<BlockBasedFS&>(*this), entry_count);
+    }
     return *m_cache;
 }
 
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/NonnullRefPtrVector.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 
 namespace Kernel {
@@ -42,6 +43,11 @@ private:
     DiskCache& cache() const;
     void flush_specific_block_if_needed(BlockIndex index);
 
+    bool start_device_reads(BlockIndex, size_t count, UserOrKernelBuffer, NonnullRefPtrVector<AsyncBlockDeviceRequest>&) const;
+    KResult read_from_device(BlockIndex, size_t count, UserOrKernelBuffer&) const;
+    void update_readahead(BlockIndex, size_t count) const;
+    void finish_readahead(bool wait) const;
+
     mutable OwnPtr<DiskCache> m_cache;
 };
 
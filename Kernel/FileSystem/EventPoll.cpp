@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+// Protects the links between interests and file descriptions, which both sides can break:
+// an EventPoll when an interest is removed, and a FileDescription when it's destroyed.
+// Taken before any block condition or ready list lock.
+static SpinLock<u8> s_interests_lock;
+
+static BlockFlags block_flags_for_events(u32 events)
+{
+    // Like poll(), errors and hangups are always reported, whether they were asked for or not.
+    auto flags = BlockFlags::Exception;
+    if (events & EPOLLIN)
+        flags |= BlockFlags::Read;
+    if (events & EPOLLOUT)
+        flags |= BlockFlags::Write;
+    if (events & EPOLLPRI)
+        flags |= BlockFlags::ReadPriority;
+    return flags;
+}
+
+static u32 events_for_block_flags(BlockFlags flags)
+{
+    u32 events = 0;
+    if (has_flag(flags, BlockFlags::Read))
+        events |= EPOLLIN;
+    if (has_flag(flags, BlockFlags::Write))
+        events |= EPOLLOUT;
+    if (has_flag(flags, BlockFlags::ReadPriority))
+        events |= EPOLLPRI;
+    if (has_flag(flags, BlockFlags::ReadHangUp))
+        events |= EPOLLRDHUP;
+    if (has_flag(flags, BlockFlags::WriteError))
+        events |= EPOLLERR;
+    if (has_flag(flags, BlockFlags::WriteHangUp))
+        events |= EPOLLHUP;
+    return events;
+}
+
+EventPoll::Interest::Interest(EventPoll& event_poll, ProcessID owner_pid, int fd, FileDescription& description, u32 events, u64 data)
+    : m_event_poll(event_poll)
+    , m_owner_pid(owner_pid)
+    , m_fd(fd)
+    , m_description(&description)
+{
+    set_events(events, data);
+}
+
+EventPoll::Interest::~Interest()
+{
+    VERIFY(!m_is_attached);
+}
+
+void EventPoll::Interest::set_events(u32 events, u64 data)
+{
+    m_events = events;
+    m_data = data;
+    m_block_flags = block_flags_for_events(events);
+}
+
+bool EventPoll::Interest::unblock(bool, void*)
+{
+    // NOTE: This is called with the description's block condition locked, every time
+    //       its state may have changed. It never returns true, which would unregister us.
+    if (m_description->should_unblock(m_block_flags) != BlockFlags::None)
+        m_event_poll.mark_ready(*this);
+    return false;
+}
+
+KResultOr<NonnullRefPtr<EventPoll>> EventPoll::create()
+{
+    auto event_poll = adopt_ref_if_nonnull(new EventPoll);
+    if (event_poll)
+        return event_poll.release_nonnull();
+    return ENOMEM;
+}
+
+EventPoll::~EventPoll()
+{
+    ScopedSpinLock lock(s_interests_lock);
+    for (auto& it : m_interests)
+        detach_interest(*it.value);
+    m_dead_interests.clear();
+}
+
+bool EventPoll::can_read(const FileDescription&, size_t) const
+{
+    ScopedSpinLock lock(m_ready_lock);
+    return !m_ready_interests.is_empty();
+}
+
+void EventPoll::mark_ready(Interest& interest)
+{
+    {
+        ScopedSpinLock lock(m_ready_lock);
+        if (interest.m_is_disabled || interest.m_ready_list_node.is_in_list())
+            return;
+        m_ready_interests.append(interest);
+    }
+    evaluate_block_conditions();
+}
+
+void EventPoll::detach_interest(Interest& interest)
+{
+    VERIFY(s_interests_lock.is_locked());
+    if (interest.m_is_attached) {
+        auto& description = *interest.m_description;
+        description.block_condition().remove_blocker(interest, nullptr);
+        description.event_poll_interests({}).remove(interest);
+        interest.m_is_attached = false;
+    }
+    {
+        ScopedSpinLock lock(m_ready_lock);
+        m_ready_interests.remove(interest);
+    }
+    m_dead_interests.remove(interest);
+}
+
+void EventPoll::detach_description(Badge<FileDescription>, Interest::DescriptionList& interests)
+{
+    ScopedSpinLock lock(s_interests_lock);
+    while (!interests.is_empty())
+        kill_interest(*interests.first());
+}
+
+void EventPoll::detach_fd(Badge<Process>, ProcessID owner_pid, int fd, FileDescription& description)
+{
+    ScopedSpinLock lock(s_interests_lock);
+    auto& interests = description.event_poll_interests({});
+    for (auto it = interests.begin(); it != interests.end();) {
+        auto& interest = *it;
+        ++it;
+        if (interest.m_fd == fd && interest.m_owner_pid == owner_pid)
+            kill_interest(interest);
+    }
+}
+
+void EventPoll::kill_interest(Interest& interest)
+{
+    VERIFY(s_interests_lock.is_locked());
+    auto& event_poll = interest.m_event_poll;
+    event_poll.detach_interest(interest);
+    // The EventPoll can't take its own lock from here, so it forgets about the
+    // interest the next time it's used.
+    event_poll.m_dead_interests.append(interest);
+}
+
+void EventPoll::forget_dead_interests()
+{
+    VERIFY(m_lock.is_locked());
+    ScopedSpinLock lock(s_interests_lock);
+    while (!m_dead_interests.is_empty()) {
+        auto* interest = m_dead_interests.take_first();
+        m_interests.remove({ interest->m_fd, interest->m_description });
+    }
+}
+
+KResult EventPoll::add_interest(ProcessID owner_pid, int fd, FileDescription& description, const epoll_event& event)
+{
+    // Letting EventPolls watch each other could make their block conditions wait for each other.
+    if (description.is_event_poll())
+        return EINVAL;
+
+    Locker locker(m_lock);
+    forget_dead_interests();
+    InterestKey key { fd, &description };
+    if (m_interests.contains(key))
+        return EEXIST;
+
+    auto interest = adopt_own_if_nonnull(new Interest(*this, owner_pid, fd, description, event.events, event.data));
+    if (!interest)
+        return ENOMEM;
+    auto& interest_ref = *interest;
+    m_interests.set(key, interest.release_nonnull());
+
+    ScopedSpinLock lock(s_interests_lock);
+    description.event_poll_interests({}).append(interest_ref);
+    // NOTE: Adding the blocker checks whether the description is ready already.
+    [[maybe_unused]] bool added = description.block_condition().add_blocker(interest_ref, nullptr);
+    VERIFY(added);
+    return KSuccess;
+}
+
+KResult EventPoll::modify_interest(int fd, FileDescription& description, const epoll_event& event)
+{
+    Locker locker(m_lock);
+    forget_dead_interests();
+    auto it = m_interests.find({ fd, &description });
+    if (it == m_interests.end())
+        return ENOENT;
+    auto& interest = *it->value;
+
+    ScopedSpinLock lock(s_interests_lock);
+    description.block_condition().remove_blocker(interest, nullptr);
+    {
+        ScopedSpinLock ready_lock(m_ready_lock);
+        m_ready_interests.remove(interest);
+        interest.m_is_disabled = false;
+        interest.set_events(event.events, event.data);
+    }
+    [[maybe_unused]] bool added = description.block_condition().add_blocker(interest, nullptr);
+    VERIFY(added);
+    return KSuccess;
+}
+
+KResult EventPoll::remove_interest(int fd, FileDescription& description)
+{
+    Locker locker(m_lock);
+    forget_dead_interests();
+    auto it = m_interests.find({ fd, &description });
+    if (it == m_interests.end())
+        return ENOENT;
+    {
+        ScopedSpinLock lock(s_interests_lock);
+        detach_interest(*it->value);
+    }
+    m_interests.remove(it);
+    return KSuccess;
+}
+
+size_t EventPoll::collect_ready_events(Span<epoll_event> events)
+{
+    ScopedSpinLock lock(m_ready_lock);
+    Interest::ReadyList still_ready;
+    size_t count = 0;
+    while (count < events.size() && !m_ready_interests.is_empty()) {
+        auto& interest = *m_ready_interests.take_first();
+        // Whatever made it ready may have been consumed since.
+        auto flags = interest.m_description->should_unblock(interest.m_block_flags);
+        if (flags == BlockFlags::None)
+            continue;
+
+        events[count++] = { events_for_block_flags(flags), interest.m_data };
+        if (interest.m_events & EPOLLONESHOT)
+            interest.m_is_disabled = true;
+        else if (!(interest.m_events & EPOLLET))
+            still_ready.append(interest);
+    }
+
+    // Level-triggered interests are reported again for as long as they stay ready.
+    // They go to the back of the list, so that every ready interest gets its turn.
+    while (!still_ready.is_empty())
+        m_ready_interests.append(*still_ready.take_first());
+    return count;
+}
+
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Badge.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Lock.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// A persistent set of file descriptors that a process is interested in, behind an epoll fd.
+// Every interest stays registered with its description's FileBlockCondition, and puts itself
+// on the ready list whenever the description's state changes in a way it cares about. Waiting
+// only has to look at that ready list, so it costs O(ready) instead of O(watched) like select().
+class EventPoll final : public File {
+public:
+    class Interest final : public Thread::FileBlocker {
+    public:
+        Interest(EventPoll&, ProcessID owner_pid, int fd, FileDescription&, u32 events, u64 data);
+        virtual ~Interest() override;
+
+        virtual const char* state_string() const override { return "EventPoll"; }
+        virtual void not_blocking(bool) override { VERIFY_NOT_REACHED(); }
+        virtual bool unblock(bool, void*) override;
+
+    private:
+        friend class EventPoll;
+
+        void set_events(u32 events, u64 data);
+
+        EventPoll& m_event_poll;
+        // The process whose fd this is, so that closing the same fd number elsewhere leaves us alone.
+        ProcessID m_owner_pid { 0 };
+        int m_fd { -1 };
+        // Only valid while m_is_attached is set. After that, it's just part of the key in m_interests.
+        FileDescription* m_description { nullptr };
+        // Cleared when the fd is closed or the description goes away. Only changed while holding s_interests_lock.
+        bool m_is_attached { true };
+        u32 m_events { 0 };
+        u64 m_data { 0 };
+        BlockFlags m_block_flags { BlockFlags::None };
+
+        // The rest is protected by the EventPoll's m_ready_lock.
+        bool m_is_disabled { false };
+        IntrusiveListNode<Interest> m_ready_list_node;
+
+        IntrusiveListNode<Interest> m_description_list_node;
+        IntrusiveListNode<Interest> m_dead_list_node;
+
+    public:
+        using DescriptionList = IntrusiveList<Interest, RawPtr<Interest>, &Interest::m_description_list_node>;
+        using ReadyList = IntrusiveList<Interest, RawPtr<Interest>, &Interest::m_ready_list_node>;
+        using DeadList = IntrusiveList<Interest, RawPtr<Interest>, &Interest::m_dead_list_node>;
+    };
+
+    static KResultOr<NonnullRefPtr<EventPoll>> create();
+    virtual ~EventPoll() override;
+
+    // Like on Linux, interests are keyed by both the fd and its description, so that dup'd fds
+    // can be watched separately.
+    KResult add_interest(ProcessID owner_pid, int fd, FileDescription&, const epoll_event&);
+    KResult modify_interest(int fd, FileDescription&, const epoll_event&);
+    KResult remove_interest(int fd, FileDescription&);
+
+    // Fills in events for up to events.size() ready interests without blocking.
+    size_t collect_ready_events(Span<epoll_event> events);
+
+    // Drops every interest in the description, which is about to be destroyed.
+    static void detach_description(Badge<FileDescription>, Interest::DescriptionList&);
+    // Drops every interest in the fd, which the owning process is about to close.
+    static void detach_fd(Badge<Process>, ProcessID owner_pid, int fd, FileDescription&);
+
+    virtual bool can_read(const FileDescription&, size_t) const override;
+    virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual bool can_write(const FileDescription&, size_t) const override { return false; }
+    virtual KResultOr<size_t> write(FileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return EINVAL; }
+
+    virtual String absolute_path(const FileDescription&) const override { return "EventPoll"; }
+    virtual const char* class_name() const override { return "EventPoll"; }
+    virtual bool is_event_poll() const override { return true; }
+
+private:
+    EventPoll() { }
+
+    void mark_ready(Interest&);
+    void detach_interest(Interest&);
+    static void kill_interest(Interest&);
+    void forget_dead_interests();
+
+    mutable Lock m_lock { "EventPoll" };
+    struct InterestKey {
+        int fd { -1 };
+        FileDescription* description { nullptr };
+
+        bool operator==(const InterestKey& other) const { return fd == other.fd && description == other.description; }
+    };
+    struct InterestKeyTraits : public GenericTraits<InterestKey> {
+        static unsigned hash(const InterestKey& key) { return pair_int_hash(key.fd, ptr_hash(key.description)); }
+    };
+    HashMap<InterestKey, NonnullOwnPtr<Interest>, InterestKeyTraits> m_interests;
+
+    mutable SpinLock<u8> m_ready_lock;
+    Interest::ReadyList m_ready_interests;
+
+    // Interests whose description went away. Protected by s_interests_lock.
+    Interest::DeadList m_dead_interests;
+};
+
+}
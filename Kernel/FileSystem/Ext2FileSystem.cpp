@@ -227,15 +227,18 @@ KResult Ext2FSInode::write_indirect_block(BlockBasedFS::BlockIndex block, Span<B
     return fs().write_block(block, buffer, stream.size());
 }
 
-KResult Ext2FSInode::grow_doubly_indirect_block(BlockBasedFS::BlockIndex block, size_t old_blocks_length, Span<BlockBasedFS::BlockIndex> blocks_indices, Vector<Ext2FS::BlockIndex>& new_meta_blocks, unsigned& meta_blocks)
+KResult Ext2FSInode::grow_doubly_indirect_block(BlockBasedFS::BlockIndex block, size_t old_blocks_length, size_t new_blocks_length, Span<BlockBasedFS::BlockIndex> blocks_indices, Vector<Ext2FS::BlockIndex>& new_meta_blocks, unsigned& meta_blocks)
 {
     const auto entries_per_block = EXT2_ADDR_PER_BLOCK(&fs().super_block());
     const auto entries_per_doubly_indirect_block = entries_per_block * entries_per_block;
     const auto old_indirect_blocks_length = divide_rounded_up(old_blocks_length, entries_per_block);
-    const auto new_indirect_blocks_length = divide_rounded_up(blocks_indices.size(), entries_per_block);
-    VERIFY(blocks_indices.size() > 0);
-    VERIFY(blocks_indices.size() > old_blocks_length);
-    VERIFY(blocks_indices.size() <= entries_per_doubly_indirect_block);
+    const auto new_indirect_blocks_length = divide_rounded_up(new_blocks_length, entries_per_block);
+    // blocks_indices starts at the first indirect block that needs to be written out.
+    const auto first_indirect_block = old_blocks_length / entries_per_block;
+    VERIFY(new_blocks_length > 0);
+    VERIFY(new_blocks_length > old_blocks_length);
+    VERIFY(new_blocks_length <= entries_per_doubly_indirect_block);
+    VERIFY(blocks_indices.size() == new_blocks_length - first_indirect_block * entries_per_block);
 
     auto block_contents = ByteBuffer::create_uninitialized(fs().block_size());
     auto* block_as_pointers = (unsigned*)block_contents.data();
@@ -259,8 +262,8 @@ KResult Ext2FSInode::grow_doubly_indirect_block(BlockBasedFS::BlockIndex block,
     stream.fill_to_end(0);
 
     // Write out the indirect blocks.
-    for (unsigned i = old_blocks_length / entries_per_block; i < new_indirect_blocks_length; i++) {
-        const auto offset_block = i * entries_per_block;
+    for (unsigned i = first_indirect_block; i < new_indirect_blocks_length; i++) {
+        const auto offset_block = (i - first_indirect_block) * entries_per_block;
         if (auto result = write_indirect_block(block_as_pointers[i], blocks_indices.slice(offset_block, min(blocks_indices.size() - offset_block, entries_per_block))); result.is_error())
             return result;
     }
@@ -304,16 +307,19 @@ KResult Ext2FSInode::shrink_doubly_indirect_block(BlockBasedFS::BlockIndex block
     return KSuccess;
 }
 
-KResult Ext2FSInode::grow_triply_indirect_block(BlockBasedFS::BlockIndex block, size_t old_blocks_length, Span<BlockBasedFS::BlockIndex> blocks_indices, Vector<Ext2FS::BlockIndex>& new_meta_blocks, unsigned& meta_blocks)
+KResult Ext2FSInode::grow_triply_indirect_block(BlockBasedFS::BlockIndex block, size_t old_blocks_length, size_t new_blocks_length, Span<BlockBasedFS::BlockIndex> blocks_indices, Vector<Ext2FS::BlockIndex>& new_meta_blocks, unsigned& meta_blocks)
 {
     const auto entries_per_block = EXT2_ADDR_PER_BLOCK(&fs().super_block());
     const auto entries_per_doubly_indirect_block = entries_per_block * entries_per_block;
     const auto entries_per_triply_indirect_block = entries_per_block * entries_per_block;
     const auto old_doubly_indirect_blocks_length = divide_rounded_up(old_blocks_length, entries_per_doubly_indirect_block);
-    const auto new_doubly_indirect_blocks_length = divide_rounded_up(blocks_indices.size(), entries_per_doubly_indirect_block);
-    VERIFY(blocks_indices.size() > 0);
-    VERIFY(blocks_indices.size() > old_blocks_length);
-    VERIFY(blocks_indices.size() <= entries_per_triply_indirect_block);
+    const auto new_doubly_indirect_blocks_length = divide_rounded_up(new_blocks_length, entries_per_doubly_indirect_block);
+    // blocks_indices starts at the first indirect block that needs to be written out.
+    const auto first_block_index = (old_blocks_length / entries_per_block) * entries_per_block;
+    VERIFY(new_blocks_length > 0);
+    VERIFY(new_blocks_length > old_blocks_length);
+    VERIFY(new_blocks_length <= entries_per_triply_indirect_block);
+    VERIFY(blocks_indices.size() == new_blocks_length - first_block_index);
 
     auto block_contents = ByteBuffer::create_uninitialized(fs().block_size());
     auto* block_as_pointers = (unsigned*)block_contents.data();
@@ -340,8 +346,10 @@ KResult Ext2FSInode::grow_triply_indirect_block(BlockBasedFS::BlockIndex block,
     for (unsigned i = old_blocks_length / entries_per_doubly_indirect_block; i < new_doubly_indirect_blocks_length; i++) {
         const auto processed_blocks = i * entries_per_doubly_indirect_block;
         const auto old_doubly_indirect_blocks_length = min(old_blocks_length > processed_blocks ? old_blocks_length - processed_blocks : 0, entries_per_doubly_indirect_block);
-        const auto new_doubly_indirect_blocks_length = min(blocks_indices.size() > processed_blocks ? blocks_indices.size() - processed_blocks : 0, entries_per_doubly_indirect_block);
-        if (auto result = grow_doubly_indirect_block(block_as_pointers[i], old_doubly_indirect_blocks_length, blocks_indices.slice(processed_blocks, new_doubly_indirect_blocks_length), new_meta_blocks, meta_blocks); result.is_error())
+        const auto new_doubly_indirect_blocks_length = min(new_blocks_length > processed_blocks ? new_blocks_length - processed_blocks : 0, entries_per_doubly_indirect_block);
+        const auto first_written_block = processed_blocks + (old_doubly_indirect_blocks_length / entries_per_block) * entries_per_block;
+        auto doubly_indirect_blocks_indices = blocks_indices.slice(first_written_block - first_block_index, processed_blocks + new_doubly_indirect_blocks_length - first_written_block);
+        if (auto result = grow_doubly_indirect_block(block_as_pointers[i], old_doubly_indirect_blocks_length, new_doubly_indirect_blocks_length, doubly_indirect_blocks_indices, new_meta_blocks, meta_blocks); result.is_error())
             return result;
     }
 
@@ -387,22 +395,31 @@ KResult Ext2FSInode::shrink_triply_indirect_block(BlockBasedFS::BlockIndex block
     return KSuccess;
 }
 
-KResult Ext2FSInode::flush_block_list()
+KResult Ext2FSInode::flush_block_list(unsigned new_block_count, Span<BlockBasedFS::BlockIndex> new_tail)
 {
     Locker locker(m_lock);
 
-    if (m_block_list.is_empty()) {
+    if (new_block_count == 0) {
         m_raw_inode.i_blocks = 0;
         memset(m_raw_inode.i_block, 0, sizeof(m_raw_inode.i_block));
         set_metadata_dirty(true);
         return KSuccess;
     }
 
-    // NOTE: There is a mismatch between i_blocks and blocks.size() since i_blocks includes meta blocks and blocks.size() does not.
-    const auto old_block_count = ceil_div(size(), static_cast<u64>(fs().block_size()));
+    // NOTE: There is a mismatch between i_blocks and the block count since i_blocks includes meta blocks and the block count does not.
+    const auto old_block_count = block_count();
 
     auto old_shape = fs().compute_block_list_shape(old_block_count);
-    const auto new_shape = fs().compute_block_list_shape(m_block_list.size());
+    const auto new_shape = fs().compute_block_list_shape(new_block_count);
+
+    // When growing, new_tail holds the entries from first_block_to_flush() onwards, which is everything that needs to be written out.
+    // When shrinking, nothing but the inode itself is rewritten.
+    const unsigned tail_start = new_block_count > old_block_count ? first_block_to_flush(old_block_count) : new_block_count;
+    VERIFY(new_tail.size() == new_block_count - tail_start);
+    auto tail_for_section = [&](unsigned section_start, unsigned section_length) {
+        auto first_block = max(section_start, tail_start);
+        return new_tail.slice(first_block - tail_start, section_start + section_length - first_block);
+    };
 
     Vector<Ext2FS::BlockIndex> new_meta_blocks;
     if (new_shape.meta_blocks > old_shape.meta_blocks) {
@@ -412,22 +429,22 @@ KResult Ext2FSInode::flush_block_list()
         new_meta_blocks = blocks_or_error.release_value();
     }
 
-    m_raw_inode.i_blocks = (m_block_list.size() + new_shape.meta_blocks) * (fs().block_size() / 512);
+    m_raw_inode.i_blocks = (new_block_count + new_shape.meta_blocks) * (fs().block_size() / 512);
     dbgln_if(EXT2_BLOCKLIST_DEBUG, "Ext2FSInode[{}]::flush_block_list(): Old shape=({};{};{};{}:{}), new shape=({};{};{};{}:{})", identifier(), old_shape.direct_blocks, old_shape.indirect_blocks, old_shape.doubly_indirect_blocks, old_shape.triply_indirect_blocks, old_shape.meta_blocks, new_shape.direct_blocks, new_shape.indirect_blocks, new_shape.doubly_indirect_blocks, new_shape.triply_indirect_blocks, new_shape.meta_blocks);
 
     unsigned output_block_index = 0;
-    unsigned remaining_blocks = m_block_list.size();
+    unsigned remaining_blocks = new_block_count;
 
     // Deal with direct blocks.
     bool inode_dirty = false;
     VERIFY(new_shape.direct_blocks <= EXT2_NDIR_BLOCKS);
-    for (unsigned i = 0; i < new_shape.direct_blocks; ++i) {
-        if (BlockBasedFS::BlockIndex(m_raw_inode.i_block[i]) != m_block_list[output_block_index])
+    for (unsigned i = tail_start; i < new_shape.direct_blocks; ++i) {
+        if (BlockBasedFS::BlockIndex(m_raw_inode.i_block[i]) != new_tail[i - tail_start])
             inode_dirty = true;
-        m_raw_inode.i_block[i] = m_block_list[output_block_index].value();
-        ++output_block_index;
-        --remaining_blocks;
+        m_raw_inode.i_block[i] = new_tail[i - tail_start].value();
     }
+    output_block_index += new_shape.direct_blocks;
+    remaining_blocks -= new_shape.direct_blocks;
     // e2fsck considers all blocks reachable through any of the pointers in
     // m_raw_inode.i_block as part of this inode regardless of the value in
     // m_raw_inode.i_size. When it finds more blocks than the amount that
@@ -439,9 +456,9 @@ KResult Ext2FSInode::flush_block_list()
     }
     if (inode_dirty) {
         if constexpr (EXT2_DEBUG) {
-            dbgln("Ext2FSInode[{}]::flush_block_list(): Writing {} direct block(s) to i_block array of inode {}", identifier(), min((size_t)EXT2_NDIR_BLOCKS, m_block_list.size()), index());
-            for (size_t i = 0; i < min((size_t)EXT2_NDIR_BLOCKS, m_block_list.size()); ++i)
-                dbgln("   + {}", m_block_list[i]);
+            dbgln("Ext2FSInode[{}]::flush_block_list(): Writing {} direct block(s) to i_block array of inode {}", identifier(), new_shape.direct_blocks, index());
+            for (size_t i = 0; i < new_shape.direct_blocks; ++i)
+                dbgln("   + {}", m_raw_inode.i_block[i]);
         }
         set_metadata_dirty(true);
     }
@@ -458,7 +475,7 @@ KResult Ext2FSInode::flush_block_list()
                 old_shape.meta_blocks++;
             }
 
-            if (auto result = write_indirect_block(m_raw_inode.i_block[EXT2_IND_BLOCK], m_block_list.span().slice(output_block_index, new_shape.indirect_blocks)); result.is_error())
+            if (auto result = write_indirect_block(m_raw_inode.i_block[EXT2_IND_BLOCK], tail_for_section(output_block_index, new_shape.indirect_blocks)); result.is_error())
                 return result;
         } else if ((new_shape.indirect_blocks == 0) && (old_shape.indirect_blocks != 0)) {
             dbgln_if(EXT2_BLOCKLIST_DEBUG, "Ext2FSInode[{}]::flush_block_list(): Freeing indirect block: {}", identifier(), m_raw_inode.i_block[EXT2_IND_BLOCK]);
@@ -482,7 +499,7 @@ KResult Ext2FSInode::flush_block_list()
                 set_metadata_dirty(true);
                 old_shape.meta_blocks++;
             }
-            if (auto result = grow_doubly_indirect_block(m_raw_inode.i_block[EXT2_DIND_BLOCK], old_shape.doubly_indirect_blocks, m_block_list.span().slice(output_block_index, new_shape.doubly_indirect_blocks), new_meta_blocks, old_shape.meta_blocks); result.is_error())
+            if (auto result = grow_doubly_indirect_block(m_raw_inode.i_block[EXT2_DIND_BLOCK], old_shape.doubly_indirect_blocks, new_shape.doubly_indirect_blocks, tail_for_section(output_block_index, new_shape.doubly_indirect_blocks), new_meta_blocks, old_shape.meta_blocks); result.is_error())
                 return result;
         } else {
             if (auto result = shrink_doubly_indirect_block(m_raw_inode.i_block[EXT2_DIND_BLOCK], old_shape.doubly_indirect_blocks, new_shape.doubly_indirect_blocks, old_shape.meta_blocks); result.is_error())
@@ -505,7 +522,7 @@ KResult Ext2FSInode::flush_block_list()
                 set_metadata_dirty(true);
                 old_shape.meta_blocks++;
             }
-            if (auto result = grow_triply_indirect_block(m_raw_inode.i_block[EXT2_TIND_BLOCK], old_shape.triply_indirect_blocks, m_block_list.span().slice(output_block_index, new_shape.triply_indirect_blocks), new_meta_blocks, old_shape.meta_blocks); result.is_error())
+            if (auto result = grow_triply_indirect_block(m_raw_inode.i_block[EXT2_TIND_BLOCK], old_shape.triply_indirect_blocks, new_shape.triply_indirect_blocks, tail_for_section(output_block_index, new_shape.triply_indirect_blocks), new_meta_blocks, old_shape.meta_blocks); result.is_error())
                 return result;
         } else {
             if (auto result = shrink_triply_indirect_block(m_raw_inode.i_block[EXT2_TIND_BLOCK], old_shape.triply_indirect_blocks, new_shape.triply_indirect_blocks, old_shape.meta_blocks); result.is_error())
@@ -528,11 +545,6 @@ KResult Ext2FSInode::flush_block_list()
     VERIFY_NOT_REACHED();
 }
 
-Vector<Ext2FS::BlockIndex> Ext2FSInode::compute_block_list() const
-{
-    return compute_block_list_impl(false);
-}
-
 Vector<Ext2FS::BlockIndex> Ext2FSInode::compute_block_list_with_meta_blocks() const
 {
     return compute_block_list_impl(true);
@@ -642,6 +654,157 @@ Vector<Ext2FS::BlockIndex> Ext2FSInode::compute_block_list_impl_internal(const e
     return list;
 }
 
+unsigned Ext2FSInode::block_count() const
+{
+    // Symbolic links that fit inside the i_block array don't have any blocks.
+    if (is_symlink() && m_raw_inode.i_blocks == 0)
+        return 0;
+    return ceil_div(size(), static_cast<u64>(fs().block_size()));
+}
+
+unsigned Ext2FSInode::first_block_to_flush(unsigned old_block_count) const
+{
+    // Appending blocks rewrites the direct block pointers or the indirect block that the old last block lives in.
+    if (old_block_count < EXT2_NDIR_BLOCKS)
+        return 0;
+    return block_range_start(block_range_index(old_block_count));
+}
+
+unsigned Ext2FSInode::block_range_index(unsigned logical_block) const
+{
+    if (logical_block < EXT2_NDIR_BLOCKS)
+        return 0;
+    return 1 + (logical_block - EXT2_NDIR_BLOCKS) / EXT2_ADDR_PER_BLOCK(&fs().super_block());
+}
+
+unsigned Ext2FSInode::block_range_start(unsigned range_index) const
+{
+    if (range_index == 0)
+        return 0;
+    return EXT2_NDIR_BLOCKS + (range_index - 1) * EXT2_ADDR_PER_BLOCK(&fs().super_block());
+}
+
+KResultOr<BlockBasedFS::BlockIndex> Ext2FSInode::read_block_pointer(BlockBasedFS::BlockIndex array_block, unsigned index) const
+{
+    if (array_block.value() == 0)
+        return BlockBasedFS::BlockIndex(0);
+    u32 pointer = 0;
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer((u8*)&pointer);
+    if (auto result = fs().read_block(array_block, &buffer, sizeof(pointer), index * sizeof(pointer)); result.is_error())
+        return result.error();
+    return BlockBasedFS::BlockIndex(pointer);
+}
+
+KResultOr<BlockBasedFS::BlockIndex> Ext2FSInode::indirect_block_for_range(unsigned range_index) const
+{
+    VERIFY(range_index > 0);
+    unsigned entries_per_block = EXT2_ADDR_PER_BLOCK(&fs().super_block());
+    unsigned indirect_block_index = range_index - 1;
+    if (indirect_block_index == 0)
+        return BlockBasedFS::BlockIndex(m_raw_inode.i_block[EXT2_IND_BLOCK]);
+
+    indirect_block_index -= 1;
+    if (indirect_block_index < entries_per_block)
+        return read_block_pointer(m_raw_inode.i_block[EXT2_DIND_BLOCK], indirect_block_index);
+
+    indirect_block_index -= entries_per_block;
+    VERIFY(indirect_block_index / entries_per_block < entries_per_block);
+    auto doubly_indirect_block_or_error = read_block_pointer(m_raw_inode.i_block[EXT2_TIND_BLOCK], indirect_block_index / entries_per_block);
+    if (doubly_indirect_block_or_error.is_error())
+        return doubly_indirect_block_or_error.error();
+    return read_block_pointer(doubly_indirect_block_or_error.value(), indirect_block_index % entries_per_block);
+}
+
+KResult Ext2FSInode::load_block_runs(unsigned range_index) const
+{
+    auto block_count = this->block_count();
+    auto first_logical_block = block_range_start(range_index);
+    VERIFY(first_logical_block < block_count);
+
+    unsigned count;
+    ByteBuffer array_storage;
+    const u32* array;
+    if (range_index == 0) {
+        count = min(block_count, (unsigned)EXT2_NDIR_BLOCKS);
+        array = m_raw_inode.i_block;
+    } else {
+        count = min(block_count - first_logical_block, (unsigned)EXT2_ADDR_PER_BLOCK(&fs().super_block()));
+        auto indirect_block_or_error = indirect_block_for_range(range_index);
+        if (indirect_block_or_error.is_error())
+            return indirect_block_or_error.error();
+        array_storage = ByteBuffer::create_zeroed(count * sizeof(u32));
+        array = (const u32*)array_storage.data();
+        // A missing indirect block means that the whole range is a hole.
+        if (auto indirect_block = indirect_block_or_error.value(); indirect_block.value() != 0) {
+            auto buffer = UserOrKernelBuffer::for_kernel_buffer(array_storage.data());
+            if (auto result = fs().read_block(indirect_block, &buffer, array_storage.size()); result.is_error())
+                return result;
+        }
+    }
+
+    Vector<BlockRun> runs;
+    for (unsigned i = 0; i < count; ++i) {
+        BlockBasedFS::BlockIndex block_index = array[i];
+        if (!runs.is_empty()) {
+            auto& last_run = runs.last();
+            bool extends_last_run = block_index.value() == 0
+                ? last_run.first_block.value() == 0
+                : last_run.first_block.value() != 0 && last_run.first_block.value() + last_run.length == block_index.value();
+            if (extends_last_run) {
+                ++last_run.length;
+                continue;
+            }
+        }
+        runs.append({ first_logical_block + i, block_index, 1 });
+    }
+
+    dbgln_if(EXT2_BLOCKLIST_DEBUG, "Ext2FSInode[{}]::load_block_runs(): Range {} has {} block(s) in {} run(s)", identifier(), range_index, count, runs.size());
+    m_block_runs.set(range_index, move(runs));
+    return KSuccess;
+}
+
+KResultOr<Ext2FSInode::BlockRun> Ext2FSInode::block_run_at(unsigned logical_block) const
+{
+    VERIFY(logical_block < block_count());
+    auto range_index = block_range_index(logical_block);
+    auto it = m_block_runs.find(range_index);
+    if (it == m_block_runs.end()) {
+        if (auto result = load_block_runs(range_index); result.is_error())
+            return result.error();
+        it = m_block_runs.find(range_index);
+    }
+
+    // Find the last run that starts at or before the logical block.
+    auto& runs = it->value;
+    size_t low = 0;
+    size_t high = runs.size();
+    while (high - low > 1) {
+        auto middle = low + (high - low) / 2;
+        if (runs[middle].logical_block <= logical_block)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    auto& run = runs[low];
+    auto blocks_into_run = logical_block - run.logical_block;
+    VERIFY(blocks_into_run < run.length);
+    BlockBasedFS::BlockIndex first_block = run.first_block.value() ? run.first_block.value() + blocks_into_run : 0;
+    return BlockRun { logical_block, first_block, run.length - blocks_into_run };
+}
+
+void Ext2FSInode::forget_block_runs_from(unsigned logical_block)
+{
+    auto first_stale_range = block_range_index(logical_block);
+    Vector<unsigned> stale_ranges;
+    for (auto& it : m_block_runs) {
+        if (it.key >= first_stale_range)
+            stale_ranges.append(it.key);
+    }
+    for (auto range_index : stale_ranges)
+        m_block_runs.remove(range_index);
+}
+
 void Ext2FS::free_inode(Ext2FSInode& inode)
 {
     Locker locker(m_lock);
@@ -668,6 +831,7 @@ void Ext2FS::free_inode(Ext2FSInode& inode)
 
     // NOTE: After this point, the inode metadata is wiped.
     memset(&inode.m_raw_inode, 0, sizeof(ext2_inode));
+    inode.m_block_runs.clear();
     inode.m_raw_inode.i_dtime = kgettimeofday().to_truncated_seconds();
     write_ext2_inode(inode.index(), inode.m_raw_inode);
 
@@ -843,10 +1007,8 @@ KResultOr<ssize_t> Ext2FSInode::read_bytes(off_t offset, ssize_t count, UserOrKe
         return nread;
     }
 
-    if (m_block_list.is_empty())
-        m_block_list = compute_block_list();
-
-    if (m_block_list.is_empty()) {
+    auto block_count = this->block_count();
+    if (block_count == 0) {
         dmesgln("Ext2FSInode[{}]::read_bytes(): Empty block list", identifier());
         return EIO;
     }
@@ -855,10 +1017,10 @@ KResultOr<ssize_t> Ext2FSInode::read_bytes(off_t offset, ssize_t count, UserOrKe
 
     const int block_size = fs().block_size();
 
-    BlockBasedFS::BlockIndex first_block_logical_index = offset / block_size;
-    BlockBasedFS::BlockIndex last_block_logical_index = (offset + count) / block_size;
-    if (last_block_logical_index >= m_block_list.size())
-        last_block_logical_index = m_block_list.size() - 1;
+    unsigned first_block_logical_index = offset / block_size;
+    unsigned last_block_logical_index = (offset + count) / block_size;
+    if (last_block_logical_index >= block_count)
+        last_block_logical_index = block_count - 1;
 
     int offset_into_first_block = offset % block_size;
 
@@ -867,11 +1029,31 @@ KResultOr<ssize_t> Ext2FSInode::read_bytes(off_t offset, ssize_t count, UserOrKe
 
     dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::read_bytes(): Reading up to {} bytes, {} bytes into inode to {}", identifier(), count, offset, buffer.user_or_kernel_ptr());
 
-    for (auto bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index; bi = bi.value() + 1) {
-        auto block_index = m_block_list[bi.value()];
+    for (auto bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index;) {
+        auto run_or_error = block_run_at(bi);
+        if (run_or_error.is_error()) {
+            dmesgln("Ext2FSInode[{}]::read_bytes(): Failed to look up block (index {})", identifier(), bi);
+            return run_or_error.error();
+        }
+        auto run = run_or_error.release_value();
+        auto block_index = run.first_block;
         size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
-        size_t num_bytes_to_copy = min((size_t)block_size - offset_into_block, (size_t)remaining_count);
         auto buffer_offset = buffer.offset(nread);
+
+        // Whole blocks that are next to each other on disk are read in one go.
+        size_t whole_blocks = offset_into_block == 0 ? min((size_t)run.length, (size_t)remaining_count / block_size) : 0;
+        if (block_index.value() != 0 && whole_blocks > 1) {
+            if (auto result = fs().read_blocks(block_index, whole_blocks, buffer_offset, allow_cache); result.is_error()) {
+                dmesgln("Ext2FSInode[{}]::read_bytes(): Failed to read {} blocks at {} (index {})", identifier(), whole_blocks, block_index.value(), bi);
+                return result.error();
+            }
+            remaining_count -= whole_blocks * block_size;
+            nread += whole_blocks * block_size;
+            bi += whole_blocks;
+            continue;
+        }
+
+        size_t num_bytes_to_copy = min((size_t)block_size - offset_into_block, (size_t)remaining_count);
         if (block_index.value() == 0) {
             // This is a hole, act as if it's filled with zeroes.
             if (!buffer_offset.memset(0, num_bytes_to_copy))
@@ -884,6 +1066,7 @@ KResultOr<ssize_t> Ext2FSInode::read_bytes(off_t offset, ssize_t count, UserOrKe
         }
         remaining_count -= num_bytes_to_copy;
         nread += num_bytes_to_copy;
+        ++bi;
     }
 
     return nread;
@@ -899,7 +1082,7 @@ KResult Ext2FSInode::resize(u64 new_size)
         return ENOSPC;
 
     u64 block_size = fs().block_size();
-    auto blocks_needed_before = ceil_div(old_size, block_size);
+    auto blocks_needed_before = block_count();
     auto blocks_needed_after = ceil_div(new_size, block_size);
 
     if constexpr (EXT2_DEBUG) {
@@ -913,34 +1096,52 @@ KResult Ext2FSInode::resize(u64 new_size)
             return ENOSPC;
     }
 
-    if (m_block_list.is_empty())
-        m_block_list = this->compute_block_list();
-
+    Vector<BlockBasedFS::BlockIndex> new_tail;
     if (blocks_needed_after > blocks_needed_before) {
+        // Only the entries that share an indirect block with the new ones have to be written out again.
+        auto tail_start = first_block_to_flush(blocks_needed_before);
+        if (!new_tail.try_ensure_capacity(blocks_needed_after - tail_start))
+            return ENOMEM;
+        for (unsigned bi = tail_start; bi < blocks_needed_before;) {
+            auto run_or_error = block_run_at(bi);
+            if (run_or_error.is_error())
+                return run_or_error.error();
+            auto run = run_or_error.release_value();
+            auto length = min(run.length, (unsigned)blocks_needed_before - bi);
+            for (unsigned i = 0; i < length; ++i)
+                new_tail.unchecked_append(run.first_block.value() ? run.first_block.value() + i : 0);
+            bi += length;
+        }
+
         auto blocks_or_error = fs().allocate_blocks(fs().group_index_from_inode(index()), blocks_needed_after - blocks_needed_before);
         if (blocks_or_error.is_error())
             return blocks_or_error.error();
-        if (!m_block_list.try_append(blocks_or_error.release_value()))
-            return ENOMEM;
+        for (auto block_index : blocks_or_error.value())
+            new_tail.unchecked_append(block_index);
+
+        forget_block_runs_from(blocks_needed_before);
     } else if (blocks_needed_after < blocks_needed_before) {
-        if constexpr (EXT2_VERY_DEBUG) {
-            dbgln("Ext2FSInode[{}]::resize(): Shrinking inode, old block list is {} entries:", identifier(), m_block_list.size());
-            for (auto block_index : m_block_list) {
-                dbgln("    # {}", block_index);
-            }
-        }
-        while (m_block_list.size() != blocks_needed_after) {
-            auto block_index = m_block_list.take_last();
-            if (block_index.value()) {
+        dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::resize(): Shrinking inode from {} to {} blocks", identifier(), blocks_needed_before, blocks_needed_after);
+        for (unsigned bi = blocks_needed_after; bi < blocks_needed_before;) {
+            auto run_or_error = block_run_at(bi);
+            if (run_or_error.is_error())
+                return run_or_error.error();
+            auto run = run_or_error.release_value();
+            auto length = min(run.length, (unsigned)blocks_needed_before - bi);
+            for (unsigned i = 0; run.first_block.value() && i < length; ++i) {
+                auto block_index = run.first_block.value() + i;
                 if (auto result = fs().set_block_allocation_state(block_index, false); result.is_error()) {
                     dbgln("Ext2FSInode[{}]::resize(): Failed to free block {}: {}", identifier(), block_index, result.error());
                     return result;
                 }
             }
+            bi += length;
         }
+
+        forget_block_runs_from(blocks_needed_after);
     }
 
-    if (auto result = flush_block_list(); result.is_error())
+    if (auto result = flush_block_list(blocks_needed_after, new_tail.span()); result.is_error())
         return result;
 
     m_raw_inode.i_size = new_size;
@@ -1002,18 +1203,16 @@ KResultOr<ssize_t> Ext2FSInode::write_bytes(off_t offset, ssize_t count, const U
     if (auto result = resize(new_size); result.is_error())
         return result;
 
-    if (m_block_list.is_empty())
-        m_block_list = compute_block_list();
-
-    if (m_block_list.is_empty()) {
+    auto block_count = this->block_count();
+    if (block_count == 0) {
         dbgln("Ext2FSInode[{}]::write_bytes(): Empty block list", identifier());
         return EIO;
     }
 
-    BlockBasedFS::BlockIndex first_block_logical_index = offset / block_size;
-    BlockBasedFS::BlockIndex last_block_logical_index = (offset + count) / block_size;
-    if (last_block_logical_index >= m_block_list.size())
-        last_block_logical_index = m_block_list.size() - 1;
+    unsigned first_block_logical_index = offset / block_size;
+    unsigned last_block_logical_index = (offset + count) / block_size;
+    if (last_block_logical_index >= block_count)
+        last_block_logical_index = block_count - 1;
 
     size_t offset_into_first_block = offset % block_size;
 
@@ -1022,12 +1221,16 @@ KResultOr<ssize_t> Ext2FSInode::write_bytes(off_t offset, ssize_t count, const U
 
     dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::write_bytes(): Writing {} bytes, {} bytes into inode from {}", identifier(), count, offset, data.user_or_kernel_ptr());
 
-    for (auto bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index; bi = bi.value() + 1) {
+    for (auto bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index; ++bi) {
+        auto run_or_error = block_run_at(bi);
+        if (run_or_error.is_error())
+            return run_or_error.error();
+        auto block_index = run_or_error.value().first_block;
         size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
         size_t num_bytes_to_copy = min((size_t)block_size - offset_into_block, (size_t)remaining_count);
-        dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::write_bytes(): Writing block {} (offset_into_block: {})", identifier(), m_block_list[bi.value()], offset_into_block);
-        if (auto result = fs().write_block(m_block_list[bi.value()], data.offset(nwritten), num_bytes_to_copy, offset_into_block, allow_cache); result.is_error()) {
-            dbgln("Ext2FSInode[{}]::write_bytes(): Failed to write block {} (index {})", identifier(), m_block_list[bi.value()], bi);
+        dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::write_bytes(): Writing block {} (offset_into_block: {})", identifier(), block_index, offset_into_block);
+        if (auto result = fs().write_block(block_index, data.offset(nwritten), num_bytes_to_copy, offset_into_block, allow_cache); result.is_error()) {
+            dbgln("Ext2FSInode[{}]::write_bytes(): Failed to write block {} (index {})", identifier(), block_index, bi);
             return result;
         }
         remaining_count -= num_bytes_to_copy;
@@ -1036,7 +1239,7 @@ KResultOr<ssize_t> Ext2FSInode::write_bytes(off_t offset, ssize_t count, const U
 
     did_modify_contents();
 
-    dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::write_bytes(): After write, i_size={}, i_blocks={} ({} blocks in list)", identifier(), size(), m_raw_inode.i_blocks, m_block_list.size());
+    dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::write_bytes(): After write, i_size={}, i_blocks={} ({} blocks in list)", identifier(), size(), m_raw_inode.i_blocks, this->block_count());
     return nwritten;
 }
 
@@ -1080,12 +1283,14 @@ KResult Ext2FSInode::traverse_as_directory(Function<bool(const FS::DirectoryEntr
     auto block_size = fs().block_size();
     bool allow_cache = true;
 
-    if (m_block_list.is_empty())
-        m_block_list = compute_block_list();
-
     // Directory entries are guaranteed not to span multiple blocks,
     // so we can iterate over blocks separately.
-    for (auto& block_index : m_block_list) {
+    auto block_count = this->block_count();
+    for (unsigned bi = 0; bi < block_count; ++bi) {
+        auto run_or_error = block_run_at(bi);
+        if (run_or_error.is_error())
+            return run_or_error.error();
+        auto block_index = run_or_error.value().first_block;
         VERIFY(block_index.value() != 0);
         if (auto result = fs().read_block(block_index, &buf, block_size, 0, allow_cache); result.is_error()) {
             return result;
@@ -1743,13 +1948,13 @@ KResultOr<int> Ext2FSInode::get_block_address(int index)
 {
     Locker locker(m_lock);
 
-    if (m_block_list.is_empty())
-        m_block_list = compute_block_list();
-
-    if (index < 0 || (size_t)index >= m_block_list.size())
+    if (index < 0 || (unsigned)index >= block_count())
         return 0;
 
-    return m_block_list[index].value();
+    auto run_or_error = block_run_at(index);
+    if (run_or_error.is_error())
+        return run_or_error.error();
+    return run_or_error.value().first_block.value();
 }
 
 unsigned Ext2FS::total_block_count() const
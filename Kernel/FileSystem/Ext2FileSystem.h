@@ -62,21 +62,40 @@ private:
     bool populate_lookup_cache() const;
     KResult resize(u64);
     KResult write_indirect_block(BlockBasedFS::BlockIndex, Span<BlockBasedFS::BlockIndex>);
-    KResult grow_doubly_indirect_block(BlockBasedFS::BlockIndex, size_t, Span<BlockBasedFS::BlockIndex>, Vector<BlockBasedFS::BlockIndex>&, unsigned&);
+    KResult grow_doubly_indirect_block(BlockBasedFS::BlockIndex, size_t, size_t, Span<BlockBasedFS::BlockIndex>, Vector<BlockBasedFS::BlockIndex>&, unsigned&);
     KResult shrink_doubly_indirect_block(BlockBasedFS::BlockIndex, size_t, size_t, unsigned&);
-    KResult grow_triply_indirect_block(BlockBasedFS::BlockIndex, size_t, Span<BlockBasedFS::BlockIndex>, Vector<BlockBasedFS::BlockIndex>&, unsigned&);
+    KResult grow_triply_indirect_block(BlockBasedFS::BlockIndex, size_t, size_t, Span<BlockBasedFS::BlockIndex>, Vector<BlockBasedFS::BlockIndex>&, unsigned&);
     KResult shrink_triply_indirect_block(BlockBasedFS::BlockIndex, size_t, size_t, unsigned&);
-    KResult flush_block_list();
-    Vector<BlockBasedFS::BlockIndex> compute_block_list() const;
+    KResult flush_block_list(unsigned new_block_count, Span<BlockBasedFS::BlockIndex> new_tail);
     Vector<BlockBasedFS::BlockIndex> compute_block_list_with_meta_blocks() const;
     Vector<BlockBasedFS::BlockIndex> compute_block_list_impl(bool include_block_list_blocks) const;
     Vector<BlockBasedFS::BlockIndex> compute_block_list_impl_internal(const ext2_inode& e2inode, bool include_block_list_blocks) const;
 
+    // A run of logically consecutive blocks that are also consecutive on disk.
+    // Holes are runs whose first_block is 0.
+    struct BlockRun {
+        unsigned logical_block { 0 };
+        BlockBasedFS::BlockIndex first_block { 0 };
+        unsigned length { 0 };
+    };
+
+    unsigned block_count() const;
+    unsigned first_block_to_flush(unsigned old_block_count) const;
+    unsigned block_range_index(unsigned logical_block) const;
+    unsigned block_range_start(unsigned range_index) const;
+    KResultOr<BlockBasedFS::BlockIndex> read_block_pointer(BlockBasedFS::BlockIndex array_block, unsigned index) const;
+    KResultOr<BlockBasedFS::BlockIndex> indirect_block_for_range(unsigned range_index) const;
+    KResult load_block_runs(unsigned range_index) const;
+    KResultOr<BlockRun> block_run_at(unsigned logical_block) const;
+    void forget_block_runs_from(unsigned logical_block);
+
     Ext2FS& fs();
     const Ext2FS& fs() const;
     Ext2FSInode(Ext2FS&, InodeIndex);
 
-    mutable Vector<BlockBasedFS::BlockIndex> m_block_list;
+    // Runs are kept per block range: range 0 is the direct blocks, and every range after that
+    // is the set of blocks listed in one indirect block. A range is only read in when needed.
+    mutable HashMap<unsigned, Vector<BlockRun>> m_block_runs;
     mutable HashMap<String, InodeIndex> m_lookup_cache;
     ext2_inode m_raw_inode;
 };
@@ -67,6 +67,7 @@ FileDescription::FileDescription(File& file)
 
 FileDescription::~FileDescription()
 {
+    EventPoll::detach_description({}, m_event_poll_interests);
     m_file->detach(*this);
     if (is_fifo())
         static_cast<FIFO*>(m_file.ptr())->detach(m_fifo_direction);
@@ -185,6 +186,30 @@ KResultOr<size_t> FileDescription::write(const UserOrKernelBuffer& data, size_t
     return nwritten_or_error;
 }
 
+KResultOr<size_t> FileDescription::read(UserOrKernelBuffer& buffer, u64 offset, size_t count)
+{
+    // NOTE: The current offset isn't involved, so there's no need to take m_lock here.
+    //       This lets several threads read from the same description at once.
+    VERIFY(m_file->is_seekable());
+    if (Checked<off_t>::addition_would_overflow(offset, count))
+        return EOVERFLOW;
+    auto nread_or_error = m_file->read(*this, offset, buffer, count);
+    if (!nread_or_error.is_error())
+        evaluate_block_conditions();
+    return nread_or_error;
+}
+
+KResultOr<size_t> FileDescription::write(u64 offset, const UserOrKernelBuffer& data, size_t size)
+{
+    VERIFY(m_file->is_seekable());
+    if (Checked<off_t>::addition_would_overflow(offset, size))
+        return EOVERFLOW;
+    auto nwritten_or_error = m_file->write(*this, offset, data, size);
+    if (!nwritten_or_error.is_error())
+        evaluate_block_conditions();
+    return nwritten_or_error;
+}
+
 bool FileDescription::can_write() const
 {
     return m_file->can_write(*this, offset());
@@ -326,6 +351,25 @@ InodeWatcher* FileDescription::inode_watcher()
     return static_cast<InodeWatcher*>(m_file.ptr());
 }
 
+bool FileDescription::is_event_poll() const
+{
+    return m_file->is_event_poll();
+}
+
+const EventPoll* FileDescription::event_poll() const
+{
+    if (!is_event_poll())
+        return nullptr;
+    return static_cast<const EventPoll*>(m_file.ptr());
+}
+
+EventPoll* FileDescription::event_poll()
+{
+    if (!is_event_poll())
+        return nullptr;
+    return static_cast<EventPoll*>(m_file.ptr());
+}
+
 bool FileDescription::is_master_pty() const
 {
     return m_file->is_master_pty();
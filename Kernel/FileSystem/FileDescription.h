@@ -9,6 +9,7 @@
 #include <AK/Badge.h>
 #include <AK/ByteBuffer.h>
 #include <AK/RefCounted.h>
+#include <Kernel/FileSystem/EventPoll.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
@@ -49,6 +50,10 @@ public:
     KResultOr<off_t> seek(off_t, int whence);
     KResultOr<size_t> read(UserOrKernelBuffer&, size_t);
     KResultOr<size_t> write(const UserOrKernelBuffer& data, size_t);
+
+    // Positional I/O for seekable files. These don't use or move the current offset.
+    KResultOr<size_t> read(UserOrKernelBuffer&, u64 offset, size_t);
+    KResultOr<size_t> write(u64 offset, const UserOrKernelBuffer& data, size_t);
     KResult stat(::stat&);
 
     KResult chmod(mode_t);
@@ -81,6 +86,10 @@ public:
     const InodeWatcher* inode_watcher() const;
     InodeWatcher* inode_watcher();
 
+    bool is_event_poll() const;
+    const EventPoll* event_poll() const;
+    EventPoll* event_poll();
+
     bool is_master_pty() const;
     const MasterPTY* master_pty() const;
     MasterPTY* master_pty();
@@ -119,10 +128,24 @@ public:
 
     off_t offset() const { return m_current_offset; }
 
+    // Calls back with the current offset and moves it along by as much as the callback consumed,
+    // holding the lock all the while, just like read() does.
+    template<typename Callback>
+    KResultOr<size_t> consume_at_current_offset(Callback callback)
+    {
+        Locker locker(m_lock);
+        auto result = callback(m_current_offset);
+        if (!result.is_error())
+            m_current_offset += result.value();
+        return result;
+    }
+
     KResult chown(uid_t, gid_t);
 
     FileBlockCondition& block_condition();
 
+    EventPoll::Interest::DescriptionList& event_poll_interests(Badge<EventPoll>) { return m_event_poll_interests; }
+
 private:
     friend class VFS;
     explicit FileDescription(File&);
@@ -142,6 +165,9 @@ private:
 
     OwnPtr<FileDescriptionData> m_data;
 
+    // The EventPolls that are watching this description.
+    EventPoll::Interest::DescriptionList m_event_poll_interests;
+
     u32 m_file_flags { 0 };
 
     bool m_readable : 1 { false };
@@ -23,12 +23,14 @@
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/ProcFS.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/Heap/Magazine.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/Interrupts/GenericInterruptHandler.h>
 #include <Kernel/Interrupts/InterruptManagement.h>
 #include <Kernel/KBufferBuilder.h>
 #include <Kernel/Module.h>
 #include <Kernel/Net/LocalSocket.h>
+#include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/NetworkAdapter.h>
 #include <Kernel/Net/NetworkingManagement.h>
 #include <Kernel/Net/Routing.h>
@@ -66,6 +68,7 @@ enum ProcFileType {
     FI_Root_df,
     FI_Root_all,
     FI_Root_memstat,
+    FI_Root_allocator_caches,
     FI_Root_cpuinfo,
     FI_Root_dmesg,
     FI_Root_interrupts,
@@ -529,6 +532,9 @@ static bool procfs$net_tcp(InodeIdentifier, KBufferBuilder& builder)
         obj.add("bytes_in", socket.bytes_in());
         obj.add("packets_out", socket.packets_out());
         obj.add("bytes_out", socket.bytes_out());
+        obj.add("congestion_window", socket.congestion_window());
+        obj.add("slow_start_threshold", socket.slow_start_threshold());
+        obj.add("retransmits", socket.retransmits());
     });
     array.finish();
     return true;
@@ -725,6 +731,11 @@ static bool procfs$memstat(InodeIdentifier, KBufferBuilder& builder)
     auto super_physical_used = MM.super_physical_pages_used();
     mm_lock.unlock();
 
+    auto zeroed_page_pool_size = MM.zeroed_page_pool_size();
+    auto zeroed_page_pool_hits = MM.zeroed_page_pool_hits();
+    auto zeroed_page_pool_misses = MM.zeroed_page_pool_misses();
+    auto large_page_mappings = MM.large_page_mappings();
+
     JsonObjectSerializer<KBufferBuilder> json { builder };
     json.add("kmalloc_allocated", stats.bytes_allocated);
     json.add("kmalloc_available", stats.bytes_free);
@@ -735,6 +746,10 @@ static bool procfs$memstat(InodeIdentifier, KBufferBuilder& builder)
     json.add("user_physical_uncommitted", user_physical_pages_uncommitted);
     json.add("super_physical_allocated", super_physical_used);
     json.add("super_physical_available", super_physical_total - super_physical_used);
+    json.add("zeroed_page_pool_size", zeroed_page_pool_size);
+    json.add("zeroed_page_pool_hits", zeroed_page_pool_hits);
+    json.add("zeroed_page_pool_misses", zeroed_page_pool_misses);
+    json.add("large_page_mappings", large_page_mappings);
     json.add("kmalloc_call_count", stats.kmalloc_call_count);
     json.add("kfree_call_count", stats.kfree_call_count);
     slab_alloc_stats([&json](size_t slab_size, size_t num_allocated, size_t num_free) {
@@ -746,6 +761,36 @@ static bool procfs$memstat(InodeIdentifier, KBufferBuilder& builder)
     return true;
 }
 
+static bool procfs$allocator_caches(InodeIdentifier, KBufferBuilder& builder)
+{
+    auto add_statistics = [](auto& object, const MagazineStatistics& statistics) {
+        object.add("alloc_hits", statistics.alloc_hits);
+        object.add("alloc_misses", statistics.alloc_misses);
+        object.add("free_hits", statistics.free_hits);
+        object.add("free_misses", statistics.free_misses);
+    };
+
+    JsonArraySerializer array { builder };
+    for (u32 processor = 0; processor < Processor::count(); ++processor) {
+        auto processor_object = array.add_object();
+        processor_object.add("processor", processor);
+        {
+            auto kmalloc_object = processor_object.add_object("kmalloc");
+            add_statistics(kmalloc_object, kmalloc_processor_cache_stats(processor));
+        }
+        auto slabs_array = processor_object.add_array("slabs");
+        slab_alloc_processor_cache_stats([&](u32 slab_processor, size_t slab_size, auto& statistics) {
+            if (slab_processor != processor)
+                return;
+            auto slab_object = slabs_array.add_object();
+            slab_object.add("slab_size", slab_size);
+            add_statistics(slab_object, statistics);
+        });
+    }
+    array.finish();
+    return true;
+}
+
 static bool procfs$all(InodeIdentifier, KBufferBuilder& builder)
 {
     JsonArraySerializer array { builder };
@@ -971,6 +1016,7 @@ bool ProcFS::initialize()
     static Lockable<bool>* kmalloc_stack_helper;
     static Lockable<bool>* ubsan_deadly_helper;
     static Lockable<bool>* caps_lock_to_ctrl_helper;
+    static Lockable<bool>* loopback_packet_loss_helper;
 
     if (kmalloc_stack_helper == nullptr) {
         kmalloc_stack_helper = new Lockable<bool>();
@@ -987,6 +1033,10 @@ bool ProcFS::initialize()
         ProcFS::add_sys_bool("caps_lock_to_ctrl", *caps_lock_to_ctrl_helper, [] {
             Kernel::g_caps_lock_remapped_to_ctrl.exchange(caps_lock_to_ctrl_helper->resource());
         });
+        loopback_packet_loss_helper = new Lockable<bool>();
+        ProcFS::add_sys_bool("loopback_packet_loss", *loopback_packet_loss_helper, [] {
+            Kernel::g_loopback_packet_loss.exchange(loopback_packet_loss_helper->resource());
+        });
     }
     return true;
 }
@@ -1690,6 +1740,7 @@ ProcFS::ProcFS()
     m_entries[FI_Root_df] = { "df", FI_Root_df, false, procfs$df };
     m_entries[FI_Root_all] = { "all", FI_Root_all, false, procfs$all };
     m_entries[FI_Root_memstat] = { "memstat", FI_Root_memstat, false, procfs$memstat };
+    m_entries[FI_Root_allocator_caches] = { "allocator_caches", FI_Root_allocator_caches, false, procfs$allocator_caches };
     m_entries[FI_Root_cpuinfo] = { "cpuinfo", FI_Root_cpuinfo, false, procfs$cpuinfo };
     m_entries[FI_Root_dmesg] = { "dmesg", FI_Root_dmesg, true, procfs$dmesg };
     m_entries[FI_Root_self] = { "self", FI_Root_self, false, procfs$self };
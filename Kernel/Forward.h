@@ -8,6 +8,7 @@
 
 namespace Kernel {
 
+class AsyncBlockDeviceRequest;
 class BlockDevice;
 class CharacterDevice;
 class CoreDump;
@@ -15,6 +16,7 @@ class Custody;
 class Device;
 class DiskCache;
 class DoubleBuffer;
+class EventPoll;
 class File;
 class FileDescription;
 class FutexQueue;
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// A small stack of free objects that belongs to a single processor. The kernel allocators
+// keep one of these per processor (and size class) in front of their shared free lists,
+// and only go to the shared state to move a whole batch of objects in or out.
+// A magazine must only be touched by its own processor with interrupts disabled,
+// or under a lock.
+template<typename T, size_t capacity>
+class Magazine {
+public:
+    static constexpr size_t batch_size = capacity / 2;
+
+    bool is_empty() const { return m_count == 0; }
+    bool is_full() const { return m_count == capacity; }
+    size_t size() const { return m_count; }
+
+    void push(T object)
+    {
+        VERIFY(!is_full());
+        m_objects[m_count++] = object;
+    }
+
+    T pop()
+    {
+        VERIFY(!is_empty());
+        return m_objects[--m_count];
+    }
+
+private:
+    T m_objects[capacity];
+    size_t m_count { 0 };
+};
+
+struct MagazineStatistics {
+    size_t alloc_hits { 0 };
+    size_t alloc_misses { 0 };
+    size_t free_hits { 0 };
+    size_t free_misses { 0 };
+};
+
+}
@@ -6,6 +6,8 @@
 
 #include <AK/Assertions.h>
 #include <AK/Memory.h>
+#include <Kernel/Arch/x86/CPU.h>
+#include <Kernel/Heap/Magazine.h>
 #include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/SpinLock.h>
@@ -39,25 +41,27 @@ public:
 
     void* alloc()
     {
-        FreeSlab* free_slab;
-        {
-            // We want to avoid being swapped out in the middle of this
-            ScopedCritical critical;
-            FreeSlab* next_free;
-            free_slab = m_freelist.load(AK::memory_order_consume);
-            do {
-                if (!free_slab)
-                    return kmalloc(slab_size());
-                // It's possible another processor is doing the same thing at
-                // the same time, so next_free *can* be a bogus pointer. However,
-                // in that case compare_exchange_strong would fail and we would
-                // try again.
-                next_free = free_slab->next;
-            } while (!m_freelist.compare_exchange_strong(free_slab, next_free, AK::memory_order_acq_rel));
-
-            m_num_allocated++;
+        FreeSlab* free_slab = nullptr;
+        if (Processor::is_initialized()) {
+            InterruptDisabler disabler;
+            auto& cache = m_processor_caches[Processor::id()];
+            if (cache.magazine.is_empty()) {
+                ++cache.statistics.alloc_misses;
+                refill(cache.magazine);
+            } else {
+                ++cache.statistics.alloc_hits;
+            }
+            if (!cache.magazine.is_empty())
+                free_slab = (FreeSlab*)cache.magazine.pop();
+        } else {
+            ScopedSpinLock lock(m_lock);
+            free_slab = take_from_freelist();
         }
 
+        if (!free_slab)
+            return kmalloc(slab_size());
+        m_num_allocated++;
+
 #ifdef SANITIZE_SLABS
         memset(free_slab, SLAB_ALLOC_SCRUB_BYTE, slab_size());
 #endif
@@ -77,12 +81,20 @@ public:
             memset(free_slab->padding, SLAB_DEALLOC_SCRUB_BYTE, sizeof(FreeSlab::padding));
 #endif
 
-        // We want to avoid being swapped out in the middle of this
-        ScopedCritical critical;
-        FreeSlab* next_free = m_freelist.load(AK::memory_order_consume);
-        do {
-            free_slab->next = next_free;
-        } while (!m_freelist.compare_exchange_strong(next_free, free_slab, AK::memory_order_acq_rel));
+        if (Processor::is_initialized()) {
+            InterruptDisabler disabler;
+            auto& cache = m_processor_caches[Processor::id()];
+            if (cache.magazine.is_full()) {
+                ++cache.statistics.free_misses;
+                drain(cache.magazine);
+            } else {
+                ++cache.statistics.free_hits;
+            }
+            cache.magazine.push(free_slab);
+        } else {
+            ScopedSpinLock lock(m_lock);
+            give_to_freelist(free_slab);
+        }
 
         m_num_allocated--;
     }
@@ -90,17 +102,71 @@ public:
     size_t num_allocated() const { return m_num_allocated; }
     size_t num_free() const { return m_slab_count - m_num_allocated; }
 
+    template<typename Callback>
+    void for_each_processor_cache(Callback callback) const
+    {
+        for (u32 id = 0; id < min(Processor::count(), max_processor_caches); ++id)
+            callback(id, m_processor_caches[id].statistics);
+    }
+
 private:
     struct FreeSlab {
         FreeSlab* next;
         char padding[templated_slab_size - sizeof(FreeSlab*)];
     };
 
-    Atomic<FreeSlab*> m_freelist { nullptr };
+    using SlabMagazine = Magazine<void*, 32>;
+
+    struct ProcessorCache {
+        SlabMagazine magazine;
+        MagazineStatistics statistics;
+    };
+
+    static constexpr u32 max_processor_caches = ProcessorContainer {}.size();
+
+    FreeSlab* take_from_freelist()
+    {
+        VERIFY(m_lock.is_locked());
+        auto* free_slab = m_freelist;
+        if (free_slab)
+            m_freelist = free_slab->next;
+        return free_slab;
+    }
+
+    void give_to_freelist(FreeSlab* free_slab)
+    {
+        VERIFY(m_lock.is_locked());
+        free_slab->next = m_freelist;
+        m_freelist = free_slab;
+    }
+
+    void refill(SlabMagazine& magazine)
+    {
+        ScopedSpinLock lock(m_lock);
+        while (magazine.size() < SlabMagazine::batch_size) {
+            auto* free_slab = take_from_freelist();
+            if (!free_slab)
+                break;
+            magazine.push(free_slab);
+        }
+    }
+
+    void drain(SlabMagazine& magazine)
+    {
+        ScopedSpinLock lock(m_lock);
+        for (size_t i = 0; i < SlabMagazine::batch_size; ++i)
+            give_to_freelist((FreeSlab*)magazine.pop());
+    }
+
+    // Only refills and drains of whole batches touch the shared freelist,
+    // so a plain spinlock is cheap enough here.
+    SpinLock<u8> m_lock;
+    FreeSlab* m_freelist { nullptr };
     Atomic<ssize_t, AK::MemoryOrder::memory_order_relaxed> m_num_allocated;
     size_t m_slab_count;
     void* m_base { nullptr };
     void* m_end { nullptr };
+    ProcessorCache m_processor_caches[max_processor_caches];
 
     static_assert(sizeof(FreeSlab) == templated_slab_size);
 };
@@ -166,4 +232,13 @@ void slab_alloc_stats(Function<void(size_t slab_size, size_t allocated, size_t f
     });
 }
 
+void slab_alloc_processor_cache_stats(Function<void(u32 processor, size_t slab_size, const MagazineStatistics&)> callback)
+{
+    for_each_allocator([&](auto& allocator) {
+        allocator.for_each_processor_cache([&](u32 processor, auto& statistics) {
+            callback(processor, allocator.slab_size(), statistics);
+        });
+    });
+}
+
 }
@@ -11,6 +11,8 @@
 
 namespace Kernel {
 
+struct MagazineStatistics;
+
 #define SLAB_ALLOC_SCRUB_BYTE 0xab
 #define SLAB_DEALLOC_SCRUB_BYTE 0xbc
 
@@ -18,6 +20,7 @@ void* slab_alloc(size_t slab_size);
 void slab_dealloc(void*, size_t slab_size);
 void slab_alloc_init();
 void slab_alloc_stats(Function<void(size_t slab_size, size_t allocated, size_t free)>);
+void slab_alloc_processor_cache_stats(Function<void(u32 processor, size_t slab_size, const MagazineStatistics&)>);
 
 #define MAKE_SLAB_ALLOCATED(type)                                                          \
 public:                                                                                    \
@@ -15,6 +15,7 @@
 #include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Heap/Heap.h>
+#include <Kernel/Heap/Magazine.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Panic.h>
@@ -196,11 +197,97 @@ bool g_dump_kmalloc_stacks;
 static u8* s_next_eternal_ptr;
 READONLY_AFTER_INIT static u8* s_end_of_eternal_range;
 
+// Small allocations are served from per-processor magazines, one per chunk count. They
+// only hold on to real heap allocations, so anything in them can go back to the heap as usual.
+static constexpr size_t KMALLOC_CACHED_CHUNK_CLASSES = 4;
+using KmallocMagazine = Magazine<void*, 32>;
+using KmallocHeapType = KmallocGlobalHeap::HeapType::HeapType;
+
+struct KmallocProcessorCache {
+    KmallocMagazine magazines[KMALLOC_CACHED_CHUNK_CLASSES];
+    MagazineStatistics statistics;
+};
+
+static constexpr u32 s_kmalloc_processor_cache_count = ProcessorContainer {}.size();
+static KmallocProcessorCache s_kmalloc_processor_caches[s_kmalloc_processor_cache_count];
+
 static void kmalloc_allocate_backup_memory()
 {
     g_kmalloc_global->allocate_backup_memory();
 }
 
+static void kmalloc_add_perf_event(size_t size, void* ptr)
+{
+    Thread* current_thread = Thread::current();
+    if (!current_thread)
+        current_thread = Processor::idle_thread();
+    if (current_thread)
+        PerformanceManager::add_kmalloc_perf_event(*current_thread, size, (FlatPtr)ptr);
+}
+
+static bool kmalloc_can_use_processor_caches()
+{
+    // The backtrace dumping wants to see every single allocation.
+    return !g_dump_kmalloc_stacks && Processor::is_initialized();
+}
+
+static void* kmalloc_from_processor_cache(size_t size)
+{
+    auto chunks = KmallocHeapType::chunks_needed_for(size);
+    if (chunks > KMALLOC_CACHED_CHUNK_CLASSES || !kmalloc_can_use_processor_caches())
+        return nullptr;
+    auto usable_size = KmallocHeapType::usable_size_for_chunks(chunks);
+
+    InterruptDisabler disabler;
+    auto& cache = s_kmalloc_processor_caches[Processor::id()];
+    auto& magazine = cache.magazines[chunks - 1];
+    if (magazine.is_empty()) {
+        ++cache.statistics.alloc_misses;
+        ScopedSpinLock lock(s_lock);
+        ++g_kmalloc_call_count;
+        while (magazine.size() < KmallocMagazine::batch_size) {
+            // Allocate the largest size with this chunk count, so any request of the class fits.
+            void* ptr = g_kmalloc_global->m_heap.allocate(usable_size);
+            if (!ptr)
+                break;
+            magazine.push(ptr);
+        }
+        if (magazine.is_empty())
+            return nullptr;
+    } else {
+        ++cache.statistics.alloc_hits;
+    }
+
+    void* ptr = magazine.pop();
+    __builtin_memset(ptr, KMALLOC_SCRUB_BYTE, usable_size);
+    return ptr;
+}
+
+static bool kfree_to_processor_cache(void* ptr)
+{
+    if (!kmalloc_can_use_processor_caches())
+        return false;
+    auto chunks = KmallocHeapType::allocation_size_in_chunks(ptr);
+    if (chunks > KMALLOC_CACHED_CHUNK_CLASSES)
+        return false;
+    __builtin_memset(ptr, KFREE_SCRUB_BYTE, KmallocHeapType::usable_size_for_chunks(chunks));
+
+    InterruptDisabler disabler;
+    auto& cache = s_kmalloc_processor_caches[Processor::id()];
+    auto& magazine = cache.magazines[chunks - 1];
+    if (magazine.is_full()) {
+        ++cache.statistics.free_misses;
+        ScopedSpinLock lock(s_lock);
+        ++g_kfree_call_count;
+        for (size_t i = 0; i < KmallocMagazine::batch_size; ++i)
+            g_kmalloc_global->m_heap.deallocate(magazine.pop());
+    } else {
+        ++cache.statistics.free_hits;
+    }
+    magazine.push(ptr);
+    return true;
+}
+
 void kmalloc_enable_expand()
 {
     g_kmalloc_global->allocate_backup_memory();
@@ -244,6 +331,11 @@ void* kmalloc_eternal(size_t size)
 void* kmalloc(size_t size)
 {
     kmalloc_verify_nospinlock_held();
+    if (void* ptr = kmalloc_from_processor_cache(size)) {
+        kmalloc_add_perf_event(size, ptr);
+        return ptr;
+    }
+
     ScopedSpinLock lock(s_lock);
     ++g_kmalloc_call_count;
 
@@ -257,12 +349,7 @@ void* kmalloc(size_t size)
         PANIC("kmalloc: Out of memory (requested size: {})", size);
     }
 
-    Thread* current_thread = Thread::current();
-    if (!current_thread)
-        current_thread = Processor::idle_thread();
-    if (current_thread)
-        PerformanceManager::add_kmalloc_perf_event(*current_thread, size, (FlatPtr)ptr);
-
+    kmalloc_add_perf_event(size, ptr);
     return ptr;
 }
 
@@ -272,6 +359,12 @@ void kfree(void* ptr)
         return;
 
     kmalloc_verify_nospinlock_held();
+    if (kfree_to_processor_cache(ptr)) {
+        if (Thread* current_thread = Thread::current())
+            PerformanceManager::add_kfree_perf_event(*current_thread, 0, (FlatPtr)ptr);
+        return;
+    }
+
     ScopedSpinLock lock(s_lock);
     ++g_kfree_call_count;
     ++g_nested_kfree_calls;
@@ -338,4 +431,14 @@ void get_kmalloc_stats(kmalloc_stats& stats)
     stats.bytes_eternal = g_kmalloc_bytes_eternal;
     stats.kmalloc_call_count = g_kmalloc_call_count;
     stats.kfree_call_count = g_kfree_call_count;
+    for (u32 id = 0; id < min(Processor::count(), s_kmalloc_processor_cache_count); ++id) {
+        stats.kmalloc_call_count += s_kmalloc_processor_caches[id].statistics.alloc_hits;
+        stats.kfree_call_count += s_kmalloc_processor_caches[id].statistics.free_hits;
+    }
+}
+
+Kernel::MagazineStatistics kmalloc_processor_cache_stats(u32 processor)
+{
+    VERIFY(processor < s_kmalloc_processor_cache_count);
+    return s_kmalloc_processor_caches[processor].statistics;
 }
@@ -35,6 +35,11 @@ struct kmalloc_stats {
 };
 void get_kmalloc_stats(kmalloc_stats&);
 
+namespace Kernel {
+struct MagazineStatistics;
+}
+Kernel::MagazineStatistics kmalloc_processor_cache_stats(u32 processor);
+
 extern bool g_dump_kmalloc_stacks;
 
 inline void* operator new(size_t, void* p) { return p; }
@@ -329,6 +329,13 @@ void Lock::restore_lock(Mode mode, u32 lock_count)
     }
 }
 
+bool Lock::own_lock() const
+{
+    // NOTE: Shared holders are only tracked on a best effort basis, so this only
+    //       recognizes locks that the current thread holds exclusively.
+    return m_mode == Mode::Exclusive && m_holder.ptr() == Thread::current();
+}
+
 void Lock::clear_waiters()
 {
     VERIFY(m_mode != Mode::Shared);
@@ -41,6 +41,7 @@ public:
     void unlock();
     [[nodiscard]] Mode force_unlock_if_locked(u32&);
     [[nodiscard]] bool is_locked() const { return m_mode != Mode::Unlocked; }
+    [[nodiscard]] bool own_lock() const;
     void clear_waiters();
 
     [[nodiscard]] const char* name() const { return m_name; }
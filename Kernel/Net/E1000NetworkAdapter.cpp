@@ -8,6 +8,7 @@
 #include <Kernel/Debug.h>
 #include <Kernel/Net/E1000NetworkAdapter.h>
 #include <Kernel/PCI/IDs.h>
+#include <Kernel/Process.h>
 
 namespace Kernel {
 
@@ -314,11 +315,11 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::initialize_rx_descriptors()
     auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
     for (size_t i = 0; i < number_of_rx_descriptors; ++i) {
         auto& descriptor = rx_descriptors[i];
-        auto region = MM.allocate_contiguous_kernel_region(8192, "E1000 RX buffer", Region::Access::Read | Region::Access::Write);
-        VERIFY(region);
-        m_rx_buffers_regions.append(region.release_nonnull());
-        descriptor.addr = m_rx_buffers_regions[i].physical_page(0)->paddr().get();
+        auto packet = acquire_packet_buffer(rx_buffer_size);
+        VERIFY(packet);
+        descriptor.addr = rx_buffer_physical_address(*packet).get();
         descriptor.status = 0;
+        m_rx_buffers.append(packet.release_nonnull());
     }
 
     out32(REG_RXDESCLO, m_rx_descriptors_region->physical_page(0)->paddr().get());
@@ -327,7 +328,7 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::initialize_rx_descriptors()
     out32(REG_RXDESCHEAD, 0);
     out32(REG_RXDESCTAIL, number_of_rx_descriptors - 1);
 
-    out32(REG_RCTRL, RCTL_EN | RCTL_SBP | RCTL_UPE | RCTL_MPE | RCTL_LBM_NONE | RTCL_RDMTS_HALF | RCTL_BAM | RCTL_SECRC | RCTL_BSIZE_8192);
+    out32(REG_RCTRL, RCTL_EN | RCTL_SBP | RCTL_UPE | RCTL_MPE | RCTL_LBM_NONE | RTCL_RDMTS_HALF | RCTL_BAM | RCTL_SECRC | RCTL_BSIZE_4096);
 }
 
 UNMAP_AFTER_INIT void E1000NetworkAdapter::initialize_tx_descriptors()
@@ -437,6 +438,13 @@ void E1000NetworkAdapter::send_raw(ReadonlyBytes payload)
     dbgln_if(E1000_DEBUG, "E1000: Sent packet, status is now {:#02x}!", (u8)descriptor.status);
 }
 
+PhysicalAddress E1000NetworkAdapter::rx_buffer_physical_address(const PacketWithTimestamp& packet)
+{
+    // The NIC writes to a buffer as a whole, which a single page always is physically.
+    VERIFY(packet.buffer.capacity() == PAGE_SIZE);
+    return packet.buffer.impl().region().physical_page(0)->paddr();
+}
+
 void E1000NetworkAdapter::receive()
 {
     auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
@@ -446,11 +454,22 @@ void E1000NetworkAdapter::receive()
         rx_current = (rx_current + 1) % number_of_rx_descriptors;
         if (!(rx_descriptors[rx_current].status & 1))
             break;
-        auto* buffer = m_rx_buffers_regions[rx_current].vaddr().as_ptr();
         u16 length = rx_descriptors[rx_current].length;
-        VERIFY(length <= 8192);
-        dbgln_if(E1000_DEBUG, "E1000: Received 1 packet @ {:p} ({} bytes)", buffer, length);
-        did_receive({ buffer, length });
+        VERIFY(length <= rx_buffer_size);
+        dbgln_if(E1000_DEBUG, "E1000: Received 1 packet @ {:p} ({} bytes)", m_rx_buffers[rx_current].buffer.data(), length);
+
+        // Hand the buffer the packet is in up the stack and put an empty one in its place.
+        // If there is none to be had, we have to copy the packet out instead.
+        if (auto replacement = acquire_packet_buffer(rx_buffer_size)) {
+            auto packet = m_rx_buffers.ptr_at(rx_current);
+            m_rx_buffers.ptr_at(rx_current) = replacement.release_nonnull();
+            rx_descriptors[rx_current].addr = rx_buffer_physical_address(m_rx_buffers[rx_current]).get();
+            packet->buffer.set_size(length);
+            packet->timestamp = kgettimeofday();
+            did_receive_packet_buffer(move(packet));
+        } else {
+            did_receive({ m_rx_buffers[rx_current].buffer.data(), length });
+        }
         rx_descriptors[rx_current].status = 0;
         out32(REG_RXDESCTAIL, rx_current);
     }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/NonnullOwnPtrVector.h>
+#include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <Kernel/IO.h>
 #include <Kernel/Interrupts/IRQHandler.h>
@@ -76,12 +77,13 @@ protected:
     u32 in32(u16 address);
 
     void receive();
+    static PhysicalAddress rx_buffer_physical_address(const PacketWithTimestamp&);
 
     IOAddress m_io_base;
     VirtualAddress m_mmio_base;
     OwnPtr<Region> m_rx_descriptors_region;
     OwnPtr<Region> m_tx_descriptors_region;
-    NonnullOwnPtrVector<Region> m_rx_buffers_regions;
+    NonnullRefPtrVector<PacketWithTimestamp> m_rx_buffers;
     NonnullOwnPtrVector<Region> m_tx_buffers_regions;
     OwnPtr<Region> m_mmio_region;
     u8 m_interrupt_line { 0 };
@@ -90,6 +92,7 @@ protected:
     EntropySource m_entropy_source;
 
     static constexpr size_t number_of_rx_descriptors = 32;
+    static constexpr size_t rx_buffer_size = 4096;
     static constexpr size_t number_of_tx_descriptors = 8;
 
     WaitQueue m_wait_queue;
@@ -63,9 +63,6 @@ IPv4Socket::IPv4Socket(int type, int protocol)
 {
     dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}) created with type={}, protocol={}", this, type, protocol);
     m_buffer_mode = type == SOCK_STREAM ? BufferMode::Bytes : BufferMode::Packets;
-    if (m_buffer_mode == BufferMode::Bytes) {
-        m_scratch_buffer = KBuffer::create_with_size(65536);
-    }
     Locker locker(all_sockets().lock());
     all_sockets().resource().set(this);
 }
@@ -186,7 +183,7 @@ PortAllocationResult IPv4Socket::allocate_local_port_if_needed()
     return { m_local_port, true };
 }
 
-KResultOr<size_t> IPv4Socket::sendto(FileDescription&, const UserOrKernelBuffer& data, size_t data_length, [[maybe_unused]] int flags, Userspace<const sockaddr*> addr, socklen_t addr_length)
+KResultOr<size_t> IPv4Socket::sendto(FileDescription& description, const UserOrKernelBuffer& data, size_t data_length, [[maybe_unused]] int flags, Userspace<const sockaddr*> addr, socklen_t addr_length)
 {
     Locker locker(lock());
 
@@ -230,16 +227,28 @@ KResultOr<size_t> IPv4Socket::sendto(FileDescription&, const UserOrKernelBuffer&
             return ENOMEM;
         routing_decision.adapter->fill_in_ipv4_header(*packet, local_address(), routing_decision.next_hop,
             m_peer_address, (IPv4Protocol)protocol(), data_length, m_ttl);
-        if (!data.read(packet->buffer.data() + ipv4_payload_offset, data_length)) {
-            routing_decision.adapter->release_packet_buffer(*packet);
+        if (!data.read(packet->buffer.data() + ipv4_payload_offset, data_length))
             return EFAULT;
-        }
         routing_decision.adapter->send_packet({ packet->buffer.data(), packet->buffer.size() });
-        routing_decision.adapter->release_packet_buffer(*packet);
         return data_length;
     }
 
     auto nsent_or_error = protocol_send(data, data_length);
+    // The protocol may have to wait for its peer before it can take any more data.
+    while (nsent_or_error.is_error() && nsent_or_error.error() == EAGAIN && description.is_blocking()) {
+        locker.unlock();
+        auto unblock_flags = BlockFlags::None;
+        auto result = Thread::current()->block<Thread::WriteBlocker>({}, description, unblock_flags);
+        locker.lock();
+        if (result.was_interrupted())
+            return EINTR;
+        // Only running into SO_SNDTIMEO makes a blocking send give up with EAGAIN.
+        if (result.timed_out())
+            return EAGAIN;
+        // Whatever woke us up, the protocol knows best whether it can take the data now, has to wait
+        // some more, or has lost its connection.
+        nsent_or_error = protocol_send(data, data_length);
+    }
     if (!nsent_or_error.is_error())
         Thread::current()->did_ipv4_socket_write(nsent_or_error.value());
     return nsent_or_error;
@@ -280,6 +289,8 @@ KResultOr<size_t> IPv4Socket::receive_byte_buffered(FileDescription& description
         Thread::current()->did_ipv4_socket_read((size_t)nreceived);
 
     set_can_read(!m_receive_buffer.is_empty());
+    if (nreceived > 0 && !(flags & MSG_PEEK))
+        protocol_did_read();
     return nreceived;
 }
 
@@ -307,11 +318,11 @@ KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& descripti
 
             dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}): recvfrom without blocking {} bytes, packets in queue: {}",
                 this,
-                packet.data.value().size(),
+                packet.data.size(),
                 m_receive_queue.size());
         }
     }
-    if (!packet.data.has_value()) {
+    if (!packet.buffer) {
         if (protocol_is_disconnected()) {
             dbgln("IPv4Socket({}) is protocol-disconnected, returning 0 in recvfrom!", this);
             return 0;
@@ -341,10 +352,10 @@ KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& descripti
 
         dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}): recvfrom with blocking {} bytes, packets in queue: {}",
             this,
-            packet.data.value().size(),
+            packet.data.size(),
             m_receive_queue.size());
     }
-    VERIFY(packet.data.has_value());
+    VERIFY(packet.buffer);
 
     packet_timestamp = packet.timestamp;
 
@@ -366,13 +377,13 @@ KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& descripti
     }
 
     if (type() == SOCK_RAW) {
-        size_t bytes_written = min(packet.data.value().size(), buffer_length);
-        if (!buffer.write(packet.data.value().data(), bytes_written))
+        size_t bytes_written = min(packet.data.size(), buffer_length);
+        if (!buffer.write(packet.data.data(), bytes_written))
             return EFAULT;
         return bytes_written;
     }
 
-    return protocol_receive(ReadonlyBytes { packet.data.value().data(), packet.data.value().size() }, buffer, buffer_length, flags);
+    return protocol_receive(packet.data, buffer, buffer_length, flags);
 }
 
 KResultOr<size_t> IPv4Socket::recvfrom(FileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*> user_addr, Userspace<socklen_t*> user_addr_length, Time& packet_timestamp)
@@ -398,7 +409,7 @@ KResultOr<size_t> IPv4Socket::recvfrom(FileDescription& description, UserOrKerne
     return nreceived;
 }
 
-bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port, ReadonlyBytes packet, const Time& packet_timestamp)
+bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port, ReadonlyBytes packet, const Time& packet_timestamp, PacketWithTimestamp* received_packet)
 {
     Locker locker(lock());
 
@@ -414,11 +425,8 @@ bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port,
             VERIFY(m_can_read);
             return false;
         }
-        auto scratch_buffer = UserOrKernelBuffer::for_kernel_buffer(m_scratch_buffer.value().data());
-        auto nreceived_or_error = protocol_receive(ReadonlyBytes { packet.data(), packet.size() }, scratch_buffer, m_scratch_buffer.value().size(), 0);
-        if (nreceived_or_error.is_error())
-            return false;
-        ssize_t nwritten = m_receive_buffer.write(scratch_buffer, nreceived_or_error.value());
+        auto payload = protocol_payload(packet);
+        ssize_t nwritten = m_receive_buffer.write(payload.data(), payload.size());
         if (nwritten < 0)
             return false;
         set_can_read(!m_receive_buffer.is_empty());
@@ -427,7 +435,17 @@ bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port,
             dbgln("IPv4Socket({}): did_receive refusing packet since queue is full.", this);
             return false;
         }
-        m_receive_queue.append({ source_address, source_port, packet_timestamp, KBuffer::copy(packet.data(), packet.size()) });
+        // Holding on to a buffer much larger than the packet would tie up memory for nothing.
+        RefPtr<PacketWithTimestamp> buffer;
+        if (received_packet && received_packet->buffer.capacity() <= max<size_t>(PAGE_SIZE, 4 * packet_size)) {
+            buffer = received_packet;
+        } else {
+            buffer = adopt_ref_if_nonnull(new PacketWithTimestamp { KBuffer::copy(packet.data(), packet.size()), packet_timestamp });
+            if (!buffer)
+                return false;
+            packet = { buffer->buffer.data(), buffer->buffer.size() };
+        }
+        m_receive_queue.append({ source_address, source_port, packet_timestamp, move(buffer), packet });
         set_can_read(true);
     }
     m_bytes_received += packet_size;
@@ -18,6 +18,7 @@
 namespace Kernel {
 
 class NetworkAdapter;
+struct PacketWithTimestamp;
 class TCPPacket;
 class TCPSocket;
 
@@ -48,7 +49,8 @@ public:
 
     virtual int ioctl(FileDescription&, unsigned request, FlatPtr arg) override;
 
-    bool did_receive(const IPv4Address& peer_address, u16 peer_port, ReadonlyBytes, const Time&);
+    // When the bytes are in a received packet's buffer, the socket may hold on to that buffer instead of copying them.
+    bool did_receive(const IPv4Address& peer_address, u16 peer_port, ReadonlyBytes, const Time&, PacketWithTimestamp* received_packet = nullptr);
 
     const IPv4Address& local_address() const { return m_local_address; }
     u16 local_port() const { return m_local_port; }
@@ -82,10 +84,16 @@ protected:
     virtual KResult protocol_bind() { return KSuccess; }
     virtual KResult protocol_listen([[maybe_unused]] bool did_allocate_port) { return KSuccess; }
     virtual KResultOr<size_t> protocol_receive(ReadonlyBytes /* raw_ipv4_packet */, UserOrKernelBuffer&, size_t, int) { return ENOTIMPL; }
+    // The part of a received packet that goes into the receive buffer of a byte-buffered socket.
+    virtual ReadonlyBytes protocol_payload(ReadonlyBytes /* raw_ipv4_packet */) const { VERIFY_NOT_REACHED(); }
     virtual KResultOr<size_t> protocol_send(const UserOrKernelBuffer&, size_t) { return ENOTIMPL; }
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) { return KSuccess; }
     virtual KResultOr<u16> protocol_allocate_local_port() { return ENOPROTOOPT; }
     virtual bool protocol_is_disconnected() const { return false; }
+    // Called after data has been taken out of the receive buffer.
+    virtual void protocol_did_read() { }
+
+    size_t receive_buffer_space() const { return m_receive_buffer.space_for_writing(); }
 
     virtual void shut_down_for_reading() override;
 
@@ -110,7 +118,9 @@ private:
         IPv4Address peer_address;
         u16 peer_port;
         Time timestamp;
-        Optional<KBuffer> data;
+        // Usually the buffer the packet was received into, but small packets in large buffers get a copy of their own.
+        RefPtr<PacketWithTimestamp> buffer;
+        ReadonlyBytes data;
     };
 
     SinglyLinkedListWithCount<ReceivedPacket> m_receive_queue;
@@ -127,8 +137,6 @@ private:
     bool m_can_read { false };
 
     BufferMode m_buffer_mode { BufferMode::Packets };
-
-    Optional<KBuffer> m_scratch_buffer;
 };
 
 }
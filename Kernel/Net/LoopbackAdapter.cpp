@@ -11,6 +11,8 @@ namespace Kernel {
 
 static bool s_loopback_initialized = false;
 
+Atomic<bool> g_loopback_packet_loss;
+
 NonnullRefPtr<LoopbackAdapter> LoopbackAdapter::create()
 {
     return adopt_ref(*new LoopbackAdapter());
@@ -31,6 +33,11 @@ LoopbackAdapter::~LoopbackAdapter()
 
 void LoopbackAdapter::send_raw(ReadonlyBytes payload)
 {
+    if (g_loopback_packet_loss && --m_packets_until_loss == 0) {
+        m_packets_until_loss = packet_loss_interval;
+        dbgln("LoopbackAdapter: Dropping {} byte(s) on purpose.", payload.size());
+        return;
+    }
     dbgln("LoopbackAdapter: Sending {} byte(s) to myself.", payload.size());
     did_receive(payload);
 }
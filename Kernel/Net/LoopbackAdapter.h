@@ -6,10 +6,14 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <Kernel/Net/NetworkAdapter.h>
 
 namespace Kernel {
 
+// Makes the loopback adapter drop some of its packets, to exercise loss recovery. Set through /proc/sys/loopback_packet_loss.
+extern Atomic<bool> g_loopback_packet_loss;
+
 class LoopbackAdapter final : public NetworkAdapter {
     AK_MAKE_ETERNAL
 
@@ -22,6 +26,10 @@ public:
 
     virtual void send_raw(ReadonlyBytes) override;
     virtual const char* class_name() const override { return "LoopbackAdapter"; }
+
+private:
+    static constexpr size_t packet_loss_interval = 50;
+    size_t m_packets_until_loss { packet_loss_interval };
 };
 
 }
@@ -12,6 +12,7 @@
 #include <Kernel/Net/EtherType.h>
 #include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/NetworkTask.h>
 #include <Kernel/Net/NetworkingManagement.h>
 #include <Kernel/Process.h>
 #include <Kernel/Random.h>
@@ -70,17 +71,24 @@ void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Addres
     ipv4.set_checksum(ipv4.compute_checksum());
 }
 
-void NetworkAdapter::did_receive(ReadonlyBytes payload)
+PacketWithTimestamp::PacketWithTimestamp(KBuffer buffer, Time timestamp, NetworkAdapter* adapter)
+    : buffer(move(buffer))
+    , timestamp(timestamp)
+    , m_adapter(adapter)
 {
-    InterruptDisabler disabler;
-    m_packets_in++;
-    m_bytes_in += payload.size();
+}
 
-    if (m_packet_queue_size == max_packet_buffers) {
-        // FIXME: Keep track of the number of dropped packets
+void PacketWithTimestamp::unref()
+{
+    if (m_ref_count.fetch_sub(1, AK::memory_order_acq_rel) != 1)
         return;
-    }
+    if (auto adapter = m_adapter.strong_ref(); adapter && adapter->return_packet_buffer(*this))
+        return;
+    delete this;
+}
 
+void NetworkAdapter::did_receive(ReadonlyBytes payload)
+{
     auto packet = acquire_packet_buffer(payload.size());
     if (!packet) {
         dbgln("Discarding packet because we're out of memory");
@@ -88,61 +96,56 @@ void NetworkAdapter::did_receive(ReadonlyBytes payload)
     }
 
     memcpy(packet->buffer.data(), payload.data(), payload.size());
-
-    m_packet_queue.append(*packet);
-    m_packet_queue_size++;
-
-    if (on_receive)
-        on_receive();
+    did_receive_packet_buffer(packet.release_nonnull());
 }
 
-size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp)
+void NetworkAdapter::did_receive_packet_buffer(NonnullRefPtr<PacketWithTimestamp> packet)
 {
-    InterruptDisabler disabler;
-    if (m_packet_queue.is_empty())
-        return 0;
-    auto packet_with_timestamp = m_packet_queue.take_first();
-    m_packet_queue_size--;
-    packet_timestamp = packet_with_timestamp->timestamp;
-    auto& packet_buffer = packet_with_timestamp->buffer;
-    size_t packet_size = packet_buffer.size();
-    VERIFY(packet_size <= buffer_size);
-    memcpy(buffer, packet_buffer.data(), packet_size);
-    release_packet_buffer(*packet_with_timestamp);
-    return packet_size;
+    m_packets_in++;
+    m_bytes_in += packet->buffer.size();
+    NetworkTask::did_receive_packet(move(packet));
 }
 
 RefPtr<PacketWithTimestamp> NetworkAdapter::acquire_packet_buffer(size_t size)
 {
-    InterruptDisabler disabler;
-    if (m_unused_packets.is_empty()) {
-        auto buffer = KBuffer::create_with_size(size, Region::Access::Read | Region::Access::Write, "Packet Buffer", AllocationStrategy::AllocateNow);
-        auto packet = adopt_ref_if_nonnull(new PacketWithTimestamp { move(buffer), kgettimeofday() });
-        if (!packet)
-            return nullptr;
-        packet->buffer.set_size(size);
-        return packet;
+    size_t capacity = size <= PAGE_SIZE ? PAGE_SIZE : max(large_packet_buffer_capacity(), page_round_up(size));
+
+    RefPtr<PacketWithTimestamp> packet;
+    {
+        ScopedSpinLock lock(m_unused_packets_lock);
+        auto& unused_packets = capacity == PAGE_SIZE ? m_unused_small_packets : m_unused_large_packets;
+        if (!unused_packets.is_empty() && unused_packets.first()->buffer.capacity() >= size) {
+            packet = unused_packets.take_first();
+            m_unused_packets_size -= packet->buffer.capacity();
+        }
     }
 
-    auto packet = m_unused_packets.take_first();
-    if (packet->buffer.capacity() >= size) {
-        packet->timestamp = kgettimeofday();
-        packet->buffer.set_size(size);
-        return packet;
+    if (!packet) {
+        auto buffer = KBuffer::create_with_size(capacity, Region::Access::Read | Region::Access::Write, "Packet Buffer", AllocationStrategy::AllocateNow);
+        packet = adopt_ref_if_nonnull(new PacketWithTimestamp { move(buffer), {}, this });
+        if (!packet)
+            return nullptr;
     }
 
-    auto buffer = KBuffer::create_with_size(size, Region::Access::Read | Region::Access::Write, "Packet Buffer", AllocationStrategy::AllocateNow);
-    packet = adopt_ref_if_nonnull(new PacketWithTimestamp { move(buffer), kgettimeofday() });
-    if (!packet)
-        return nullptr;
+    packet->timestamp = kgettimeofday();
     packet->buffer.set_size(size);
     return packet;
 }
 
-void NetworkAdapter::release_packet_buffer(PacketWithTimestamp& packet)
+bool NetworkAdapter::return_packet_buffer(PacketWithTimestamp& packet)
 {
-    InterruptDisabler disabler;
-    m_unused_packets.append(packet);
+    size_t capacity = packet.buffer.capacity();
+    ScopedSpinLock lock(m_unused_packets_lock);
+    if (m_unused_packets_size + capacity > max_unused_packet_buffer_size)
+        return false;
+    if (capacity == PAGE_SIZE)
+        m_unused_small_packets.append(packet);
+    else if (capacity == large_packet_buffer_capacity())
+        m_unused_large_packets.append(packet);
+    else
+        return false;
+    m_unused_packets_size += capacity;
+    return true;
 }
 
 void NetworkAdapter::set_ipv4_address(const IPv4Address& address)
@@ -6,10 +6,12 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/ByteBuffer.h>
 #include <AK/Function.h>
 #include <AK/IntrusiveList.h>
 #include <AK/MACAddress.h>
+#include <AK/Noncopyable.h>
 #include <AK/Types.h>
 #include <AK/WeakPtr.h>
 #include <AK/Weakable.h>
@@ -19,6 +21,7 @@
 #include <Kernel/Net/ICMP.h>
 #include <Kernel/Net/IPv4.h>
 #include <Kernel/PCI/Definitions.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/UserOrKernelBuffer.h>
 
 namespace Kernel {
@@ -27,16 +30,32 @@ class NetworkAdapter;
 
 using NetworkByteBuffer = AK::Detail::ByteBuffer<1500>;
 
-struct PacketWithTimestamp : public RefCounted<PacketWithTimestamp> {
-    PacketWithTimestamp(KBuffer buffer, Time timestamp)
-        : buffer(move(buffer))
-        , timestamp(timestamp)
+// A buffer for one packet, received or to be sent. Buffers belong to the adapter that handed
+// them out, and go back to it for reuse once the last reference to them is gone, so a received
+// packet can be passed all the way up to a socket without being copied.
+struct PacketWithTimestamp {
+    AK_MAKE_NONCOPYABLE(PacketWithTimestamp);
+    AK_MAKE_NONMOVABLE(PacketWithTimestamp);
+
+public:
+    PacketWithTimestamp(KBuffer buffer, Time timestamp, NetworkAdapter* adapter = nullptr);
+
+    void ref()
     {
+        m_ref_count.fetch_add(1, AK::memory_order_acq_rel);
     }
 
+    void unref();
+
     KBuffer buffer;
     Time timestamp;
     IntrusiveListNode<PacketWithTimestamp, RefPtr<PacketWithTimestamp>> packet_node;
+
+    using List = IntrusiveList<PacketWithTimestamp, RefPtr<PacketWithTimestamp>, &PacketWithTimestamp::packet_node>;
+
+private:
+    Atomic<u32> m_ref_count { 1 };
+    WeakPtr<NetworkAdapter> m_adapter;
 };
 
 class NetworkAdapter : public RefCounted<NetworkAdapter>
@@ -53,6 +72,8 @@ public:
     IPv4Address ipv4_broadcast() const { return IPv4Address { (m_ipv4_address.to_u32() & m_ipv4_netmask.to_u32()) | ~m_ipv4_netmask.to_u32() }; }
     IPv4Address ipv4_gateway() const { return m_ipv4_gateway; }
     virtual bool link_up() { return false; }
+    // Adapters that fill in TCP checksums themselves only need the pseudo-header sum from us.
+    virtual bool has_tcp_checksum_offload() const { return false; }
 
     void set_ipv4_address(const IPv4Address&);
     void set_ipv4_netmask(const IPv4Address&);
@@ -61,10 +82,6 @@ public:
     void send(const MACAddress&, const ARPPacket&);
     void fill_in_ipv4_header(PacketWithTimestamp&, IPv4Address const&, MACAddress const&, IPv4Address const&, IPv4Protocol, size_t, u8);
 
-    size_t dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp);
-
-    bool has_queued_packets() const { return !m_packet_queue.is_empty(); }
-
     u32 mtu() const { return m_mtu; }
     void set_mtu(u32 mtu) { m_mtu = mtu; }
 
@@ -74,13 +91,10 @@ public:
     u32 bytes_out() const { return m_bytes_out; }
 
     RefPtr<PacketWithTimestamp> acquire_packet_buffer(size_t);
-    void release_packet_buffer(PacketWithTimestamp&);
 
     constexpr size_t layer3_payload_offset() const { return sizeof(EthernetFrameHeader); }
     constexpr size_t ipv4_payload_offset() const { return layer3_payload_offset() + sizeof(IPv4Packet); }
 
-    Function<void()> on_receive;
-
     void send_packet(ReadonlyBytes);
 
 protected:
@@ -88,24 +102,31 @@ protected:
     void set_interface_name(const PCI::Address&);
     void set_mac_address(const MACAddress& mac_address) { m_mac_address = mac_address; }
     void did_receive(ReadonlyBytes);
+    void did_receive_packet_buffer(NonnullRefPtr<PacketWithTimestamp>);
     virtual void send_raw(ReadonlyBytes) = 0;
 
     void set_loopback_name();
 
 private:
+    friend struct PacketWithTimestamp;
+    bool return_packet_buffer(PacketWithTimestamp&);
+    size_t large_packet_buffer_capacity() const { return page_round_up(layer3_payload_offset() + mtu()); }
+
+    // Keep at most this much memory in unused packet buffers.
+    static constexpr size_t max_unused_packet_buffer_size = 4 * MiB;
+
     MACAddress m_mac_address;
     IPv4Address m_ipv4_address;
     IPv4Address m_ipv4_netmask;
     IPv4Address m_ipv4_gateway;
 
-    // FIXME: Make this configurable
-    static constexpr size_t max_packet_buffers = 1024;
-
-    using PacketList = IntrusiveList<PacketWithTimestamp, RefPtr<PacketWithTimestamp>, &PacketWithTimestamp::packet_node>;
-
-    PacketList m_packet_queue;
-    size_t m_packet_queue_size { 0 };
-    PacketList m_unused_packets;
+    // Packets can be sent and received on several processors at once.
+    SpinLock<u8> m_unused_packets_lock;
+    // Most packets fit in a page. Only adapters with a large MTU, like the loopback
+    // adapter, need larger buffers for the rest.
+    PacketWithTimestamp::List m_unused_small_packets;
+    PacketWithTimestamp::List m_unused_large_packets;
+    size_t m_unused_packets_size { 0 };
     String m_name;
     u32 m_packets_in { 0 };
     u32 m_bytes_in { 0 };
@@ -24,102 +24,184 @@
 
 namespace Kernel {
 
+static void handle_packet(PacketWithTimestamp&);
 static void handle_arp(const EthernetFrameHeader&, size_t frame_size);
-static void handle_ipv4(const EthernetFrameHeader&, size_t frame_size, const Time& packet_timestamp);
-static void handle_icmp(const EthernetFrameHeader&, const IPv4Packet&, const Time& packet_timestamp);
-static void handle_udp(const IPv4Packet&, const Time& packet_timestamp);
+static void handle_ipv4(const EthernetFrameHeader&, size_t frame_size, PacketWithTimestamp&);
+static void handle_icmp(const EthernetFrameHeader&, const IPv4Packet&, PacketWithTimestamp&);
+static void handle_udp(const IPv4Packet&, PacketWithTimestamp&);
 static void handle_tcp(const IPv4Packet&, const Time& packet_timestamp);
 static void send_delayed_tcp_ack(RefPtr<TCPSocket> socket);
 static void flush_delayed_tcp_acks();
 static void retransmit_tcp_packets();
 
-static Thread* network_task = nullptr;
-static HashTable<RefPtr<TCPSocket>>* delayed_ack_sockets;
+// Received packets are handled by one thread per processor, each with its own queue. Every
+// packet of a flow goes to the same queue, so a flow's packets are still handled in order,
+// while different flows are handled in parallel.
+struct NetworkReceiveQueue {
+    SpinLock<u8> lock;
+    PacketWithTimestamp::List packets;
+    size_t packet_count { 0 };
+    WaitQueue wait_queue;
+    RefPtr<Thread> thread;
+    // Only touched by this queue's thread.
+    HashTable<RefPtr<TCPSocket>> delayed_ack_sockets;
+};
+
+// FIXME: Make these configurable
+static constexpr size_t max_queued_packets = 1024;
+static constexpr size_t max_packets_per_batch = 64;
+
+static NetworkReceiveQueue* s_receive_queues;
+static Atomic<u32> s_receive_queue_count;
 
 [[noreturn]] static void NetworkTask_main(void*);
 
 void NetworkTask::spawn()
 {
+    NetworkingManagement::the().for_each([&](auto& adapter) {
+        dmesgln("NetworkTask: {} network adapter found: hw={}", adapter.class_name(), adapter.mac_address().to_string());
+
+        if (String(adapter.class_name()) == "LoopbackAdapter") {
+            adapter.set_ipv4_address({ 127, 0, 0, 1 });
+            adapter.set_ipv4_netmask({ 255, 0, 0, 0 });
+            adapter.set_ipv4_gateway({ 0, 0, 0, 0 });
+        }
+    });
+
+    u32 queue_count = Processor::count();
+    s_receive_queues = new NetworkReceiveQueue[queue_count];
+
     RefPtr<Thread> thread;
-    Process::create_kernel_process(thread, "NetworkTask", NetworkTask_main, nullptr);
-    network_task = thread;
+    auto process = Process::create_kernel_process(thread, "NetworkTask", NetworkTask_main, &s_receive_queues[0], 1u << 0);
+    s_receive_queues[0].thread = move(thread);
+    for (u32 i = 1; i < queue_count; ++i)
+        s_receive_queues[i].thread = process->create_kernel_thread(NetworkTask_main, &s_receive_queues[i], THREAD_PRIORITY_NORMAL, String::formatted("NetworkTask #{}", i), 1u << i, false);
+
+    s_receive_queue_count.store(queue_count, AK::MemoryOrder::memory_order_release);
+    dmesgln("NetworkTask: Handling received packets on {} processor(s)", queue_count);
+}
+
+static NetworkReceiveQueue* current_receive_queue()
+{
+    auto* current_thread = Thread::current();
+    u32 queue_count = s_receive_queue_count.load(AK::MemoryOrder::memory_order_acquire);
+    for (u32 i = 0; i < queue_count; ++i) {
+        if (s_receive_queues[i].thread == current_thread)
+            return &s_receive_queues[i];
+    }
+    return nullptr;
 }
 
 bool NetworkTask::is_current()
 {
-    return Thread::current() == network_task;
+    return current_receive_queue() != nullptr;
 }
 
-void NetworkTask_main(void*)
+static u32 receive_queue_index_for(ReadonlyBytes frame, u32 queue_count)
 {
-    delayed_ack_sockets = new HashTable<RefPtr<TCPSocket>>;
+    if (queue_count == 1)
+        return 0;
+    if (frame.size() < sizeof(EthernetFrameHeader) + sizeof(IPv4Packet))
+        return 0;
+    auto& eth = *(const EthernetFrameHeader*)frame.data();
+    if (eth.ether_type() != EtherType::IPv4)
+        return 0;
+
+    // NOTE: This is the tuple of the socket that will receive the packet, so our side is the local one.
+    auto& ipv4_packet = *static_cast<const IPv4Packet*>(eth.payload());
+    u16 source_port = 0;
+    u16 destination_port = 0;
+    auto protocol = (IPv4Protocol)ipv4_packet.protocol();
+    if ((protocol == IPv4Protocol::TCP || protocol == IPv4Protocol::UDP)
+        && frame.size() >= sizeof(EthernetFrameHeader) + sizeof(IPv4Packet) + 2 * sizeof(u16)) {
+        // Both TCP and UDP headers start with the source and destination ports.
+        auto* ports = static_cast<const NetworkOrdered<u16>*>(ipv4_packet.payload());
+        source_port = ports[0];
+        destination_port = ports[1];
+    }
+    IPv4SocketTuple tuple(ipv4_packet.destination(), destination_port, ipv4_packet.source(), source_port);
+    return Traits<IPv4SocketTuple>::hash(tuple) % queue_count;
+}
 
-    WaitQueue packet_wait_queue;
-    int pending_packets = 0;
-    NetworkingManagement::the().for_each([&](auto& adapter) {
-        dmesgln("NetworkTask: {} network adapter found: hw={}", adapter.class_name(), adapter.mac_address().to_string());
+void NetworkTask::did_receive_packet(NonnullRefPtr<PacketWithTimestamp> packet)
+{
+    u32 queue_count = s_receive_queue_count.load(AK::MemoryOrder::memory_order_acquire);
+    if (queue_count == 0)
+        return;
 
-        if (String(adapter.class_name()) == "LoopbackAdapter") {
-            adapter.set_ipv4_address({ 127, 0, 0, 1 });
-            adapter.set_ipv4_netmask({ 255, 0, 0, 0 });
-            adapter.set_ipv4_gateway({ 0, 0, 0, 0 });
+    auto& queue = s_receive_queues[receive_queue_index_for(ReadonlyBytes { packet->buffer.data(), packet->buffer.size() }, queue_count)];
+    bool was_empty;
+    {
+        ScopedSpinLock lock(queue.lock);
+        if (queue.packet_count == max_queued_packets) {
+            // FIXME: Keep track of the number of dropped packets
+            return;
         }
+        was_empty = queue.packets.is_empty();
+        queue.packets.append(*packet);
+        queue.packet_count++;
+    }
 
-        adapter.on_receive = [&]() {
-            pending_packets++;
-            packet_wait_queue.wake_all();
-        };
-    });
+    // The thread takes everything that's queued before it waits again, so it only needs waking once.
+    if (was_empty)
+        queue.wait_queue.wake_one();
+}
 
-    auto dequeue_packet = [&pending_packets](u8* buffer, size_t buffer_size, Time& packet_timestamp) -> size_t {
-        if (pending_packets == 0)
-            return 0;
-        size_t packet_size = 0;
-        NetworkingManagement::the().for_each([&](auto& adapter) {
-            if (packet_size || !adapter.has_queued_packets())
-                return;
-            packet_size = adapter.dequeue_packet(buffer, buffer_size, packet_timestamp);
-            pending_packets--;
-            dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} ({} bytes)", adapter.name(), packet_size);
-        });
-        return packet_size;
-    };
-
-    size_t buffer_size = 64 * KiB;
-    auto buffer_region = MM.allocate_kernel_region(buffer_size, "Kernel Packet Buffer", Region::Access::Read | Region::Access::Write);
-    auto buffer = (u8*)buffer_region->vaddr().get();
-    Time packet_timestamp;
+void NetworkTask_main(void* data)
+{
+    auto& queue = *static_cast<NetworkReceiveQueue*>(data);
+    bool handles_retransmits = &queue == &s_receive_queues[0];
 
     for (;;) {
         flush_delayed_tcp_acks();
-        retransmit_tcp_packets();
-        size_t packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
-        if (!packet_size) {
+        if (handles_retransmits)
+            retransmit_tcp_packets();
+
+        PacketWithTimestamp::List batch;
+        {
+            ScopedSpinLock lock(queue.lock);
+            for (size_t i = 0; i < max_packets_per_batch && !queue.packets.is_empty(); ++i) {
+                batch.append(*queue.packets.take_first());
+                queue.packet_count--;
+            }
+        }
+
+        if (batch.is_empty()) {
             auto timeout_time = Time::from_milliseconds(500);
             auto timeout = Thread::BlockTimeout { false, &timeout_time };
-            [[maybe_unused]] auto result = packet_wait_queue.wait_on(timeout, "NetworkTask");
-            continue;
-        }
-        if (packet_size < sizeof(EthernetFrameHeader)) {
-            dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", packet_size);
+            [[maybe_unused]] auto result = queue.wait_queue.wait_on(timeout, "NetworkTask");
             continue;
         }
-        auto& eth = *(const EthernetFrameHeader*)buffer;
-        dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), packet_size);
-
-        switch (eth.ether_type()) {
-        case EtherType::ARP:
-            handle_arp(eth, packet_size);
-            break;
-        case EtherType::IPv4:
-            handle_ipv4(eth, packet_size, packet_timestamp);
-            break;
-        case EtherType::IPv6:
-            // ignore
-            break;
-        default:
-            dbgln_if(ETHERNET_DEBUG, "NetworkTask: Unknown ethernet type {:#04x}", eth.ether_type());
-        }
+
+        // Once handled, a packet's buffer goes back to its adapter, unless a socket is still holding on to it.
+        while (!batch.is_empty())
+            handle_packet(*batch.take_first());
+    }
+}
+
+void handle_packet(PacketWithTimestamp& packet)
+{
+    ReadonlyBytes frame { packet.buffer.data(), packet.buffer.size() };
+    dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Handling packet ({} bytes)", frame.size());
+    if (frame.size() < sizeof(EthernetFrameHeader)) {
+        dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", frame.size());
+        return;
+    }
+    auto& eth = *(const EthernetFrameHeader*)frame.data();
+    dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), frame.size());
+
+    switch (eth.ether_type()) {
+    case EtherType::ARP:
+        handle_arp(eth, frame.size());
+        break;
+    case EtherType::IPv4:
+        handle_ipv4(eth, frame.size(), packet);
+        break;
+    case EtherType::IPv6:
+        // ignore
+        break;
+    default:
+        dbgln_if(ETHERNET_DEBUG, "NetworkTask: Unknown ethernet type {:#04x}", eth.ether_type());
     }
 }
 
@@ -172,7 +254,7 @@ void handle_arp(const EthernetFrameHeader& eth, size_t frame_size)
     }
 }
 
-void handle_ipv4(const EthernetFrameHeader& eth, size_t frame_size, const Time& packet_timestamp)
+void handle_ipv4(const EthernetFrameHeader& eth, size_t frame_size, PacketWithTimestamp& received_packet)
 {
     constexpr size_t minimum_ipv4_frame_size = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet);
     if (frame_size < minimum_ipv4_frame_size) {
@@ -205,18 +287,18 @@ void handle_ipv4(const EthernetFrameHeader& eth, size_t frame_size, const Time&
 
     switch ((IPv4Protocol)packet.protocol()) {
     case IPv4Protocol::ICMP:
-        return handle_icmp(eth, packet, packet_timestamp);
+        return handle_icmp(eth, packet, received_packet);
     case IPv4Protocol::UDP:
-        return handle_udp(packet, packet_timestamp);
+        return handle_udp(packet, received_packet);
     case IPv4Protocol::TCP:
-        return handle_tcp(packet, packet_timestamp);
+        return handle_tcp(packet, received_packet.timestamp);
     default:
         dbgln_if(IPV4_DEBUG, "handle_ipv4: Unhandled protocol {:#02x}", packet.protocol());
         break;
     }
 }
 
-void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
+void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet, PacketWithTimestamp& received_packet)
 {
     auto& icmp_header = *static_cast<const ICMPHeader*>(ipv4_packet.payload());
     dbgln_if(ICMP_DEBUG, "handle_icmp: source={}, destination={}, type={:#02x}, code={:#02x}", ipv4_packet.source().to_string(), ipv4_packet.destination().to_string(), icmp_header.type(), icmp_header.code());
@@ -232,7 +314,7 @@ void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet,
             }
         }
         for (auto& socket : icmp_sockets)
-            socket.did_receive(ipv4_packet.source(), 0, { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, packet_timestamp);
+            socket.did_receive(ipv4_packet.source(), 0, { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, received_packet.timestamp, &received_packet);
     }
 
     auto adapter = NetworkingManagement::the().from_ipv4_address(ipv4_packet.destination());
@@ -265,11 +347,10 @@ void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet,
         response.header.set_checksum(internet_checksum(&response, icmp_packet_size));
         // FIXME: What is the right TTL value here? Is 64 ok? Should we use the same TTL as the echo request?
         adapter->send_packet({ packet->buffer.data(), packet->buffer.size() });
-        adapter->release_packet_buffer(*packet);
     }
 }
 
-void handle_udp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
+void handle_udp(const IPv4Packet& ipv4_packet, PacketWithTimestamp& received_packet)
 {
     if (ipv4_packet.payload_size() < sizeof(UDPPacket)) {
         dbgln("handle_udp: Packet too small ({}, need {})", ipv4_packet.payload_size(), sizeof(UDPPacket));
@@ -294,7 +375,7 @@ void handle_udp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
     auto& destination = ipv4_packet.destination();
 
     if (destination == IPv4Address(255, 255, 255, 255) || NetworkingManagement::the().from_ipv4_address(destination) || socket->multicast_memberships().contains_slow(destination))
-        socket->did_receive(ipv4_packet.source(), udp_packet.source_port(), { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, packet_timestamp);
+        socket->did_receive(ipv4_packet.source(), udp_packet.source_port(), { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, received_packet.timestamp, &received_packet);
 }
 
 void send_delayed_tcp_ack(RefPtr<TCPSocket> socket)
@@ -305,13 +386,14 @@ void send_delayed_tcp_ack(RefPtr<TCPSocket> socket)
         return;
     }
 
-    delayed_ack_sockets->set(move(socket));
+    current_receive_queue()->delayed_ack_sockets.set(move(socket));
 }
 
 void flush_delayed_tcp_acks()
 {
+    auto& delayed_ack_sockets = current_receive_queue()->delayed_ack_sockets;
     Vector<RefPtr<TCPSocket>, 32> remaining_sockets;
-    for (auto& socket : *delayed_ack_sockets) {
+    for (auto& socket : delayed_ack_sockets) {
         Locker locker(socket->lock());
         if (socket->should_delay_next_ack()) {
             remaining_sockets.append(socket);
@@ -320,12 +402,12 @@ void flush_delayed_tcp_acks()
         [[maybe_unused]] auto result = socket->send_ack();
     }
 
-    if (remaining_sockets.size() != delayed_ack_sockets->size()) {
-        delayed_ack_sockets->clear();
+    if (remaining_sockets.size() != delayed_ack_sockets.size()) {
+        delayed_ack_sockets.clear();
         if (remaining_sockets.size() > 0)
             dbgln("flush_delayed_tcp_acks: {} sockets remaining", remaining_sockets.size());
         for (auto&& socket : remaining_sockets)
-            delayed_ack_sockets->set(move(socket));
+            delayed_ack_sockets.set(move(socket));
     }
 }
 
@@ -430,6 +512,7 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            client->receive_syn_options(tcp_packet);
             [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             client->set_state(TCPSocket::State::SynReceived);
             return;
@@ -443,11 +526,13 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
         switch (tcp_packet.flags()) {
         case TCPFlags::SYN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            socket->receive_syn_options(tcp_packet);
             unused_rc = socket->send_ack(true);
             socket->set_state(TCPSocket::State::SynReceived);
             return;
         case TCPFlags::ACK | TCPFlags::SYN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            socket->receive_syn_options(tcp_packet);
             unused_rc = socket->send_ack(true);
             socket->set_state(TCPSocket::State::Established);
             socket->set_setup_state(Socket::SetupState::Completed);
@@ -580,22 +665,20 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
         }
     case TCPSocket::State::Established:
         if (tcp_packet.has_rst()) {
+            socket->set_error(TCPSocket::Error::ConnectionReset);
             socket->set_state(TCPSocket::State::Closed);
             return;
         }
 
         if (tcp_packet.sequence_number() != socket->ack_number()) {
-            dbgln_if(TCP_DEBUG, "Discarding out of order packet: seq {} vs. ack {}", tcp_packet.sequence_number(), socket->ack_number());
-            if (socket->duplicate_acks() < TCPSocket::maximum_duplicate_acks) {
-                dbgln_if(TCP_DEBUG, "Sending ACK with same ack number to trigger fast retransmission");
-                socket->set_duplicate_acks(socket->duplicate_acks() + 1);
-                [[maybe_unused]] auto result = socket->send_ack(true);
-            }
+            dbgln_if(TCP_DEBUG, "Got out of order packet: seq {} vs. ack {}", tcp_packet.sequence_number(), socket->ack_number());
+            if (payload_size && !tcp_packet.has_fin())
+                socket->queue_out_of_order_segment({ &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, tcp_packet.sequence_number(), payload_size, packet_timestamp);
+            // Every out of order packet gets an immediate duplicate ACK, which tells the peer what's missing.
+            [[maybe_unused]] auto result = socket->send_ack(true);
             return;
         }
 
-        socket->set_duplicate_acks(0);
-
         if (tcp_packet.has_fin()) {
             if (payload_size != 0)
                 socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, packet_timestamp);
@@ -612,7 +695,14 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
                 socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
                 dbgln_if(TCP_DEBUG, "Got packet with ack_no={}, seq_no={}, payload_size={}, acking it with new ack_no={}, seq_no={}",
                     tcp_packet.ack_number(), tcp_packet.sequence_number(), payload_size, socket->ack_number(), socket->sequence_number());
-                send_delayed_tcp_ack(socket);
+                // Filling a hole should be acknowledged right away, so the peer can leave loss recovery.
+                if (socket->receive_out_of_order_segments())
+                    [[maybe_unused]] auto result = socket->send_ack();
+                else
+                    send_delayed_tcp_ack(socket);
+            } else {
+                // Tell the peer how little room we have left.
+                [[maybe_unused]] auto result = socket->send_ack(true);
             }
         }
     }
@@ -6,10 +6,18 @@
 
 #pragma once
 
+#include <AK/NonnullRefPtr.h>
+
 namespace Kernel {
+
+struct PacketWithTimestamp;
+
 class NetworkTask {
 public:
     static void spawn();
     static bool is_current();
+
+    // Queues a received packet for one of the NetworkTask threads. Safe to call from interrupt handlers.
+    static void did_receive_packet(NonnullRefPtr<PacketWithTimestamp>);
 };
 }
@@ -17,6 +17,7 @@
 #include <Kernel/Net/NetworkingManagement.h>
 #include <Kernel/Net/RTL8139NetworkAdapter.h>
 #include <Kernel/Net/RTL8168NetworkAdapter.h>
+#include <Kernel/Net/VirtIONetworkAdapter.h>
 #include <Kernel/Panic.h>
 #include <Kernel/VM/AnonymousVMObject.h>
 
@@ -86,6 +87,8 @@ UNMAP_AFTER_INIT RefPtr<NetworkAdapter> NetworkingManagement::determine_network_
         return candidate;
     if (auto candidate = NE2000NetworkAdapter::try_to_initialize(address); !candidate.is_null())
         return candidate;
+    if (auto candidate = VirtIONetworkAdapter::try_to_initialize(address); !candidate.is_null())
+        return candidate;
     return {};
 }
 
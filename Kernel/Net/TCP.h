@@ -21,6 +21,15 @@ struct TCPFlags {
     };
 };
 
+enum class TCPOptionKind : u8 {
+    End = 0,
+    NoOperation = 1,
+    MSS = 2,
+    WindowScale = 3,
+    SACKPermitted = 4,
+    SACK = 5,
+};
+
 class [[gnu::packed]] TCPOptionMSS {
 public:
     TCPOptionMSS(u16 value)
@@ -38,6 +47,40 @@ private:
 
 static_assert(sizeof(TCPOptionMSS) == 4);
 
+// RFC 7323: The peer should shift the window field of our segments left by this many bits.
+class [[gnu::packed]] TCPOptionWindowScale {
+public:
+    TCPOptionWindowScale(u8 value)
+        : m_value(value)
+    {
+    }
+
+    u8 value() const { return m_value; }
+
+private:
+    u8 m_option_kind { (u8)TCPOptionKind::WindowScale };
+    u8 m_option_length { sizeof(TCPOptionWindowScale) };
+    u8 m_value;
+};
+
+static_assert(sizeof(TCPOptionWindowScale) == 3);
+
+// RFC 2018: We understand SACK options in the peer's ACKs.
+class [[gnu::packed]] TCPOptionSACKPermitted {
+private:
+    u8 m_option_kind { (u8)TCPOptionKind::SACKPermitted };
+    u8 m_option_length { sizeof(TCPOptionSACKPermitted) };
+};
+
+static_assert(sizeof(TCPOptionSACKPermitted) == 2);
+
+struct [[gnu::packed]] TCPSACKBlock {
+    NetworkOrdered<u32> left_edge;
+    NetworkOrdered<u32> right_edge;
+};
+
+static_assert(sizeof(TCPSACKBlock) == 8);
+
 class [[gnu::packed]] TCPPacket {
 public:
     TCPPacket() = default;
@@ -77,6 +120,32 @@ public:
     u16 urgent() const { return m_urgent; }
     void set_urgent(u16 urgent) { m_urgent = urgent; }
 
+    ReadonlyBytes options() const { return { ((const u8*)this) + sizeof(TCPPacket), header_size() - sizeof(TCPPacket) }; }
+
+    // Calls callback(kind, data) for every option, where data excludes the kind and length bytes.
+    template<typename Callback>
+    void for_each_option(Callback callback) const
+    {
+        auto options = this->options();
+        size_t offset = 0;
+        while (offset < options.size()) {
+            auto kind = (TCPOptionKind)options[offset];
+            if (kind == TCPOptionKind::End)
+                return;
+            if (kind == TCPOptionKind::NoOperation) {
+                ++offset;
+                continue;
+            }
+            if (offset + 1 >= options.size())
+                return;
+            size_t length = options[offset + 1];
+            if (length < 2 || offset + length > options.size())
+                return;
+            callback(kind, options.slice(offset + 2, length - 2));
+            offset += length;
+        }
+    }
+
     const void* payload() const { return ((const u8*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
@@ -21,6 +21,17 @@
 
 namespace Kernel {
 
+// Sequence numbers wrap around, so they can only be compared relative to each other.
+static bool sequence_number_before(u32 a, u32 b)
+{
+    return (i32)(a - b) < 0;
+}
+
+static bool sequence_number_at_or_before(u32 a, u32 b)
+{
+    return (i32)(a - b) <= 0;
+}
+
 void TCPSocket::for_each(Function<void(const TCPSocket&)> callback)
 {
     Locker locker(sockets_by_tuple().lock(), Lock::Mode::Shared);
@@ -40,6 +51,9 @@ void TCPSocket::set_state(State new_state)
     if (new_state == State::Established && m_direction == Direction::Outgoing)
         m_role = Role::Connected;
 
+    if (new_state == State::Established && m_congestion_window == 0)
+        m_congestion_window = initial_congestion_window();
+
     if (new_state == State::Closed) {
         Locker locker(closing_sockets().lock());
         closing_sockets().resource().remove(tuple());
@@ -155,25 +169,48 @@ KResultOr<NonnullRefPtr<TCPSocket>> TCPSocket::create(int protocol)
     return ENOMEM;
 }
 
-KResultOr<size_t> TCPSocket::protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, [[maybe_unused]] int flags)
+ReadonlyBytes TCPSocket::protocol_payload(ReadonlyBytes raw_ipv4_packet) const
 {
     auto& ipv4_packet = *reinterpret_cast<const IPv4Packet*>(raw_ipv4_packet.data());
     auto& tcp_packet = *static_cast<const TCPPacket*>(ipv4_packet.payload());
     size_t payload_size = raw_ipv4_packet.size() - sizeof(IPv4Packet) - tcp_packet.header_size();
-    dbgln_if(TCP_SOCKET_DEBUG, "payload_size {}, will it fit in {}?", payload_size, buffer_size);
-    VERIFY(buffer_size >= payload_size);
-    if (!buffer.write(tcp_packet.payload(), payload_size))
-        return EFAULT;
-    return payload_size;
+    return { tcp_packet.payload(), payload_size };
 }
 
 KResultOr<size_t> TCPSocket::protocol_send(const UserOrKernelBuffer& data, size_t data_length)
 {
+    switch (m_state) {
+    case State::Closed:
+        if (error() == Error::ConnectionReset)
+            return ECONNRESET;
+        if (error() == Error::RetransmitTimeout)
+            return ETIMEDOUT;
+        return ENOTCONN;
+    case State::FinWait1:
+    case State::FinWait2:
+    case State::Closing:
+    case State::LastAck:
+    case State::TimeWait:
+        // We've sent our FIN already.
+        return EPIPE;
+    default:
+        break;
+    }
+
     RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return EHOSTUNREACH;
-    size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-    data_length = min(data_length, mss);
+    size_t mss = min<size_t>(routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket), m_mss);
+    if (m_state == State::Established || m_state == State::CloseWait) {
+        Locker locker(m_not_acked_lock);
+        size_t space = send_window_space();
+        // Rather than sending a runt segment, wait for a whole one to fit, unless it would be the only one in flight.
+        if (space == 0 || (space < min(data_length, mss) && m_not_acked_size > 0))
+            return EAGAIN;
+        data_length = min(data_length, min(mss, space));
+    } else {
+        data_length = min(data_length, mss);
+    }
     int err = send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &data, data_length, &routing_decision);
     if (err < 0)
         return KResult((ErrnoCode)-err);
@@ -195,8 +232,14 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
 
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
 
-    const bool has_mss_option = flags == TCPFlags::SYN;
-    const size_t options_size = has_mss_option ? sizeof(TCPOptionMSS) : 0;
+    u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
+    if (flags & TCPFlags::SYN) {
+        m_mss = m_peer_mss ? min<u32>(mss, m_peer_mss) : mss;
+        m_recovery_point = m_sequence_number;
+    }
+
+    u8 options[max_options_size];
+    const size_t options_size = write_options(flags, mss, options);
     const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
     const size_t buffer_size = ipv4_payload_offset + tcp_header_size + payload_size;
     auto packet = routing_decision.adapter->acquire_packet_buffer(buffer_size);
@@ -210,7 +253,7 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(NumericLimits<u16>::max());
+    tcp_packet.set_window_size(advertised_window_size(flags));
     tcp_packet.set_sequence_number(m_sequence_number);
     tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
@@ -221,25 +264,22 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
         tcp_packet.set_ack_number(m_ack_number);
     }
 
-    if (payload && !payload->read(tcp_packet.payload(), payload_size)) {
-        routing_decision.adapter->release_packet_buffer(*packet);
+    if (payload && !payload->read(tcp_packet.payload(), payload_size))
         return EFAULT;
-    }
 
+    u32 sequence_number = m_sequence_number;
     if (flags & TCPFlags::SYN) {
         ++m_sequence_number;
     } else {
         m_sequence_number += payload_size;
     }
 
-    if (has_mss_option) {
-        u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-        TCPOptionMSS mss_option { mss };
-        VERIFY(packet->buffer.size() >= ipv4_payload_offset + sizeof(TCPPacket) + sizeof(mss_option));
-        memcpy(packet->buffer.data() + ipv4_payload_offset + sizeof(TCPPacket), &mss_option, sizeof(mss_option));
+    if (options_size > 0) {
+        VERIFY(packet->buffer.size() >= ipv4_payload_offset + sizeof(TCPPacket) + options_size);
+        memcpy(packet->buffer.data() + ipv4_payload_offset + sizeof(TCPPacket), options, options_size);
     }
 
-    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    fill_in_checksum(tcp_packet, payload_size, *routing_decision.adapter);
 
     routing_decision.adapter->send_packet({ packet->buffer.data(), packet->buffer.size() });
 
@@ -247,11 +287,17 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     m_bytes_out += buffer_size;
     if (tcp_packet.has_syn() || payload_size > 0) {
         Locker locker(m_not_acked_lock);
-        m_not_acked.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter });
+        auto now = kgettimeofday();
+        if (m_not_acked.is_empty())
+            m_last_retransmit_time = now;
+        m_not_acked.append({ sequence_number, m_sequence_number, move(packet), ipv4_payload_offset, 0, (u32)payload_size });
         m_not_acked_size += payload_size;
+        if (!m_is_timing_round_trip) {
+            m_is_timing_round_trip = true;
+            m_round_trip_timed_sequence_number = m_sequence_number;
+            m_round_trip_start_time = now;
+        }
         enqueue_for_retransmit();
-    } else {
-        routing_decision.adapter->release_packet_buffer(*packet);
     }
 
     return KSuccess;
@@ -259,52 +305,242 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
 
 void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
 {
-    if (packet.has_ack()) {
-        u32 ack_number = packet.ack_number();
+    m_packets_in++;
+    m_bytes_in += packet.header_size() + size;
 
-        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
+    if (!packet.has_ack())
+        return;
 
-        int removed = 0;
-        Locker locker(m_not_acked_lock);
-        while (!m_not_acked.is_empty()) {
-            auto& packet = m_not_acked.first();
-
-            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
-
-            if (packet.ack_number <= ack_number) {
-                auto old_adapter = packet.adapter.strong_ref();
-                if (old_adapter)
-                    old_adapter->release_packet_buffer(*packet.buffer);
-                TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
-                auto payload_size = packet.buffer->buffer.data() + packet.buffer->buffer.size() - (u8*)tcp_packet.payload();
-                m_not_acked_size -= payload_size;
-                evaluate_block_conditions();
-                m_not_acked.take_first();
-                removed++;
+    u32 ack_number = packet.ack_number();
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
+
+    Locker locker(m_not_acked_lock);
+    u32 oldest_unacknowledged = m_not_acked.is_empty() ? m_sequence_number : m_not_acked.first().sequence_number;
+    if (sequence_number_before(ack_number, oldest_unacknowledged) || sequence_number_before(m_sequence_number, ack_number)) {
+        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet ignoring stale ACK {}", ack_number);
+        return;
+    }
+
+    // RFC 7323: The window in a SYN segment is never scaled.
+    u32 send_window_size = packet.has_syn() ? packet.window_size() : (u32)packet.window_size() << m_send_window_scale;
+    bool window_changed = send_window_size != m_send_window_size;
+    m_send_window_size = send_window_size;
+
+    if (m_sack_permitted)
+        receive_sack_blocks(packet);
+
+    int removed = 0;
+    u32 acked_size = 0;
+    while (!m_not_acked.is_empty()) {
+        auto& packet = m_not_acked.first();
+
+        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
+
+        if (!sequence_number_at_or_before(packet.ack_number, ack_number))
+            break;
+
+        m_not_acked_size -= packet.payload_size;
+        if (packet.is_sacked)
+            m_sacked_size -= packet.payload_size;
+        acked_size += packet.payload_size;
+        m_not_acked.take_first();
+        removed++;
+    }
+
+    if (sequence_number_before(oldest_unacknowledged, ack_number)) {
+        auto now = kgettimeofday();
+        m_duplicate_acks = 0;
+        m_retransmit_attempts = 0;
+        m_last_retransmit_time = now;
+
+        if (m_is_timing_round_trip && sequence_number_at_or_before(m_round_trip_timed_sequence_number, ack_number)) {
+            m_is_timing_round_trip = false;
+            update_round_trip_time(now - m_round_trip_start_time);
+        }
+
+        if (m_congestion_window == 0) {
+            // Still connecting, so there's no congestion window yet.
+        } else if (m_recovery_state == RecoveryState::FastRecovery) {
+            if (sequence_number_at_or_before(m_recovery_point, ack_number)) {
+                // RFC 6582: A full acknowledgment ends the recovery, and deflates the window.
+                m_congestion_window = min(m_slow_start_threshold, max(bytes_in_flight(), m_mss) + m_mss);
+                m_recovery_state = RecoveryState::None;
             } else {
-                break;
+                // A partial acknowledgment means the next packet was lost too.
+                retransmit_holes(1);
+                m_congestion_window -= min(m_congestion_window, acked_size);
+                if (acked_size >= m_mss)
+                    m_congestion_window += m_mss;
+                m_congestion_window = max(m_congestion_window, m_mss);
             }
+        } else {
+            if (m_congestion_window < m_slow_start_threshold)
+                m_congestion_window += min(acked_size, m_mss);
+            else
+                m_congestion_window += max(1u, m_mss * m_mss / m_congestion_window);
+
+            if (m_recovery_state == RecoveryState::RetransmitTimeout) {
+                if (sequence_number_at_or_before(m_recovery_point, ack_number))
+                    m_recovery_state = RecoveryState::None;
+                else
+                    retransmit_holes(2);
+            }
+        }
+    } else if (size == packet.header_size() && !packet.has_syn() && !packet.has_fin() && !window_changed && !m_not_acked.is_empty()) {
+        // RFC 5681: A duplicate ACK means a segment left the network, but not the one we were waiting for.
+        ++m_duplicate_acks;
+        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet got duplicate ACK {} ({} in a row)", ack_number, m_duplicate_acks);
+        if (m_recovery_state == RecoveryState::FastRecovery) {
+            m_congestion_window += m_mss;
+            if (m_sack_permitted)
+                retransmit_holes(1);
+        } else if (m_recovery_state == RecoveryState::None && m_duplicate_acks == 3 && sequence_number_before(m_recovery_point, ack_number)) {
+            m_slow_start_threshold = max(bytes_in_flight() / 2, 2 * m_mss);
+            m_recovery_point = m_sequence_number;
+            m_recovery_state = RecoveryState::FastRecovery;
+            for (auto& packet : m_not_acked)
+                packet.is_retransmitted = false;
+            retransmit_holes(1);
+            m_congestion_window = m_slow_start_threshold + 3 * m_mss;
         }
+    }
+
+    if (m_not_acked.is_empty())
+        dequeue_for_retransmit();
+
+    if (removed > 0 || window_changed)
+        evaluate_block_conditions();
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
+}
 
-        if (m_not_acked.is_empty()) {
-            m_retransmit_attempts = 0;
-            dequeue_for_retransmit();
+void TCPSocket::receive_sack_blocks(const TCPPacket& packet)
+{
+    VERIFY(m_not_acked_lock.is_locked());
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        if (kind != TCPOptionKind::SACK)
+            return;
+        for (size_t offset = 0; offset + sizeof(TCPSACKBlock) <= data.size(); offset += sizeof(TCPSACKBlock)) {
+            TCPSACKBlock block;
+            memcpy(&block, data.offset(offset), sizeof(block));
+            u32 left_edge = block.left_edge;
+            u32 right_edge = block.right_edge;
+            if (!sequence_number_before(left_edge, right_edge))
+                continue;
+            for (auto& outgoing_packet : m_not_acked) {
+                if (outgoing_packet.is_sacked || outgoing_packet.payload_size == 0)
+                    continue;
+                if (sequence_number_before(outgoing_packet.sequence_number, left_edge))
+                    continue;
+                if (sequence_number_before(right_edge, outgoing_packet.ack_number))
+                    break;
+                outgoing_packet.is_sacked = true;
+                m_sacked_size += outgoing_packet.payload_size;
+            }
         }
+    });
+}
 
-        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
+void TCPSocket::receive_syn_options(const TCPPacket& packet)
+{
+    Optional<u8> send_window_scale;
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        switch (kind) {
+        case TCPOptionKind::MSS:
+            if (data.size() == sizeof(u16)) {
+                m_peer_mss = (data[0] << 8) | data[1];
+                if (m_peer_mss > 0)
+                    m_mss = min<u32>(m_mss, m_peer_mss);
+            }
+            break;
+        case TCPOptionKind::WindowScale:
+            // RFC 7323: Shifts greater than 14 are treated as 14.
+            if (data.size() == sizeof(u8))
+                send_window_scale = min(data[0], (u8)14);
+            break;
+        case TCPOptionKind::SACKPermitted:
+            m_sack_permitted = true;
+            break;
+        default:
+            break;
+        }
+    });
+
+    // Window scaling is only in effect if both sides ask for it.
+    m_send_window_scale = send_window_scale.value_or(0);
+    m_receive_window_scale = send_window_scale.has_value() ? our_window_scale : 0;
+    m_send_window_size = packet.window_size();
+}
+
+void TCPSocket::queue_out_of_order_segment(ReadonlyBytes raw_ipv4_packet, u32 sequence_number, size_t payload_size, const Time& packet_timestamp)
+{
+    if (!sequence_number_before(m_ack_number, sequence_number))
+        return;
+    if (sequence_number - m_ack_number + payload_size > receive_buffer_space())
+        return;
+    if (m_out_of_order_segments.size() >= maximum_out_of_order_segments)
+        return;
+
+    size_t index = 0;
+    for (; index < m_out_of_order_segments.size(); ++index) {
+        auto& segment = m_out_of_order_segments[index];
+        if (sequence_number_before(sequence_number, segment.sequence_number)) {
+            if (sequence_number_before(segment.sequence_number, sequence_number + payload_size))
+                return;
+            break;
+        }
+        // Overlapping or already queued.
+        if (sequence_number_before(sequence_number, segment.sequence_number + segment.payload_size))
+            return;
     }
 
-    m_packets_in++;
-    m_bytes_in += packet.header_size() + size;
+    auto packet = KBuffer::try_create_with_bytes(raw_ipv4_packet);
+    if (!packet)
+        return;
+    m_out_of_order_segments.insert(index, { sequence_number, (u32)payload_size, packet_timestamp, packet.release_nonnull() });
+    m_out_of_order_size += payload_size;
+    m_last_out_of_order_sequence_number = sequence_number;
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) queued out of order segment {} ({} bytes)", this, sequence_number, payload_size);
 }
 
-bool TCPSocket::should_delay_next_ack() const
+bool TCPSocket::receive_out_of_order_segments()
 {
-    // FIXME: We don't know the MSS here so make a reasonable guess.
-    const size_t mss = 1500;
+    bool did_receive_any = false;
+    while (!m_out_of_order_segments.is_empty()) {
+        auto& segment = m_out_of_order_segments.first();
+        if (sequence_number_before(m_ack_number, segment.sequence_number))
+            break;
 
+        u32 overlap = m_ack_number - segment.sequence_number;
+        if (overlap < segment.payload_size) {
+            // The start of the segment arrived again in order, but we've SACKed the rest of it, so we
+            // can't drop that. Trim off the part we already have by moving the rest of the payload up.
+            if (overlap) {
+                auto& packet = *segment.packet;
+                auto payload = protocol_payload({ packet.data(), packet.size() });
+                auto* payload_data = packet.data() + (payload.data() - packet.data());
+                memmove(payload_data, payload_data + overlap, payload.size() - overlap);
+                packet.set_size(packet.size() - overlap);
+                segment.sequence_number += overlap;
+                segment.payload_size -= overlap;
+                m_out_of_order_size -= overlap;
+            }
+            if (!did_receive(peer_address(), peer_port(), { segment.packet->data(), segment.packet->size() }, segment.timestamp))
+                break;
+            m_ack_number += segment.payload_size;
+            did_receive_any = true;
+        }
+        m_out_of_order_size -= segment.payload_size;
+        m_out_of_order_segments.take_first();
+    }
+    return did_receive_any;
+}
+
+bool TCPSocket::should_delay_next_ack() const
+{
     // RFC 1122 says we should send an ACK for every two full-sized segments.
-    if (m_ack_number >= m_last_ack_number_sent + 2 * mss)
+    if (m_ack_number >= m_last_ack_number_sent + 2 * m_mss)
         return false;
 
     // RFC 1122 says we should not delay ACKs for more than 500 milliseconds.
@@ -314,7 +550,141 @@ bool TCPSocket::should_delay_next_ack() const
     return true;
 }
 
-NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
+size_t TCPSocket::write_options(u16 flags, u16 mss, u8* options) const
+{
+    size_t size = 0;
+    auto append = [&](const auto& option) {
+        memcpy(options + size, &option, sizeof(option));
+        size += sizeof(option);
+    };
+    auto append_padding = [&](size_t count) {
+        for (size_t i = 0; i < count; ++i)
+            options[size++] = (u8)TCPOptionKind::NoOperation;
+    };
+
+    if (flags & TCPFlags::SYN) {
+        append(TCPOptionMSS { mss });
+        // A SYN-ACK may only carry the options that were in the SYN.
+        if (!(flags & TCPFlags::ACK) || m_receive_window_scale) {
+            append_padding(1);
+            append(TCPOptionWindowScale { our_window_scale });
+        }
+        if (!(flags & TCPFlags::ACK) || m_sack_permitted) {
+            append_padding(2);
+            append(TCPOptionSACKPermitted {});
+        }
+        return size;
+    }
+
+    if (flags != TCPFlags::ACK || !m_sack_permitted || m_out_of_order_segments.is_empty())
+        return size;
+
+    // RFC 2018: Tell the peer which segments we're holding on to, the most recently received one first.
+    Vector<TCPSACKBlock, max_sack_blocks> blocks;
+    Optional<size_t> most_recent_block;
+    for (auto& segment : m_out_of_order_segments) {
+        if (!blocks.is_empty() && (u32)blocks.last().right_edge == segment.sequence_number) {
+            blocks.last().right_edge = segment.sequence_number + segment.payload_size;
+        } else {
+            blocks.append({ segment.sequence_number, segment.sequence_number + segment.payload_size });
+        }
+        if (segment.sequence_number == m_last_out_of_order_sequence_number)
+            most_recent_block = blocks.size() - 1;
+    }
+    if (most_recent_block.has_value() && most_recent_block.value() != 0) {
+        auto block = blocks.take(most_recent_block.value());
+        blocks.prepend(block);
+    }
+
+    size_t block_count = min(blocks.size(), max_sack_blocks);
+    append_padding(2);
+    options[size++] = (u8)TCPOptionKind::SACK;
+    options[size++] = 2 + block_count * sizeof(TCPSACKBlock);
+    for (size_t i = 0; i < block_count; ++i)
+        append(blocks[i]);
+    return size;
+}
+
+u32 TCPSocket::receive_window_size() const
+{
+    // did_receive() wants room for each whole IPv4 packet, so leave some for the headers as well.
+    constexpr size_t header_allowance = sizeof(IPv4Packet) + max_header_size;
+    size_t space = receive_buffer_space();
+    size_t segment_count = space / (m_mss + header_allowance) + 1;
+    if (space <= segment_count * header_allowance)
+        return 0;
+    return space - segment_count * header_allowance;
+}
+
+u16 TCPSocket::advertised_window_size(u16 flags)
+{
+    u8 scale = (flags & TCPFlags::SYN) ? 0 : m_receive_window_scale;
+    u16 window_size = min(receive_window_size() >> scale, (u32)NumericLimits<u16>::max());
+    m_last_advertised_window = (u32)window_size << scale;
+    return window_size;
+}
+
+void TCPSocket::update_round_trip_time(const Time& sample)
+{
+    // RFC 6298, section 2.
+    i64 sample_us = sample.to_microseconds();
+    i64 smoothed_us = m_smoothed_round_trip_time.to_microseconds();
+    i64 variation_us = m_round_trip_time_variation.to_microseconds();
+    if (m_smoothed_round_trip_time.is_zero()) {
+        smoothed_us = max(sample_us, (i64)1);
+        variation_us = sample_us / 2;
+    } else {
+        i64 difference_us = smoothed_us > sample_us ? smoothed_us - sample_us : sample_us - smoothed_us;
+        variation_us = (3 * variation_us + difference_us) / 4;
+        smoothed_us = (7 * smoothed_us + sample_us) / 8;
+    }
+    m_smoothed_round_trip_time = Time::from_microseconds(smoothed_us);
+    m_round_trip_time_variation = Time::from_microseconds(variation_us);
+
+    i64 timeout_us = smoothed_us + max(4 * variation_us, (i64)1000);
+    timeout_us = clamp(timeout_us, (i64)1'000'000, (i64)60'000'000);
+    m_retransmit_timeout = Time::from_microseconds(timeout_us);
+}
+
+u32 TCPSocket::initial_congestion_window() const
+{
+    // RFC 5681, section 3.1.
+    if (m_mss > 2190)
+        return 2 * m_mss;
+    if (m_mss > 1095)
+        return 3 * m_mss;
+    return 4 * m_mss;
+}
+
+u32 TCPSocket::bytes_in_flight() const
+{
+    return m_not_acked_size - m_sacked_size;
+}
+
+size_t TCPSocket::send_window_space() const
+{
+    // When the peer has no room at all, we still send a byte now and then to find out when it does.
+    if (m_send_window_size == 0 && m_not_acked.is_empty())
+        return 1;
+    u32 window = min(m_congestion_window, m_send_window_size);
+    u32 in_flight = bytes_in_flight();
+    if (in_flight >= window)
+        return 0;
+    return window - in_flight;
+}
+
+void TCPSocket::protocol_did_read()
+{
+    if (m_state != State::Established && m_state != State::FinWait1 && m_state != State::FinWait2)
+        return;
+    // Let the peer know once there's room for another full segment, so it doesn't have to probe for it.
+    u8 scale = m_receive_window_scale;
+    u32 window = min(receive_window_size() >> scale, (u32)NumericLimits<u16>::max()) << scale;
+    if (window >= m_last_advertised_window + m_mss)
+        [[maybe_unused]] auto rc = send_ack(true);
+}
+
+NetworkOrdered<u16> TCPSocket::compute_tcp_pseudo_header_checksum(const IPv4Address& source, const IPv4Address& destination, u16 tcp_size)
 {
     struct [[gnu::packed]] PseudoHeader {
         IPv4Address source;
@@ -324,7 +694,7 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
         NetworkOrdered<u16> payload_size;
     };
 
-    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, packet.header_size() + payload_size };
+    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, tcp_size };
 
     u32 checksum = 0;
     auto* w = (const NetworkOrdered<u16>*)&pseudo_header;
@@ -333,7 +703,13 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
         if (checksum > 0xffff)
             checksum = (checksum >> 16) + (checksum & 0xffff);
     }
-    w = (const NetworkOrdered<u16>*)&packet;
+    return checksum;
+}
+
+NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
+{
+    u32 checksum = compute_tcp_pseudo_header_checksum(source, destination, packet.header_size() + payload_size);
+    auto* w = (const NetworkOrdered<u16>*)&packet;
     for (size_t i = 0; i < packet.header_size() / sizeof(u16); ++i) {
         checksum += w[i];
         if (checksum > 0xffff)
@@ -355,6 +731,16 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
     return ~(checksum & 0xffff);
 }
 
+void TCPSocket::fill_in_checksum(TCPPacket& packet, u16 payload_size, const NetworkAdapter& adapter) const
+{
+    packet.set_checksum(0);
+    // The adapter sums up the rest of the packet on its way out and folds that into the pseudo-header sum.
+    if (adapter.has_tcp_checksum_offload())
+        packet.set_checksum(compute_tcp_pseudo_header_checksum(local_address(), peer_address(), packet.header_size() + payload_size));
+    else
+        packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), packet, payload_size));
+}
+
 KResult TCPSocket::protocol_bind()
 {
     if (has_specific_local_address() && !m_adapter) {
@@ -522,11 +908,11 @@ void TCPSocket::retransmit_packets()
 
     // RFC6298 says we should have at least one second between retransmits. According to
     // RFC1122 we must do exponential backoff - even for SYN packets.
-    i64 retransmit_interval = 1;
+    auto retransmit_timeout = m_retransmit_timeout;
     for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
-        retransmit_interval *= 2;
+        retransmit_timeout += retransmit_timeout;
 
-    if (m_last_retransmit_time > now - Time::from_seconds(retransmit_interval))
+    if (m_last_retransmit_time > now - retransmit_timeout)
         return;
 
     dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit", this);
@@ -545,38 +931,110 @@ void TCPSocket::retransmit_packets()
     if (routing_decision.is_zero())
         return;
 
-    Locker locker(m_not_acked_lock, Lock::Mode::Shared);
+    Locker locker(m_not_acked_lock);
+    if (m_not_acked.is_empty())
+        return;
+
+    // A timeout says nothing about the network when we're only probing a zero window.
+    if (m_congestion_window != 0 && m_send_window_size != 0) {
+        // RFC 5681: Loss detected by the retransmission timer means starting again from slow start.
+        if (m_retransmit_attempts == 1)
+            m_slow_start_threshold = max(bytes_in_flight() / 2, 2 * m_mss);
+        m_congestion_window = m_mss;
+        m_recovery_state = RecoveryState::RetransmitTimeout;
+        m_recovery_point = m_sequence_number;
+        m_duplicate_acks = 0;
+    }
+
+    // RFC 2018: The peer may have dropped what it told us it had, so we can't rely on that anymore.
     for (auto& packet : m_not_acked) {
-        packet.tx_counter++;
-
-        if constexpr (TCP_SOCKET_DEBUG) {
-            auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
-            dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                local_address(), local_port(),
-                peer_address(), peer_port(),
-                (tcp_packet.has_syn() ? "SYN " : ""),
-                (tcp_packet.has_ack() ? "ACK " : ""),
-                (tcp_packet.has_fin() ? "FIN " : ""),
-                (tcp_packet.has_rst() ? "RST " : ""),
-                tcp_packet.sequence_number(),
-                tcp_packet.ack_number(),
-                packet.tx_counter);
-        }
+        packet.is_sacked = false;
+        packet.is_retransmitted = false;
+    }
+    m_sacked_size = 0;
 
-        size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
-        if (ipv4_payload_offset != packet.ipv4_payload_offset) {
-            // FIXME: Add support for this. This can happen if after a route change
-            // we ended up on another adapter which doesn't have the same layer 2 type
-            // like the previous adapter.
-            VERIFY_NOT_REACHED();
-        }
-        routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
-            local_address(), routing_decision.next_hop, peer_address(),
-            IPv4Protocol::TCP, packet.buffer->buffer.size() - ipv4_payload_offset, ttl());
-        routing_decision.adapter->send_packet({ packet.buffer->buffer.data(), packet.buffer->buffer.size() });
-        m_packets_out++;
-        m_bytes_out += packet.buffer->buffer.size();
+    retransmit_packet(m_not_acked.first(), routing_decision);
+}
+
+void TCPSocket::retransmit_holes(size_t max_packets)
+{
+    VERIFY(m_not_acked_lock.is_locked());
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return;
+
+    // Packets after the last one the peer has may just still be on their way. After a
+    // timeout, though, we assume everything that hasn't been acknowledged was lost.
+    const OutgoingPacket* last_sacked_packet = nullptr;
+    for (auto& packet : m_not_acked) {
+        if (packet.is_sacked)
+            last_sacked_packet = &packet;
     }
+
+    size_t retransmitted = 0;
+    bool is_first_packet = true;
+    bool is_before_last_sacked_packet = last_sacked_packet != nullptr;
+    for (auto& packet : m_not_acked) {
+        if (retransmitted == max_packets)
+            break;
+        if (&packet == last_sacked_packet)
+            is_before_last_sacked_packet = false;
+        bool is_lost = m_recovery_state == RecoveryState::RetransmitTimeout || is_first_packet || is_before_last_sacked_packet;
+        is_first_packet = false;
+        if (!is_lost)
+            break;
+        if (packet.is_sacked || packet.is_retransmitted)
+            continue;
+        retransmit_packet(packet, routing_decision);
+        ++retransmitted;
+    }
+}
+
+void TCPSocket::retransmit_packet(OutgoingPacket& packet, RoutingDecision& routing_decision)
+{
+    packet.tx_counter++;
+    packet.is_retransmitted = true;
+    // RFC 6298: Karn's algorithm, we can't tell which transmission an ACK is for.
+    m_is_timing_round_trip = false;
+
+    auto& tcp_packet = *(TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
+    if constexpr (TCP_SOCKET_DEBUG) {
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+    }
+
+    size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
+    if (ipv4_payload_offset != packet.ipv4_payload_offset) {
+        // FIXME: Add support for this. This can happen if after a route change
+        // we ended up on another adapter which doesn't have the same layer 2 type
+        // like the previous adapter.
+        VERIFY_NOT_REACHED();
+    }
+
+    // What we've received and how much room we have may have changed since the packet was first sent.
+    if (!tcp_packet.has_syn() && tcp_packet.has_ack()) {
+        tcp_packet.set_ack_number(m_ack_number);
+        tcp_packet.set_window_size(advertised_window_size(tcp_packet.flags()));
+        m_last_ack_number_sent = m_ack_number;
+        m_last_ack_sent_time = kgettimeofday();
+    }
+    fill_in_checksum(tcp_packet, packet.payload_size, *routing_decision.adapter);
+
+    routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
+        local_address(), routing_decision.next_hop, peer_address(),
+        IPv4Protocol::TCP, packet.buffer->buffer.size() - ipv4_payload_offset, ttl());
+    routing_decision.adapter->send_packet({ packet.buffer->buffer.data(), packet.buffer->buffer.size() });
+    m_packets_out++;
+    m_bytes_out += packet.buffer->buffer.size();
+    m_retransmits++;
 }
 
 bool TCPSocket::can_write(const FileDescription& file_description, size_t size) const
@@ -587,11 +1045,13 @@ bool TCPSocket::can_write(const FileDescription& file_description, size_t size)
     if (m_state == State::SynSent || m_state == State::SynReceived)
         return false;
 
-    if (!file_description.is_blocking())
+    if (m_state != State::Established && m_state != State::CloseWait)
         return true;
 
+    // Keep this in sync with protocol_send(), or blocked writers would wake up only to get EAGAIN.
     Locker lock(m_not_acked_lock);
-    return m_not_acked_size + size <= m_send_window_size;
+    size_t space = send_window_space();
+    return space >= m_mss || (space > 0 && m_not_acked_size == 0);
 }
 
 }
@@ -8,6 +8,7 @@
 
 #include <AK/Function.h>
 #include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
 #include <AK/SinglyLinkedList.h>
 #include <AK/WeakPtr.h>
 #include <Kernel/KResult.h>
@@ -94,6 +95,7 @@ public:
         RSTDuringConnect,
         UnexpectedFlagsDuringConnect,
         RetransmitTimeout,
+        ConnectionReset,
     };
 
     static const char* to_string(Error error)
@@ -107,6 +109,10 @@ public:
             return "RSTDuringConnect";
         case Error::UnexpectedFlagsDuringConnect:
             return "UnexpectedFlagsDuringConnect";
+        case Error::RetransmitTimeout:
+            return "RetransmitTimeout";
+        case Error::ConnectionReset:
+            return "ConnectionReset";
         default:
             return "Invalid";
         }
@@ -129,16 +135,22 @@ public:
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
-
-    // FIXME: Make this configurable?
-    static constexpr u32 maximum_duplicate_acks = 5;
-    void set_duplicate_acks(u32 acks) { m_duplicate_acks = acks; }
-    u32 duplicate_acks() const { return m_duplicate_acks; }
+    u32 congestion_window() const { return m_congestion_window; }
+    u32 slow_start_threshold() const { return m_slow_start_threshold; }
+    u32 retransmits() const { return m_retransmits; }
 
     KResult send_ack(bool allow_duplicate = false);
     KResult send_tcp_packet(u16 flags, const UserOrKernelBuffer* = nullptr, size_t = 0, RoutingDecision* = nullptr);
     void receive_tcp_packet(const TCPPacket&, u16 size);
 
+    // Picks up the MSS, window scale and SACK options from the peer's SYN.
+    void receive_syn_options(const TCPPacket&);
+
+    // Holds on to a segment that arrived ahead of the next one we expect.
+    void queue_out_of_order_segment(ReadonlyBytes raw_ipv4_packet, u32 sequence_number, size_t payload_size, const Time& packet_timestamp);
+    // Receives the queued segments that follow on from ack_number(). Returns whether there were any.
+    bool receive_out_of_order_segments();
+
     bool should_delay_next_ack() const;
 
     static Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>& sockets_by_tuple();
@@ -167,20 +179,38 @@ private:
     virtual const char* class_name() const override { return "TCPSocket"; }
 
     static NetworkOrdered<u16> compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket&, u16 payload_size);
+    static NetworkOrdered<u16> compute_tcp_pseudo_header_checksum(const IPv4Address& source, const IPv4Address& destination, u16 tcp_size);
+    void fill_in_checksum(TCPPacket&, u16 payload_size, const NetworkAdapter&) const;
 
     virtual void shut_down_for_writing() override;
 
-    virtual KResultOr<size_t> protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, int flags) override;
+    virtual ReadonlyBytes protocol_payload(ReadonlyBytes raw_ipv4_packet) const override;
     virtual KResultOr<size_t> protocol_send(const UserOrKernelBuffer&, size_t) override;
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) override;
     virtual KResultOr<u16> protocol_allocate_local_port() override;
     virtual bool protocol_is_disconnected() const override;
     virtual KResult protocol_bind() override;
     virtual KResult protocol_listen(bool did_allocate_port) override;
+    virtual void protocol_did_read() override;
 
     void enqueue_for_retransmit();
     void dequeue_for_retransmit();
 
+    struct OutgoingPacket;
+    void retransmit_packet(OutgoingPacket&, RoutingDecision&);
+    void retransmit_holes(size_t max_packets);
+    void receive_sack_blocks(const TCPPacket&);
+    void update_round_trip_time(const Time& sample);
+    u32 initial_congestion_window() const;
+    u32 bytes_in_flight() const;
+    size_t send_window_space() const;
+    u32 receive_window_size() const;
+    u16 advertised_window_size(u16 flags);
+    static constexpr size_t max_header_size = 60;
+    static constexpr size_t max_options_size = 40;
+    static constexpr size_t max_sack_blocks = 4;
+    size_t write_options(u16 flags, u16 mss, u8* options) const;
+
     WeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullRefPtr<TCPSocket>> m_pending_release_for_accept;
     Direction m_direction { Direction::Unspecified };
@@ -195,18 +225,64 @@ private:
     u32 m_bytes_out { 0 };
 
     struct OutgoingPacket {
+        u32 sequence_number { 0 };
         u32 ack_number { 0 };
         RefPtr<PacketWithTimestamp> buffer;
         size_t ipv4_payload_offset;
-        WeakPtr<NetworkAdapter> adapter;
         int tx_counter { 0 };
+        u32 payload_size { 0 };
+        // The peer has told us it has this packet, but not everything before it.
+        bool is_sacked { false };
+        // Already sent again during the current loss recovery.
+        bool is_retransmitted { false };
     };
 
     mutable Lock m_not_acked_lock { "TCPSocket unacked packets" };
     SinglyLinkedList<OutgoingPacket> m_not_acked;
     size_t m_not_acked_size { 0 };
+    size_t m_sacked_size { 0 };
+
+    // Maximum segment size for sending, the smaller of the route's and the peer's.
+    u32 m_mss { 536 };
+    u16 m_peer_mss { 0 };
 
+    // Congestion control is NewReno (RFC 5681 and RFC 6582), using SACK information to pick
+    // which packets to send again during recovery when the peer provides it.
+    enum class RecoveryState {
+        None,
+        FastRecovery,
+        RetransmitTimeout,
+    };
+    RecoveryState m_recovery_state { RecoveryState::None };
+    // Recovery ends once everything up to here has been acknowledged.
+    u32 m_recovery_point { 0 };
+    u32 m_congestion_window { 0 };
+    u32 m_slow_start_threshold { NumericLimits<u32>::max() };
     u32 m_duplicate_acks { 0 };
+    u32 m_retransmits { 0 };
+
+    // The peer's receive window, already scaled.
+    u32 m_send_window_size { 64 * KiB };
+    u8 m_send_window_scale { 0 };
+    bool m_sack_permitted { false };
+
+    // We can advertise all of our receive buffer with a shift of 3.
+    static constexpr u8 our_window_scale = 3;
+    u8 m_receive_window_scale { 0 };
+    u32 m_last_advertised_window { 0 };
+
+    struct OutOfOrderSegment {
+        u32 sequence_number { 0 };
+        u32 payload_size { 0 };
+        Time timestamp;
+        NonnullOwnPtr<KBuffer> packet;
+    };
+    static constexpr size_t maximum_out_of_order_segments = 64;
+    // Sorted by sequence number, without overlaps.
+    Vector<OutOfOrderSegment> m_out_of_order_segments;
+    size_t m_out_of_order_size { 0 };
+    // The first SACK block we send should be the one with the most recent segment in it.
+    u32 m_last_out_of_order_sequence_number { 0 };
 
     u32 m_last_ack_number_sent { 0 };
     Time m_last_ack_sent_time;
@@ -216,8 +292,13 @@ private:
     Time m_last_retransmit_time;
     u32 m_retransmit_attempts { 0 };
 
-    // FIXME: Parse window size TCP option from the peer
-    u32 m_send_window_size { 64 * KiB };
+    // RFC 6298: Round trip time measurement and retransmission timeout.
+    Time m_smoothed_round_trip_time;
+    Time m_round_trip_time_variation;
+    Time m_retransmit_timeout { Time::from_seconds(1) };
+    bool m_is_timing_round_trip { false };
+    u32 m_round_trip_timed_sequence_number { 0 };
+    Time m_round_trip_start_time;
 };
 
 }
@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/MACAddress.h>
+#include <Kernel/CommandLine.h>
+#include <Kernel/Debug.h>
+#include <Kernel/Net/EtherType.h>
+#include <Kernel/Net/VirtIONetworkAdapter.h>
+#include <Kernel/PCI/IDs.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+#define RECEIVEQ 0
+#define TRANSMITQ 1
+
+UNMAP_AFTER_INIT RefPtr<VirtIONetworkAdapter> VirtIONetworkAdapter::try_to_initialize(PCI::Address address)
+{
+    if (kernel_command_line().disable_virtio())
+        return {};
+    auto id = PCI::get_id(address);
+    if (id.vendor_id != (u16)PCIVendorID::VirtIO || id.device_id != (u16)PCIDeviceID::VirtIONetwork)
+        return {};
+    auto adapter = adopt_ref_if_nonnull(new VirtIONetworkAdapter(address));
+    if (!adapter)
+        return {};
+    if (adapter->initialize())
+        return adapter;
+    return {};
+}
+
+UNMAP_AFTER_INIT VirtIONetworkAdapter::VirtIONetworkAdapter(PCI::Address address)
+    : VirtIODevice(address, "VirtIONetworkAdapter")
+{
+    set_interface_name(pci_address());
+}
+
+UNMAP_AFTER_INIT VirtIONetworkAdapter::~VirtIONetworkAdapter()
+{
+}
+
+static PhysicalAddress packet_buffer_address(const PacketWithTimestamp& packet)
+{
+    // The device writes to a buffer as a whole, which a single page always is physically.
+    VERIFY(packet.buffer.capacity() == PAGE_SIZE);
+    return packet.buffer.impl().region().physical_page(0)->paddr();
+}
+
+UNMAP_AFTER_INIT bool VirtIONetworkAdapter::initialize()
+{
+    auto* cfg = get_config(ConfigurationType::Device);
+    if (!cfg)
+        return false;
+    bool success = negotiate_features([&](u64 supported_features) {
+        u64 negotiated = 0;
+        if (is_feature_set(supported_features, VIRTIO_NET_F_MAC))
+            negotiated |= VIRTIO_NET_F_MAC;
+        if (is_feature_set(supported_features, VIRTIO_NET_F_STATUS))
+            negotiated |= VIRTIO_NET_F_STATUS;
+        if (is_feature_set(supported_features, VIRTIO_NET_F_CSUM))
+            negotiated |= VIRTIO_NET_F_CSUM;
+        // We don't verify the checksums of received packets, so the host doesn't need to fill them in either.
+        if (is_feature_set(supported_features, VIRTIO_NET_F_GUEST_CSUM))
+            negotiated |= VIRTIO_NET_F_GUEST_CSUM;
+        return negotiated;
+    });
+    if (!success)
+        return false;
+    if (!is_feature_accepted(VIRTIO_NET_F_MAC)) {
+        dmesgln("{}: Device has no MAC address", m_class_name);
+        return false;
+    }
+
+    MACAddress mac;
+    read_config_atomic([&]() {
+        for (size_t i = 0; i < 6; ++i)
+            mac[i] = config_read8(*cfg, i);
+    });
+    set_mac_address(mac);
+    m_has_tcp_checksum_offload = is_feature_accepted(VIRTIO_NET_F_CSUM);
+
+    if (!setup_queues(2))
+        return false;
+    finish_init();
+
+    auto& receive_queue = get_queue(RECEIVEQ);
+    size_t receive_slot_count = receive_queue.size() / 2;
+    m_receive_headers = MM.allocate_contiguous_kernel_region(page_round_up(receive_slot_count * sizeof(VirtIONetHeader)), "VirtIONetworkAdapter RX", Region::Access::Read | Region::Access::Write);
+    if (!m_receive_headers)
+        return false;
+    for (size_t i = 0; i < receive_slot_count; ++i) {
+        auto buffer = acquire_packet_buffer(PAGE_SIZE);
+        if (!buffer)
+            return false;
+        m_receive_buffers.append(move(buffer));
+    }
+
+    auto& transmit_queue = get_queue(TRANSMITQ);
+    size_t transmit_slot_count = min(max_transmit_slots, (size_t)transmit_queue.size());
+    m_transmit_buffers = MM.allocate_contiguous_kernel_region(page_round_up(transmit_slot_count * transmit_buffer_size), "VirtIONetworkAdapter TX", Region::Access::Read | Region::Access::Write);
+    if (!m_transmit_buffers)
+        return false;
+    m_free_transmit_slots.ensure_capacity(transmit_slot_count);
+    for (size_t i = transmit_slot_count; i > 0; --i)
+        m_free_transmit_slots.append(i - 1);
+
+    {
+        ScopedSpinLock lock(receive_queue.lock());
+        for (size_t i = 0; i < receive_slot_count; ++i)
+            supply_receive_buffer(i);
+        notify_queue_if_needed(RECEIVEQ);
+    }
+    {
+        ScopedSpinLock lock(transmit_queue.lock());
+        transmit_queue.disable_interrupts();
+    }
+
+    dmesgln("{}: {} @ {}, MAC address {}, {} RX and {} TX slots{}", m_class_name, name(), pci_address(), mac.to_string(),
+        receive_slot_count, transmit_slot_count, m_has_tcp_checksum_offload ? ", TCP checksum offload" : "");
+    return true;
+}
+
+bool VirtIONetworkAdapter::link_up()
+{
+    if (!is_feature_accepted(VIRTIO_NET_F_STATUS))
+        return true;
+    auto* cfg = get_config(ConfigurationType::Device);
+    VERIFY(cfg);
+    u16 status = 0;
+    read_config_atomic([&]() {
+        status = config_read16(*cfg, 0x6);
+    });
+    return status & VIRTIO_NET_S_LINK_UP;
+}
+
+bool VirtIONetworkAdapter::handle_device_config_change()
+{
+    dmesgln("{}: Link is {}", m_class_name, link_up() ? "up" : "down");
+    return true;
+}
+
+void VirtIONetworkAdapter::handle_queue_update(u16 queue_index)
+{
+    switch (queue_index) {
+    case RECEIVEQ: {
+        auto& queue = get_queue(RECEIVEQ);
+        ScopedSpinLock lock(queue.lock());
+        // No need for interrupts about packets that arrive while we're going through the ring
+        // anyway. Once they're back on, we have to look again for what came in just before.
+        bool did_receive_packets = false;
+        do {
+            queue.disable_interrupts();
+            did_receive_packets |= receive_packets() > 0;
+            queue.enable_interrupts();
+            full_memory_barrier();
+        } while (queue.new_data_available());
+        // All the buffers we gave back get announced at once.
+        if (did_receive_packets)
+            notify_queue_if_needed(RECEIVEQ);
+        break;
+    }
+    case TRANSMITQ: {
+        auto& queue = get_queue(TRANSMITQ);
+        ScopedSpinLock lock(queue.lock());
+        reclaim_sent_buffers();
+        queue.disable_interrupts();
+        m_transmit_wait_queue.wake_all();
+        break;
+    }
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+void VirtIONetworkAdapter::supply_receive_buffer(size_t slot_index)
+{
+    auto& queue = get_queue(RECEIVEQ);
+    VERIFY(queue.lock().is_locked());
+    VirtIOQueueChain chain(queue);
+    bool did_add_buffers = chain.add_buffer_to_chain(receive_header_address(slot_index), sizeof(VirtIONetHeader), BufferType::DeviceWritable);
+    did_add_buffers &= chain.add_buffer_to_chain(packet_buffer_address(*m_receive_buffers[slot_index]), PAGE_SIZE, BufferType::DeviceWritable);
+    // There are two descriptors for every receive slot, so this can't run out of them.
+    VERIFY(did_add_buffers);
+    supply_chain(RECEIVEQ, chain);
+}
+
+size_t VirtIONetworkAdapter::receive_packets()
+{
+    auto& queue = get_queue(RECEIVEQ);
+    VERIFY(queue.lock().is_locked());
+    auto headers_start = receive_header_address(0);
+    size_t received_packets = 0;
+    for (;;) {
+        size_t used;
+        auto chain = queue.pop_used_buffer_chain(used);
+        if (chain.is_empty())
+            break;
+        Optional<size_t> slot_index;
+        chain.for_each([&](PhysicalAddress address, size_t) {
+            // The first buffer of every chain is the header of its slot.
+            if (!slot_index.has_value())
+                slot_index = (address.get() - headers_start.get()) / sizeof(VirtIONetHeader);
+        });
+        chain.release_buffer_slots_to_queue();
+        VERIFY(slot_index.has_value() && slot_index.value() < m_receive_buffers.size());
+        auto slot = slot_index.value();
+
+        size_t length = used - min(used, sizeof(VirtIONetHeader));
+        dbgln_if(VIRTIO_DEBUG, "{}: Received {} bytes in slot {}", m_class_name, length, slot);
+        if (length > 0) {
+            // Hand the buffer the packet is in up the stack and put an empty one in its place.
+            // If there is none to be had, we have to copy the packet out instead.
+            if (auto replacement = acquire_packet_buffer(PAGE_SIZE)) {
+                auto packet = m_receive_buffers[slot].release_nonnull();
+                m_receive_buffers[slot] = move(replacement);
+                packet->buffer.set_size(length);
+                packet->timestamp = kgettimeofday();
+                did_receive_packet_buffer(move(packet));
+            } else {
+                did_receive({ m_receive_buffers[slot]->buffer.data(), length });
+            }
+        }
+        supply_receive_buffer(slot);
+        ++received_packets;
+    }
+    return received_packets;
+}
+
+void VirtIONetworkAdapter::reclaim_sent_buffers()
+{
+    auto& queue = get_queue(TRANSMITQ);
+    VERIFY(queue.lock().is_locked());
+    auto buffers_start = transmit_buffer_address(0);
+    for (;;) {
+        size_t used;
+        auto chain = queue.pop_used_buffer_chain(used);
+        if (chain.is_empty())
+            break;
+        Optional<size_t> slot_index;
+        chain.for_each([&](PhysicalAddress address, size_t) {
+            slot_index = (address.get() - buffers_start.get()) / transmit_buffer_size;
+        });
+        chain.release_buffer_slots_to_queue();
+        VERIFY(slot_index.has_value());
+        m_free_transmit_slots.append(slot_index.value());
+    }
+}
+
+void VirtIONetworkAdapter::fill_in_header(VirtIONetHeader& header, ReadonlyBytes frame) const
+{
+    memset(&header, 0, sizeof(header));
+    header.gso_type = VIRTIO_NET_HDR_GSO_NONE;
+    if (!m_has_tcp_checksum_offload || frame.size() < sizeof(EthernetFrameHeader) + sizeof(IPv4Packet))
+        return;
+    auto& ethernet = *(const EthernetFrameHeader*)frame.data();
+    if (ethernet.ether_type() != EtherType::IPv4)
+        return;
+    auto& ipv4 = *(const IPv4Packet*)ethernet.payload();
+    if (ipv4.protocol() != (u8)IPv4Protocol::TCP)
+        return;
+    // TCPSocket only put the pseudo-header sum into the checksum field, the device adds the rest.
+    header.flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+    header.checksum_start = sizeof(EthernetFrameHeader) + ipv4.internet_header_length() * sizeof(u32);
+    header.checksum_offset = 16; // Where the checksum is in the TCP header.
+}
+
+void VirtIONetworkAdapter::send_raw(ReadonlyBytes payload)
+{
+    VERIFY(sizeof(VirtIONetHeader) + payload.size() <= transmit_buffer_size);
+    auto& queue = get_queue(TRANSMITQ);
+    for (;;) {
+        {
+            ScopedSpinLock lock(queue.lock());
+            reclaim_sent_buffers();
+            if (!m_free_transmit_slots.is_empty()) {
+                auto slot_index = m_free_transmit_slots.take_last();
+                auto* buffer = m_transmit_buffers->vaddr().offset(slot_index * transmit_buffer_size).as_ptr();
+                fill_in_header(*(VirtIONetHeader*)buffer, payload);
+                memcpy(buffer + sizeof(VirtIONetHeader), payload.data(), payload.size());
+
+                VirtIOQueueChain chain(queue);
+                bool did_add_buffer = chain.add_buffer_to_chain(transmit_buffer_address(slot_index), sizeof(VirtIONetHeader) + payload.size(), BufferType::DeviceReadable);
+                VERIFY(did_add_buffer);
+                supply_chain_and_notify(TRANSMITQ, chain);
+                return;
+            }
+
+            // The ring is full, so we need the device to tell us when it's done with some of it.
+            queue.enable_interrupts();
+            full_memory_barrier();
+            if (queue.new_data_available())
+                continue;
+        }
+        dbgln_if(VIRTIO_DEBUG, "{}: Transmit ring is full, waiting", m_class_name);
+        m_transmit_wait_queue.wait_forever("VirtIONetworkAdapter");
+    }
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/VirtIO/VirtIO.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+#define VIRTIO_NET_F_CSUM (1 << 0)
+#define VIRTIO_NET_F_GUEST_CSUM (1 << 1)
+#define VIRTIO_NET_F_MAC (1 << 5)
+#define VIRTIO_NET_F_STATUS (1 << 16)
+
+#define VIRTIO_NET_S_LINK_UP 1
+
+#define VIRTIO_NET_HDR_F_NEEDS_CSUM 1
+#define VIRTIO_NET_HDR_GSO_NONE 0
+
+class VirtIONetworkAdapter final : public NetworkAdapter
+    , public VirtIODevice {
+public:
+    static RefPtr<VirtIONetworkAdapter> try_to_initialize(PCI::Address);
+
+    virtual ~VirtIONetworkAdapter() override;
+
+    virtual void send_raw(ReadonlyBytes) override;
+    virtual bool link_up() override;
+    virtual bool has_tcp_checksum_offload() const override { return m_has_tcp_checksum_offload; }
+
+    virtual const char* purpose() const override { return class_name(); }
+
+private:
+    explicit VirtIONetworkAdapter(PCI::Address);
+    bool initialize();
+
+    virtual const char* class_name() const override { return m_class_name.characters(); }
+
+    // ^VirtIODevice
+    virtual bool handle_device_config_change() override;
+    virtual void handle_queue_update(u16 queue_index) override;
+
+    struct [[gnu::packed]] VirtIONetHeader {
+        u8 flags;
+        u8 gso_type;
+        u16 header_length;
+        u16 gso_size;
+        u16 checksum_start;
+        u16 checksum_offset;
+        u16 buffer_count;
+    };
+    static_assert(sizeof(VirtIONetHeader) == 12);
+
+    void supply_receive_buffer(size_t slot_index);
+    size_t receive_packets();
+    void reclaim_sent_buffers();
+    void fill_in_header(VirtIONetHeader&, ReadonlyBytes frame) const;
+
+    PhysicalAddress receive_header_address(size_t slot_index) const { return m_receive_headers->physical_page(0)->paddr().offset(slot_index * sizeof(VirtIONetHeader)); }
+    PhysicalAddress transmit_buffer_address(size_t slot_index) const { return m_transmit_buffers->physical_page(0)->paddr().offset(slot_index * transmit_buffer_size); }
+
+    // A sent frame is copied in right behind its header, which both fit into one of these.
+    static constexpr size_t transmit_buffer_size = 2048;
+    static constexpr size_t max_transmit_slots = 512;
+
+    // Received frames go straight into packet buffers that get handed up the stack, with their
+    // headers kept apart, so every receive slot takes two descriptors.
+    OwnPtr<Region> m_receive_headers;
+    Vector<RefPtr<PacketWithTimestamp>> m_receive_buffers;
+
+    // Only sends that find the ring full ask for an interrupt, everything else is reclaimed
+    // the next time we send something.
+    OwnPtr<Region> m_transmit_buffers;
+    Vector<u16> m_free_transmit_slots;
+    WaitQueue m_transmit_wait_queue;
+
+    bool m_has_tcp_checksum_offload { false };
+};
+
+}
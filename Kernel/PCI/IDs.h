@@ -17,6 +17,8 @@ enum class PCIVendorID {
 };
 
 enum class PCIDeviceID {
+    VirtIONetwork = 0x1000,
+    VirtIOBlock = 0x1001,
     VirtIOConsole = 0x1003,
     VirtIOEntropy = 0x1005,
 };
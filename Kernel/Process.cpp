@@ -5,6 +5,7 @@
  */
 
 #include <AK/Demangle.h>
+#include <AK/NumericLimits.h>
 #include <AK/StdLibExtras.h>
 #include <AK/StringBuilder.h>
 #include <AK/Time.h>
@@ -368,12 +369,17 @@ RefPtr<Process> Process::from_pid(ProcessID pid)
     return {};
 }
 
+RefPtr<FileDescription> Process::FileDescriptionAndFlags::description_ref() const
+{
+    return m_description;
+}
+
 RefPtr<FileDescription> Process::file_description(int fd) const
 {
     if (fd < 0)
         return nullptr;
     if (static_cast<size_t>(fd) < m_fds.size())
-        return m_fds[fd].description();
+        return m_fds[fd].description_ref();
     return nullptr;
 }
 
@@ -451,6 +457,28 @@ KResultOr<NonnullOwnPtr<KString>> Process::get_syscall_path_argument(Syscall::St
     return get_syscall_path_argument(path.characters, path.length);
 }
 
+KResult Process::copy_iovecs_from_user(Vector<iovec, 32>& vecs, Userspace<const struct iovec*> iov, int iov_count) const
+{
+    if (iov_count < 0)
+        return EINVAL;
+
+    // Arbitrary pain threshold.
+    if (iov_count > (int)MiB)
+        return EFAULT;
+
+    u64 total_length = 0;
+    if (!vecs.try_resize(iov_count))
+        return ENOMEM;
+    if (!copy_n_from_user(vecs.data(), iov, iov_count))
+        return EFAULT;
+    for (auto& vec : vecs) {
+        total_length += vec.iov_len;
+        if (total_length > NumericLimits<i32>::max())
+            return EINVAL;
+    }
+    return KSuccess;
+}
+
 bool Process::dump_core()
 {
     VERIFY(is_dumpable());
@@ -505,6 +533,8 @@ void Process::finalize()
 
     if (m_alarm_timer)
         TimerQueue::the().cancel_timer(m_alarm_timer.release_nonnull());
+    for (size_t i = 0; i < m_fds.size(); ++i)
+        detach_fd_from_event_polls(i);
     m_fds.clear();
     m_tty = nullptr;
     m_executable = nullptr;
@@ -647,6 +677,12 @@ RefPtr<Thread> Process::create_kernel_thread(void (*entry)(void*), void* entry_d
     return thread;
 }
 
+void Process::detach_fd_from_event_polls(int fd)
+{
+    if (auto* description = m_fds[fd].description())
+        EventPoll::detach_fd({}, pid(), fd, *description);
+}
+
 void Process::FileDescriptionAndFlags::clear()
 {
     m_description = nullptr;
@@ -269,6 +269,9 @@ public:
     KResultOr<int> sys$create_inode_watcher(u32 flags);
     KResultOr<int> sys$inode_watcher_add_watch(Userspace<const Syscall::SC_inode_watcher_add_watch_params*> user_params);
     KResultOr<int> sys$inode_watcher_remove_watch(int fd, int wd);
+    KResultOr<int> sys$epoll_create(int flags);
+    KResultOr<int> sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*>);
+    KResultOr<int> sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*>);
     KResultOr<int> sys$dbgputch(u8);
     KResultOr<size_t> sys$dbgputstr(Userspace<const u8*>, int length);
     KResultOr<int> sys$dump_backtrace();
@@ -294,6 +297,9 @@ public:
     KResultOr<ssize_t> sys$readv(int fd, Userspace<const struct iovec*> iov, int iov_count);
     KResultOr<ssize_t> sys$write(int fd, Userspace<const u8*>, ssize_t);
     KResultOr<ssize_t> sys$writev(int fd, Userspace<const struct iovec*> iov, int iov_count);
+    KResultOr<ssize_t> sys$preadv(Userspace<const Syscall::SC_preadv_params*>);
+    KResultOr<ssize_t> sys$pwritev(Userspace<const Syscall::SC_pwritev_params*>);
+    KResultOr<ssize_t> sys$copy_file_range(Userspace<const Syscall::SC_copy_file_range_params*>);
     KResultOr<int> sys$fstat(int fd, Userspace<stat*>);
     KResultOr<int> sys$stat(Userspace<const Syscall::SC_stat_params*>);
     KResultOr<int> sys$lseek(int fd, Userspace<off_t*>, int whence);
@@ -461,6 +467,7 @@ public:
 
     Lock& big_lock() { return m_big_lock; }
     Lock& ptrace_lock() { return m_ptrace_lock; }
+    Lock& space_lock() { return m_space_lock; }
 
     Custody& root_directory();
     Custody& root_directory_relative_to_global_root();
@@ -536,6 +543,8 @@ private:
     KResultOr<RefPtr<FileDescription>> find_elf_interpreter_for_executable(const String& path, const Elf32_Ehdr& elf_header, int nread, size_t file_size);
 
     int alloc_fd(int first_candidate_fd = 0);
+    // Has to be called before an fd gets closed, since EventPolls keep interests per fd.
+    void detach_fd_from_event_polls(int fd);
 
     KResult do_kill(Process&, int signal);
     KResult do_killpg(ProcessGroupID pgrp, int signal);
@@ -550,6 +559,7 @@ private:
         return get_syscall_path_argument(user_path.unsafe_userspace_ptr(), path_length);
     }
     KResultOr<NonnullOwnPtr<KString>> get_syscall_path_argument(const Syscall::StringArgument&) const;
+    KResult copy_iovecs_from_user(Vector<iovec, 32>&, Userspace<const struct iovec*>, int iov_count) const;
 
     bool has_tracee_thread(ProcessID tracer_pid);
 
@@ -589,6 +599,10 @@ private:
         FileDescription* description() { return m_description; }
         const FileDescription* description() const { return m_description; }
 
+        // Copying the RefPtr takes the reference atomically, so this is safe even while
+        // another thread replaces the description.
+        RefPtr<FileDescription> description_ref() const;
+
         u32 flags() const { return m_flags; }
         void set_flags(u32 flags) { m_flags = flags; }
 
@@ -626,6 +640,10 @@ private:
     Lock m_big_lock { "Process" };
     Lock m_ptrace_lock { "ptrace" };
 
+    // Held by everything that looks up regions and then changes them or relies on them staying put,
+    // since mmap, munmap, mprotect and madvise don't run under the big lock.
+    Lock m_space_lock { "Space" };
+
     RefPtr<Timer> m_alarm_timer;
 
     VeilState m_veil_state { VeilState::None };
@@ -796,6 +814,9 @@ inline ProcessID Thread::pid() const
         }                                          \
     } while (0)
 
+#define VERIFY_NO_PROCESS_BIG_LOCK(process) \
+    VERIFY(!process->big_lock().own_lock())
+
 #define REQUIRE_PROMISE(promise)                                     \
     do {                                                             \
         if (Process::current()->has_promises()                       \
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/NumericLimits.h>
 #include <AK/ScopeGuard.h>
 #include <AK/TemporaryChange.h>
 #include <AK/Time.h>
@@ -51,16 +52,28 @@ READONLY_AFTER_INIT static Process* s_colonel_process;
 struct ThreadReadyQueue {
     IntrusiveList<Thread, RawPtr<Thread>, &Thread::m_ready_queue_node> thread_list;
 };
-static SpinLock<u8> g_ready_queues_lock;
-static u32 g_ready_queues_mask;
-static constexpr u32 g_ready_queue_buckets = sizeof(g_ready_queues_mask) * 8;
-READONLY_AFTER_INIT static ThreadReadyQueue* g_ready_queues; // g_ready_queue_buckets entries
+static constexpr u32 g_ready_queue_buckets = sizeof(u32) * 8;
+
+// Every processor has its own set of ready queues, so that threads tend to stay on the
+// processor whose caches they warmed up, and processors don't all contend on one lock.
+struct ThreadReadyQueues {
+    SpinLock<u8> lock;
+    u32 mask { 0 };
+    Atomic<u32, AK::MemoryOrder::memory_order_relaxed> thread_count { 0 };
+    ThreadReadyQueue queues[g_ready_queue_buckets];
+};
+static constexpr u32 g_ready_queues_count = ProcessorContainer {}.size();
+READONLY_AFTER_INIT static ThreadReadyQueues* g_ready_queues; // g_ready_queues_count entries
 static void dump_thread_list();
 
+// A thread is only moved away from the processor it last ran on if that processor
+// has at least this many more threads waiting than the least busy one.
+static constexpr u32 g_ready_queue_imbalance_threshold = 2;
+
 static inline u32 thread_priority_to_priority_index(u32 thread_priority)
 {
     // Converts the priority in the range of THREAD_PRIORITY_MIN...THREAD_PRIORITY_MAX
-    // to a index into g_ready_queues where 0 is the highest priority bucket
+    // to a index into the ready queues where 0 is the highest priority bucket
     VERIFY(thread_priority >= THREAD_PRIORITY_MIN && thread_priority <= THREAD_PRIORITY_MAX);
     constexpr u32 thread_priority_count = THREAD_PRIORITY_MAX - THREAD_PRIORITY_MIN + 1;
     static_assert(thread_priority_count > 0);
@@ -69,16 +82,25 @@ static inline u32 thread_priority_to_priority_index(u32 thread_priority)
     return priority_bucket;
 }
 
-Thread& Scheduler::pull_next_runnable_thread()
+static inline u32 scheduling_processors_mask()
 {
-    auto affinity_mask = 1u << Processor::current().id();
+#if SCHEDULE_ON_ALL_PROCESSORS
+    auto count = min(Processor::count(), g_ready_queues_count);
+    return count >= 32 ? 0xffffffff : (1u << count) - 1;
+#else
+    return 1;
+#endif
+}
 
-    ScopedSpinLock lock(g_ready_queues_lock);
-    auto priority_mask = g_ready_queues_mask;
+Thread* Scheduler::take_runnable_thread_from(u32 processor, u32 affinity_mask)
+{
+    auto& ready_queues = g_ready_queues[processor];
+    ScopedSpinLock lock(ready_queues.lock);
+    auto priority_mask = ready_queues.mask;
     while (priority_mask != 0) {
         auto priority = __builtin_ffsl(priority_mask);
         VERIFY(priority > 0);
-        auto& ready_queue = g_ready_queues[--priority];
+        auto& ready_queue = ready_queues.queues[--priority];
         for (auto& thread : ready_queue.thread_list) {
             VERIFY(thread.m_runnable_priority == (int)priority);
             if (thread.is_active())
@@ -86,9 +108,11 @@ Thread& Scheduler::pull_next_runnable_thread()
             if (!(thread.affinity() & affinity_mask))
                 continue;
             thread.m_runnable_priority = -1;
+            thread.m_runnable_processor = -1;
             ready_queue.thread_list.remove(thread);
+            ready_queues.thread_count--;
             if (ready_queue.thread_list.is_empty())
-                g_ready_queues_mask &= ~(1u << priority);
+                ready_queues.mask &= ~(1u << priority);
             // Mark it as active because we are using this thread. This is similar
             // to comparing it with Processor::current_thread, but when there are
             // multiple processors there's no easy way to check whether the thread
@@ -100,10 +124,42 @@ Thread& Scheduler::pull_next_runnable_thread()
             // switching to it.
             // FIXME: Figure out a better way maybe?
             thread.set_active(true);
-            return thread;
+            return &thread;
         }
         priority_mask &= ~(1u << priority);
     }
+    return nullptr;
+}
+
+Thread& Scheduler::pull_next_runnable_thread()
+{
+    auto processor_id = Processor::current().id();
+    auto affinity_mask = 1u << processor_id;
+
+    if (auto* thread = take_runnable_thread_from(processor_id, affinity_mask))
+        return *thread;
+
+    // We have nothing to do ourselves, so steal work from the busiest processor that has some.
+    auto other_processors_mask = scheduling_processors_mask() & ~affinity_mask;
+    while (other_processors_mask != 0) {
+        u32 busiest_processor = 0;
+        u32 busiest_thread_count = 0;
+        for (auto mask = other_processors_mask; mask != 0; mask &= mask - 1) {
+            auto id = __builtin_ffsl(mask) - 1;
+            auto thread_count = g_ready_queues[id].thread_count.load();
+            if (thread_count > busiest_thread_count) {
+                busiest_processor = id;
+                busiest_thread_count = thread_count;
+            }
+        }
+        if (busiest_thread_count == 0)
+            break;
+        if (auto* thread = take_runnable_thread_from(busiest_processor, affinity_mask)) {
+            dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Stole {} from processor {}", processor_id, *thread, busiest_processor);
+            return *thread;
+        }
+        other_processors_mask &= ~(1u << busiest_processor);
+    }
     return *Processor::idle_thread();
 }
 
@@ -111,41 +167,85 @@ bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
 {
     if (thread.is_idle_thread())
         return true;
-    ScopedSpinLock lock(g_ready_queues_lock);
-    auto priority = thread.m_runnable_priority;
-    if (priority < 0) {
+    auto processor = thread.m_runnable_processor;
+    if (processor < 0) {
+        VERIFY(thread.m_runnable_priority < 0);
         VERIFY(!thread.m_ready_queue_node.is_in_list());
         return false;
     }
 
+    auto& ready_queues = g_ready_queues[processor];
+    ScopedSpinLock lock(ready_queues.lock);
+    auto priority = thread.m_runnable_priority;
+    VERIFY(priority >= 0);
+    VERIFY(thread.m_runnable_processor == processor);
+
     if (check_affinity && !(thread.affinity() & (1 << Processor::current().id())))
         return false;
 
-    VERIFY(g_ready_queues_mask & (1u << priority));
-    auto& ready_queue = g_ready_queues[priority];
+    VERIFY(ready_queues.mask & (1u << priority));
+    auto& ready_queue = ready_queues.queues[priority];
     thread.m_runnable_priority = -1;
+    thread.m_runnable_processor = -1;
     ready_queue.thread_list.remove(thread);
+    ready_queues.thread_count--;
     if (ready_queue.thread_list.is_empty())
-        g_ready_queues_mask &= ~(1u << priority);
+        ready_queues.mask &= ~(1u << priority);
     return true;
 }
 
+static u32 processor_for_runnable_thread(const Thread& thread)
+{
+    auto allowed_mask = thread.affinity() & scheduling_processors_mask();
+    if (allowed_mask == 0) {
+        // The thread can only run on processors that don't schedule (yet), so just
+        // queue it on the first one it's allowed on and let it pick it up from there.
+        VERIFY(thread.affinity() != 0);
+        return min((u32)__builtin_ffsl(thread.affinity()) - 1, g_ready_queues_count - 1);
+    }
+
+    u32 least_busy_processor = 0;
+    u32 least_busy_thread_count = NumericLimits<u32>::max();
+    for (auto mask = allowed_mask; mask != 0; mask &= mask - 1) {
+        auto id = __builtin_ffsl(mask) - 1;
+        auto thread_count = g_ready_queues[id].thread_count.load();
+        if (thread_count < least_busy_thread_count) {
+            least_busy_processor = id;
+            least_busy_thread_count = thread_count;
+        }
+    }
+
+    // Prefer the processor the thread ran on last, since its caches are still warm,
+    // unless that one is noticeably busier than the others.
+    auto last_processor = thread.cpu();
+    if (last_processor < g_ready_queues_count && (allowed_mask & (1u << last_processor))) {
+        if (g_ready_queues[last_processor].thread_count.load() < least_busy_thread_count + g_ready_queue_imbalance_threshold)
+            return last_processor;
+    }
+    return least_busy_processor;
+}
+
 void Scheduler::queue_runnable_thread(Thread& thread)
 {
     VERIFY(g_scheduler_lock.own_lock());
     if (thread.is_idle_thread())
         return;
     auto priority = thread_priority_to_priority_index(thread.priority());
+    auto processor = processor_for_runnable_thread(thread);
 
-    ScopedSpinLock lock(g_ready_queues_lock);
+    auto& ready_queues = g_ready_queues[processor];
+    ScopedSpinLock lock(ready_queues.lock);
     VERIFY(thread.m_runnable_priority < 0);
+    VERIFY(thread.m_runnable_processor < 0);
     thread.m_runnable_priority = (int)priority;
+    thread.m_runnable_processor = (int)processor;
     VERIFY(!thread.m_ready_queue_node.is_in_list());
-    auto& ready_queue = g_ready_queues[priority];
+    auto& ready_queue = ready_queues.queues[priority];
     bool was_empty = ready_queue.thread_list.is_empty();
     ready_queue.thread_list.append(thread);
+    ready_queues.thread_count++;
     if (was_empty)
-        g_ready_queues_mask |= (1u << priority);
+        ready_queues.mask |= (1u << priority);
 }
 
 UNMAP_AFTER_INIT void Scheduler::start()
@@ -439,7 +539,7 @@ UNMAP_AFTER_INIT void Scheduler::initialize()
 
     RefPtr<Thread> idle_thread;
     g_finalizer_wait_queue = new WaitQueue;
-    g_ready_queues = new ThreadReadyQueue[g_ready_queue_buckets];
+    g_ready_queues = new ThreadReadyQueues[g_ready_queues_count];
 
     g_finalizer_has_work.store(false, AK::MemoryOrder::memory_order_release);
     s_colonel_process = Process::create_kernel_process(idle_thread, "colonel", idle_loop, nullptr, 1).leak_ref();
@@ -554,6 +654,8 @@ void Scheduler::idle_loop(void*)
 void Scheduler::dump_scheduler_state()
 {
     dump_thread_list();
+    for (u32 i = 0; i < min(Processor::count(), g_ready_queues_count); ++i)
+        dmesgln("  Processor {} has {} runnable thread(s) queued", i, g_ready_queues[i].thread_count.load());
 }
 
 void dump_thread_list()
@@ -51,6 +51,9 @@ public:
     static bool dequeue_runnable_thread(Thread&, bool = false);
     static void queue_runnable_thread(Thread&);
     static void dump_scheduler_state();
+
+private:
+    static Thread* take_runnable_thread_from(u32 processor, u32 affinity_mask);
 };
 
 }
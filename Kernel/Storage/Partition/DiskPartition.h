@@ -18,6 +18,8 @@ public:
     virtual ~DiskPartition();
 
     virtual void start_request(AsyncBlockDeviceRequest&) override;
+    virtual size_t max_blocks_per_request() const override { return m_device->max_blocks_per_request(); }
+    virtual size_t max_requests_in_flight() const override { return m_device->max_requests_in_flight(); }
 
     // ^BlockDevice
     virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override;
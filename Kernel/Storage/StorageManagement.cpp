@@ -17,6 +17,7 @@
 #include <Kernel/Storage/Partition/MBRPartitionTable.h>
 #include <Kernel/Storage/RamdiskController.h>
 #include <Kernel/Storage/StorageManagement.h>
+#include <Kernel/Storage/VirtIOBlockController.h>
 
 namespace Kernel {
 
@@ -58,6 +59,8 @@ UNMAP_AFTER_INIT NonnullRefPtrVector<StorageController> StorageManagement::enume
                 controllers.append(AHCIController::initialize(address));
             }
         });
+        if (!kernel_command_line().disable_virtio())
+            controllers.append(VirtIOBlockController::initialize());
     }
     controllers.append(RamdiskController::initialize());
     return controllers;
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/RefPtr.h>
+#include <AK/Types.h>
+#include <Kernel/PCI/IDs.h>
+#include <Kernel/Storage/VirtIOBlockController.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT NonnullRefPtr<VirtIOBlockController> VirtIOBlockController::initialize()
+{
+    return adopt_ref(*new VirtIOBlockController());
+}
+
+bool VirtIOBlockController::reset()
+{
+    TODO();
+}
+
+bool VirtIOBlockController::shutdown()
+{
+    TODO();
+}
+
+size_t VirtIOBlockController::devices_count() const
+{
+    return m_devices.size();
+}
+
+void VirtIOBlockController::start_request(const StorageDevice&, AsyncBlockDeviceRequest&)
+{
+    // Every device talks to its own PCI function, so requests never go through the controller.
+    VERIFY_NOT_REACHED();
+}
+
+void VirtIOBlockController::complete_current_request(AsyncDeviceRequest::RequestResult)
+{
+    VERIFY_NOT_REACHED();
+}
+
+UNMAP_AFTER_INIT VirtIOBlockController::VirtIOBlockController()
+    : StorageController()
+{
+    PCI::enumerate([&](const PCI::Address& address, PCI::ID id) {
+        if (address.is_null() || id.is_null())
+            return;
+        if (id.vendor_id != (u16)PCIVendorID::VirtIO || id.device_id != (u16)PCIDeviceID::VirtIOBlock)
+            return;
+        if (auto device = VirtIOBlockDevice::create(*this, address, m_devices.size()))
+            m_devices.append(device.release_nonnull());
+        else
+            dmesgln("VirtIOBlockController: Failed to initialize device @ {}", address);
+    });
+}
+
+VirtIOBlockController::~VirtIOBlockController()
+{
+}
+
+RefPtr<StorageDevice> VirtIOBlockController::device(u32 index) const
+{
+    if (index >= m_devices.size())
+        return nullptr;
+    return m_devices[index];
+}
+
+}
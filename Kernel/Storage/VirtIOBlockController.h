@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/RefPtr.h>
+#include <AK/Types.h>
+#include <Kernel/Storage/StorageController.h>
+#include <Kernel/Storage/VirtIOBlockDevice.h>
+
+namespace Kernel {
+
+class AsyncBlockDeviceRequest;
+
+class VirtIOBlockController final : public StorageController {
+    AK_MAKE_ETERNAL
+public:
+    static NonnullRefPtr<VirtIOBlockController> initialize();
+    virtual ~VirtIOBlockController() override;
+
+    virtual RefPtr<StorageDevice> device(u32 index) const override;
+    virtual bool reset() override;
+    virtual bool shutdown() override;
+    virtual size_t devices_count() const override;
+    virtual void start_request(const StorageDevice&, AsyncBlockDeviceRequest&) override;
+    virtual void complete_current_request(AsyncDeviceRequest::RequestResult) override;
+
+private:
+    VirtIOBlockController();
+
+    NonnullRefPtrVector<VirtIOBlockDevice> m_devices;
+};
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/Storage/VirtIOBlockController.h>
+#include <Kernel/Storage/VirtIOBlockDevice.h>
+#include <Kernel/WorkQueue.h>
+
+namespace Kernel {
+
+#define REQUESTQ 0
+
+static constexpr size_t sector_size = 512;
+static constexpr size_t max_pages_per_request = 16;
+static constexpr size_t max_request_slots = 32;
+
+RefPtr<VirtIOBlockDevice> VirtIOBlockDevice::create(const VirtIOBlockController& controller, PCI::Address address, size_t index)
+{
+    auto device = adopt_ref(*new VirtIOBlockDevice(controller, address, index));
+    if (!device->initialize())
+        return {};
+    return device;
+}
+
+UNMAP_AFTER_INIT VirtIOBlockDevice::VirtIOBlockDevice(const VirtIOBlockController& controller, PCI::Address address, size_t index)
+    : StorageDevice(controller, 254, index, sector_size, 0)
+    , VirtIODevice(address, "VirtIOBlockDevice")
+    , m_index(index)
+{
+}
+
+VirtIOBlockDevice::~VirtIOBlockDevice()
+{
+}
+
+UNMAP_AFTER_INIT bool VirtIOBlockDevice::initialize()
+{
+    auto* cfg = get_config(ConfigurationType::Device);
+    if (!cfg)
+        return false;
+    bool success = negotiate_features([&](u64 supported_features) {
+        u64 negotiated = 0;
+        if (is_feature_set(supported_features, VIRTIO_BLK_F_SEG_MAX))
+            negotiated |= VIRTIO_BLK_F_SEG_MAX;
+        if (is_feature_set(supported_features, VIRTIO_BLK_F_RO))
+            negotiated |= VIRTIO_BLK_F_RO;
+        return negotiated;
+    });
+    if (!success)
+        return false;
+
+    u32 max_segments = 0;
+    read_config_atomic([&]() {
+        if (is_feature_accepted(VIRTIO_BLK_F_SEG_MAX))
+            max_segments = config_read32(*cfg, 0xc);
+    });
+    read_capacity();
+    m_is_read_only = is_feature_accepted(VIRTIO_BLK_F_RO);
+
+    if (!setup_queues(1))
+        return false;
+    finish_init();
+
+    // A request takes one descriptor for its header, one per data page and one for its status,
+    // so the queue size decides how many requests fit in it at once.
+    auto queue_size = get_queue(REQUESTQ).size();
+    if (queue_size < 3)
+        return false;
+    m_pages_per_request = min(max_pages_per_request, (size_t)queue_size - 2);
+    if (max_segments != 0)
+        m_pages_per_request = min(m_pages_per_request, (size_t)max_segments);
+    size_t slot_count = min(max_request_slots, (size_t)queue_size / (m_pages_per_request + 2));
+
+    m_request_headers = MM.allocate_contiguous_kernel_region(page_round_up(slot_count * sizeof(RequestHeader)), "VirtIOBlockDevice Headers", Region::Access::Read | Region::Access::Write);
+    if (!m_request_headers)
+        return false;
+    for (size_t slot_index = 0; slot_index < slot_count; ++slot_index) {
+        RequestSlot slot;
+        for (size_t page_index = 0; page_index < m_pages_per_request; ++page_index) {
+            auto page = MM.allocate_supervisor_physical_page();
+            if (!page)
+                return false;
+            slot.dma_pages.append(page.release_nonnull());
+        }
+        m_request_slots.append(move(slot));
+    }
+
+    dmesgln("{}: {} @ {}, capacity {} bytes, {} requests of up to {} KiB in flight{}", m_class_name, device_name(), pci_address(),
+        m_max_addressable_block * block_size(), slot_count, m_pages_per_request * PAGE_SIZE / KiB, m_is_read_only ? ", read-only" : "");
+    return true;
+}
+
+void VirtIOBlockDevice::read_capacity()
+{
+    auto* cfg = get_config(ConfigurationType::Device);
+    VERIFY(cfg);
+    u64 capacity = 0;
+    read_config_atomic([&]() {
+        capacity = config_read32(*cfg, 0x0) | ((u64)config_read32(*cfg, 0x4) << 32);
+    });
+    // The capacity is always given in 512-byte sectors.
+    m_max_addressable_block = capacity * sector_size / block_size();
+}
+
+String VirtIOBlockDevice::device_name() const
+{
+    return String::formatted("vd{:c}", 'a' + m_index);
+}
+
+bool VirtIOBlockDevice::handle_device_config_change()
+{
+    // The only thing that can change is the capacity, when the disk gets resized.
+    read_capacity();
+    dbgln("{}: Capacity changed to {} bytes", m_class_name, m_max_addressable_block * block_size());
+    return true;
+}
+
+void VirtIOBlockDevice::start_request(AsyncBlockDeviceRequest& request)
+{
+    bool is_write = request.request_type() == AsyncBlockDeviceRequest::Write;
+    if (is_write && m_is_read_only) {
+        request.complete(AsyncDeviceRequest::Failure);
+        return;
+    }
+    VERIFY(request.block_count() > 0);
+    VERIFY(request.block_count() <= max_blocks_per_request());
+
+    // Device only starts as many requests as we have slots, so there is always one free here.
+    Optional<size_t> free_slot_index;
+    {
+        ScopedSpinLock lock(m_request_slots_lock);
+        for (size_t i = 0; i < m_request_slots.size(); ++i) {
+            if (!m_request_slots[i].request) {
+                m_request_slots[i].request = request;
+                free_slot_index = i;
+                break;
+            }
+        }
+    }
+    VERIFY(free_slot_index.has_value());
+    auto slot_index = free_slot_index.value();
+    auto& slot = m_request_slots[slot_index];
+
+    size_t byte_count = request.block_count() * block_size();
+    size_t page_count = page_round_up(byte_count) / PAGE_SIZE;
+    NonnullRefPtrVector<PhysicalPage> pages;
+    for (size_t i = 0; i < page_count; ++i)
+        pages.append(slot.dma_pages[i]);
+    slot.scatter_list = ScatterGatherList::create(request, move(pages), block_size());
+    if (!slot.scatter_list) {
+        finish_request(slot_index, AsyncDeviceRequest::Failure);
+        return;
+    }
+    if (is_write && !request.read_from_buffer(request.buffer(), slot.scatter_list->dma_region().as_ptr(), byte_count)) {
+        finish_request(slot_index, AsyncDeviceRequest::MemoryFault);
+        return;
+    }
+
+    auto& header = request_header(slot_index);
+    header.type = is_write ? VIRTIO_BLK_T_OUT : VIRTIO_BLK_T_IN;
+    header.reserved = 0;
+    header.sector = request.block_index() * (block_size() / sector_size);
+    header.status = 0xff;
+
+    dbgln_if(VIRTIO_DEBUG, "{}: Starting {} of {} blocks at {} in slot {}", m_class_name, is_write ? "write" : "read", request.block_count(), request.block_index(), slot_index);
+
+    auto& queue = get_queue(REQUESTQ);
+    ScopedSpinLock lock(queue.lock());
+    VirtIOQueueChain chain(queue);
+    auto header_address = request_header_address(slot_index);
+    auto data_buffer_type = is_write ? BufferType::DeviceReadable : BufferType::DeviceWritable;
+    bool did_add_buffers = chain.add_buffer_to_chain(header_address, __builtin_offsetof(RequestHeader, status), BufferType::DeviceReadable);
+    for (size_t i = 0; i < page_count; ++i) {
+        size_t length = min((size_t)PAGE_SIZE, byte_count - i * PAGE_SIZE);
+        did_add_buffers &= chain.add_buffer_to_chain(slot.dma_pages[i].paddr(), length, data_buffer_type);
+    }
+    did_add_buffers &= chain.add_buffer_to_chain(header_address.offset(__builtin_offsetof(RequestHeader, status)), 1, BufferType::DeviceWritable);
+    // The queue has room for the chains of all slots, so this can't run out of descriptors.
+    VERIFY(did_add_buffers);
+    supply_chain_and_notify(REQUESTQ, chain);
+}
+
+void VirtIOBlockDevice::handle_queue_update(u16 queue_index)
+{
+    VERIFY(queue_index == REQUESTQ);
+    auto& queue = get_queue(REQUESTQ);
+    auto headers_start = request_header_address(0);
+    bool did_finish_requests = false;
+    {
+        ScopedSpinLock lock(queue.lock());
+        ScopedSpinLock slots_lock(m_request_slots_lock);
+        for (;;) {
+            size_t used;
+            auto chain = queue.pop_used_buffer_chain(used);
+            if (chain.is_empty())
+                break;
+            Optional<size_t> slot_index;
+            chain.for_each([&](PhysicalAddress address, size_t) {
+                // The first buffer of every chain is the header of its slot.
+                if (!slot_index.has_value())
+                    slot_index = (address.get() - headers_start.get()) / sizeof(RequestHeader);
+            });
+            chain.release_buffer_slots_to_queue();
+            VERIFY(slot_index.has_value() && slot_index.value() < m_request_slots.size());
+            m_request_slots[slot_index.value()].is_finished = true;
+            did_finish_requests = true;
+        }
+    }
+    if (!did_finish_requests)
+        return;
+
+    // Copying the data to the request buffers could trigger page faults, which
+    // we can't handle in the irq handler.
+    g_io_work->queue([this]() {
+        complete_finished_requests();
+    });
+}
+
+void VirtIOBlockDevice::complete_finished_requests()
+{
+    for (size_t slot_index = 0; slot_index < m_request_slots.size(); ++slot_index) {
+        {
+            ScopedSpinLock lock(m_request_slots_lock);
+            if (!m_request_slots[slot_index].is_finished)
+                continue;
+            m_request_slots[slot_index].is_finished = false;
+        }
+        auto& slot = m_request_slots[slot_index];
+        auto& request = *slot.request;
+        auto status = request_header(slot_index).status;
+        if (status != VIRTIO_BLK_S_OK) {
+            dbgln("{}: Request for {} blocks at {} failed with status {}", m_class_name, request.block_count(), request.block_index(), status);
+            finish_request(slot_index, AsyncDeviceRequest::Failure);
+            continue;
+        }
+        if (request.request_type() == AsyncBlockDeviceRequest::Read) {
+            if (!request.write_to_buffer(request.buffer(), slot.scatter_list->dma_region().as_ptr(), request.block_count() * block_size())) {
+                finish_request(slot_index, AsyncDeviceRequest::MemoryFault);
+                continue;
+            }
+        }
+        finish_request(slot_index, AsyncDeviceRequest::Success);
+    }
+}
+
+void VirtIOBlockDevice::finish_request(size_t slot_index, AsyncDeviceRequest::RequestResult result)
+{
+    auto& slot = m_request_slots[slot_index];
+    auto scatter_list = move(slot.scatter_list);
+    RefPtr<AsyncBlockDeviceRequest> request;
+    {
+        ScopedSpinLock lock(m_request_slots_lock);
+        request = move(slot.request);
+    }
+    // Completing the request may start the next one right away, which is why its slot has to be free by now.
+    request->complete(result);
+}
+
+}
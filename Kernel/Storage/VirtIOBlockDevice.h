@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Vector.h>
+#include <Kernel/Storage/StorageDevice.h>
+#include <Kernel/VM/ScatterGatherList.h>
+#include <Kernel/VirtIO/VirtIO.h>
+
+namespace Kernel {
+
+#define VIRTIO_BLK_F_SEG_MAX (1 << 2)
+#define VIRTIO_BLK_F_RO (1 << 5)
+
+#define VIRTIO_BLK_T_IN 0
+#define VIRTIO_BLK_T_OUT 1
+
+#define VIRTIO_BLK_S_OK 0
+
+class VirtIOBlockController;
+
+class VirtIOBlockDevice final : public StorageDevice
+    , public VirtIODevice {
+public:
+    static RefPtr<VirtIOBlockDevice> create(const VirtIOBlockController&, PCI::Address, size_t index);
+    virtual ~VirtIOBlockDevice() override;
+
+    // ^StorageDevice
+    virtual u64 max_addressable_block() const override { return m_max_addressable_block; }
+
+    // ^BlockDevice
+    virtual void start_request(AsyncBlockDeviceRequest&) override;
+    virtual size_t max_blocks_per_request() const override { return m_pages_per_request * PAGE_SIZE / block_size(); }
+
+    // ^Device
+    virtual size_t max_requests_in_flight() const override { return m_request_slots.size(); }
+    virtual String device_name() const override;
+
+private:
+    VirtIOBlockDevice(const VirtIOBlockController&, PCI::Address, size_t index);
+
+    // ^DiskDevice
+    virtual const char* class_name() const override { return m_class_name.characters(); }
+
+    // ^VirtIODevice
+    virtual bool handle_device_config_change() override;
+    virtual void handle_queue_update(u16 queue_index) override;
+
+    bool initialize();
+    void read_capacity();
+    void complete_finished_requests();
+    void finish_request(size_t slot_index, AsyncDeviceRequest::RequestResult);
+
+    struct [[gnu::packed]] RequestHeader {
+        u32 type;
+        u32 reserved;
+        u64 sector;
+        // The status byte is written by the device, so it goes into a descriptor of its own.
+        u8 status;
+        u8 padding[15];
+    };
+    static_assert(sizeof(RequestHeader) == 32);
+
+    // Every request in flight gets a slot with its own header and DMA pages, so requests
+    // never have to wait for each other, only for a free slot.
+    struct RequestSlot {
+        RefPtr<AsyncBlockDeviceRequest> request;
+        RefPtr<ScatterGatherList> scatter_list;
+        NonnullRefPtrVector<PhysicalPage> dma_pages;
+        bool is_finished { false };
+    };
+
+    RequestHeader& request_header(size_t slot_index) { return reinterpret_cast<RequestHeader*>(m_request_headers->vaddr().as_ptr())[slot_index]; }
+    PhysicalAddress request_header_address(size_t slot_index) const { return m_request_headers->physical_page(0)->paddr().offset(slot_index * sizeof(RequestHeader)); }
+
+    const size_t m_index;
+    u64 m_max_addressable_block { 0 };
+    size_t m_pages_per_request { 0 };
+    bool m_is_read_only { false };
+
+    OwnPtr<Region> m_request_headers;
+    Vector<RequestSlot> m_request_slots;
+    SpinLock<u8> m_request_slots_lock;
+};
+
+}
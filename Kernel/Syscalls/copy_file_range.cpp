@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+static constexpr size_t max_copy_chunk_size = 64 * KiB;
+
+KResultOr<ssize_t> Process::sys$copy_file_range(Userspace<const Syscall::SC_copy_file_range_params*> user_params)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_copy_file_range_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+    if (params.flags != 0)
+        return EINVAL;
+    if (params.length == 0)
+        return 0;
+
+    auto input = file_description(params.fd_in);
+    if (!input)
+        return EBADF;
+    if (!input->is_readable())
+        return EBADF;
+    if (input->is_directory())
+        return EISDIR;
+    // The input has to be seekable, so that data the output didn't take can be read again later.
+    if (!input->file().is_seekable())
+        return EINVAL;
+
+    auto output = file_description(params.fd_out);
+    if (!output)
+        return EBADF;
+    if (!output->is_writable())
+        return EBADF;
+    if (params.offset_out && !output->file().is_seekable())
+        return ESPIPE;
+    // Like on Linux, an output offset can't be combined with O_APPEND.
+    if (params.offset_out && output->should_append())
+        return EBADF;
+    // The input offset is moved along while the output is written to, which can't work out
+    // if the output is going to move that same offset to the end of the file first.
+    if (!params.offset_in && !params.offset_out && input == output && output->should_append())
+        return EINVAL;
+
+    Userspace<i64*> user_offset_in((FlatPtr)params.offset_in);
+    Userspace<i64*> user_offset_out((FlatPtr)params.offset_out);
+
+    i64 offset_in = 0;
+    if (user_offset_in && !copy_from_user(&offset_in, user_offset_in))
+        return EFAULT;
+    i64 offset_out = 0;
+    if (user_offset_out && !copy_from_user(&offset_out, user_offset_out))
+        return EFAULT;
+    if (offset_in < 0 || offset_out < 0)
+        return EINVAL;
+
+    size_t length = min(params.length, (size_t)NumericLimits<i32>::max());
+    auto chunk = KBuffer::try_create_with_size(min(length, max_copy_chunk_size), Region::Access::Read | Region::Access::Write, "copy_file_range", AllocationStrategy::AllocateNow);
+    if (!chunk)
+        return ENOMEM;
+
+    auto write_chunk = [&](const UserOrKernelBuffer& buffer, size_t size, size_t position) -> KResultOr<ssize_t> {
+        if (!user_offset_out)
+            return do_write(*output, buffer, size);
+        auto result = output->write(offset_out + position, buffer, size);
+        if (result.is_error())
+            return result.error();
+        return (ssize_t)result.value();
+    };
+
+    auto copy_from_offset = [&](i64 offset) -> KResultOr<size_t> {
+        // Copying between overlapping ranges of the same file isn't allowed.
+        auto* inode = input->inode();
+        if (inode && inode == output->inode()) {
+            i64 input_size = inode->size();
+            i64 input_end = min(offset + (i64)length, max(offset, input_size));
+            i64 output_start = user_offset_out ? offset_out : (output->should_append() ? input_size : (i64)output->offset());
+            if (offset < output_start + (input_end - offset) && output_start < input_end)
+                return EINVAL;
+        }
+
+        size_t ncopied = 0;
+        KResult error = KSuccess;
+        while (ncopied < length) {
+            auto chunk_buffer = UserOrKernelBuffer::for_kernel_buffer(chunk->data());
+            auto nread_or_error = input->read(chunk_buffer, offset + ncopied, min(length - ncopied, chunk->size()));
+            if (nread_or_error.is_error()) {
+                error = nread_or_error.error();
+                break;
+            }
+            auto nread = nread_or_error.value();
+            if (nread == 0)
+                break;
+
+            auto nwritten_or_error = write_chunk(chunk_buffer, nread, ncopied);
+            if (nwritten_or_error.is_error()) {
+                error = nwritten_or_error.error();
+                break;
+            }
+            ncopied += nwritten_or_error.value();
+            // A short write means the output can't take any more right now.
+            if ((size_t)nwritten_or_error.value() < nread)
+                break;
+        }
+
+        if (ncopied == 0 && error.is_error())
+            return error;
+        return ncopied;
+    };
+
+    // Without an input offset, the description's own one is used and moved along by what was copied,
+    // under the same lock read() takes, so nobody else can read the same data in the meantime.
+    auto ncopied_or_error = user_offset_in ? copy_from_offset(offset_in) : input->consume_at_current_offset(copy_from_offset);
+    if (ncopied_or_error.is_error())
+        return ncopied_or_error.error();
+    auto ncopied = ncopied_or_error.value();
+
+    if (user_offset_in) {
+        i64 new_offset_in = offset_in + ncopied;
+        if (!copy_to_user(user_offset_in, &new_offset_in))
+            return EFAULT;
+    }
+
+    if (user_offset_out) {
+        i64 new_offset_out = offset_out + ncopied;
+        if (!copy_to_user(user_offset_out, &new_offset_out))
+            return EFAULT;
+    }
+
+    return ncopied;
+}
+
+}
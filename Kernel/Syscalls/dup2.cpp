@@ -19,6 +19,7 @@ KResultOr<int> Process::sys$dup2(int old_fd, int new_fd)
         return new_fd;
     if (new_fd < 0 || new_fd >= m_max_open_file_descriptors)
         return EINVAL;
+    detach_fd_from_event_polls(new_fd);
     m_fds[new_fd].set(*description);
     return new_fd;
 }
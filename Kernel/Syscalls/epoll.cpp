@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Time.h>
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+// Bounds the kernel buffer for one sys$epoll_wait(). Anything beyond this stays
+// on the ready list for the next call.
+static constexpr int max_events_per_wait = 1024;
+
+KResultOr<int> Process::sys$epoll_create(int flags)
+{
+    REQUIRE_PROMISE(stdio);
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    int fd = alloc_fd();
+    if (fd < 0)
+        return fd;
+
+    auto event_poll_or_error = EventPoll::create();
+    if (event_poll_or_error.is_error())
+        return event_poll_or_error.error();
+
+    auto description_or_error = FileDescription::create(*event_poll_or_error.value());
+    if (description_or_error.is_error())
+        return description_or_error.error();
+
+    m_fds[fd].set(description_or_error.release_value());
+    m_fds[fd].description()->set_readable(true);
+    if (flags & EPOLL_CLOEXEC)
+        m_fds[fd].set_flags(FD_CLOEXEC);
+    return fd;
+}
+
+KResultOr<int> Process::sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_epoll_ctl_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    auto event_poll_description = file_description(params.epfd);
+    if (!event_poll_description)
+        return EBADF;
+    auto description = file_description(params.fd);
+    if (!description)
+        return EBADF;
+    if (!event_poll_description->is_event_poll())
+        return EINVAL;
+    if (event_poll_description == description)
+        return EINVAL;
+    auto& event_poll = *event_poll_description->event_poll();
+
+    epoll_event event {};
+    if (params.op != EPOLL_CTL_DEL && !copy_from_user(&event, params.event))
+        return EFAULT;
+
+    switch (params.op) {
+    case EPOLL_CTL_ADD:
+        return event_poll.add_interest(pid(), params.fd, *description, event);
+    case EPOLL_CTL_MOD:
+        return event_poll.modify_interest(params.fd, *description, event);
+    case EPOLL_CTL_DEL:
+        return event_poll.remove_interest(params.fd, *description);
+    default:
+        return EINVAL;
+    }
+}
+
+KResultOr<int> Process::sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*> user_params)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_epoll_wait_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+    if (params.max_events <= 0)
+        return EINVAL;
+
+    auto description = file_description(params.epfd);
+    if (!description)
+        return EBADF;
+    if (!description->is_event_poll())
+        return EINVAL;
+    auto& event_poll = *description->event_poll();
+
+    // NOTE: The deadline is absolute from here on, so waking up for nothing doesn't extend it.
+    Thread::BlockTimeout timeout;
+    if (params.timeout) {
+        Optional<Time> timeout_time = copy_time_from_user(params.timeout);
+        if (!timeout_time.has_value())
+            return EFAULT;
+        timeout = Thread::BlockTimeout(false, &timeout_time.value());
+    }
+
+    Vector<epoll_event, 32> events;
+    if (!events.try_resize(min(params.max_events, max_events_per_wait)))
+        return ENOMEM;
+
+    size_t count = 0;
+    for (;;) {
+        count = event_poll.collect_ready_events(events.span());
+        if (count > 0 || !timeout.should_block())
+            break;
+
+        auto unblock_flags = BlockFlags::None;
+        auto result = Thread::current()->block<Thread::ReadBlocker>(timeout, *description, unblock_flags);
+        if (result.was_interrupted())
+            return EINTR;
+        if (result == Thread::BlockResult::InterruptedByTimeout) {
+            count = event_poll.collect_ready_events(events.span());
+            break;
+        }
+    }
+
+    if (count > 0 && !copy_to_user(params.events, events.data(), count * sizeof(epoll_event)))
+        return EFAULT;
+    return count;
+}
+
+}
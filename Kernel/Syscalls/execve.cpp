@@ -564,8 +564,10 @@ KResult Process::do_exec(NonnullRefPtr<FileDescription> main_program_description
 
     for (size_t i = 0; i < m_fds.size(); ++i) {
         auto& description_and_flags = m_fds[i];
-        if (description_and_flags.description() && description_and_flags.flags() & FD_CLOEXEC)
+        if (description_and_flags.description() && description_and_flags.flags() & FD_CLOEXEC) {
+            detach_fd_from_event_polls(i);
             description_and_flags = {};
+        }
     }
 
     int main_program_fd = -1;
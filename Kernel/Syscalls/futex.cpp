@@ -84,6 +84,7 @@ void Process::clear_futex_queues_on_exec()
 
 KResultOr<int> Process::sys$futex(Userspace<const Syscall::SC_futex_params*> user_params)
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     Syscall::SC_futex_params params;
     if (!copy_from_user(&params, user_params))
         return EFAULT;
@@ -128,6 +129,7 @@ KResultOr<int> Process::sys$futex(Userspace<const Syscall::SC_futex_params*> use
     // acquiring the queue lock
     RefPtr<VMObject> vmobject, vmobject2;
     if (!is_private) {
+        Locker locker(space_lock());
         auto region = space().find_region_containing(Range { VirtualAddress { user_address_or_offset }, sizeof(u32) });
         if (!region)
             return EFAULT;
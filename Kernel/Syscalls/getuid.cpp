@@ -10,24 +10,28 @@ namespace Kernel {
 
 KResultOr<uid_t> Process::sys$getuid()
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
     return uid();
 }
 
 KResultOr<gid_t> Process::sys$getgid()
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
     return gid();
 }
 
 KResultOr<uid_t> Process::sys$geteuid()
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
     return euid();
 }
 
 KResultOr<gid_t> Process::sys$getegid()
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
     return egid();
 }
@@ -11,6 +11,7 @@ namespace Kernel {
 
 KResultOr<int> Process::sys$lseek(int fd, Userspace<off_t*> userspace_offset, int whence)
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
     auto description = file_description(fd);
     if (!description)
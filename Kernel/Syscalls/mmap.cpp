@@ -125,6 +125,7 @@ static bool validate_inode_mmap_prot(const Process& process, int prot, const Ino
 
 KResultOr<FlatPtr> Process::sys$mmap(Userspace<const Syscall::SC_mmap_params*> user_params)
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
 
     Syscall::SC_mmap_params params;
@@ -178,6 +179,7 @@ KResultOr<FlatPtr> Process::sys$mmap(Userspace<const Syscall::SC_mmap_params*> u
     bool map_fixed = flags & MAP_FIXED;
     bool map_noreserve = flags & MAP_NORESERVE;
     bool map_randomized = flags & MAP_RANDOMIZED;
+    bool map_large_pages = flags & MAP_LARGE_PAGES;
 
     if (map_shared && map_private)
         return EINVAL;
@@ -194,6 +196,15 @@ KResultOr<FlatPtr> Process::sys$mmap(Userspace<const Syscall::SC_mmap_params*> u
     if (map_stack && (!map_private || !map_anonymous))
         return EINVAL;
 
+    if (map_large_pages && (!map_anonymous || map_noreserve))
+        return EINVAL;
+
+    // Anonymous memory that is large page aligned gets large pages where possible, either right
+    // away with MAP_LARGE_PAGES or when untouched 2 MiB of it are first accessed.
+    if (map_anonymous && size >= LARGE_PAGE_SIZE && !addr)
+        alignment = max(alignment, (size_t)LARGE_PAGE_SIZE);
+
+    Locker locker(space_lock());
     Region* region = nullptr;
     Optional<Range> range;
 
@@ -214,6 +225,8 @@ KResultOr<FlatPtr> Process::sys$mmap(Userspace<const Syscall::SC_mmap_params*> u
 
     if (map_anonymous) {
         auto strategy = map_noreserve ? AllocationStrategy::None : AllocationStrategy::Reserve;
+        if (map_large_pages)
+            strategy = AllocationStrategy::AllocateNow;
         auto region_or_error = space().allocate_region(range.value(), {}, prot, strategy);
         if (region_or_error.is_error())
             return region_or_error.error().error();
@@ -280,6 +293,7 @@ static KResultOr<Range> expand_range_to_page_boundaries(FlatPtr address, size_t
 
 KResultOr<int> Process::sys$mprotect(Userspace<void*> addr, size_t size, int prot)
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
 
     if (prot & PROT_EXEC) {
@@ -297,6 +311,8 @@ KResultOr<int> Process::sys$mprotect(Userspace<void*> addr, size_t size, int pro
     if (!is_user_range(range_to_mprotect))
         return EFAULT;
 
+    Locker locker(space_lock());
+
     if (auto* whole_region = space().find_region_from_range(range_to_mprotect)) {
         if (!whole_region->is_mmap())
             return EPERM;
@@ -422,6 +438,7 @@ KResultOr<int> Process::sys$mprotect(Userspace<void*> addr, size_t size, int pro
 
 KResultOr<int> Process::sys$madvise(Userspace<void*> address, size_t size, int advice)
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
 
     auto range_or_error = expand_range_to_page_boundaries(address, size);
@@ -436,6 +453,7 @@ KResultOr<int> Process::sys$madvise(Userspace<void*> address, size_t size, int a
     if (!is_user_range(range_to_madvise))
         return EFAULT;
 
+    Locker locker(space_lock());
     auto* region = space().find_region_from_range(range_to_madvise);
     if (!region)
         return EINVAL;
@@ -491,6 +509,7 @@ KResultOr<int> Process::sys$set_mmap_name(Userspace<const Syscall::SC_set_mmap_n
 
     auto range = range_or_error.value();
 
+    Locker locker(space_lock());
     auto* region = space().find_region_from_range(range);
     if (!region)
         return EINVAL;
@@ -505,8 +524,10 @@ KResultOr<int> Process::sys$set_mmap_name(Userspace<const Syscall::SC_set_mmap_n
 
 KResultOr<int> Process::sys$munmap(Userspace<void*> addr, size_t size)
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
 
+    Locker locker(space_lock());
     auto result = space().unmap_mmap_range(VirtualAddress { addr }, size);
     if (result.is_error())
         return result;
@@ -527,6 +548,7 @@ KResultOr<FlatPtr> Process::sys$mremap(Userspace<const Syscall::SC_mremap_params
 
     auto old_range = range_or_error.value();
 
+    Locker locker(space_lock());
     auto* old_region = space().find_region_from_range(old_range);
     if (!old_region)
         return EINVAL;
@@ -570,6 +592,8 @@ KResultOr<FlatPtr> Process::sys$allocate_tls(Userspace<const char*> initial_data
     if (!size || size % PAGE_SIZE != 0)
         return EINVAL;
 
+    Locker locker(space_lock());
+
     if (!m_master_tls_region.is_null())
         return EEXIST;
 
@@ -615,6 +639,8 @@ KResultOr<FlatPtr> Process::sys$allocate_tls(Userspace<const char*> initial_data
 
 KResultOr<int> Process::sys$msyscall(Userspace<void*> address)
 {
+    Locker locker(space_lock());
+
     if (space().enforces_syscall_regions())
         return EPERM;
 
@@ -83,6 +83,7 @@ KResultOr<int> Process::sys$close(int fd)
     if (!description)
         return EBADF;
     int rc = description->close();
+    detach_fd_from_event_polls(fd);
     m_fds[fd] = {};
     return rc;
 }
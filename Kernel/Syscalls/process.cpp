@@ -11,6 +11,7 @@ namespace Kernel {
 
 KResultOr<pid_t> Process::sys$getpid()
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
     return pid().value();
 }
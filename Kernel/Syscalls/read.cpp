@@ -14,25 +14,11 @@ using BlockFlags = Thread::FileBlocker::BlockFlags;
 
 KResultOr<ssize_t> Process::sys$readv(int fd, Userspace<const struct iovec*> iov, int iov_count)
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
-    if (iov_count < 0)
-        return EINVAL;
-
-    // Arbitrary pain threshold.
-    if (iov_count > (int)MiB)
-        return EFAULT;
-
-    u64 total_length = 0;
     Vector<iovec, 32> vecs;
-    if (!vecs.try_resize(iov_count))
-        return ENOMEM;
-    if (!copy_n_from_user(vecs.data(), iov, iov_count))
-        return EFAULT;
-    for (auto& vec : vecs) {
-        total_length += vec.iov_len;
-        if (total_length > NumericLimits<i32>::max())
-            return EINVAL;
-    }
+    if (auto result = copy_iovecs_from_user(vecs, iov, iov_count); result.is_error())
+        return result;
 
     auto description = file_description(fd);
     if (!description)
@@ -68,8 +54,55 @@ KResultOr<ssize_t> Process::sys$readv(int fd, Userspace<const struct iovec*> iov
     return nread;
 }
 
+KResultOr<ssize_t> Process::sys$preadv(Userspace<const Syscall::SC_preadv_params*> user_params)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_preadv_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+    if (params.offset < 0)
+        return EINVAL;
+
+    Vector<iovec, 32> vecs;
+    if (auto result = copy_iovecs_from_user(vecs, Userspace<const struct iovec*>((FlatPtr)params.iov), params.iov_count); result.is_error())
+        return result;
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return EBADF;
+    if (!description->is_readable())
+        return EBADF;
+    if (description->is_directory())
+        return EISDIR;
+    if (!description->file().is_seekable())
+        return ESPIPE;
+
+    // Seekable files never block for reading, so unlike sys$readv() there's no ReadBlocker here.
+    u64 offset = params.offset;
+    size_t nread = 0;
+    for (auto& vec : vecs) {
+        auto buffer = UserOrKernelBuffer::for_user_buffer((u8*)vec.iov_base, vec.iov_len);
+        if (!buffer.has_value())
+            return EFAULT;
+        auto result = description->read(buffer.value(), offset + nread, vec.iov_len);
+        if (result.is_error()) {
+            if (nread == 0)
+                return result.error();
+            break;
+        }
+        nread += result.value();
+        // A short read means we've reached the end of the file.
+        if (result.value() < vec.iov_len)
+            break;
+    }
+
+    return nread;
+}
+
 KResultOr<ssize_t> Process::sys$read(int fd, Userspace<u8*> buffer, ssize_t size)
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
     if (size < 0)
         return EINVAL;
@@ -10,6 +10,7 @@ namespace Kernel {
 
 KResultOr<int> Process::sys$yield()
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
     Thread::current()->yield_without_holding_big_lock();
     return 0;
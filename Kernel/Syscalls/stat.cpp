@@ -14,6 +14,7 @@ namespace Kernel {
 
 KResultOr<int> Process::sys$fstat(int fd, Userspace<stat*> user_statbuf)
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
     auto description = file_description(fd);
     if (!description)
@@ -92,6 +92,7 @@ void Process::sys$exit_thread(Userspace<void*> exit_value, Userspace<void*> stac
     PerformanceManager::add_thread_exit_event(*current_thread);
 
     if (stack_location) {
+        Locker locker(space_lock());
         auto unmap_result = space().unmap_mmap_range(VirtualAddress { stack_location }, stack_size);
         if (unmap_result.is_error())
             dbgln("Failed to unmap thread stack, terminating thread anyway. Error code: {}", unmap_result.error());
@@ -189,6 +190,7 @@ KResultOr<int> Process::sys$get_thread_name(pid_t tid, Userspace<char*> buffer,
 
 KResultOr<int> Process::sys$gettid()
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
     return Thread::current()->tid().value();
 }
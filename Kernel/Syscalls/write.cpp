@@ -4,7 +4,6 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/NumericLimits.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/Process.h>
@@ -13,25 +12,11 @@ namespace Kernel {
 
 KResultOr<ssize_t> Process::sys$writev(int fd, Userspace<const struct iovec*> iov, int iov_count)
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
-    if (iov_count < 0)
-        return EINVAL;
-
-    // Arbitrary pain threshold.
-    if (iov_count > (int)MiB)
-        return EFAULT;
-
-    u64 total_length = 0;
     Vector<iovec, 32> vecs;
-    if (!vecs.try_resize(iov_count))
-        return ENOMEM;
-    if (!copy_n_from_user(vecs.data(), iov, iov_count))
-        return EFAULT;
-    for (auto& vec : vecs) {
-        total_length += vec.iov_len;
-        if (total_length > NumericLimits<i32>::max())
-            return EINVAL;
-    }
+    if (auto result = copy_iovecs_from_user(vecs, iov, iov_count); result.is_error())
+        return result;
 
     auto description = file_description(fd);
     if (!description)
@@ -57,6 +42,49 @@ KResultOr<ssize_t> Process::sys$writev(int fd, Userspace<const struct iovec*> io
     return nwritten;
 }
 
+KResultOr<ssize_t> Process::sys$pwritev(Userspace<const Syscall::SC_pwritev_params*> user_params)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_pwritev_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+    if (params.offset < 0)
+        return EINVAL;
+
+    Vector<iovec, 32> vecs;
+    if (auto result = copy_iovecs_from_user(vecs, Userspace<const struct iovec*>((FlatPtr)params.iov), params.iov_count); result.is_error())
+        return result;
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return EBADF;
+    if (!description->is_writable())
+        return EBADF;
+    if (!description->file().is_seekable())
+        return ESPIPE;
+
+    // NOTE: Like on Linux, O_APPEND is ignored here and the data goes where it was asked to.
+    u64 offset = params.offset;
+    size_t nwritten = 0;
+    for (auto& vec : vecs) {
+        auto buffer = UserOrKernelBuffer::for_user_buffer((u8*)vec.iov_base, vec.iov_len);
+        if (!buffer.has_value())
+            return EFAULT;
+        auto result = description->write(offset + nwritten, buffer.value(), vec.iov_len);
+        if (result.is_error()) {
+            if (nwritten == 0)
+                return result.error();
+            break;
+        }
+        nwritten += result.value();
+        if (result.value() < vec.iov_len)
+            break;
+    }
+
+    return nwritten;
+}
+
 KResultOr<ssize_t> Process::do_write(FileDescription& description, const UserOrKernelBuffer& data, size_t data_size)
 {
     ssize_t total_nwritten = 0;
@@ -98,6 +126,7 @@ KResultOr<ssize_t> Process::do_write(FileDescription& description, const UserOrK
 
 KResultOr<ssize_t> Process::sys$write(int fd, Userspace<const u8*> data, ssize_t size)
 {
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
     REQUIRE_PROMISE(stdio);
     if (size < 0)
         return EINVAL;
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Process.h>
+#include <Kernel/Scheduler.h>
+#include <Kernel/Tasks/PageZeroingTask.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+static void page_zeroing_task(void*)
+{
+    // Zeroing pages ahead of time only pays off if it doesn't get in anyone's way.
+    Thread::current()->set_priority(THREAD_PRIORITY_MIN);
+    for (;;) {
+        if (MM.refill_zeroed_page_pool())
+            Scheduler::yield();
+        else
+            MM.wait_until_zeroed_page_pool_needs_refill();
+    }
+}
+
+UNMAP_AFTER_INIT void PageZeroingTask::spawn()
+{
+    RefPtr<Thread> page_zeroing_thread;
+    auto page_zeroing_process = Process::create_kernel_process(page_zeroing_thread, "PageZeroingTask", page_zeroing_task, nullptr);
+    VERIFY(page_zeroing_process);
+}
+
+}
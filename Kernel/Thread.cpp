@@ -277,6 +277,7 @@ void Thread::exit(void* exit_value)
     u32 unlock_count;
     [[maybe_unused]] auto rc = unlock_process_if_locked(unlock_count);
     if (m_thread_specific_range.has_value()) {
+        Locker locker(process().space_lock());
         auto* region = process().space().find_region_from_range(m_thread_specific_range.value());
         VERIFY(region);
         if (!process().space().deallocate_region(*region))
@@ -1029,6 +1030,7 @@ KResult Thread::make_thread_specific_region(Badge<Process>)
     if (!process().m_master_tls_region)
         return KSuccess;
 
+    Locker locker(process().space_lock());
     auto range = process().space().allocate_range({}, thread_specific_region_size());
     if (!range.has_value())
         return ENOMEM;
@@ -460,11 +460,12 @@ public:
 
     class QueueBlocker : public Blocker {
     public:
-        explicit QueueBlocker(WaitQueue&, const char* block_reason = nullptr);
+        explicit QueueBlocker(WaitQueue&, const char* block_reason = nullptr, bool interruptible = true);
         virtual ~QueueBlocker();
 
         virtual Type blocker_type() const override { return Type::Queue; }
         virtual const char* state_string() const override { return m_block_reason ? m_block_reason : "Queue"; }
+        virtual bool can_be_interrupted() const override { return m_interruptible; }
         virtual void not_blocking(bool) override { }
 
         virtual bool should_block() override
@@ -476,6 +477,7 @@ public:
 
     protected:
         const char* const m_block_reason;
+        const bool m_interruptible;
         bool m_should_block { true };
         bool m_did_unblock { false };
     };
@@ -1139,6 +1141,7 @@ private:
 
     IntrusiveListNode<Thread> m_process_thread_list_node;
     int m_runnable_priority { -1 };
+    int m_runnable_processor { -1 };
 
     friend class WaitQueue;
 
@@ -118,8 +118,9 @@ bool Thread::JoinBlocker::unblock(void* value, bool from_add_blocker)
     return true;
 }
 
-Thread::QueueBlocker::QueueBlocker(WaitQueue& wait_queue, const char* block_reason)
+Thread::QueueBlocker::QueueBlocker(WaitQueue& wait_queue, const char* block_reason, bool interruptible)
     : m_block_reason(block_reason)
+    , m_interruptible(interruptible)
 {
     if (!set_block_condition(wait_queue, Thread::current()))
         m_should_block = false;
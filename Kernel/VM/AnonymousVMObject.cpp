@@ -90,9 +90,23 @@ AnonymousVMObject::AnonymousVMObject(size_t size, AllocationStrategy strategy)
     , m_unused_committed_pages(strategy == AllocationStrategy::Reserve ? page_count() : 0)
 {
     if (strategy == AllocationStrategy::AllocateNow) {
-        // Allocate all pages right now. We know we can get all because we committed the amount needed
-        for (size_t i = 0; i < page_count(); ++i)
-            physical_pages()[i] = MM.allocate_committed_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+        // Allocate all pages right now. We know we can get all because we committed the amount needed.
+        // Whole large pages are taken physically contiguous while that's possible, so that regions
+        // mapping this object can use large pages.
+        bool try_large_pages = true;
+        size_t i = 0;
+        while (i < page_count()) {
+            if (try_large_pages && i + PAGES_PER_LARGE_PAGE <= page_count()) {
+                auto large_page = MM.allocate_committed_user_physical_large_page(MemoryManager::ShouldZeroFill::Yes);
+                if (!large_page.is_empty()) {
+                    for (auto& page : large_page)
+                        physical_pages()[i++] = page;
+                    continue;
+                }
+                try_large_pages = false;
+            }
+            physical_pages()[i++] = MM.allocate_committed_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+        }
     } else {
         auto& initial_page = (strategy == AllocationStrategy::Reserve) ? MM.lazy_committed_page() : MM.shared_zero_page();
         for (size_t i = 0; i < page_count(); ++i)
@@ -395,6 +409,30 @@ RefPtr<PhysicalPage> AnonymousVMObject::allocate_committed_page(size_t page_inde
     return MM.allocate_committed_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
 }
 
+bool AnonymousVMObject::allocate_committed_large_page(size_t first_page_index)
+{
+    VERIFY(first_page_index + PAGES_PER_LARGE_PAGE <= page_count());
+    {
+        ScopedSpinLock lock(m_lock);
+        if (m_unused_committed_pages < PAGES_PER_LARGE_PAGE)
+            return false;
+        for (size_t i = 0; i < PAGES_PER_LARGE_PAGE; ++i) {
+            if (!physical_pages()[first_page_index + i]->is_lazy_committed_page())
+                return false;
+        }
+    }
+
+    auto large_page = MM.allocate_committed_user_physical_large_page(MemoryManager::ShouldZeroFill::Yes);
+    if (large_page.is_empty())
+        return false;
+
+    ScopedSpinLock lock(m_lock);
+    m_unused_committed_pages -= PAGES_PER_LARGE_PAGE;
+    for (size_t i = 0; i < PAGES_PER_LARGE_PAGE; ++i)
+        physical_pages()[first_page_index + i] = large_page[i];
+    return true;
+}
+
 Bitmap& AnonymousVMObject::ensure_cow_map()
 {
     if (m_cow_map.is_null())
@@ -27,6 +27,9 @@ public:
     virtual RefPtr<VMObject> clone() override;
 
     RefPtr<PhysicalPage> allocate_committed_page(size_t);
+    // Replaces PAGES_PER_LARGE_PAGE untouched lazy committed pages starting at the given index with
+    // physically contiguous ones. Returns false if they are not all untouched or memory is too fragmented.
+    bool allocate_committed_large_page(size_t first_page_index);
     PageFaultResponse handle_cow_fault(size_t, VirtualAddress);
     size_t cow_pages() const;
     bool should_cow(size_t page_index, bool) const;
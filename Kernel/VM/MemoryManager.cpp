@@ -20,6 +20,7 @@
 #include <Kernel/VM/PageDirectory.h>
 #include <Kernel/VM/PhysicalRegion.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
+#include <Kernel/WaitQueue.h>
 
 extern u8* start_of_kernel_image;
 extern u8* end_of_kernel_image;
@@ -56,8 +57,18 @@ bool MemoryManager::is_initialized()
     return s_the != nullptr;
 }
 
+// The page zeroing task is woken up once the pool drops to this many pages.
+static constexpr size_t zeroed_page_pool_low_watermark = 64;
+
+// How many pages the page zeroing task zeroes before it lets others run again.
+static constexpr size_t zeroed_page_pool_refill_batch = 16;
+
+READONLY_AFTER_INIT static WaitQueue* s_zeroed_page_pool_wait_queue;
+
 UNMAP_AFTER_INIT MemoryManager::MemoryManager()
 {
+    s_zeroed_page_pool_wait_queue = new WaitQueue;
+
     ScopedSpinLock lock(s_mm_lock);
     m_kernel_page_directory = PageDirectory::create_kernel_page_directory();
     parse_memory_map();
@@ -307,7 +318,8 @@ PageTableEntry* MemoryManager::pte(PageDirectory& page_directory, VirtualAddress
 
     auto* pd = quickmap_pd(const_cast<PageDirectory&>(page_directory), page_directory_table_index);
     const PageDirectoryEntry& pde = pd[page_directory_index];
-    if (!pde.is_present())
+    // A large page has no page table entries to look at.
+    if (!pde.is_present() || pde.is_huge())
         return nullptr;
 
     return &quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
@@ -323,6 +335,13 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
     u32 page_table_index = (vaddr.get() >> 12) & 0x1ff;
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    if (pd[page_directory_index].is_huge()) {
+        // Someone wants to change a single page inside a large page, so it has to become
+        // a page table first.
+        if (!split_large_page(page_directory, vaddr))
+            return nullptr;
+        pd = quickmap_pd(page_directory, page_directory_table_index);
+    }
     PageDirectoryEntry& pde = pd[page_directory_index];
     if (!pde.is_present()) {
         bool did_purge = false;
@@ -365,6 +384,13 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     PageDirectoryEntry& pde = pd[page_directory_index];
+    if (pde.is_present() && pde.is_huge()) {
+        // Large pages are only used for 2 MiB that belong to a single region, and regions
+        // are always unmapped as a whole, so releasing any part releases all of it.
+        pde.clear();
+        --m_large_page_mappings;
+        return;
+    }
     if (pde.is_present()) {
         auto* page_table = quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()));
         auto& pte = page_table[page_table_index];
@@ -390,6 +416,77 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
     }
 }
 
+PageDirectoryEntry* MemoryManager::ensure_large_page_pde(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(page_directory.get_lock().own_lock());
+    VERIFY((vaddr.get() & ~LARGE_PAGE_MASK) == 0);
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x3;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    PageDirectoryEntry& pde = pd[page_directory_index];
+    if (pde.is_present() && !pde.is_huge()) {
+        // The caller owns all of these 2 MiB, so whatever the page table still maps
+        // is about to be replaced anyway.
+        auto result = page_directory.m_page_tables.remove(vaddr.get());
+        VERIFY(result);
+        pde.clear();
+    }
+    if (!pde.is_present())
+        ++m_large_page_mappings;
+    return &pde;
+}
+
+bool MemoryManager::split_large_page(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x3;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    bool did_purge = false;
+    auto page_table = allocate_user_physical_page(ShouldZeroFill::No, &did_purge);
+    if (!page_table) {
+        dbgln("MM: Unable to allocate page table to split large page at {}", vaddr);
+        return false;
+    }
+
+    // Purging may have unmapped the large page while we were looking for memory.
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    auto large_pde = pd[page_directory_index];
+    if (did_purge && !large_pde.is_huge())
+        return true;
+    VERIFY(large_pde.is_present() && large_pde.is_huge());
+
+    // Map the same memory with the same permissions, one page at a time.
+    auto large_page_base = (FlatPtr)large_pde.page_table_base() & LARGE_PAGE_MASK;
+    auto* page_table_entries = quickmap_pt(page_table->paddr());
+    for (size_t i = 0; i < PAGES_PER_LARGE_PAGE; ++i) {
+        auto& pte = page_table_entries[i];
+        pte.clear();
+        pte.set_physical_page_base(large_page_base + i * PAGE_SIZE);
+        pte.set_cache_disabled(large_pde.is_cache_disabled());
+        pte.set_writable(large_pde.is_writable());
+        pte.set_user_allowed(large_pde.is_user_allowed());
+        pte.set_global(large_pde.is_global());
+        pte.set_execute_disabled(large_pde.is_execute_disabled());
+        pte.set_present(true);
+    }
+
+    pd = quickmap_pd(page_directory, page_directory_table_index);
+    auto& pde = pd[page_directory_index];
+    pde.clear();
+    pde.set_page_table_base(page_table->paddr().get());
+    pde.set_user_allowed(true);
+    pde.set_present(true);
+    pde.set_writable(true);
+    pde.set_global(&page_directory == m_kernel_page_directory.ptr());
+    auto result = page_directory.m_page_tables.set(vaddr.get() & ~0x1fffff, move(page_table));
+    VERIFY(result == AK::HashSetResult::InsertedNewEntry);
+    --m_large_page_mappings;
+    return true;
+}
+
 UNMAP_AFTER_INIT void MemoryManager::initialize(u32 cpu)
 {
     auto mm_data = new MemoryManagerData;
@@ -460,7 +557,7 @@ OwnPtr<Region> MemoryManager::allocate_contiguous_kernel_region(size_t size, Str
 {
     VERIFY(!(size % PAGE_SIZE));
     ScopedSpinLock lock(s_mm_lock);
-    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size);
+    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size, size >= LARGE_PAGE_SIZE ? LARGE_PAGE_SIZE : PAGE_SIZE);
     if (!range.has_value())
         return {};
     auto vmobject = ContiguousVMObject::create_with_size(size, physical_alignment);
@@ -478,7 +575,7 @@ OwnPtr<Region> MemoryManager::allocate_kernel_region(size_t size, StringView nam
     if (!vm_object)
         return {};
     ScopedSpinLock lock(s_mm_lock);
-    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size);
+    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size, size >= LARGE_PAGE_SIZE ? LARGE_PAGE_SIZE : PAGE_SIZE);
     if (!range.has_value())
         return {};
     return allocate_kernel_region_with_vmobject(range.value(), vm_object.release_nonnull(), name, access, cacheable);
@@ -491,7 +588,10 @@ OwnPtr<Region> MemoryManager::allocate_kernel_region(PhysicalAddress paddr, size
         return {};
     VERIFY(!(size % PAGE_SIZE));
     ScopedSpinLock lock(s_mm_lock);
-    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size);
+    // Physical ranges that are large page aligned, like framebuffers, can be mapped with large pages
+    // if the virtual range is aligned the same way.
+    bool can_use_large_pages = size >= LARGE_PAGE_SIZE && !(paddr.get() & ~LARGE_PAGE_MASK);
+    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size, can_use_large_pages ? LARGE_PAGE_SIZE : PAGE_SIZE);
     if (!range.has_value())
         return {};
     return allocate_kernel_region_with_vmobject(range.value(), *vm_object, name, access, cacheable);
@@ -529,14 +629,24 @@ OwnPtr<Region> MemoryManager::allocate_kernel_region_with_vmobject(VMObject& vmo
     return allocate_kernel_region_with_vmobject(range.value(), vmobject, name, access, cacheable);
 }
 
+bool MemoryManager::try_take_uncommitted_user_physical_pages(size_t page_count)
+{
+    // Pages are allocated from the uncommitted pool without holding s_mm_lock,
+    // so the check and the update have to happen in one go.
+    auto uncommitted = m_user_physical_pages_uncommitted.load();
+    do {
+        if (uncommitted < page_count)
+            return false;
+    } while (!m_user_physical_pages_uncommitted.compare_exchange_strong(uncommitted, uncommitted - page_count));
+    return true;
+}
+
 bool MemoryManager::commit_user_physical_pages(size_t page_count)
 {
     VERIFY(page_count > 0);
-    ScopedSpinLock lock(s_mm_lock);
-    if (m_user_physical_pages_uncommitted < page_count)
+    if (!try_take_uncommitted_user_physical_pages(page_count))
         return false;
 
-    m_user_physical_pages_uncommitted -= page_count;
     m_user_physical_pages_committed += page_count;
     return true;
 }
@@ -551,71 +661,264 @@ void MemoryManager::uncommit_user_physical_pages(size_t page_count)
     m_user_physical_pages_committed -= page_count;
 }
 
-void MemoryManager::deallocate_user_physical_page(const PhysicalPage& page)
+void MemoryManager::return_user_physical_page_address(PhysicalAddress paddr)
 {
-    ScopedSpinLock lock(s_mm_lock);
+    VERIFY(s_mm_lock.is_locked());
     for (auto& region : m_user_physical_regions) {
-        if (!region.contains(page))
+        if (!region.contains(paddr))
             continue;
 
-        region.return_page(page);
-        --m_user_physical_pages_used;
-
-        // Always return pages to the uncommitted pool. Pages that were
-        // committed and allocated are only freed upon request. Once
-        // returned there is no guarantee being able to get them back.
-        ++m_user_physical_pages_uncommitted;
+        region.return_page(paddr);
         return;
     }
 
-    dmesgln("MM: deallocate_user_physical_page couldn't figure out region for user page @ {}", page.paddr());
+    dmesgln("MM: deallocate_user_physical_page couldn't figure out region for user page @ {}", paddr);
     VERIFY_NOT_REACHED();
 }
 
-RefPtr<PhysicalPage> MemoryManager::find_free_user_physical_page(bool committed)
+void MemoryManager::reclaim_user_physical_page_caches()
 {
     VERIFY(s_mm_lock.is_locked());
-    RefPtr<PhysicalPage> page;
+    Processor::for_each([&](Processor& processor) {
+        auto& mm_data = processor.get_mm_data();
+        ScopedSpinLock cache_lock(mm_data.m_user_physical_page_cache_lock);
+        while (!mm_data.m_user_physical_page_cache.is_empty())
+            return_user_physical_page_address(mm_data.m_user_physical_page_cache.pop());
+    });
+
+    // Zeroed pages are nice to have, but not at the cost of running out of memory.
+    ScopedSpinLock pool_lock(m_zeroed_page_pool_lock);
+    while (!m_zeroed_page_pool.is_empty())
+        return_user_physical_page_address(m_zeroed_page_pool.pop());
+}
+
+Optional<PhysicalAddress> MemoryManager::take_zeroed_user_physical_page_address()
+{
+    Optional<PhysicalAddress> paddr;
+    bool should_wake_zeroing_task;
+    {
+        ScopedSpinLock pool_lock(m_zeroed_page_pool_lock);
+        if (!m_zeroed_page_pool.is_empty())
+            paddr = m_zeroed_page_pool.pop();
+        should_wake_zeroing_task = m_zeroed_page_pool.size() <= zeroed_page_pool_low_watermark;
+    }
+
+    if (paddr.has_value())
+        ++m_zeroed_page_pool_hits;
+    else
+        ++m_zeroed_page_pool_misses;
+
+    if (should_wake_zeroing_task)
+        s_zeroed_page_pool_wait_queue->wake_one();
+    return paddr;
+}
+
+bool MemoryManager::refill_zeroed_page_pool()
+{
+    for (size_t i = 0; i < zeroed_page_pool_refill_batch; ++i) {
+        {
+            ScopedSpinLock pool_lock(m_zeroed_page_pool_lock);
+            if (m_zeroed_page_pool.is_full())
+                return false;
+        }
+
+        // When memory runs low, the pool would just get reclaimed again right away.
+        if (m_user_physical_pages_uncommitted < 2 * zeroed_page_pool_capacity)
+            return false;
+
+        auto paddr = take_user_physical_page_address();
+        if (!paddr.has_value())
+            return false;
+
+        {
+            InterruptDisabler disabler;
+            auto* ptr = quickmap_page(paddr.value());
+            memset(ptr, 0, PAGE_SIZE);
+            unquickmap_page();
+        }
+
+        {
+            ScopedSpinLock pool_lock(m_zeroed_page_pool_lock);
+            if (!m_zeroed_page_pool.is_full()) {
+                m_zeroed_page_pool.push(paddr.value());
+                continue;
+            }
+        }
+        ScopedSpinLock lock(s_mm_lock);
+        return_user_physical_page_address(paddr.value());
+        return false;
+    }
+    return true;
+}
+
+void MemoryManager::wait_until_zeroed_page_pool_needs_refill()
+{
+    s_zeroed_page_pool_wait_queue->wait_forever("PageZeroingTask");
+}
+
+size_t MemoryManager::zeroed_page_pool_size() const
+{
+    ScopedSpinLock pool_lock(m_zeroed_page_pool_lock);
+    return m_zeroed_page_pool.size();
+}
+
+Optional<PhysicalAddress> MemoryManager::take_user_physical_page_address()
+{
+    using PageCache = decltype(MemoryManagerData::m_user_physical_page_cache);
+    auto& mm_data = get_data();
+    {
+        ScopedSpinLock cache_lock(mm_data.m_user_physical_page_cache_lock);
+        if (!mm_data.m_user_physical_page_cache.is_empty())
+            return mm_data.m_user_physical_page_cache.pop();
+    }
+
+    // The cache is empty, so grab a whole batch of pages from the regions while we're at it.
+    ScopedSpinLock lock(s_mm_lock);
+    Array<PhysicalAddress, PageCache::batch_size> batch;
+    size_t batch_count = 0;
+    auto fill_batch = [&] {
+        for (auto& region : m_user_physical_regions) {
+            while (batch_count < batch.size()) {
+                auto paddr = region.take_free_page_address();
+                if (!paddr.has_value())
+                    break;
+                batch[batch_count++] = paddr.value();
+            }
+        }
+    };
+    fill_batch();
+    if (batch_count == 0) {
+        // The last free pages may all be sitting in other processors' caches.
+        reclaim_user_physical_page_caches();
+        fill_batch();
+    }
+    if (batch_count == 0)
+        return {};
+
+    size_t cached_count = 1;
+    {
+        ScopedSpinLock cache_lock(mm_data.m_user_physical_page_cache_lock);
+        for (; cached_count < batch_count && !mm_data.m_user_physical_page_cache.is_full(); ++cached_count)
+            mm_data.m_user_physical_page_cache.push(batch[cached_count]);
+    }
+    for (; cached_count < batch_count; ++cached_count)
+        return_user_physical_page_address(batch[cached_count]);
+    return batch[0];
+}
+
+void MemoryManager::deallocate_user_physical_page(const PhysicalPage& page)
+{
+    using PageCache = decltype(MemoryManagerData::m_user_physical_page_cache);
+    auto& mm_data = get_data();
+    bool did_cache_page = false;
+    {
+        ScopedSpinLock cache_lock(mm_data.m_user_physical_page_cache_lock);
+        auto& cache = mm_data.m_user_physical_page_cache;
+        if (!cache.is_full()) {
+            cache.push(page.paddr());
+            did_cache_page = true;
+        }
+    }
+    if (!did_cache_page) {
+        // A free page that is in neither a cache nor a region can't be found by a committed allocation,
+        // so the overflow has to go back to the regions in the same critical section that takes it out
+        // of the cache. The locks are taken in the same order as in take_user_physical_page_address().
+        ScopedSpinLock lock(s_mm_lock);
+        ScopedSpinLock cache_lock(mm_data.m_user_physical_page_cache_lock);
+        auto& cache = mm_data.m_user_physical_page_cache;
+        if (cache.is_full()) {
+            for (size_t i = 0; i < PageCache::batch_size; ++i)
+                return_user_physical_page_address(cache.pop());
+        }
+        cache.push(page.paddr());
+    }
+
+    // Only account for the page once someone else could actually find it.
+    --m_user_physical_pages_used;
+
+    // Always return pages to the uncommitted pool. Pages that were
+    // committed and allocated are only freed upon request. Once
+    // returned there is no guarantee being able to get them back.
+    ++m_user_physical_pages_uncommitted;
+}
+
+RefPtr<PhysicalPage> MemoryManager::find_free_user_physical_page(bool committed, ShouldZeroFill should_zero_fill)
+{
     if (committed) {
         // Draw from the committed pages pool. We should always have these pages available
         VERIFY(m_user_physical_pages_committed > 0);
         m_user_physical_pages_committed--;
     } else {
         // We need to make sure we don't touch pages that we have committed to
-        if (m_user_physical_pages_uncommitted == 0)
+        if (!try_take_uncommitted_user_physical_pages(1))
             return {};
-        m_user_physical_pages_uncommitted--;
     }
-    for (auto& region : m_user_physical_regions) {
-        page = region.take_free_page(false);
-        if (!page.is_null()) {
-            ++m_user_physical_pages_used;
-            break;
-        }
+
+    Optional<PhysicalAddress> paddr;
+    if (should_zero_fill == ShouldZeroFill::Yes)
+        paddr = take_zeroed_user_physical_page_address();
+    bool needs_zero_fill = should_zero_fill == ShouldZeroFill::Yes && !paddr.has_value();
+    if (!paddr.has_value())
+        paddr = take_user_physical_page_address();
+
+    VERIFY(!committed || paddr.has_value());
+    if (!paddr.has_value()) {
+        ++m_user_physical_pages_uncommitted;
+        return {};
     }
-    VERIFY(!committed || !page.is_null());
-    return page;
+    ++m_user_physical_pages_used;
+
+    if (needs_zero_fill) {
+        InterruptDisabler disabler;
+        auto* ptr = quickmap_page(paddr.value());
+        memset(ptr, 0, PAGE_SIZE);
+        unquickmap_page();
+    }
+    return PhysicalPage::create(paddr.value(), false);
 }
 
 NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_user_physical_page(ShouldZeroFill should_zero_fill)
 {
-    ScopedSpinLock lock(s_mm_lock);
-    auto page = find_free_user_physical_page(true);
+    auto page = find_free_user_physical_page(true, should_zero_fill);
+    return page.release_nonnull();
+}
+
+NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_committed_user_physical_large_page(ShouldZeroFill should_zero_fill)
+{
+    NonnullRefPtrVector<PhysicalPage> physical_pages;
+    {
+        ScopedSpinLock lock(s_mm_lock);
+        for (auto& region : m_user_physical_regions) {
+            physical_pages = region.take_contiguous_free_pages(PAGES_PER_LARGE_PAGE, false, LARGE_PAGE_SIZE);
+            if (!physical_pages.is_empty())
+                break;
+        }
+    }
+    if (physical_pages.is_empty())
+        return {};
+
+    VERIFY(m_user_physical_pages_committed >= PAGES_PER_LARGE_PAGE);
+    m_user_physical_pages_committed -= PAGES_PER_LARGE_PAGE;
+    m_user_physical_pages_used += PAGES_PER_LARGE_PAGE;
+
     if (should_zero_fill == ShouldZeroFill::Yes) {
-        auto* ptr = quickmap_page(*page);
-        memset(ptr, 0, PAGE_SIZE);
-        unquickmap_page();
+        InterruptDisabler disabler;
+        for (auto& page : physical_pages) {
+            auto* ptr = quickmap_page(page);
+            fast_u32_fill((u32*)ptr, 0, PAGE_SIZE / sizeof(u32));
+            unquickmap_page();
+        }
     }
-    return page.release_nonnull();
+    return physical_pages;
 }
 
 RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill should_zero_fill, bool* did_purge)
 {
-    ScopedSpinLock lock(s_mm_lock);
-    auto page = find_free_user_physical_page(false);
+    auto page = find_free_user_physical_page(false, should_zero_fill);
     bool purged_pages = false;
 
     if (!page) {
+        ScopedSpinLock lock(s_mm_lock);
         // We didn't have a single free physical page. Let's try to free something up!
         // First, we look for a purgeable VMObject in the volatile state.
         for_each_vmobject([&](auto& vmobject) {
@@ -624,7 +927,7 @@ RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill s
             int purged_page_count = static_cast<AnonymousVMObject&>(vmobject).purge_with_interrupts_disabled({});
             if (purged_page_count) {
                 dbgln("MM: Purge saved the day! Purged {} pages from AnonymousVMObject", purged_page_count);
-                page = find_free_user_physical_page(false);
+                page = find_free_user_physical_page(false, should_zero_fill);
                 purged_pages = true;
                 VERIFY(page);
                 return IterationDecision::Break;
@@ -637,12 +940,6 @@ RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill s
         }
     }
 
-    if (should_zero_fill == ShouldZeroFill::Yes) {
-        auto* ptr = quickmap_page(*page);
-        memset(ptr, 0, PAGE_SIZE);
-        unquickmap_page();
-    }
-
     if (did_purge)
         *did_purge = purged_pages;
     return page;
@@ -800,6 +1097,11 @@ PageTableEntry* MemoryManager::quickmap_pt(PhysicalAddress pt_paddr)
 }
 
 u8* MemoryManager::quickmap_page(PhysicalPage& physical_page)
+{
+    return quickmap_page(physical_page.paddr());
+}
+
+u8* MemoryManager::quickmap_page(PhysicalAddress paddr)
 {
     VERIFY_INTERRUPTS_DISABLED();
     auto& mm_data = get_data();
@@ -810,8 +1112,8 @@ u8* MemoryManager::quickmap_page(PhysicalPage& physical_page)
     VirtualAddress vaddr(0xffe00000 + pte_idx * PAGE_SIZE);
 
     auto& pte = boot_pd3_pt1023[pte_idx];
-    if (pte.physical_page_base() != physical_page.paddr().as_ptr()) {
-        pte.set_physical_page_base(physical_page.paddr().get());
+    if (pte.physical_page_base() != paddr.as_ptr()) {
+        pte.set_physical_page_base(paddr.get());
         pte.set_present(true);
         pte.set_writable(true);
         pte.set_user_allowed(false);
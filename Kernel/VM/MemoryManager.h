@@ -12,6 +12,7 @@
 #include <AK/String.h>
 #include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/Forward.h>
+#include <Kernel/Heap/Magazine.h>
 #include <Kernel/SpinLock.h>
 #include <Kernel/VM/AllocationStrategy.h>
 #include <Kernel/VM/PhysicalPage.h>
@@ -94,6 +95,12 @@ struct MemoryManagerData {
 
     PhysicalAddress m_last_quickmap_pd;
     PhysicalAddress m_last_quickmap_pt;
+
+    // Free user pages kept close at hand for this processor. The lock is only contended
+    // when another processor reclaims the pages because it ran out. It nests inside
+    // s_mm_lock, never the other way around.
+    SpinLock<u8> m_user_physical_page_cache_lock;
+    Magazine<PhysicalAddress, 64> m_user_physical_page_cache;
 };
 
 extern RecursiveSpinLock s_mm_lock;
@@ -138,12 +145,26 @@ public:
     bool commit_user_physical_pages(size_t);
     void uncommit_user_physical_pages(size_t);
     NonnullRefPtr<PhysicalPage> allocate_committed_user_physical_page(ShouldZeroFill = ShouldZeroFill::Yes);
+    // Takes PAGES_PER_LARGE_PAGE committed pages that are physically contiguous and aligned to
+    // LARGE_PAGE_SIZE, so they can be mapped with a single page directory entry. Returns an empty
+    // vector if physical memory is too fragmented, in which case the caller should use single pages.
+    NonnullRefPtrVector<PhysicalPage> allocate_committed_user_physical_large_page(ShouldZeroFill = ShouldZeroFill::Yes);
     RefPtr<PhysicalPage> allocate_user_physical_page(ShouldZeroFill = ShouldZeroFill::Yes, bool* did_purge = nullptr);
     RefPtr<PhysicalPage> allocate_supervisor_physical_page();
     NonnullRefPtrVector<PhysicalPage> allocate_contiguous_supervisor_physical_pages(size_t size, size_t physical_alignment = PAGE_SIZE);
     void deallocate_user_physical_page(const PhysicalPage&);
     void deallocate_supervisor_physical_page(const PhysicalPage&);
 
+    // Used by the page zeroing task. Zeroes a batch of free pages for the pool and
+    // returns whether the pool could take more.
+    bool refill_zeroed_page_pool();
+    void wait_until_zeroed_page_pool_needs_refill();
+    size_t zeroed_page_pool_size() const;
+    unsigned zeroed_page_pool_hits() const { return m_zeroed_page_pool_hits; }
+    unsigned zeroed_page_pool_misses() const { return m_zeroed_page_pool_misses; }
+
+    unsigned large_page_mappings() const { return m_large_page_mappings; }
+
     OwnPtr<Region> allocate_contiguous_kernel_region(size_t, StringView name, Region::Access access, size_t physical_alignment = PAGE_SIZE, Region::Cacheable = Region::Cacheable::Yes);
     OwnPtr<Region> allocate_kernel_region(size_t, StringView name, Region::Access access, AllocationStrategy strategy = AllocationStrategy::Reserve, Region::Cacheable = Region::Cacheable::Yes);
     OwnPtr<Region> allocate_kernel_region(PhysicalAddress, size_t, StringView name, Region::Access access, Region::Cacheable = Region::Cacheable::Yes);
@@ -207,8 +228,14 @@ private:
 
     static Region* find_region_from_vaddr(VirtualAddress);
 
-    RefPtr<PhysicalPage> find_free_user_physical_page(bool);
+    RefPtr<PhysicalPage> find_free_user_physical_page(bool committed, ShouldZeroFill);
+    Optional<PhysicalAddress> take_zeroed_user_physical_page_address();
+    Optional<PhysicalAddress> take_user_physical_page_address();
+    void return_user_physical_page_address(PhysicalAddress);
+    void reclaim_user_physical_page_caches();
+    bool try_take_uncommitted_user_physical_pages(size_t);
     u8* quickmap_page(PhysicalPage&);
+    u8* quickmap_page(PhysicalAddress);
     void unquickmap_page();
 
     PageDirectoryEntry* quickmap_pd(PageDirectory&, size_t pdpt_index);
@@ -217,6 +244,8 @@ private:
     PageTableEntry* pte(PageDirectory&, VirtualAddress);
     PageTableEntry* ensure_pte(PageDirectory&, VirtualAddress);
     void release_pte(PageDirectory&, VirtualAddress, bool);
+    PageDirectoryEntry* ensure_large_page_pde(PageDirectory&, VirtualAddress);
+    bool split_large_page(PageDirectory&, VirtualAddress);
 
     RefPtr<PageDirectory> m_kernel_page_directory;
 
@@ -230,6 +259,18 @@ private:
     Atomic<unsigned, AK::MemoryOrder::memory_order_relaxed> m_super_physical_pages { 0 };
     Atomic<unsigned, AK::MemoryOrder::memory_order_relaxed> m_super_physical_pages_used { 0 };
 
+    static constexpr size_t zeroed_page_pool_capacity = 256;
+
+    // Free user pages that have already been zeroed by the page zeroing task, so that
+    // faults on fresh anonymous memory don't have to zero the page themselves.
+    // Like the per-processor page caches, the pool lock nests inside s_mm_lock.
+    mutable SpinLock<u8> m_zeroed_page_pool_lock;
+    Magazine<PhysicalAddress, zeroed_page_pool_capacity> m_zeroed_page_pool;
+    Atomic<unsigned, AK::MemoryOrder::memory_order_relaxed> m_zeroed_page_pool_hits { 0 };
+    Atomic<unsigned, AK::MemoryOrder::memory_order_relaxed> m_zeroed_page_pool_misses { 0 };
+
+    Atomic<unsigned, AK::MemoryOrder::memory_order_relaxed> m_large_page_mappings { 0 };
+
     NonnullRefPtrVector<PhysicalRegion> m_user_physical_regions;
     NonnullRefPtrVector<PhysicalRegion> m_super_physical_regions;
 
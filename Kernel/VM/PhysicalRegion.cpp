@@ -4,17 +4,23 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/Bitmap.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/RefPtr.h>
-#include <AK/Vector.h>
 #include <Kernel/Assertions.h>
-#include <Kernel/Random.h>
 #include <Kernel/VM/PhysicalPage.h>
 #include <Kernel/VM/PhysicalRegion.h>
 
 namespace Kernel {
 
+static size_t order_for_page_count(size_t page_count)
+{
+    VERIFY(page_count);
+    size_t order = 0;
+    while ((1u << order) < page_count)
+        ++order;
+    return order;
+}
+
 NonnullRefPtr<PhysicalRegion> PhysicalRegion::create(PhysicalAddress lower, PhysicalAddress upper)
 {
     return adopt_ref(*new PhysicalRegion(lower, upper));
@@ -39,133 +45,157 @@ unsigned PhysicalRegion::finalize_capacity()
     VERIFY(!m_pages);
 
     m_pages = (m_upper.get() - m_lower.get()) / PAGE_SIZE;
-    m_bitmap.grow(m_pages, false);
+
+    // Carve the region up into the largest naturally aligned zones that fit. Since every
+    // buddy block is then naturally aligned as well, alignment requests are just larger orders.
+    auto lower_page = m_lower.get() / PAGE_SIZE;
+    size_t page_index = 0;
+    while (page_index < m_pages) {
+        size_t order = PhysicalZone::max_order;
+        while (order > 0 && (((lower_page + page_index) & ((1u << order) - 1)) != 0 || page_index + (1u << order) > m_pages))
+            --order;
+        m_zones.append(make<PhysicalZone>(m_lower.offset(page_index * PAGE_SIZE), 1u << order));
+        m_usable_zones.append(m_zones.last());
+        page_index += 1u << order;
+    }
 
     return size();
 }
 
-NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count, bool supervisor, size_t physical_alignment)
+PhysicalZone& PhysicalRegion::zone_containing(PhysicalAddress paddr)
 {
-    VERIFY(m_pages);
-    VERIFY(m_used != m_pages);
-
-    NonnullRefPtrVector<PhysicalPage> physical_pages;
-    physical_pages.ensure_capacity(count);
-
-    auto first_contiguous_page = find_contiguous_free_pages(count, physical_alignment);
+    size_t low = 0;
+    size_t high = m_zones.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        auto& zone = m_zones[middle];
+        if (paddr < zone.base())
+            high = middle;
+        else if (zone.contains(paddr))
+            return zone;
+        else
+            low = middle + 1;
+    }
+    VERIFY_NOT_REACHED();
+}
 
-    for (size_t index = 0; index < count; index++)
-        physical_pages.append(PhysicalPage::create(m_lower.offset(PAGE_SIZE * (index + first_contiguous_page)), supervisor));
-    return physical_pages;
+Optional<PhysicalAddress> PhysicalRegion::allocate_block(size_t order)
+{
+    for (auto& zone : m_usable_zones) {
+        if (!zone.has_free_block(order))
+            continue;
+        auto address = zone.allocate_block(order);
+        VERIFY(address.has_value());
+        if (!zone.available())
+            m_full_zones.append(zone);
+        m_used += 1u << order;
+        return address;
+    }
+    return {};
 }
 
-unsigned PhysicalRegion::find_contiguous_free_pages(size_t count, size_t physical_alignment)
+void PhysicalRegion::deallocate_block(PhysicalAddress address, size_t order)
 {
-    VERIFY(count != 0);
-    VERIFY(physical_alignment % PAGE_SIZE == 0);
-    // search from the last page we allocated
-    auto range = find_and_allocate_contiguous_range(count, physical_alignment / PAGE_SIZE);
-    VERIFY(range.has_value());
-    return range.value();
+    auto& zone = zone_containing(address);
+    bool was_full = !zone.available();
+    zone.deallocate_block(address, order);
+    if (was_full)
+        m_usable_zones.append(zone);
+    VERIFY(m_used >= (1u << order));
+    m_used -= 1u << order;
 }
 
-Optional<unsigned> PhysicalRegion::find_one_free_page()
+Optional<PhysicalAddress> PhysicalRegion::allocate_zone_run(size_t zone_count, size_t physical_alignment)
 {
-    if (m_used == m_pages) {
-        // We know we don't have any free pages, no need to check the bitmap
-        // Check if we can draw one from the return queue
-        if (m_recently_returned.size() > 0) {
-            u8 index = get_fast_random<u8>() % m_recently_returned.size();
-            Checked<FlatPtr> local_offset = m_recently_returned[index].get();
-            local_offset -= m_lower.get();
-            m_recently_returned.remove(index);
-            VERIFY(!local_offset.has_overflow());
-            VERIFY(local_offset.value() < (FlatPtr)(m_pages * PAGE_SIZE));
-            return local_offset.value() / PAGE_SIZE;
+    // Only zones of the largest order take part, the smaller ones are just at the edges of the region.
+    constexpr size_t zone_page_count = 1u << PhysicalZone::max_order;
+    size_t run_start = 0;
+    size_t run_length = 0;
+    for (size_t i = 0; i < m_zones.size() && run_length < zone_count; ++i) {
+        auto& zone = m_zones[i];
+        bool extends_run = run_length && zone.base() == m_zones[i - 1].base().offset(zone_page_count * PAGE_SIZE);
+        if (zone.page_count() != zone_page_count || zone.used()) {
+            run_length = 0;
+        } else if (extends_run) {
+            ++run_length;
+        } else if (zone.base().get() % physical_alignment == 0) {
+            run_start = i;
+            run_length = 1;
+        } else {
+            run_length = 0;
         }
-        return {};
     }
-    auto free_index = m_bitmap.find_one_anywhere_unset(m_free_hint);
-    if (!free_index.has_value())
+    if (run_length < zone_count)
         return {};
 
-    auto page_index = free_index.value();
-    m_bitmap.set(page_index, true);
-    m_used++;
-    m_free_hint = free_index.value() + 1; // Just a guess
-    if (m_free_hint >= m_bitmap.size())
-        m_free_hint = 0;
-    return page_index;
+    for (size_t i = run_start; i < run_start + zone_count; ++i) {
+        auto& zone = m_zones[i];
+        auto address = zone.allocate_block(PhysicalZone::max_order);
+        VERIFY(address.has_value());
+        m_full_zones.append(zone);
+        m_used += zone_page_count;
+    }
+    return m_zones[run_start].base();
 }
 
-Optional<unsigned> PhysicalRegion::find_and_allocate_contiguous_range(size_t count, unsigned alignment)
+NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count, bool supervisor, size_t physical_alignment)
 {
+    VERIFY(m_pages);
     VERIFY(count != 0);
-    size_t found_pages_count = 0;
-    // TODO: Improve how we deal with alignment != 1
-    auto first_index = m_bitmap.find_longest_range_of_unset_bits(count + alignment - 1, found_pages_count);
-    if (!first_index.has_value())
-        return {};
+    VERIFY(physical_alignment % PAGE_SIZE == 0);
 
-    auto page = first_index.value();
-    if (alignment != 1) {
-        auto lower_page = m_lower.get() / PAGE_SIZE;
-        page = ((lower_page + page + alignment - 1) & ~(alignment - 1)) - lower_page;
+    auto order = order_for_page_count(max(count, physical_alignment / PAGE_SIZE));
+    Optional<PhysicalAddress> block;
+    size_t block_page_count;
+    if (order <= PhysicalZone::max_order) {
+        block = allocate_block(order);
+        block_page_count = 1u << order;
+    } else {
+        // No single zone can hold this, so take a run of whole zones instead.
+        constexpr size_t zone_page_count = 1u << PhysicalZone::max_order;
+        block_page_count = (count + zone_page_count - 1) & ~(zone_page_count - 1);
+        block = allocate_zone_run(block_page_count / zone_page_count, physical_alignment);
     }
-    if (found_pages_count >= count) {
-        m_bitmap.set_range<true>(page, count);
-        m_used += count;
-        m_free_hint = first_index.value() + count + 1; // Just a guess
-        if (m_free_hint >= m_bitmap.size())
-            m_free_hint = 0;
-        return page;
+    if (!block.has_value())
+        return {};
+
+    // Hand back the pages past the end of the request in the largest blocks that fit.
+    size_t page_index = count;
+    while (page_index < block_page_count) {
+        size_t tail_order = min((size_t)__builtin_ctzl(page_index), PhysicalZone::max_order);
+        while (page_index + (1u << tail_order) > block_page_count)
+            --tail_order;
+        deallocate_block(block.value().offset(page_index * PAGE_SIZE), tail_order);
+        page_index += 1u << tail_order;
     }
-    return {};
+
+    NonnullRefPtrVector<PhysicalPage> physical_pages;
+    physical_pages.ensure_capacity(count);
+    for (size_t index = 0; index < count; index++)
+        physical_pages.append(PhysicalPage::create(block.value().offset(PAGE_SIZE * index), supervisor));
+    return physical_pages;
 }
 
-RefPtr<PhysicalPage> PhysicalRegion::take_free_page(bool supervisor)
+Optional<PhysicalAddress> PhysicalRegion::take_free_page_address()
 {
     VERIFY(m_pages);
-
-    auto free_index = find_one_free_page();
-    if (!free_index.has_value())
-        return nullptr;
-
-    return PhysicalPage::create(m_lower.offset(free_index.value() * PAGE_SIZE), supervisor);
+    return allocate_block(0);
 }
 
-void PhysicalRegion::free_page_at(PhysicalAddress addr)
+RefPtr<PhysicalPage> PhysicalRegion::take_free_page(bool supervisor)
 {
-    VERIFY(m_pages);
-
-    if (m_used == 0) {
-        VERIFY_NOT_REACHED();
-    }
-
-    Checked<FlatPtr> local_offset = addr.get();
-    local_offset -= m_lower.get();
-    VERIFY(!local_offset.has_overflow());
-    VERIFY(local_offset.value() < (FlatPtr)(m_pages * PAGE_SIZE));
+    auto address = take_free_page_address();
+    if (!address.has_value())
+        return nullptr;
 
-    auto page = local_offset.value() / PAGE_SIZE;
-    m_bitmap.set(page, false);
-    m_free_hint = page; // We know we can find one here for sure
-    m_used--;
+    return PhysicalPage::create(address.value(), supervisor);
 }
 
-void PhysicalRegion::return_page(const PhysicalPage& page)
+void PhysicalRegion::return_page(PhysicalAddress paddr)
 {
-    auto returned_count = m_recently_returned.size();
-    if (returned_count >= m_recently_returned.capacity()) {
-        // Return queue is full, pick a random entry and free that page
-        // and replace the entry with this page
-        auto& entry = m_recently_returned[get_fast_random<u8>()];
-        free_page_at(entry);
-        entry = page.paddr();
-    } else {
-        // Still filling the return queue, just append it
-        m_recently_returned.append(page.paddr());
-    }
+    VERIFY(m_pages);
+    VERIFY(m_used);
+    deallocate_block(paddr, 0);
 }
 
 }
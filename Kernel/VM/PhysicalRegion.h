@@ -6,11 +6,12 @@
 
 #pragma once
 
-#include <AK/Bitmap.h>
+#include <AK/NonnullOwnPtrVector.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/Optional.h>
 #include <AK/RefCounted.h>
 #include <Kernel/VM/PhysicalPage.h>
+#include <Kernel/VM/PhysicalZone.h>
 
 namespace Kernel {
 
@@ -27,19 +28,22 @@ public:
     PhysicalAddress lower() const { return m_lower; }
     PhysicalAddress upper() const { return m_upper; }
     unsigned size() const { return m_pages; }
-    unsigned used() const { return m_used - m_recently_returned.size(); }
-    unsigned free() const { return m_pages - m_used + m_recently_returned.size(); }
-    bool contains(const PhysicalPage& page) const { return page.paddr() >= m_lower && page.paddr() <= m_upper; }
+    unsigned used() const { return m_used; }
+    unsigned free() const { return m_pages - m_used; }
+    bool contains(PhysicalAddress paddr) const { return paddr >= m_lower && paddr <= m_upper; }
+    bool contains(const PhysicalPage& page) const { return contains(page.paddr()); }
 
     RefPtr<PhysicalPage> take_free_page(bool supervisor);
+    Optional<PhysicalAddress> take_free_page_address();
     NonnullRefPtrVector<PhysicalPage> take_contiguous_free_pages(size_t count, bool supervisor, size_t physical_alignment = PAGE_SIZE);
-    void return_page(const PhysicalPage& page);
+    void return_page(const PhysicalPage& page) { return_page(page.paddr()); }
+    void return_page(PhysicalAddress);
 
 private:
-    unsigned find_contiguous_free_pages(size_t count, size_t physical_alignment = PAGE_SIZE);
-    Optional<unsigned> find_and_allocate_contiguous_range(size_t count, unsigned alignment = 1);
-    Optional<unsigned> find_one_free_page();
-    void free_page_at(PhysicalAddress addr);
+    Optional<PhysicalAddress> allocate_block(size_t order);
+    void deallocate_block(PhysicalAddress, size_t order);
+    Optional<PhysicalAddress> allocate_zone_run(size_t zone_count, size_t physical_alignment);
+    PhysicalZone& zone_containing(PhysicalAddress);
 
     PhysicalRegion(PhysicalAddress lower, PhysicalAddress upper);
 
@@ -47,9 +51,13 @@ private:
     PhysicalAddress m_upper;
     unsigned m_pages { 0 };
     unsigned m_used { 0 };
-    Bitmap m_bitmap;
-    size_t m_free_hint { 0 };
-    Vector<PhysicalAddress, 256> m_recently_returned;
+
+    // Sorted by address, so the zone owning a page can be found with a binary search.
+    NonnullOwnPtrVector<PhysicalZone> m_zones;
+
+    // Zones move between these lists as they run out of free pages and get some back.
+    PhysicalZone::List m_usable_zones;
+    PhysicalZone::List m_full_zones;
 };
 
 }
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Assertions.h>
+#include <Kernel/VM/PhysicalZone.h>
+
+namespace Kernel {
+
+static Optional<size_t> find_set_bit(const Bitmap& bitmap, size_t hint)
+{
+    // Bucket bitmaps are powers of two in size, so they either fit into a single byte or
+    // are made up of whole 32-bit words, which we can skip over a word at a time.
+    auto size = bitmap.size();
+    if (size < 32) {
+        for (size_t i = 0; i < size; ++i) {
+            if (bitmap.get(i))
+                return i;
+        }
+        return {};
+    }
+
+    auto* words = reinterpret_cast<const u32*>(bitmap.data());
+    size_t word_count = size / 32;
+    size_t first_word = hint / 32;
+    for (size_t i = 0; i < word_count; ++i) {
+        size_t word_index = (first_word + i) % word_count;
+        if (auto word = words[word_index])
+            return word_index * 32 + __builtin_ctz(word);
+    }
+    return {};
+}
+
+PhysicalZone::PhysicalZone(PhysicalAddress base, size_t page_count)
+    : m_base(base)
+    , m_page_count(page_count)
+{
+    VERIFY(page_count && (page_count & (page_count - 1)) == 0);
+    m_order = __builtin_ctzl(page_count);
+    VERIFY(m_order <= max_order);
+    VERIFY((base.get() / PAGE_SIZE) % page_count == 0);
+
+    for (size_t order = 0; order <= m_order; ++order)
+        m_buckets[order].bitmap.grow(page_count >> order, false);
+
+    // The whole zone starts out as one free block.
+    mark_block_free(0, m_order);
+}
+
+bool PhysicalZone::has_free_block(size_t order) const
+{
+    for (size_t candidate_order = order; candidate_order <= m_order; ++candidate_order) {
+        if (m_buckets[candidate_order].free_blocks)
+            return true;
+    }
+    return false;
+}
+
+void PhysicalZone::mark_block_free(size_t page_index, size_t order)
+{
+    auto& bucket = m_buckets[order];
+    auto block_index = page_index >> order;
+    VERIFY(!bucket.bitmap.get(block_index));
+    bucket.bitmap.set(block_index, true);
+    bucket.free_blocks++;
+    bucket.hint = block_index;
+}
+
+void PhysicalZone::mark_block_used(size_t page_index, size_t order)
+{
+    auto& bucket = m_buckets[order];
+    auto block_index = page_index >> order;
+    VERIFY(bucket.bitmap.get(block_index));
+    bucket.bitmap.set(block_index, false);
+    bucket.free_blocks--;
+}
+
+Optional<size_t> PhysicalZone::allocate_block_impl(size_t order)
+{
+    if (order > m_order)
+        return {};
+
+    for (size_t candidate_order = order; candidate_order <= m_order; ++candidate_order) {
+        auto& bucket = m_buckets[candidate_order];
+        if (!bucket.free_blocks)
+            continue;
+
+        auto block_index = find_set_bit(bucket.bitmap, bucket.hint);
+        VERIFY(block_index.has_value());
+        size_t page_index = block_index.value() << candidate_order;
+        mark_block_used(page_index, candidate_order);
+
+        // Split the block down to the requested size, leaving the upper halves free.
+        while (candidate_order > order) {
+            --candidate_order;
+            mark_block_free(page_index + (1u << candidate_order), candidate_order);
+        }
+        return page_index;
+    }
+    return {};
+}
+
+void PhysicalZone::deallocate_block_impl(size_t page_index, size_t order)
+{
+    // Merge with the buddy for as long as it's free as well.
+    while (order < m_order) {
+        size_t buddy_page_index = page_index ^ (1u << order);
+        if (!m_buckets[order].bitmap.get(buddy_page_index >> order))
+            break;
+        mark_block_used(buddy_page_index, order);
+        page_index = min(page_index, buddy_page_index);
+        ++order;
+    }
+    mark_block_free(page_index, order);
+}
+
+Optional<PhysicalAddress> PhysicalZone::allocate_block(size_t order)
+{
+    auto page_index = allocate_block_impl(order);
+    if (!page_index.has_value())
+        return {};
+    m_used += 1u << order;
+    return m_base.offset(page_index.value() * PAGE_SIZE);
+}
+
+void PhysicalZone::deallocate_block(PhysicalAddress address, size_t order)
+{
+    VERIFY(contains(address));
+    size_t page_index = (address.get() - m_base.get()) / PAGE_SIZE;
+    VERIFY((page_index & ((1u << order) - 1)) == 0);
+    VERIFY(m_used >= (1u << order));
+    m_used -= 1u << order;
+    deallocate_block_impl(page_index, order);
+}
+
+}
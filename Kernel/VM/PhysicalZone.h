@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Bitmap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/Optional.h>
+#include <Kernel/Arch/x86/CPU.h>
+#include <Kernel/PhysicalAddress.h>
+
+namespace Kernel {
+
+// A naturally aligned, power-of-two sized chunk of physical memory that hands out
+// blocks of 2^order pages with a buddy allocator. Splitting and merging blocks is
+// O(order), and a block of any order is found by looking only at the bitmap of that
+// order, which is small for everything but single pages.
+class PhysicalZone {
+    AK_MAKE_ETERNAL
+    AK_MAKE_NONCOPYABLE(PhysicalZone);
+    AK_MAKE_NONMOVABLE(PhysicalZone);
+
+public:
+    static constexpr size_t max_order = 12;
+
+    PhysicalZone(PhysicalAddress base, size_t page_count);
+
+    Optional<PhysicalAddress> allocate_block(size_t order);
+    void deallocate_block(PhysicalAddress, size_t order);
+
+    PhysicalAddress base() const { return m_base; }
+    size_t page_count() const { return m_page_count; }
+    size_t used() const { return m_used; }
+    size_t available() const { return m_page_count - m_used; }
+    bool contains(PhysicalAddress paddr) const { return paddr >= m_base && paddr < m_base.offset(m_page_count * PAGE_SIZE); }
+
+    // Whether a block of this order could be allocated right now.
+    bool has_free_block(size_t order) const;
+
+private:
+    Optional<size_t> allocate_block_impl(size_t order);
+    void deallocate_block_impl(size_t page_index, size_t order);
+
+    void mark_block_free(size_t page_index, size_t order);
+    void mark_block_used(size_t page_index, size_t order);
+
+    struct BuddyBucket {
+        // One bit per block of this order, set while that block is free.
+        Bitmap bitmap;
+        size_t free_blocks { 0 };
+        // Where the last free block of this order was found or put back.
+        size_t hint { 0 };
+    };
+
+    PhysicalAddress m_base;
+    size_t m_page_count { 0 };
+    size_t m_order { 0 };
+    size_t m_used { 0 };
+    BuddyBucket m_buckets[max_order + 1];
+
+    IntrusiveListNode<PhysicalZone> m_list_node;
+
+public:
+    using List = IntrusiveList<PhysicalZone, RawPtr<PhysicalZone>, &PhysicalZone::m_list_node>;
+};
+
+}
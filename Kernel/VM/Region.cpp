@@ -267,6 +267,77 @@ bool Region::map_individual_page_impl(size_t page_index)
     return true;
 }
 
+bool Region::can_map_large_page(size_t page_index) const
+{
+    if (!vmobject().is_anonymous() && !vmobject().is_contiguous())
+        return false;
+    if (vaddr_from_page_index(page_index).get() & ~LARGE_PAGE_MASK)
+        return false;
+    if (page_index + PAGES_PER_LARGE_PAGE > page_count())
+        return false;
+    if (!is_readable() && !is_writable())
+        return false;
+
+    // The pages have to be physically contiguous and start on a large page boundary.
+    // The shared zero and lazy committed pages never are.
+    auto* first_page = physical_page(page_index);
+    if (!first_page || (first_page->paddr().get() & ~LARGE_PAGE_MASK))
+        return false;
+    for (size_t i = 1; i < PAGES_PER_LARGE_PAGE; ++i) {
+        auto* page = physical_page(page_index + i);
+        if (!page || page->paddr() != first_page->paddr().offset(i * PAGE_SIZE))
+            return false;
+    }
+    return true;
+}
+
+void Region::map_large_page_impl(size_t page_index)
+{
+    VERIFY(m_page_directory->get_lock().own_lock());
+    auto page_vaddr = vaddr_from_page_index(page_index);
+
+    bool user_allowed = page_vaddr.get() >= 0x00800000 && is_user_address(page_vaddr);
+    if (is_mmap() && !user_allowed) {
+        PANIC("About to map mmap'ed page at a kernel address");
+    }
+
+    // If any page still needs to be copied on write, the whole large page is mapped read-only.
+    // The first write fault then splits it into a page table.
+    bool writable = is_writable();
+    for (size_t i = 0; writable && i < PAGES_PER_LARGE_PAGE; ++i) {
+        if (should_cow(page_index + i))
+            writable = false;
+    }
+
+    auto* pde = MM.ensure_large_page_pde(*m_page_directory, page_vaddr);
+    pde->clear();
+    pde->set_page_table_base(physical_page(page_index)->paddr().get());
+    pde->set_huge(true);
+    pde->set_cache_disabled(!m_cacheable);
+    pde->set_writable(writable);
+    if (Processor::current().has_feature(CPUFeature::NX))
+        pde->set_execute_disabled(!is_executable());
+    pde->set_user_allowed(user_allowed);
+    pde->set_present(true);
+}
+
+size_t Region::map_page_range_impl(size_t page_index, size_t page_count)
+{
+    size_t end = page_index + page_count;
+    size_t index = page_index;
+    while (index < end) {
+        if (index + PAGES_PER_LARGE_PAGE <= end && can_map_large_page(index)) {
+            map_large_page_impl(index);
+            index += PAGES_PER_LARGE_PAGE;
+            continue;
+        }
+        if (!map_individual_page_impl(index))
+            break;
+        ++index;
+    }
+    return index - page_index;
+}
+
 bool Region::do_remap_vmobject_page_range(size_t page_index, size_t page_count)
 {
     bool success = true;
@@ -276,16 +347,11 @@ bool Region::do_remap_vmobject_page_range(size_t page_index, size_t page_count)
     if (!translate_vmobject_page_range(page_index, page_count))
         return success; // not an error, region doesn't map this page range
     ScopedSpinLock page_lock(m_page_directory->get_lock());
-    size_t index = page_index;
-    while (index < page_index + page_count) {
-        if (!map_individual_page_impl(index)) {
-            success = false;
-            break;
-        }
-        index++;
-    }
-    if (index > page_index)
-        MM.flush_tlb(m_page_directory, vaddr_from_page_index(page_index), index - page_index);
+    size_t mapped_page_count = map_page_range_impl(page_index, page_count);
+    if (mapped_page_count != page_count)
+        success = false;
+    if (mapped_page_count > 0)
+        MM.flush_tlb(m_page_directory, vaddr_from_page_index(page_index), mapped_page_count);
     return success;
 }
 
@@ -377,12 +443,7 @@ bool Region::map(PageDirectory& page_directory, ShouldFlushTLB should_flush_tlb)
     }
 
     set_page_directory(page_directory);
-    size_t page_index = 0;
-    while (page_index < page_count()) {
-        if (!map_individual_page_impl(page_index))
-            break;
-        ++page_index;
-    }
+    size_t page_index = map_page_range_impl(0, page_count());
     if (page_index > 0) {
         if (should_flush_tlb == ShouldFlushTLB::Yes)
             MM.flush_tlb(m_page_directory, vaddr(), page_index);
@@ -416,6 +477,8 @@ PageFaultResponse Region::handle_fault(const PageFault& fault, ScopedSpinLock<Re
 
         auto& page_slot = physical_page_slot(page_index_in_region);
         if (page_slot->is_lazy_committed_page()) {
+            if (auto response = try_fault_in_large_page(page_index_in_region); response.has_value())
+                return response.value();
             auto page_index_in_vmobject = translate_to_vmobject_page(page_index_in_region);
             page_slot = static_cast<AnonymousVMObject&>(*m_vmobject).allocate_committed_page(page_index_in_vmobject);
             remap_vmobject_page(page_index_in_vmobject);
@@ -447,6 +510,24 @@ PageFaultResponse Region::handle_fault(const PageFault& fault, ScopedSpinLock<Re
     return PageFaultResponse::ShouldCrash;
 }
 
+Optional<PageFaultResponse> Region::try_fault_in_large_page(size_t page_index_in_region)
+{
+    // If the whole large page around the faulting page lies inside this region and none of it
+    // has been touched yet, allocate all of it at once so it can be mapped with a large page.
+    auto large_page_vaddr = VirtualAddress(vaddr_from_page_index(page_index_in_region).get() & LARGE_PAGE_MASK);
+    if (!contains(Range { large_page_vaddr, LARGE_PAGE_SIZE }))
+        return {};
+    auto page_index_in_vmobject = translate_to_vmobject_page(page_index_from_address(large_page_vaddr));
+    if (!static_cast<AnonymousVMObject&>(*m_vmobject).allocate_committed_large_page(page_index_in_vmobject))
+        return {};
+    // The faulting page isn't lazily committed anymore, so there is no falling back to a single page from here on.
+    if (!remap_vmobject_page_range(page_index_in_vmobject, PAGES_PER_LARGE_PAGE)) {
+        dmesgln("MM: try_fault_in_large_page was unable to map the large page at {}", large_page_vaddr);
+        return PageFaultResponse::ShouldCrash;
+    }
+    return PageFaultResponse::Continue;
+}
+
 PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -247,6 +247,10 @@ private:
     PageFaultResponse handle_zero_fault(size_t page_index);
 
     bool map_individual_page_impl(size_t page_index);
+    bool can_map_large_page(size_t page_index) const;
+    void map_large_page_impl(size_t page_index);
+    size_t map_page_range_impl(size_t page_index, size_t page_count);
+    Optional<PageFaultResponse> try_fault_in_large_page(size_t page_index);
 
     void register_purgeable_page_ranges();
     void unregister_purgeable_page_ranges();
@@ -30,6 +30,12 @@ UNMAP_AFTER_INIT void VirtIO::detect()
             [[maybe_unused]] auto& unused = adopt_ref(*new VirtIORNG(address)).leak_ref();
             break;
         }
+        case (u16)PCIDeviceID::VirtIOBlock:
+            // Block devices are brought up by StorageManagement.
+            break;
+        case (u16)PCIDeviceID::VirtIONetwork:
+            // Network adapters are brought up by NetworkingManagement.
+            break;
         default:
             dbgln_if(VIRTIO_DEBUG, "VirtIO: Unknown VirtIO device with ID: {}", id.device_id);
             break;
@@ -354,22 +360,41 @@ void VirtIODevice::handle_irq(const RegisterState&)
     }
     if (isr_type & QUEUE_INTERRUPT) {
         dbgln_if(VIRTIO_DEBUG, "{}: VirtIO Queue interrupt!", m_class_name);
+        // A single interrupt can be for several queues at once.
+        bool did_handle_queue_update = false;
         for (size_t i = 0; i < m_queues.size(); i++) {
-            if (get_queue(i).new_data_available())
-                return handle_queue_update(i);
+            if (get_queue(i).new_data_available()) {
+                handle_queue_update(i);
+                did_handle_queue_update = true;
+            }
         }
-        dbgln_if(VIRTIO_DEBUG, "{}: Got queue interrupt but all queues are up to date!", m_class_name);
+        if (!did_handle_queue_update)
+            dbgln_if(VIRTIO_DEBUG, "{}: Got queue interrupt but all queues are up to date!", m_class_name);
     }
     if (isr_type & ~(QUEUE_INTERRUPT | DEVICE_CONFIG_INTERRUPT))
         dbgln("{}: Handling interrupt with unknown type: {}", m_class_name, isr_type);
 }
 
 void VirtIODevice::supply_chain_and_notify(u16 queue_index, VirtIOQueueChain& chain)
+{
+    supply_chain(queue_index, chain);
+    notify_queue_if_needed(queue_index);
+}
+
+void VirtIODevice::supply_chain(u16 queue_index, VirtIOQueueChain& chain)
 {
     auto& queue = get_queue(queue_index);
     VERIFY(&chain.queue() == &queue);
     VERIFY(queue.lock().is_locked());
     chain.submit_to_queue();
+}
+
+void VirtIODevice::notify_queue_if_needed(u16 queue_index)
+{
+    auto& queue = get_queue(queue_index);
+    VERIFY(queue.lock().is_locked());
+    // The device may have started ignoring notifications while we were making our buffers available.
+    full_memory_barrier();
     if (queue.should_notify())
         notify_queue(queue_index);
 }
@@ -30,6 +30,7 @@ VirtIOQueue::VirtIOQueue(u16 queue_size, u16 notify_offset)
         m_descriptors[i].next = i + 1; // link all of the descriptors in a line
     }
 
+    ScopedSpinLock lock(m_lock);
     enable_interrupts();
 }
 
@@ -39,14 +40,14 @@ VirtIOQueue::~VirtIOQueue()
 
 void VirtIOQueue::enable_interrupts()
 {
-    ScopedSpinLock lock(m_lock);
+    VERIFY(m_lock.is_locked());
     m_driver->flags = 0;
 }
 
 void VirtIOQueue::disable_interrupts()
 {
-    ScopedSpinLock lock(m_lock);
-    m_driver->flags = 1;
+    VERIFY(m_lock.is_locked());
+    m_driver->flags = VIRTQ_AVAIL_F_NO_INTERRUPT;
 }
 
 bool VirtIOQueue::new_data_available() const
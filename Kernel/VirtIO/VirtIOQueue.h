@@ -32,6 +32,7 @@ public:
     ~VirtIOQueue();
 
     bool is_null() const { return !m_queue_region; }
+    u16 size() const { return m_queue_size; }
     u16 notify_offset() const { return m_notify_offset; }
 
     void enable_interrupts();
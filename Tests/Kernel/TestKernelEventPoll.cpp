@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct Pipe {
+    Pipe()
+    {
+        VERIFY(pipe(fds) == 0);
+    }
+    ~Pipe()
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+    int read_fd() const { return fds[0]; }
+    int write_fd() const { return fds[1]; }
+    int fds[2];
+};
+
+static int add_interest(int epfd, int fd, u32 events, int data)
+{
+    epoll_event event {};
+    event.events = events;
+    event.data.fd = data;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event);
+}
+
+TEST_CASE(level_triggered)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    EXPECT(epfd >= 0);
+    Pipe pipe;
+    EXPECT_EQ(add_interest(epfd, pipe.read_fd(), EPOLLIN, 42), 0);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    EXPECT_EQ(write(pipe.write_fd(), "xy", 2), 2);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].events, EPOLLIN);
+    EXPECT_EQ(events[0].data.fd, 42);
+
+    // Still readable, so it's reported again.
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+
+    char buffer[2];
+    EXPECT_EQ(read(pipe.read_fd(), buffer, 2), 2);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+    close(epfd);
+}
+
+TEST_CASE(edge_triggered)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    Pipe pipe;
+    EXPECT_EQ(add_interest(epfd, pipe.read_fd(), EPOLLIN | EPOLLET, 1), 0);
+
+    epoll_event events[4];
+    EXPECT_EQ(write(pipe.write_fd(), "x", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    // More data is a new edge.
+    EXPECT_EQ(write(pipe.write_fd(), "y", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    close(epfd);
+}
+
+TEST_CASE(oneshot_until_modified)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    Pipe pipe;
+    EXPECT_EQ(add_interest(epfd, pipe.read_fd(), EPOLLIN | EPOLLONESHOT, 1), 0);
+
+    epoll_event events[4];
+    EXPECT_EQ(write(pipe.write_fd(), "x", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    EXPECT_EQ(write(pipe.write_fd(), "y", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    // Modifying the interest arms it again.
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = 2;
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_MOD, pipe.read_fd(), &event), 0);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].data.fd, 2);
+    close(epfd);
+}
+
+TEST_CASE(control_errors)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    Pipe pipe;
+    epoll_event event {};
+    event.events = EPOLLIN;
+
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_MOD, pipe.read_fd(), &event), -1);
+    EXPECT_EQ(errno, ENOENT);
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_DEL, pipe.read_fd(), nullptr), -1);
+    EXPECT_EQ(errno, ENOENT);
+
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, pipe.read_fd(), &event), 0);
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, pipe.read_fd(), &event), -1);
+    EXPECT_EQ(errno, EEXIST);
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, epfd, &event), -1);
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, -1, &event), -1);
+    EXPECT_EQ(errno, EBADF);
+
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_DEL, pipe.read_fd(), nullptr), 0);
+    EXPECT_EQ(write(pipe.write_fd(), "x", 1), 1);
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+    close(epfd);
+}
+
+TEST_CASE(closing_removes_interest)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    EXPECT_EQ(add_interest(epfd, fds[0], EPOLLIN, 1), 0);
+    EXPECT_EQ(write(fds[1], "x", 1), 1);
+    close(fds[0]);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    // The fd number can be watched again once it's reused.
+    int new_fds[2];
+    EXPECT_EQ(pipe(new_fds), 0);
+    EXPECT_EQ(new_fds[0], fds[0]);
+    EXPECT_EQ(add_interest(epfd, new_fds[0], EPOLLIN, 2), 0);
+
+    close(fds[1]);
+    close(new_fds[0]);
+    close(new_fds[1]);
+    close(epfd);
+}
+
+TEST_CASE(dup_fds_are_separate_interests)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    Pipe pipe;
+    int dup_fd = dup(pipe.read_fd());
+    EXPECT(dup_fd >= 0);
+    EXPECT_EQ(add_interest(epfd, pipe.read_fd(), EPOLLIN, 1), 0);
+    EXPECT_EQ(add_interest(epfd, dup_fd, EPOLLIN, 2), 0);
+
+    // Modifying one of them leaves the other one alone.
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = 3;
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_MOD, dup_fd, &event), 0);
+
+    epoll_event events[4];
+    EXPECT_EQ(write(pipe.write_fd(), "x", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 2);
+    EXPECT_EQ(events[0].data.fd + events[1].data.fd, 4);
+
+    // Closing the dup only drops its own interest, even though the description lives on.
+    close(dup_fd);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].data.fd, 1);
+    close(epfd);
+}
+
+TEST_CASE(many_ready_interests)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    Pipe pipes[6];
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_EQ(add_interest(epfd, pipes[i].read_fd(), EPOLLIN, i), 0);
+        EXPECT_EQ(write(pipes[i].write_fd(), "x", 1), 1);
+    }
+
+    // Every ready interest gets its turn, even when fewer events fit than are ready.
+    epoll_event events[4];
+    bool seen[6] {};
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 4);
+    for (int i = 0; i < 4; ++i)
+        seen[events[i].data.fd] = true;
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 4);
+    for (int i = 0; i < 4; ++i)
+        seen[events[i].data.fd] = true;
+    for (bool was_seen : seen)
+        EXPECT(was_seen);
+    close(epfd);
+}
+
+TEST_CASE(wait_times_out)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    Pipe pipe;
+    EXPECT_EQ(add_interest(epfd, pipe.read_fd(), EPOLLIN, 1), 0);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 50), 0);
+    EXPECT_EQ(epoll_wait(epfd, events, 0, 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+    close(epfd);
+}
+
+TEST_CASE(wakes_up_when_ready)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    Pipe pipe;
+    EXPECT_EQ(add_interest(epfd, pipe.read_fd(), EPOLLIN, 1), 0);
+
+    pid_t pid = fork();
+    EXPECT(pid >= 0);
+    if (pid == 0) {
+        usleep(20000);
+        (void)write(pipe.write_fd(), "x", 1);
+        _exit(0);
+    }
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, -1), 1);
+    EXPECT_EQ(events[0].data.fd, 1);
+    EXPECT_EQ(waitpid(pid, nullptr, 0), pid);
+    close(epfd);
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static int create_file_with_contents(char* path, const char* contents)
+{
+    int fd = mkstemp(path);
+    VERIFY(fd >= 0);
+    size_t length = strlen(contents);
+    VERIFY(write(fd, contents, length) == (ssize_t)length);
+    return fd;
+}
+
+TEST_CASE(pread_does_not_move_offset)
+{
+    char path[] = "/tmp/pread.XXXXXX";
+    int fd = create_file_with_contents(path, "0123456789");
+    EXPECT_EQ(lseek(fd, 2, SEEK_SET), 2);
+
+    char buffer[4] {};
+    EXPECT_EQ(pread(fd, buffer, 3, 5), 3);
+    EXPECT_EQ(memcmp(buffer, "567", 3), 0);
+    EXPECT_EQ(lseek(fd, 0, SEEK_CUR), 2);
+
+    // Reading past the end is a short read, not an error.
+    EXPECT_EQ(pread(fd, buffer, 4, 8), 2);
+    EXPECT_EQ(pread(fd, buffer, 4, 20), 0);
+    EXPECT_EQ(pread(fd, buffer, 4, -1), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    close(fd);
+    unlink(path);
+}
+
+TEST_CASE(pwrite_does_not_move_offset)
+{
+    char path[] = "/tmp/pwrite.XXXXXX";
+    int fd = create_file_with_contents(path, "0123456789");
+    EXPECT_EQ(lseek(fd, 1, SEEK_SET), 1);
+
+    EXPECT_EQ(pwrite(fd, "abc", 3, 4), 3);
+    EXPECT_EQ(lseek(fd, 0, SEEK_CUR), 1);
+
+    char buffer[10] {};
+    EXPECT_EQ(pread(fd, buffer, sizeof(buffer), 0), 10);
+    EXPECT_EQ(memcmp(buffer, "0123abc789", 10), 0);
+
+    close(fd);
+    unlink(path);
+}
+
+TEST_CASE(preadv_and_pwritev)
+{
+    char path[] = "/tmp/preadv.XXXXXX";
+    int fd = create_file_with_contents(path, "..........");
+
+    char first[] = "ab";
+    char second[] = "cde";
+    iovec write_vecs[] = { { first, 2 }, { second, 3 } };
+    EXPECT_EQ(pwritev(fd, write_vecs, 2, 3), 5);
+
+    char head[4] {};
+    char tail[8] {};
+    iovec read_vecs[] = { { head, 4 }, { tail, 8 } };
+    EXPECT_EQ(preadv(fd, read_vecs, 2, 1), 9);
+    EXPECT_EQ(memcmp(head, "..ab", 4), 0);
+    EXPECT_EQ(memcmp(tail, "cde..", 5), 0);
+
+    close(fd);
+    unlink(path);
+}
+
+TEST_CASE(positional_io_on_pipe)
+{
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    char buffer[4] {};
+    EXPECT_EQ(pread(fds[0], buffer, sizeof(buffer), 0), -1);
+    EXPECT_EQ(errno, ESPIPE);
+    EXPECT_EQ(pwrite(fds[1], buffer, sizeof(buffer), 0), -1);
+    EXPECT_EQ(errno, ESPIPE);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_CASE(copy_file_range_between_files)
+{
+    char source_path[] = "/tmp/copy_source.XXXXXX";
+    int source_fd = create_file_with_contents(source_path, "hello friends");
+    char destination_path[] = "/tmp/copy_destination.XXXXXX";
+    int destination_fd = create_file_with_contents(destination_path, "xxxxxxxx");
+
+    // With explicit offsets, neither file's own offset moves.
+    off_t offset_in = 6;
+    off_t offset_out = 2;
+    EXPECT_EQ(copy_file_range(source_fd, &offset_in, destination_fd, &offset_out, 4, 0), 4);
+    EXPECT_EQ(offset_in, 10);
+    EXPECT_EQ(offset_out, 6);
+    EXPECT_EQ(lseek(source_fd, 0, SEEK_CUR), 13);
+    EXPECT_EQ(lseek(destination_fd, 0, SEEK_CUR), 8);
+
+    char buffer[8] {};
+    EXPECT_EQ(pread(destination_fd, buffer, sizeof(buffer), 0), 8);
+    EXPECT_EQ(memcmp(buffer, "xxfriexx", 8), 0);
+
+    // Without offsets, both files' offsets are used and moved.
+    EXPECT_EQ(lseek(source_fd, 0, SEEK_SET), 0);
+    EXPECT_EQ(copy_file_range(source_fd, nullptr, destination_fd, nullptr, 100, 0), 13);
+    EXPECT_EQ(lseek(source_fd, 0, SEEK_CUR), 13);
+    EXPECT_EQ(lseek(destination_fd, 0, SEEK_CUR), 21);
+    EXPECT_EQ(copy_file_range(source_fd, nullptr, destination_fd, nullptr, 100, 0), 0);
+
+    close(source_fd);
+    close(destination_fd);
+    unlink(source_path);
+    unlink(destination_path);
+}
+
+TEST_CASE(copy_file_range_rejects_bad_ranges)
+{
+    char path[] = "/tmp/copy_overlap.XXXXXX";
+    int fd = create_file_with_contents(path, "0123456789");
+
+    // Overlapping ranges within the same file.
+    off_t offset_in = 0;
+    off_t offset_out = 4;
+    EXPECT_EQ(copy_file_range(fd, &offset_in, fd, &offset_out, 6, 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    // Ranges that don't overlap are fine.
+    offset_in = 0;
+    offset_out = 6;
+    EXPECT_EQ(copy_file_range(fd, &offset_in, fd, &offset_out, 4, 0), 4);
+    char buffer[10] {};
+    EXPECT_EQ(pread(fd, buffer, sizeof(buffer), 0), 10);
+    EXPECT_EQ(memcmp(buffer, "0123450123", 10), 0);
+
+    // An output offset doesn't go together with O_APPEND.
+    int append_fd = open(path, O_WRONLY | O_APPEND);
+    EXPECT(append_fd >= 0);
+    offset_in = 0;
+    offset_out = 0;
+    EXPECT_EQ(copy_file_range(fd, &offset_in, append_fd, &offset_out, 4, 0), -1);
+    EXPECT_EQ(errno, EBADF);
+
+    close(append_fd);
+    close(fd);
+    unlink(path);
+}
+
+TEST_CASE(sendfile_to_pipe)
+{
+    char path[] = "/tmp/sendfile.XXXXXX";
+    int fd = create_file_with_contents(path, "over the pipe");
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+
+    off_t offset = 5;
+    EXPECT_EQ(sendfile(fds[1], fd, &offset, 100), 8);
+    EXPECT_EQ(offset, 13);
+
+    char buffer[8] {};
+    EXPECT_EQ(read(fds[0], buffer, sizeof(buffer)), 8);
+    EXPECT_EQ(memcmp(buffer, "the pipe", 8), 0);
+
+    close(fds[0]);
+    close(fds[1]);
+    close(fd);
+    unlink(path);
+}
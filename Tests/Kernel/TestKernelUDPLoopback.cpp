@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+struct UDPPair {
+    UDPPair()
+    {
+        receiver = socket(AF_INET, SOCK_DGRAM, 0);
+        sender = socket(AF_INET, SOCK_DGRAM, 0);
+        VERIFY(receiver >= 0 && sender >= 0);
+
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        VERIFY(bind(receiver, (sockaddr*)&address, sizeof(address)) == 0);
+        socklen_t address_length = sizeof(address);
+        VERIFY(getsockname(receiver, (sockaddr*)&address, &address_length) == 0);
+    }
+    ~UDPPair()
+    {
+        close(receiver);
+        close(sender);
+    }
+
+    ssize_t send(const void* data, size_t size)
+    {
+        return sendto(sender, data, size, 0, (sockaddr*)&address, sizeof(address));
+    }
+
+    int receiver { -1 };
+    int sender { -1 };
+    sockaddr_in address {};
+};
+
+static void fill_pattern(u8* data, size_t size, u8 seed)
+{
+    for (size_t i = 0; i < size; ++i)
+        data[i] = (u8)(i * 31 + seed);
+}
+
+TEST_CASE(datagrams_of_many_sizes)
+{
+    UDPPair pair;
+    // Small datagrams get copied out of large receive buffers, big ones are kept in them.
+    static constexpr size_t sizes[] = { 1, 100, 1400, 4000, 20000, 60000 };
+    static u8 sent[60000];
+    static u8 received[60000];
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        fill_pattern(sent, sizes[i], i);
+        EXPECT_EQ(pair.send(sent, sizes[i]), (ssize_t)sizes[i]);
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        fill_pattern(sent, sizes[i], i);
+        EXPECT_EQ(recv(pair.receiver, received, sizeof(received), 0), (ssize_t)sizes[i]);
+        EXPECT_EQ(memcmp(sent, received, sizes[i]), 0);
+    }
+}
+
+TEST_CASE(peek_leaves_datagram_queued)
+{
+    UDPPair pair;
+    EXPECT_EQ(pair.send("hello", 5), 5);
+    EXPECT_EQ(pair.send("world", 5), 5);
+
+    char buffer[16] {};
+    EXPECT_EQ(recv(pair.receiver, buffer, sizeof(buffer), MSG_PEEK), 5);
+    EXPECT_EQ(memcmp(buffer, "hello", 5), 0);
+    memset(buffer, 0, sizeof(buffer));
+    EXPECT_EQ(recv(pair.receiver, buffer, sizeof(buffer), 0), 5);
+    EXPECT_EQ(memcmp(buffer, "hello", 5), 0);
+    EXPECT_EQ(recv(pair.receiver, buffer, sizeof(buffer), 0), 5);
+    EXPECT_EQ(memcmp(buffer, "world", 5), 0);
+}
+
+TEST_CASE(many_queued_datagrams)
+{
+    UDPPair pair;
+    // Each queued datagram holds on to a buffer of its own.
+    for (u32 i = 0; i < 200; ++i)
+        EXPECT_EQ(pair.send(&i, sizeof(i)), (ssize_t)sizeof(i));
+    for (u32 i = 0; i < 200; ++i) {
+        u32 value = 0;
+        EXPECT_EQ(recv(pair.receiver, &value, sizeof(value), 0), (ssize_t)sizeof(value));
+        EXPECT_EQ(value, i);
+    }
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Measures context switch throughput by bouncing a byte back and forth between pairs of
+// processes over pipes. Every round trip is two context switches. The number of pairs is
+// increased from 1 to the number of processors, which shows how well the scheduler scales.
+
+static void ping_pong(int read_fd, int write_fd, int round_trips, bool starts)
+{
+    char byte = 0;
+    for (int i = 0; i < round_trips; ++i) {
+        if (starts && write(write_fd, &byte, 1) != 1) {
+            perror("write");
+            _exit(1);
+        }
+        if (read(read_fd, &byte, 1) != 1) {
+            perror("read");
+            _exit(1);
+        }
+        if (!starts && write(write_fd, &byte, 1) != 1) {
+            perror("write");
+            _exit(1);
+        }
+    }
+}
+
+static pid_t spawn(int read_fd, int write_fd, int round_trips, bool starts, int fds_to_close[4])
+{
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0) {
+        for (int i = 0; i < 4; ++i) {
+            if (fds_to_close[i] != read_fd && fds_to_close[i] != write_fd)
+                close(fds_to_close[i]);
+        }
+        ping_pong(read_fd, write_fd, round_trips, starts);
+        _exit(0);
+    }
+    return pid;
+}
+
+static double run_pairs(int pair_count, int round_trips)
+{
+    Vector<pid_t> children;
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < pair_count; ++i) {
+        int ping[2];
+        int pong[2];
+        if (pipe(ping) < 0 || pipe(pong) < 0) {
+            perror("pipe");
+            exit(1);
+        }
+        int fds[4] = { ping[0], ping[1], pong[0], pong[1] };
+        children.append(spawn(pong[0], ping[1], round_trips, true, fds));
+        children.append(spawn(ping[0], pong[1], round_trips, false, fds));
+        for (int fd : fds)
+            close(fd);
+    }
+
+    for (auto pid : children) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) < 0) {
+            perror("waitpid");
+            exit(1);
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "Child %d failed\n", pid);
+            exit(1);
+        }
+    }
+
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    return (2.0 * round_trips * pair_count) / seconds;
+}
+
+int main(int argc, char** argv)
+{
+    int round_trips = 20000;
+    int max_pairs = sysconf(_SC_NPROCESSORS_ONLN);
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure context switch throughput with 1 to N pairs of processes.");
+    args_parser.add_option(round_trips, "Round trips per pair (default 20000)", "round-trips", 'r', "count");
+    args_parser.add_option(max_pairs, "Largest number of pairs to run at once (default: processor count)", "max-pairs", 'p', "count");
+    args_parser.parse(argc, argv);
+
+    if (round_trips <= 0 || max_pairs <= 0) {
+        fprintf(stderr, "Round trips and pairs must be positive\n");
+        return 1;
+    }
+
+    printf("%5s %16s %8s\n", "pairs", "switches/sec", "scaling");
+    fflush(stdout);
+    double single_pair_rate = 0;
+    for (int pairs = 1; pairs <= max_pairs; ++pairs) {
+        double rate = run_pairs(pairs, round_trips);
+        if (pairs == 1)
+            single_pair_rate = rate;
+        printf("%5d %16.0f %7.2fx\n", pairs, rate, rate / single_pair_rate);
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+// Stresses the physical page allocator from every processor at once. Each thread maps
+// anonymous memory, touches every page so that it gets backed by a physical page, and
+// unmaps it again, which hands all of those pages back to the allocator.
+
+static constexpr size_t page_size = 4096;
+
+struct ThreadContext {
+    int iterations { 0 };
+    size_t pages_per_iteration { 0 };
+    Atomic<bool>* go { nullptr };
+};
+
+static void* worker(void* argument)
+{
+    auto& context = *static_cast<ThreadContext*>(argument);
+    while (!context.go->load())
+        sched_yield();
+
+    size_t size = context.pages_per_iteration * page_size;
+    for (int i = 0; i < context.iterations; ++i) {
+        auto* memory = static_cast<u8*>(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0));
+        if (memory == MAP_FAILED) {
+            perror("mmap");
+            exit(1);
+        }
+        for (size_t offset = 0; offset < size; offset += page_size)
+            memory[offset] = static_cast<u8>(i);
+        if (munmap(memory, size) < 0) {
+            perror("munmap");
+            exit(1);
+        }
+    }
+    return nullptr;
+}
+
+static double run_threads(int thread_count, int iterations, size_t pages_per_iteration)
+{
+    Atomic<bool> go { false };
+    Vector<ThreadContext> contexts;
+    contexts.resize(thread_count);
+    Vector<pthread_t> threads;
+    threads.resize(thread_count);
+
+    for (int i = 0; i < thread_count; ++i) {
+        auto& context = contexts[i];
+        context.iterations = iterations;
+        context.pages_per_iteration = pages_per_iteration;
+        context.go = &go;
+        if (int rc = pthread_create(&threads[i], nullptr, worker, &context); rc != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+            exit(1);
+        }
+    }
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    go.store(true);
+    for (auto thread : threads)
+        pthread_join(thread, nullptr);
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    return (static_cast<double>(iterations) * pages_per_iteration * thread_count) / seconds;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 2000;
+    int pages_per_iteration = 64;
+    int max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure physical page allocation throughput with 1 to N threads.");
+    args_parser.add_option(iterations, "Map/touch/unmap rounds per thread (default 2000)", "iterations", 'i', "count");
+    args_parser.add_option(pages_per_iteration, "Pages touched per round (default 64)", "pages", 'p', "count");
+    args_parser.add_option(max_threads, "Largest number of threads to run at once (default: processor count)", "max-threads", 't', "count");
+    args_parser.parse(argc, argv);
+
+    if (iterations <= 0 || pages_per_iteration <= 0 || max_threads <= 0) {
+        fprintf(stderr, "Iterations, pages and threads must be positive\n");
+        return 1;
+    }
+
+    printf("%7s %14s %8s\n", "threads", "pages/sec", "scaling");
+    double single_thread_rate = 0;
+    for (int threads = 1; threads <= max_threads; ++threads) {
+        double rate = run_threads(threads, iterations, pages_per_iteration);
+        if (threads == 1)
+            single_thread_rate = rate;
+        printf("%7d %14.0f %7.2fx\n", threads, rate, rate / single_thread_rate);
+    }
+    return 0;
+}
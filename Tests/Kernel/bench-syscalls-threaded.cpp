@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+// Measures how well syscalls that don't need the process big lock scale when every thread
+// of a single process hammers them at the same time. Each workload is run with 1 to N threads.
+
+struct Workload {
+    const char* name;
+    void (*run_one)(int fd);
+};
+
+static void read_zero(int fd)
+{
+    char buffer[64];
+    if (read(fd, buffer, sizeof(buffer)) != sizeof(buffer)) {
+        perror("read");
+        exit(1);
+    }
+}
+
+static void get_time(int)
+{
+    timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0) {
+        perror("clock_gettime");
+        exit(1);
+    }
+}
+
+static void map_and_unmap(int)
+{
+    void* address = mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    if (address == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+    if (munmap(address, 4096) < 0) {
+        perror("munmap");
+        exit(1);
+    }
+}
+
+static const Workload s_workloads[] = {
+    { "read", read_zero },
+    { "clock_gettime", get_time },
+    { "mmap+munmap", map_and_unmap },
+};
+
+struct ThreadContext {
+    const Workload* workload { nullptr };
+    int iterations { 0 };
+    int fd { -1 };
+    Atomic<bool>* go { nullptr };
+};
+
+static void* worker(void* argument)
+{
+    auto& context = *static_cast<ThreadContext*>(argument);
+    while (!context.go->load())
+        sched_yield();
+    for (int i = 0; i < context.iterations; ++i)
+        context.workload->run_one(context.fd);
+    return nullptr;
+}
+
+static double run_workload(const Workload& workload, int thread_count, int iterations)
+{
+    Atomic<bool> go { false };
+    Vector<ThreadContext> contexts;
+    contexts.resize(thread_count);
+    Vector<pthread_t> threads;
+    threads.resize(thread_count);
+
+    for (int i = 0; i < thread_count; ++i) {
+        auto& context = contexts[i];
+        context.workload = &workload;
+        context.iterations = iterations;
+        context.go = &go;
+        context.fd = open("/dev/zero", O_RDONLY);
+        if (context.fd < 0) {
+            perror("open");
+            exit(1);
+        }
+        if (int rc = pthread_create(&threads[i], nullptr, worker, &context); rc != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+            exit(1);
+        }
+    }
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    go.store(true);
+    for (auto thread : threads)
+        pthread_join(thread, nullptr);
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (auto& context : contexts)
+        close(context.fd);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    return (static_cast<double>(iterations) * thread_count) / seconds;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 100000;
+    int max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure syscall throughput with 1 to N threads of the same process.");
+    args_parser.add_option(iterations, "Syscalls per thread (default 100000)", "iterations", 'i', "count");
+    args_parser.add_option(max_threads, "Largest number of threads to run at once (default: processor count)", "max-threads", 't', "count");
+    args_parser.parse(argc, argv);
+
+    if (iterations <= 0 || max_threads <= 0) {
+        fprintf(stderr, "Iterations and threads must be positive\n");
+        return 1;
+    }
+
+    printf("%-14s %7s %14s %8s\n", "syscall", "threads", "ops/sec", "scaling");
+    for (auto& workload : s_workloads) {
+        double single_thread_rate = 0;
+        for (int threads = 1; threads <= max_threads; ++threads) {
+            double rate = run_workload(workload, threads, iterations);
+            if (threads == 1)
+                single_thread_rate = rate;
+            printf("%-14s %7d %14.0f %7.2fx\n", workload.name, threads, rate, rate / single_thread_rate);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/JsonValue.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/File.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Measures TCP throughput over the loopback adapter by sending a known byte pattern from
+// one process to another, which checks that every byte arrives in order. With --loss, the
+// loopback adapter drops some packets on purpose, which exercises fast retransmit and SACK.
+
+static constexpr size_t chunk_size = 64 * KiB;
+
+static u8 pattern_byte(size_t offset)
+{
+    return (u8)((offset * 7) ^ (offset >> 13));
+}
+
+static bool set_packet_loss(bool enabled)
+{
+    int fd = open("/proc/sys/loopback_packet_loss", O_WRONLY);
+    if (fd < 0) {
+        perror("open /proc/sys/loopback_packet_loss");
+        return false;
+    }
+    bool ok = write(fd, enabled ? "1" : "0", 1) == 1;
+    if (!ok)
+        perror("write /proc/sys/loopback_packet_loss");
+    close(fd);
+    return ok;
+}
+
+static int listen_on_loopback(u16& port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        exit(1);
+    }
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    if (bind(fd, (sockaddr*)&address, sizeof(address)) < 0 || listen(fd, 1) < 0) {
+        perror("bind/listen");
+        exit(1);
+    }
+    socklen_t address_length = sizeof(address);
+    if (getsockname(fd, (sockaddr*)&address, &address_length) < 0) {
+        perror("getsockname");
+        exit(1);
+    }
+    port = ntohs(address.sin_port);
+    return fd;
+}
+
+static void receive_and_verify(int listen_fd, size_t total_size)
+{
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+        perror("accept");
+        _exit(1);
+    }
+    close(listen_fd);
+
+    auto* buffer = (u8*)malloc(chunk_size);
+    size_t received = 0;
+    while (received < total_size) {
+        ssize_t nread = read(fd, buffer, chunk_size);
+        if (nread < 0) {
+            perror("read");
+            _exit(1);
+        }
+        if (nread == 0)
+            break;
+        for (ssize_t i = 0; i < nread; ++i) {
+            if (buffer[i] != pattern_byte(received + i)) {
+                fprintf(stderr, "Wrong byte at offset %zu\n", received + i);
+                _exit(1);
+            }
+        }
+        received += nread;
+    }
+    if (received != total_size) {
+        fprintf(stderr, "Received %zu bytes, expected %zu\n", received, total_size);
+        _exit(1);
+    }
+    close(fd);
+    _exit(0);
+}
+
+static void print_socket_statistics(u16 local_port)
+{
+    auto file = Core::File::construct("/proc/net/tcp");
+    if (!file->open(Core::OpenMode::ReadOnly))
+        return;
+    auto json = JsonValue::from_string(file->read_all());
+    if (!json.has_value() || !json.value().is_array())
+        return;
+    json.value().as_array().for_each([&](auto& value) {
+        auto& socket = value.as_object();
+        if (socket.get("local_port").to_u32() != local_port)
+            return;
+        printf("retransmits: %u, congestion window: %u, slow start threshold: %u\n",
+            socket.get("retransmits").to_u32(),
+            socket.get("congestion_window").to_u32(),
+            socket.get("slow_start_threshold").to_u32());
+    });
+}
+
+int main(int argc, char** argv)
+{
+    int megabytes = 64;
+    bool with_loss = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure TCP throughput over the loopback adapter.");
+    args_parser.add_option(megabytes, "Megabytes to transfer (default 64)", "size", 's', "megabytes");
+    args_parser.add_option(with_loss, "Make the loopback adapter drop some packets", "loss", 'l');
+    args_parser.parse(argc, argv);
+
+    if (megabytes <= 0) {
+        fprintf(stderr, "Size must be positive\n");
+        return 1;
+    }
+    size_t total_size = (size_t)megabytes * MiB;
+
+    u16 port = 0;
+    int listen_fd = listen_on_loopback(port);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (pid == 0)
+        receive_and_verify(listen_fd, total_size);
+    close(listen_fd);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (fd < 0 || connect(fd, (sockaddr*)&address, sizeof(address)) < 0) {
+        perror("connect");
+        return 1;
+    }
+    socklen_t address_length = sizeof(address);
+    if (getsockname(fd, (sockaddr*)&address, &address_length) < 0) {
+        perror("getsockname");
+        return 1;
+    }
+    u16 local_port = ntohs(address.sin_port);
+
+    if (with_loss && !set_packet_loss(true))
+        return 1;
+
+    auto* buffer = (u8*)malloc(chunk_size);
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    size_t sent = 0;
+    bool failed = false;
+    while (sent < total_size) {
+        size_t size = min(chunk_size, total_size - sent);
+        for (size_t i = 0; i < size; ++i)
+            buffer[i] = pattern_byte(sent + i);
+        size_t chunk_sent = 0;
+        while (chunk_sent < size) {
+            ssize_t nwritten = write(fd, buffer + chunk_sent, size - chunk_sent);
+            if (nwritten < 0) {
+                perror("write");
+                failed = true;
+                break;
+            }
+            chunk_sent += nwritten;
+        }
+        if (failed)
+            break;
+        sent += size;
+    }
+
+    print_socket_statistics(local_port);
+    close(fd);
+
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0) {
+        perror("waitpid");
+        failed = true;
+    } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "Receiver failed\n");
+        failed = true;
+    }
+
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (with_loss)
+        set_packet_loss(false);
+    if (failed)
+        return 1;
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%d MiB in %.2f s: %.2f MiB/s%s\n", megabytes, seconds, megabytes / seconds, with_loss ? " (with packet loss)" : "");
+    return 0;
+}
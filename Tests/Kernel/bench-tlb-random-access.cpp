@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/ArgsParser.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+// Measures the cost of TLB misses by reading from random places in a large buffer.
+// The same buffer size is mapped with 4 KiB pages, with large pages that are faulted in
+// on first access, and with large pages that are allocated right away by MAP_LARGE_PAGES.
+
+struct Mapping {
+    const char* name;
+    int flags;
+};
+
+static const Mapping s_mappings[] = {
+    // Memory that isn't reserved up front is faulted in one page at a time.
+    { "4 KiB pages", MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE },
+    { "on first access", MAP_ANONYMOUS | MAP_PRIVATE },
+    { "MAP_LARGE_PAGES", MAP_ANONYMOUS | MAP_PRIVATE | MAP_LARGE_PAGES },
+};
+
+static double run_mapping(const Mapping& mapping, size_t size, size_t accesses)
+{
+    auto* buffer = (u64*)mmap(nullptr, size, PROT_READ | PROT_WRITE, mapping.flags, 0, 0);
+    if (buffer == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+
+    // Touch everything first so that only TLB misses are measured, not page faults.
+    size_t count = size / sizeof(u64);
+    for (size_t i = 0; i < count; i += 4096 / sizeof(u64))
+        buffer[i] = i;
+
+    u32 state = 2463534242;
+    u64 sum = 0;
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < accesses; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        sum += buffer[state % count];
+    }
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // Keep the compiler from throwing the loop away.
+    if (sum == 1)
+        printf("\n");
+
+    if (munmap(buffer, size) < 0) {
+        perror("munmap");
+        exit(1);
+    }
+
+    double nanoseconds = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    return nanoseconds / accesses;
+}
+
+int main(int argc, char** argv)
+{
+    int size_in_mib = 1024;
+    int accesses = 20000000;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure random access latency over a large buffer with small and large pages.");
+    args_parser.add_option(size_in_mib, "Buffer size in MiB (default 1024)", "size", 's', "MiB");
+    args_parser.add_option(accesses, "Random reads per run (default 20000000)", "accesses", 'a', "count");
+    args_parser.parse(argc, argv);
+
+    if (size_in_mib <= 0 || accesses <= 0) {
+        fprintf(stderr, "Size and accesses must be positive\n");
+        return 1;
+    }
+
+    size_t size = (size_t)size_in_mib * 1024 * 1024;
+    printf("%-16s %12s\n", "mapping", "ns/access");
+    fflush(stdout);
+    for (auto& mapping : s_mappings) {
+        double latency = run_mapping(mapping, size, accesses);
+        printf("%-16s %12.2f\n", mapping.name, latency);
+        fflush(stdout);
+    }
+    return 0;
+}
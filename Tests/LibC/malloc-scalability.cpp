@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Measures how malloc() and free() scale with the number of threads. In the "local" workload
+// every thread frees what it allocated itself. In the "producer/consumer" workload half of the
+// threads allocate and hand everything to a partner thread, which frees it.
+
+static constexpr size_t ring_size = 256;
+
+struct Ring {
+    Atomic<void*> slots[ring_size];
+};
+
+struct ThreadContext {
+    int iterations { 0 };
+    Ring* ring { nullptr };
+    Atomic<bool>* go { nullptr };
+};
+
+static size_t allocation_size(int i)
+{
+    // Mostly small allocations, like most programs make.
+    return 8 + (i * 37) % 500;
+}
+
+static void wait_for_go(ThreadContext& context)
+{
+    while (!context.go->load())
+        sched_yield();
+}
+
+static void* local_worker(void* argument)
+{
+    auto& context = *static_cast<ThreadContext*>(argument);
+    wait_for_go(context);
+    void* pointers[16];
+    for (int i = 0; i < context.iterations; i += 16) {
+        for (int j = 0; j < 16; ++j) {
+            pointers[j] = malloc(allocation_size(i + j));
+            memset(pointers[j], 0, 8);
+        }
+        for (auto* pointer : pointers)
+            free(pointer);
+    }
+    return nullptr;
+}
+
+static void* producer_worker(void* argument)
+{
+    auto& context = *static_cast<ThreadContext*>(argument);
+    wait_for_go(context);
+    for (int i = 0; i < context.iterations; ++i) {
+        void* pointer = malloc(allocation_size(i));
+        memset(pointer, 0, 8);
+        auto& slot = context.ring->slots[i % ring_size];
+        void* expected = nullptr;
+        while (!slot.compare_exchange_strong(expected, pointer)) {
+            expected = nullptr;
+            sched_yield();
+        }
+    }
+    return nullptr;
+}
+
+static void* consumer_worker(void* argument)
+{
+    auto& context = *static_cast<ThreadContext*>(argument);
+    wait_for_go(context);
+    for (int i = 0; i < context.iterations; ++i) {
+        auto& slot = context.ring->slots[i % ring_size];
+        void* pointer;
+        while (!(pointer = slot.exchange(nullptr)))
+            sched_yield();
+        free(pointer);
+    }
+    return nullptr;
+}
+
+using Worker = void* (*)(void*);
+
+struct Workload {
+    const char* name;
+    // Threads are started in groups of this many, which share a ring.
+    int threads_per_unit;
+    Worker (*worker_for_thread)(int thread_index);
+};
+
+static const Workload s_workloads[] = {
+    { "local", 1, [](int) -> Worker { return local_worker; } },
+    { "producer/consumer", 2, [](int thread_index) -> Worker { return thread_index % 2 ? consumer_worker : producer_worker; } },
+};
+
+static double run_workload(const Workload& workload, int thread_count, int iterations)
+{
+    Atomic<bool> go { false };
+    Vector<Ring*> rings;
+    Vector<ThreadContext> contexts;
+    contexts.resize(thread_count);
+    Vector<pthread_t> threads;
+    threads.resize(thread_count);
+
+    for (int i = 0; i < thread_count; ++i) {
+        auto& context = contexts[i];
+        context.iterations = iterations;
+        context.go = &go;
+        if (i % workload.threads_per_unit == 0) {
+            auto* ring = new Ring;
+            for (auto& slot : ring->slots)
+                slot.store(nullptr);
+            rings.append(ring);
+        }
+        context.ring = rings.last();
+        if (int rc = pthread_create(&threads[i], nullptr, workload.worker_for_thread(i), &context); rc != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+            exit(1);
+        }
+    }
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    go.store(true);
+    for (auto thread : threads)
+        pthread_join(thread, nullptr);
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (auto* ring : rings)
+        delete ring;
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    // Count one malloc() and one free() as one operation.
+    double operations = static_cast<double>(iterations) * thread_count / workload.threads_per_unit;
+    return operations / seconds;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 200000;
+    int max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure malloc/free throughput with 1 to N threads.");
+    args_parser.add_option(iterations, "Allocations per thread (default 200000)", "iterations", 'i', "count");
+    args_parser.add_option(max_threads, "Largest number of threads to run at once (default: processor count)", "max-threads", 't', "count");
+    args_parser.parse(argc, argv);
+
+    if (iterations <= 0 || max_threads <= 0) {
+        fprintf(stderr, "Iterations and threads must be positive\n");
+        return 1;
+    }
+
+    printf("%-18s %7s %14s %8s\n", "workload", "threads", "allocs/sec", "scaling");
+    for (auto& workload : s_workloads) {
+        double single_unit_rate = 0;
+        for (int threads = workload.threads_per_unit; threads <= max(max_threads, workload.threads_per_unit); threads += workload.threads_per_unit) {
+            double rate = run_workload(workload, threads, iterations);
+            if (threads == workload.threads_per_unit)
+                single_unit_rate = rate;
+            printf("%-18s %7d %14.0f %7.2fx\n", workload.name, threads, rate, rate / single_unit_rate);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/Array.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/MarkedValueList.h>
+#include <LibJS/Runtime/PrimitiveString.h>
+
+// Most of what gets allocated here dies young, with a small working set that keeps getting replaced.
+static StringView const churn_source = R"(
+var keep = [];
+for (var i = 0; i < 50000; i++) {
+    var object = { index: i, label: "item" + i };
+    var array = [i, i + 1, i + 2, object];
+    var string = object.label + "/" + array.length;
+    keep[i % 64] = { object: object, array: array, string: string };
+}
+keep[63].string;
+)"sv;
+
+static String run_script(StringView source)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto parser = JS::Parser(JS::Lexer(source));
+    auto program = parser.parse_program();
+    VERIFY(!parser.has_errors());
+    interpreter->run(interpreter->global_object(), *program);
+    VERIFY(!vm->exception());
+    return vm->last_value().to_string_without_side_effects();
+}
+
+TEST_CASE(cells_survive_allocation_churn)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto& global_object = interpreter->global_object();
+
+    JS::MarkedValueList kept_alive(vm->heap());
+    for (size_t i = 0; i < 100000; ++i) {
+        auto* object = JS::Object::create_empty(global_object);
+        object->put("index", JS::Value(static_cast<double>(i)));
+        if (i % 1000 == 0)
+            kept_alive.append(object);
+        JS::js_string(*vm, String::number(i));
+        JS::Array::create(global_object, 4);
+    }
+    vm->heap().collect_garbage();
+
+    for (size_t i = 0; i < kept_alive.size(); ++i)
+        EXPECT_EQ(kept_alive[i].as_object().get("index").as_double(), static_cast<double>(i * 1000));
+}
+
+BENCHMARK_CASE(object_array_and_string_churn)
+{
+    auto result = run_script(churn_source);
+    EXPECT_EQ(result, "item49983/4");
+}
+
+BENCHMARK_CASE(raw_cell_allocation)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto& global_object = interpreter->global_object();
+    for (size_t i = 0; i < 1000000; ++i) {
+        JS::Object::create_empty(global_object);
+        JS::js_string(*vm, "string");
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/Array.h>
+#include <LibJS/Runtime/GlobalObject.h>
+
+static StringView const numeric_array_source = R"(
+var numbers = [];
+for (var i = 0; i < 20000; i++)
+    numbers.push((i * 7919) % 20000);
+var doubled = numbers.map(function (x) { return x * 2; });
+var sum = doubled.reduce(function (a, b) { return a + b; }, 0);
+var found = 0;
+for (var j = 0; j < 200; j++)
+    found += numbers.indexOf(j * 97);
+numbers.sort();
+sum + "/" + found + "/" + numbers[0] + "/" + numbers[19999];
+)"sv;
+
+static String run_script(StringView source)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto parser = JS::Parser(JS::Lexer(source));
+    auto program = parser.parse_program();
+    VERIFY(!parser.has_errors());
+    interpreter->run(interpreter->global_object(), *program);
+    VERIFY(!vm->exception());
+    return vm->last_value().to_string_without_side_effects();
+}
+
+TEST_CASE(element_kinds_only_generalize)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto& global_object = interpreter->global_object();
+
+    auto* array = JS::Array::create(global_object);
+    auto& indexed_properties = array->indexed_properties();
+    auto element_kind = [&] { return indexed_properties.simple_storage()->element_kind(); };
+
+    indexed_properties.append(JS::Value(1));
+    indexed_properties.append(JS::Value(2));
+    EXPECT(element_kind() == JS::ElementKind::PackedInt32);
+
+    indexed_properties.append(JS::Value(2.5));
+    EXPECT(element_kind() == JS::ElementKind::PackedDouble);
+
+    // Integral doubles are stored as Int32 values, but the kind doesn't go back.
+    indexed_properties.put(array, 2, JS::Value(3.0));
+    EXPECT(element_kind() == JS::ElementKind::PackedDouble);
+
+    indexed_properties.put(array, 5, JS::Value(6));
+    EXPECT(element_kind() == JS::ElementKind::HoleyDouble);
+
+    indexed_properties.put(array, 0, JS::js_undefined());
+    EXPECT(element_kind() == JS::ElementKind::HoleyAny);
+
+    indexed_properties.set_array_like_size(0);
+    EXPECT(element_kind() == JS::ElementKind::PackedInt32);
+}
+
+BENCHMARK_CASE(numeric_array_builtins)
+{
+    auto result = run_script(numeric_array_source);
+    EXPECT_EQ(result, "399980000/2013700/0/9999");
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/GlobalObject.h>
+
+using DispatchMode = JS::Bytecode::Interpreter::DispatchMode;
+
+static StringView const loop_source = R"(
+var sum = 0;
+for (var i = 0; i < 300000; i++) {
+    if (i % 3 == 0)
+        sum = sum + i;
+    else
+        sum = sum - 1;
+}
+sum;
+)"sv;
+
+static StringView const call_source = R"(
+function add(a, b) {
+    return a + b;
+}
+function fib(n) {
+    if (n < 2)
+        return n;
+    return add(fib(n - 1), fib(n - 2));
+}
+fib(20);
+)"sv;
+
+static StringView const exception_source = R"(
+var caught = 0;
+for (var i = 0; i < 100; i++) {
+    try {
+        if (i % 2)
+            undefinedFunction();
+        caught = caught + 100;
+    } catch (e) {
+        caught = caught + 1;
+    }
+}
+caught;
+)"sv;
+
+static JS::Value run_bytecode(StringView source, DispatchMode mode)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto parser = JS::Parser(JS::Lexer(source));
+    auto program = parser.parse_program();
+    VERIFY(!parser.has_errors());
+
+    auto executable = JS::Bytecode::Generator::generate(*program);
+    JS::Bytecode::Interpreter bytecode_interpreter(interpreter->global_object());
+    bytecode_interpreter.set_dispatch_mode(mode);
+    bytecode_interpreter.run(executable);
+    VERIFY(!vm->exception());
+    return vm->last_value();
+}
+
+TEST_CASE(dispatch_modes_agree)
+{
+    for (auto source : { loop_source, call_source, exception_source }) {
+        auto switch_result = run_bytecode(source, DispatchMode::Switch);
+        auto threaded_result = run_bytecode(source, DispatchMode::Threaded);
+        EXPECT(switch_result.is_number());
+        EXPECT_EQ(switch_result.as_double(), threaded_result.as_double());
+    }
+}
+
+BENCHMARK_CASE(loop_with_switch_dispatch)
+{
+    run_bytecode(loop_source, DispatchMode::Switch);
+}
+
+BENCHMARK_CASE(loop_with_threaded_dispatch)
+{
+    run_bytecode(loop_source, DispatchMode::Threaded);
+}
+
+BENCHMARK_CASE(calls_with_switch_dispatch)
+{
+    run_bytecode(call_source, DispatchMode::Switch);
+}
+
+BENCHMARK_CASE(calls_with_threaded_dispatch)
+{
+    run_bytecode(call_source, DispatchMode::Threaded);
+}
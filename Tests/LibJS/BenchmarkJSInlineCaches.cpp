@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/GlobalObject.h>
+
+// Objects with two different shapes are accessed from the same GetById/PutById instructions,
+// which exercises the polymorphic part of the inline caches.
+static StringView const property_heavy_source = R"(
+var points = [];
+for (var i = 0; i < 8; i++) {
+    var point = {};
+    if (i % 2)
+        point.tag = i;
+    point.x = i;
+    point.y = i * 2;
+    points[i] = point;
+}
+var sum = 0;
+for (var j = 0; j < 100000; j++) {
+    var p = points[j % 8];
+    p.x = p.x + 1;
+    sum = sum + p.x + p.y;
+}
+sum;
+)"sv;
+
+static JS::Value run_bytecode(StringView source, bool inline_caches_enabled, JS::Bytecode::InlineCacheStatistics& statistics)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto parser = JS::Parser(JS::Lexer(source));
+    auto program = parser.parse_program();
+    VERIFY(!parser.has_errors());
+
+    auto executable = JS::Bytecode::Generator::generate(*program);
+    JS::Bytecode::Interpreter bytecode_interpreter(interpreter->global_object());
+    bytecode_interpreter.set_inline_caches_enabled(inline_caches_enabled);
+    bytecode_interpreter.run(executable);
+    VERIFY(!vm->exception());
+    statistics = bytecode_interpreter.inline_cache_statistics();
+    return vm->last_value();
+}
+
+TEST_CASE(inline_caches_do_not_change_results)
+{
+    JS::Bytecode::InlineCacheStatistics cached_statistics;
+    JS::Bytecode::InlineCacheStatistics uncached_statistics;
+    auto cached_result = run_bytecode(property_heavy_source, true, cached_statistics);
+    auto uncached_result = run_bytecode(property_heavy_source, false, uncached_statistics);
+
+    EXPECT(cached_result.is_number());
+    EXPECT_EQ(cached_result.as_double(), uncached_result.as_double());
+    EXPECT_EQ(uncached_statistics.hits, 0u);
+    EXPECT(cached_statistics.hits > 100 * cached_statistics.misses);
+}
+
+BENCHMARK_CASE(property_access_with_inline_caches)
+{
+    JS::Bytecode::InlineCacheStatistics statistics;
+    run_bytecode(property_heavy_source, true, statistics);
+    auto total = statistics.hits + statistics.misses;
+    warnln("Inline cache hits: {}, misses: {} ({}% hit rate)", statistics.hits, statistics.misses, total ? statistics.hits * 100 / total : 0);
+}
+
+BENCHMARK_CASE(property_access_without_inline_caches)
+{
+    JS::Bytecode::InlineCacheStatistics statistics;
+    run_bytecode(property_heavy_source, false, statistics);
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/MarkedValueList.h>
+#include <LibJS/Runtime/Shape.h>
+
+// Lots of objects that are built up property by property along the same long transition chain,
+// plus a few that have options added and removed all the time.
+static StringView const config_objects_source = R"(
+var configs = [];
+for (var i = 0; i < 2000; i++) {
+    var config = {};
+    for (var j = 0; j < 60; j++)
+        config["option" + j] = i + j;
+    configs.push(config);
+}
+var overrides = {};
+for (var i = 0; i < 20000; i++) {
+    overrides["override" + (i % 300)] = i;
+    if (i % 3 == 0)
+        delete overrides["override" + ((i + 150) % 300)];
+}
+var sum = 0;
+for (var i = 0; i < configs.length; i++)
+    sum += configs[i].option0 + configs[i].option59;
+sum + "/" + Object.keys(overrides).length;
+)"sv;
+
+static String run_script(StringView source)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto parser = JS::Parser(JS::Lexer(source));
+    auto program = parser.parse_program();
+    VERIFY(!parser.has_errors());
+    interpreter->run(interpreter->global_object(), *program);
+    VERIFY(!vm->exception());
+    return vm->last_value().to_string_without_side_effects();
+}
+
+TEST_CASE(shapes_sharing_a_property_table)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto& global_object = interpreter->global_object();
+
+    auto* short_object = JS::Object::create_empty(global_object);
+    short_object->put("a", JS::Value(1));
+    short_object->put("b", JS::Value(2));
+    auto* long_object = JS::Object::create_empty(global_object);
+    long_object->put("a", JS::Value(1));
+    long_object->put("b", JS::Value(2));
+    long_object->put("c", JS::Value(3));
+    auto* branched_object = JS::Object::create_empty(global_object);
+    branched_object->put("a", JS::Value(1));
+    branched_object->put("b", JS::Value(2));
+    branched_object->put("d", JS::Value(4));
+
+    EXPECT(!short_object->shape().lookup("c").has_value());
+    EXPECT_EQ(long_object->shape().lookup("c").value().offset, 2u);
+    EXPECT(!branched_object->shape().lookup("c").has_value());
+    EXPECT_EQ(branched_object->shape().lookup("d").value().offset, 2u);
+    EXPECT_EQ(long_object->shape().property_table_ordered().size(), 3u);
+    EXPECT_EQ(long_object->get("c").as_i32(), 3);
+    EXPECT_EQ(branched_object->get("d").as_i32(), 4);
+}
+
+TEST_CASE(too_many_transitions_make_objects_unique)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto& global_object = interpreter->global_object();
+
+    JS::MarkedValueList objects(vm->heap());
+    for (size_t i = 0; i <= JS::Shape::max_forward_transitions; ++i) {
+        auto* object = JS::Object::create_empty(global_object);
+        object->put(String::formatted("key{}", i), JS::Value(static_cast<i32>(i)));
+        objects.append(object);
+    }
+    EXPECT(!objects.first().as_object().shape().is_unique());
+    EXPECT(objects.last().as_object().shape().is_unique());
+    EXPECT_EQ(objects.last().as_object().get(String::formatted("key{}", JS::Shape::max_forward_transitions)).as_i32(), static_cast<i32>(JS::Shape::max_forward_transitions));
+}
+
+BENCHMARK_CASE(config_objects)
+{
+    auto result = run_script(config_objects_source);
+    EXPECT_EQ(result, "4116000/250");
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/PassManager.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/GlobalObject.h>
+
+using namespace JS::Bytecode;
+using OptimizationLevel = Interpreter::OptimizationLevel;
+
+static Executable make_executable(size_t block_count)
+{
+    Executable executable { {}, make<StringTable>(), 8, {} };
+    for (size_t i = 0; i < block_count; ++i)
+        executable.basic_blocks.append(BasicBlock::create(String::number(i)));
+    return executable;
+}
+
+template<typename OpType, typename... Args>
+static void append(BasicBlock& block, Args&&... args)
+{
+    void* slot = block.next_slot();
+    block.grow(sizeof(OpType));
+    new (slot) OpType(forward<Args>(args)...);
+}
+
+// One line per instruction, prefixed with the name of its block, so whole executables can be compared at once.
+static Vector<String> describe(Executable const& executable)
+{
+    Vector<String> lines;
+    for (auto& block : executable.basic_blocks) {
+        InstructionStreamIterator it(block.instruction_stream());
+        while (!it.at_end()) {
+            lines.append(String::formatted("{}: {}", block.name(), (*it).to_string(executable)));
+            ++it;
+        }
+    }
+    return lines;
+}
+
+static void expect_bytecode(Executable const& executable, Vector<String> const& expected)
+{
+    auto actual = describe(executable);
+    EXPECT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < min(actual.size(), expected.size()); ++i)
+        EXPECT_EQ(actual[i], expected[i]);
+}
+
+template<typename... Passes>
+static void perform(Executable& executable)
+{
+    PassManager passes;
+    (passes.add<Passes>(), ...);
+    passes.perform(executable);
+}
+
+TEST_CASE(thread_jumps)
+{
+    auto executable = make_executable(4);
+    auto& blocks = executable.basic_blocks;
+    append<Op::JumpConditional>(blocks[0], Label { blocks[1] }, Label { blocks[3] });
+    append<Op::Jump>(blocks[1], Label { blocks[2] });
+    append<Op::Jump>(blocks[2], Label { blocks[3] });
+    append<Op::Return>(blocks[3]);
+
+    // Both trampolines get skipped, but stay around until they're found to be unreachable.
+    perform<Passes::ThreadJumps>(executable);
+    expect_bytecode(executable, {
+                                    "0: JumpConditional true:@3 false:@3",
+                                    "1: Jump @3",
+                                    "2: Jump @3",
+                                    "3: Return",
+                                });
+}
+
+TEST_CASE(thread_jumps_gives_up_on_cycles)
+{
+    auto executable = make_executable(3);
+    auto& blocks = executable.basic_blocks;
+    append<Op::Jump>(blocks[0], Label { blocks[1] });
+    append<Op::Jump>(blocks[1], Label { blocks[2] });
+    append<Op::Jump>(blocks[2], Label { blocks[1] });
+
+    perform<Passes::ThreadJumps>(executable);
+    expect_bytecode(executable, {
+                                    "0: Jump @1",
+                                    "1: Jump @2",
+                                    "2: Jump @1",
+                                });
+}
+
+TEST_CASE(eliminate_unreachable_blocks)
+{
+    auto executable = make_executable(4);
+    auto& blocks = executable.basic_blocks;
+    append<Op::Jump>(blocks[0], Label { blocks[2] });
+    // Only reachable from itself.
+    append<Op::Jump>(blocks[1], Label { blocks[1] });
+    append<Op::Return>(blocks[2]);
+    append<Op::Jump>(blocks[3], Label { blocks[2] });
+
+    perform<Passes::GenerateCFG, Passes::EliminateUnreachableBlocks>(executable);
+    expect_bytecode(executable, {
+                                    "0: Jump @2",
+                                    "2: Return",
+                                });
+}
+
+TEST_CASE(merge_blocks)
+{
+    auto executable = make_executable(4);
+    auto& blocks = executable.basic_blocks;
+    append<Op::LoadImmediate>(blocks[0], JS::Value(1));
+    append<Op::Jump>(blocks[0], Label { blocks[1] });
+    append<Op::Store>(blocks[1], Register(2));
+    append<Op::JumpConditional>(blocks[1], Label { blocks[2] }, Label { blocks[3] });
+    append<Op::Jump>(blocks[2], Label { blocks[3] });
+    append<Op::Return>(blocks[3]);
+
+    // Block 1 only has block 0 as its predecessor, but block 3 has two.
+    perform<Passes::GenerateCFG, Passes::MergeBlocks>(executable);
+    expect_bytecode(executable, {
+                                    "0: LoadImmediate 1",
+                                    "0: Store $2",
+                                    "0: JumpConditional true:@2 false:@3",
+                                    "2: Jump @3",
+                                    "3: Return",
+                                });
+}
+
+TEST_CASE(merge_blocks_keeps_the_entry_block)
+{
+    auto executable = make_executable(3);
+    auto& blocks = executable.basic_blocks;
+    append<Op::JumpConditional>(blocks[0], Label { blocks[1] }, Label { blocks[2] });
+    append<Op::Jump>(blocks[1], Label { blocks[0] });
+    append<Op::Return>(blocks[2]);
+
+    // Block 1 is the only predecessor of the entry block, but mustn't swallow it.
+    perform<Passes::GenerateCFG, Passes::MergeBlocks>(executable);
+    expect_bytecode(executable, {
+                                    "0: JumpConditional true:@1 false:@2",
+                                    "1: Jump @0",
+                                    "2: Return",
+                                });
+}
+
+TEST_CASE(eliminate_redundant_moves)
+{
+    auto executable = make_executable(1);
+    auto& block = executable.basic_blocks[0];
+    append<Op::Store>(block, Register(2));
+    append<Op::Load>(block, Register(2));
+    append<Op::Load>(block, Register(3));
+    append<Op::Store>(block, Register(3));
+    append<Op::LoadImmediate>(block, JS::Value(1));
+    append<Op::LoadImmediate>(block, JS::Value(2));
+    append<Op::Add>(block, Register(2));
+    append<Op::Return>(block);
+
+    perform<Passes::EliminateRedundantMoves>(executable);
+    expect_bytecode(executable, {
+                                    "0: Store $2",
+                                    "0: LoadImmediate 2",
+                                    "0: Add $2",
+                                    "0: Return",
+                                });
+}
+
+TEST_CASE(eliminate_dead_stores)
+{
+    auto executable = make_executable(1);
+    auto& block = executable.basic_blocks[0];
+    append<Op::LoadImmediate>(block, JS::Value(1));
+    append<Op::Store>(block, Register(2));
+    append<Op::Store>(block, Register(3));
+    append<Op::Store>(block, Register::accumulator());
+    append<Op::Add>(block, Register(3));
+    append<Op::Return>(block);
+
+    // Register 2 is never read, the accumulator is what the executable leaves behind.
+    perform<Passes::EliminateDeadStores>(executable);
+    expect_bytecode(executable, {
+                                    "0: LoadImmediate 1",
+                                    "0: Store $3",
+                                    "0: Store acc",
+                                    "0: Add $3",
+                                    "0: Return",
+                                });
+}
+
+static StringView const switch_source = R"(
+var result = 0;
+for (var i = 0; i < 10; i++) {
+    switch (i % 3) {
+    case 0:
+        result = result + i;
+        break;
+    case 1:
+        continue;
+    default:
+        result = result - 1;
+    }
+}
+result;
+)"sv;
+
+static JS::Value run_bytecode(StringView source, OptimizationLevel level, size_t& block_count)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto parser = JS::Parser(JS::Lexer(source));
+    auto program = parser.parse_program();
+    VERIFY(!parser.has_errors());
+
+    auto executable = Generator::generate(*program);
+    Interpreter::optimization_pipeline(level).perform(executable);
+    block_count = executable.basic_blocks.size();
+    Interpreter bytecode_interpreter(interpreter->global_object());
+    bytecode_interpreter.set_optimization_level(level);
+    bytecode_interpreter.run(executable);
+    VERIFY(!vm->exception());
+    return vm->last_value();
+}
+
+TEST_CASE(optimization_levels_agree)
+{
+    size_t unoptimized_block_count = 0;
+    auto unoptimized_result = run_bytecode(switch_source, OptimizationLevel::None, unoptimized_block_count);
+    EXPECT(unoptimized_result.is_number());
+
+    for (auto level : { OptimizationLevel::Default, OptimizationLevel::Aggressive }) {
+        size_t block_count = 0;
+        auto result = run_bytecode(switch_source, level, block_count);
+        EXPECT(result.is_number());
+        EXPECT_EQ(result.as_double(), unoptimized_result.as_double());
+        EXPECT(block_count < unoptimized_block_count);
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Vector.h>
+#include <LibPthread/pthread.h>
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <stdio.h>
+#include <time.h>
+
+struct Counter {
+    pthread_mutex_t mutex;
+    u64 value { 0 };
+    int increments_per_thread { 0 };
+    Atomic<bool> go { false };
+};
+
+static void* increment_counter(void* argument)
+{
+    auto& counter = *static_cast<Counter*>(argument);
+    while (!counter.go.load())
+        sched_yield();
+    for (int i = 0; i < counter.increments_per_thread; ++i) {
+        pthread_mutex_lock(&counter.mutex);
+        ++counter.value;
+        pthread_mutex_unlock(&counter.mutex);
+    }
+    return nullptr;
+}
+
+// Returns how long it took all threads to increment the counter, in seconds.
+static double run_threads(Counter& counter, int thread_count)
+{
+    Vector<pthread_t> threads;
+    threads.resize(thread_count);
+    for (auto& thread : threads)
+        VERIFY(pthread_create(&thread, nullptr, increment_counter, &counter) == 0);
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    counter.go.store(true);
+    for (auto thread : threads)
+        pthread_join(thread, nullptr);
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+TEST_CASE(mutex_excludes_other_threads)
+{
+    Counter counter;
+    pthread_mutex_init(&counter.mutex, nullptr);
+    counter.increments_per_thread = 20000;
+    run_threads(counter, 8);
+    EXPECT_EQ(counter.value, 8u * 20000u);
+    pthread_mutex_destroy(&counter.mutex);
+}
+
+TEST_CASE(mutex_trylock)
+{
+    pthread_mutex_t mutex;
+    pthread_mutex_init(&mutex, nullptr);
+    EXPECT_EQ(pthread_mutex_trylock(&mutex), 0);
+    EXPECT_EQ(pthread_mutex_trylock(&mutex), EBUSY);
+    EXPECT_EQ(pthread_mutex_unlock(&mutex), 0);
+    EXPECT_EQ(pthread_mutex_trylock(&mutex), 0);
+    EXPECT_EQ(pthread_mutex_unlock(&mutex), 0);
+    pthread_mutex_destroy(&mutex);
+}
+
+TEST_CASE(recursive_mutex)
+{
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_t mutex;
+    pthread_mutex_init(&mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+
+    EXPECT_EQ(pthread_mutex_lock(&mutex), 0);
+    EXPECT_EQ(pthread_mutex_lock(&mutex), 0);
+    EXPECT_EQ(pthread_mutex_trylock(&mutex), 0);
+    EXPECT_EQ(pthread_mutex_unlock(&mutex), 0);
+    EXPECT_EQ(pthread_mutex_unlock(&mutex), 0);
+    EXPECT_EQ(pthread_mutex_unlock(&mutex), 0);
+    pthread_mutex_destroy(&mutex);
+}
+
+BENCHMARK_CASE(mutex_contention)
+{
+    constexpr int increments_per_thread = 200000;
+    double single_thread_rate = 0;
+    for (int thread_count = 1; thread_count <= 16; ++thread_count) {
+        Counter counter;
+        pthread_mutex_init(&counter.mutex, nullptr);
+        counter.increments_per_thread = increments_per_thread;
+        double seconds = run_threads(counter, thread_count);
+        EXPECT_EQ(counter.value, static_cast<u64>(increments_per_thread) * thread_count);
+        pthread_mutex_destroy(&counter.mutex);
+
+        double rate = (static_cast<double>(increments_per_thread) * thread_count) / seconds;
+        if (thread_count == 1)
+            single_thread_rate = rate;
+        printf("%2d threads: %12.0f locks/sec %6.2fx\n", thread_count, rate, rate / single_thread_rate);
+    }
+}
@@ -650,10 +650,10 @@ JsonObject Sheet::gather_documentation() const
             dbgln("Sheet::gather_documentation(): Failed to parse the documentation for '{}'!", it.key.to_display_string());
     };
 
-    for (auto& it : interpreter().global_object().shape().property_table())
+    for (auto& it : interpreter().global_object().shape().property_table_ordered())
         add_docs_from(it, interpreter().global_object());
 
-    for (auto& it : global_object().shape().property_table())
+    for (auto& it : global_object().shape().property_table_ordered())
         add_docs_from(it, global_object());
 
     m_cached_documentation = move(object);
@@ -98,6 +98,9 @@ private:
     int virt$setgid(gid_t);
     u32 virt$read(int, FlatPtr, ssize_t);
     u32 virt$write(int, FlatPtr, ssize_t);
+    u32 virt$preadv(FlatPtr params_addr);
+    u32 virt$pwritev(FlatPtr params_addr);
+    u32 virt$copy_file_range(FlatPtr params_addr);
     u32 virt$mprotect(FlatPtr, size_t, int);
     u32 virt$madvise(FlatPtr, size_t, int);
     u32 virt$open(u32);
@@ -162,6 +165,9 @@ private:
     int virt$create_inode_watcher(unsigned);
     int virt$inode_watcher_add_watch(FlatPtr);
     int virt$inode_watcher_remove_watch(int, int);
+    int virt$epoll_create(int);
+    int virt$epoll_ctl(FlatPtr params_addr);
+    int virt$epoll_wait(FlatPtr params_addr);
     int virt$readlink(FlatPtr);
     u32 virt$allocate_tls(FlatPtr, size_t);
     int virt$ptsname(int fd, FlatPtr buffer, size_t buffer_size);
@@ -13,6 +13,7 @@
 #include <sched.h>
 #include <serenity.h>
 #include <strings.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/select.h>
@@ -128,6 +129,12 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$write(arg1, arg2, arg3);
     case SC_read:
         return virt$read(arg1, arg2, arg3);
+    case SC_preadv:
+        return virt$preadv(arg1);
+    case SC_pwritev:
+        return virt$pwritev(arg1);
+    case SC_copy_file_range:
+        return virt$copy_file_range(arg1);
     case SC_mprotect:
         return virt$mprotect(arg1, arg2, arg3);
     case SC_madvise:
@@ -228,6 +235,12 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$inode_watcher_add_watch(arg1);
     case SC_inode_watcher_remove_watch:
         return virt$inode_watcher_remove_watch(arg1, arg2);
+    case SC_epoll_create:
+        return virt$epoll_create(arg1);
+    case SC_epoll_ctl:
+        return virt$epoll_ctl(arg1);
+    case SC_epoll_wait:
+        return virt$epoll_wait(arg1);
     case SC_clock_nanosleep:
         return virt$clock_nanosleep(arg1);
     case SC_readlink:
@@ -1024,6 +1037,89 @@ u32 Emulator::virt$read(int fd, FlatPtr buffer, ssize_t size)
     return nread;
 }
 
+u32 Emulator::virt$preadv(FlatPtr params_addr)
+{
+    Syscall::SC_preadv_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+    if (params.iov_count < 0)
+        return -EINVAL;
+
+    // Read everything into one local buffer, then scatter it into the emulated iovecs.
+    Vector<iovec> vecs;
+    vecs.resize(params.iov_count);
+    mmu().copy_from_vm(vecs.data(), (FlatPtr)params.iov, vecs.size() * sizeof(iovec));
+    size_t total_length = 0;
+    for (auto& vec : vecs)
+        total_length += vec.iov_len;
+
+    auto local_buffer = ByteBuffer::create_uninitialized(total_length);
+    iovec local_vec { local_buffer.data(), local_buffer.size() };
+    Syscall::SC_preadv_params local_params { params.fd, &local_vec, 1, params.offset };
+    int nread = syscall(SC_preadv, &local_params);
+    if (nread < 0)
+        return nread;
+
+    size_t offset = 0;
+    for (auto& vec : vecs) {
+        auto size = min(vec.iov_len, (size_t)nread - offset);
+        mmu().copy_to_vm((FlatPtr)vec.iov_base, local_buffer.data() + offset, size);
+        offset += size;
+    }
+    return nread;
+}
+
+u32 Emulator::virt$pwritev(FlatPtr params_addr)
+{
+    Syscall::SC_pwritev_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+    if (params.iov_count < 0)
+        return -EINVAL;
+
+    Vector<iovec> vecs;
+    vecs.resize(params.iov_count);
+    mmu().copy_from_vm(vecs.data(), (FlatPtr)params.iov, vecs.size() * sizeof(iovec));
+    ByteBuffer local_buffer;
+    for (auto& vec : vecs) {
+        auto vec_buffer = mmu().copy_buffer_from_vm((FlatPtr)vec.iov_base, vec.iov_len);
+        local_buffer.append(vec_buffer.data(), vec_buffer.size());
+    }
+
+    iovec local_vec { local_buffer.data(), local_buffer.size() };
+    Syscall::SC_pwritev_params local_params { params.fd, &local_vec, 1, params.offset };
+    return syscall(SC_pwritev, &local_params);
+}
+
+u32 Emulator::virt$copy_file_range(FlatPtr params_addr)
+{
+    Syscall::SC_copy_file_range_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+
+    off_t offset_in = 0;
+    off_t offset_out = 0;
+    if (params.offset_in)
+        mmu().copy_from_vm(&offset_in, (FlatPtr)params.offset_in, sizeof(offset_in));
+    if (params.offset_out)
+        mmu().copy_from_vm(&offset_out, (FlatPtr)params.offset_out, sizeof(offset_out));
+
+    Syscall::SC_copy_file_range_params local_params {
+        params.fd_in,
+        params.offset_in ? &offset_in : nullptr,
+        params.fd_out,
+        params.offset_out ? &offset_out : nullptr,
+        params.length,
+        params.flags,
+    };
+    int rc = syscall(SC_copy_file_range, &local_params);
+    if (rc < 0)
+        return rc;
+
+    if (params.offset_in)
+        mmu().copy_to_vm((FlatPtr)params.offset_in, &offset_in, sizeof(offset_in));
+    if (params.offset_out)
+        mmu().copy_to_vm((FlatPtr)params.offset_out, &offset_out, sizeof(offset_out));
+    return rc;
+}
+
 void Emulator::virt$sync()
 {
     syscall(SC_sync);
@@ -1421,6 +1517,45 @@ int Emulator::virt$inode_watcher_remove_watch(int fd, int wd)
     return syscall(SC_inode_watcher_add_watch, fd, wd);
 }
 
+int Emulator::virt$epoll_create(int flags)
+{
+    return syscall(SC_epoll_create, flags);
+}
+
+int Emulator::virt$epoll_ctl(FlatPtr params_addr)
+{
+    Syscall::SC_epoll_ctl_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+
+    epoll_event event {};
+    if (params.event)
+        mmu().copy_from_vm(&event, (FlatPtr)params.event, sizeof(event));
+    params.event = params.event ? &event : nullptr;
+    return syscall(SC_epoll_ctl, &params);
+}
+
+int Emulator::virt$epoll_wait(FlatPtr params_addr)
+{
+    Syscall::SC_epoll_wait_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+    if (params.max_events <= 0)
+        return -EINVAL;
+
+    timespec timeout;
+    if (params.timeout)
+        mmu().copy_from_vm(&timeout, (FlatPtr)params.timeout, sizeof(timeout));
+
+    Vector<epoll_event> events;
+    events.resize(params.max_events);
+    auto* user_events = params.events;
+    params.events = events.data();
+    params.timeout = params.timeout ? &timeout : nullptr;
+    int rc = syscall(SC_epoll_wait, &params);
+    if (rc > 0)
+        mmu().copy_to_vm((FlatPtr)user_events, events.data(), rc * sizeof(epoll_event));
+    return rc;
+}
+
 int Emulator::virt$clock_nanosleep(FlatPtr params_addr)
 {
     Syscall::SC_clock_nanosleep_params params;
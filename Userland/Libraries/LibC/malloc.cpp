@@ -5,6 +5,7 @@
  */
 
 #include <AK/Debug.h>
+#include <AK/Optional.h>
 #include <AK/ScopedValueRollback.h>
 #include <AK/Vector.h>
 #include <LibELF/AuxiliaryVector.h>
@@ -24,6 +25,11 @@
 
 #define RECYCLE_BIG_ALLOCATIONS
 
+// The dynamic loader can't use thread-local storage.
+#ifndef NO_TLS
+#    define USE_THREAD_CACHES
+#endif
+
 #define PAGE_ROUND_UP(x) ((((size_t)(x)) + PAGE_SIZE - 1) & (~(PAGE_SIZE - 1)))
 
 static Threading::Lock& malloc_lock()
@@ -36,6 +42,12 @@ constexpr size_t number_of_hot_chunked_blocks_to_keep_around = 16;
 constexpr size_t number_of_cold_chunked_blocks_to_keep_around = 16;
 constexpr size_t number_of_big_blocks_to_keep_around_per_size_class = 8;
 
+// Each thread keeps a few free chunks of the smallest size classes (up to 1016 bytes) for itself,
+// and only takes the malloc lock to move a batch of chunks between its cache and the blocks.
+constexpr size_t number_of_thread_cached_size_classes = 8;
+constexpr size_t number_of_chunks_to_keep_per_thread_and_size_class = 32;
+constexpr size_t number_of_chunks_to_move_at_once = 16;
+
 static bool s_log_malloc = false;
 static bool s_scrub_malloc = true;
 static bool s_scrub_free = true;
@@ -88,6 +100,9 @@ struct MallocStats {
     size_t number_of_hot_keeps;
     size_t number_of_cold_keeps;
     size_t number_of_frees;
+
+    size_t number_of_thread_cache_refills;
+    size_t number_of_thread_cache_flushes;
 };
 static MallocStats g_malloc_stats = {};
 
@@ -138,6 +153,33 @@ static Allocator* allocator_for_size(size_t size, size_t& good_size)
     return nullptr;
 }
 
+#ifdef USE_THREAD_CACHES
+struct ThreadCache {
+    FreelistEntry* chunks[number_of_thread_cached_size_classes] { nullptr };
+    size_t chunk_counts[number_of_thread_cached_size_classes] { 0 };
+
+    // Calls that never took the malloc lock. These are added to g_malloc_stats whenever it's taken anyway.
+    size_t number_of_malloc_calls { 0 };
+    size_t number_of_free_calls { 0 };
+
+    // Whether the cache will be flushed when the thread exits.
+    bool is_registered { false };
+};
+
+static __thread ThreadCache s_thread_cache;
+static pthread_key_t s_thread_cache_key;
+
+static Optional<size_t> thread_cache_index_for(const Allocator& allocator)
+{
+    if (s_in_userspace_emulator)
+        return {};
+    size_t index = &allocator - allocators();
+    if (index >= number_of_thread_cached_size_classes)
+        return {};
+    return index;
+}
+#endif
+
 #ifdef RECYCLE_BIG_ALLOCATIONS
 static BigAllocator* big_allocator_for_size(size_t size)
 {
@@ -167,60 +209,11 @@ enum class CallerWillInitializeMemory {
     Yes,
 };
 
-static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
+static void* allocate_chunk(Allocator& allocator)
 {
-    Threading::Locker locker(malloc_lock());
-
-    if (s_log_malloc)
-        dbgln("LibC: malloc({})", size);
-
-    if (!size) {
-        // Legally we could just return a null pointer here, but this is more
-        // compatible with existing software.
-        size = 1;
-    }
-
-    g_malloc_stats.number_of_malloc_calls++;
-
-    size_t good_size;
-    auto* allocator = allocator_for_size(size, good_size);
-
-    if (!allocator) {
-        size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
-#ifdef RECYCLE_BIG_ALLOCATIONS
-        if (auto* allocator = big_allocator_for_size(real_size)) {
-            if (!allocator->blocks.is_empty()) {
-                g_malloc_stats.number_of_big_allocator_hits++;
-                auto* block = allocator->blocks.take_last();
-                int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
-                bool this_block_was_purged = rc == 1;
-                if (rc < 0) {
-                    perror("madvise");
-                    VERIFY_NOT_REACHED();
-                }
-                if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
-                    perror("mprotect");
-                    VERIFY_NOT_REACHED();
-                }
-                if (this_block_was_purged) {
-                    g_malloc_stats.number_of_big_allocator_purge_hits++;
-                    new (block) BigAllocationBlock(real_size);
-                }
-
-                ue_notify_malloc(&block->m_slot[0], size);
-                return &block->m_slot[0];
-            }
-        }
-#endif
-        g_malloc_stats.number_of_big_allocs++;
-        auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
-        new (block) BigAllocationBlock(real_size);
-        ue_notify_malloc(&block->m_slot[0], size);
-        return &block->m_slot[0];
-    }
-
+    size_t good_size = allocator.size;
     ChunkedBlock* block = nullptr;
-    for (auto& current : allocator->usable_blocks) {
+    for (auto& current : allocator.usable_blocks) {
         if (current.free_chunks()) {
             block = &current;
             break;
@@ -237,7 +230,7 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
             snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
             set_mmap_name(block, ChunkedBlock::block_size, buffer);
         }
-        allocator->usable_blocks.append(*block);
+        allocator.usable_blocks.append(*block);
     }
 
     if (!block && s_cold_empty_block_count) {
@@ -260,7 +253,7 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
             new (block) ChunkedBlock(good_size);
             ue_notify_chunk_size_changed(block, good_size);
         }
-        allocator->usable_blocks.append(*block);
+        allocator.usable_blocks.append(*block);
     }
 
     if (!block) {
@@ -269,8 +262,8 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
         snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
         block = (ChunkedBlock*)os_alloc(ChunkedBlock::block_size, buffer);
         new (block) ChunkedBlock(good_size);
-        allocator->usable_blocks.append(*block);
-        ++allocator->block_count;
+        allocator.usable_blocks.append(*block);
+        ++allocator.block_count;
     }
 
     --block->m_free_chunks;
@@ -285,65 +278,15 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
     if (block->is_full()) {
         g_malloc_stats.number_of_blocks_full++;
         dbgln_if(MALLOC_DEBUG, "Block {:p} is now full in size class {}", block, good_size);
-        allocator->usable_blocks.remove(*block);
-        allocator->full_blocks.append(*block);
+        allocator.usable_blocks.remove(*block);
+        allocator.full_blocks.append(*block);
     }
     dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (chunk in block {:p}, size {})", ptr, block, block->bytes_per_chunk());
-
-    if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
-        memset(ptr, MALLOC_SCRUB_BYTE, block->m_size);
-
-    ue_notify_malloc(ptr, size);
     return ptr;
 }
 
-static void free_impl(void* ptr)
+static void free_chunk(ChunkedBlock* block, void* ptr)
 {
-    ScopedValueRollback rollback(errno);
-
-    if (!ptr)
-        return;
-
-    g_malloc_stats.number_of_free_calls++;
-
-    Threading::Locker locker(malloc_lock());
-
-    void* block_base = (void*)((FlatPtr)ptr & ChunkedBlock::ChunkedBlock::block_mask);
-    size_t magic = *(size_t*)block_base;
-
-    if (magic == MAGIC_BIGALLOC_HEADER) {
-        auto* block = (BigAllocationBlock*)block_base;
-#ifdef RECYCLE_BIG_ALLOCATIONS
-        if (auto* allocator = big_allocator_for_size(block->m_size)) {
-            if (allocator->blocks.size() < number_of_big_blocks_to_keep_around_per_size_class) {
-                g_malloc_stats.number_of_big_allocator_keeps++;
-                allocator->blocks.append(block);
-                size_t this_block_size = block->m_size;
-                if (mprotect(block, this_block_size, PROT_NONE) < 0) {
-                    perror("mprotect");
-                    VERIFY_NOT_REACHED();
-                }
-                if (madvise(block, this_block_size, MADV_SET_VOLATILE) != 0) {
-                    perror("madvise");
-                    VERIFY_NOT_REACHED();
-                }
-                return;
-            }
-        }
-#endif
-        g_malloc_stats.number_of_big_allocator_frees++;
-        os_free(block, block->m_size);
-        return;
-    }
-
-    assert(magic == MAGIC_PAGE_HEADER);
-    auto* block = (ChunkedBlock*)block_base;
-
-    dbgln_if(MALLOC_DEBUG, "LibC: freeing {:p} in allocator {:p} (size={}, used={})", ptr, block, block->bytes_per_chunk(), block->used_chunks());
-
-    if (s_scrub_free)
-        memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
-
     auto* entry = (FreelistEntry*)ptr;
     entry->next = block->m_freelist;
     block->m_freelist = entry;
@@ -386,6 +329,229 @@ static void free_impl(void* ptr)
     }
 }
 
+#ifdef USE_THREAD_CACHES
+static void add_thread_cache_stats(ThreadCache& cache)
+{
+    g_malloc_stats.number_of_malloc_calls += exchange(cache.number_of_malloc_calls, 0);
+    g_malloc_stats.number_of_free_calls += exchange(cache.number_of_free_calls, 0);
+}
+
+static void flush_thread_cache(void*)
+{
+    auto& cache = s_thread_cache;
+    cache.is_registered = false;
+
+    Threading::Locker locker(malloc_lock());
+    g_malloc_stats.number_of_thread_cache_flushes++;
+    add_thread_cache_stats(cache);
+    for (size_t index = 0; index < number_of_thread_cached_size_classes; ++index) {
+        while (auto* entry = cache.chunks[index]) {
+            cache.chunks[index] = entry->next;
+            free_chunk((ChunkedBlock*)((FlatPtr)entry & ChunkedBlock::block_mask), entry);
+        }
+        cache.chunk_counts[index] = 0;
+    }
+}
+
+static void register_thread_cache(ThreadCache& cache)
+{
+    // The key's destructor gives the chunks back when the thread exits.
+    // This must not happen with the malloc lock held, since exiting threads
+    // take the lock from inside the key destructors.
+    cache.is_registered = true;
+    __pthread_setspecific(s_thread_cache_key, &cache);
+}
+
+static void* malloc_from_thread_cache(Allocator& allocator, size_t index)
+{
+    auto& cache = s_thread_cache;
+    ++cache.number_of_malloc_calls;
+
+    if (!cache.chunks[index]) {
+        if (!cache.is_registered)
+            register_thread_cache(cache);
+        Threading::Locker locker(malloc_lock());
+        g_malloc_stats.number_of_thread_cache_refills++;
+        add_thread_cache_stats(cache);
+        for (size_t i = 0; i < number_of_chunks_to_move_at_once; ++i) {
+            auto* entry = (FreelistEntry*)allocate_chunk(allocator);
+            entry->next = cache.chunks[index];
+            cache.chunks[index] = entry;
+        }
+        cache.chunk_counts[index] = number_of_chunks_to_move_at_once;
+    }
+
+    auto* entry = cache.chunks[index];
+    cache.chunks[index] = entry->next;
+    --cache.chunk_counts[index];
+    return entry;
+}
+
+static void free_to_thread_cache(void* ptr, size_t index)
+{
+    auto& cache = s_thread_cache;
+    ++cache.number_of_free_calls;
+    if (!cache.is_registered)
+        register_thread_cache(cache);
+
+    auto* entry = (FreelistEntry*)ptr;
+    entry->next = cache.chunks[index];
+    cache.chunks[index] = entry;
+    if (++cache.chunk_counts[index] <= number_of_chunks_to_keep_per_thread_and_size_class)
+        return;
+
+    Threading::Locker locker(malloc_lock());
+    g_malloc_stats.number_of_thread_cache_flushes++;
+    add_thread_cache_stats(cache);
+    for (size_t i = 0; i < number_of_chunks_to_move_at_once; ++i) {
+        entry = cache.chunks[index];
+        cache.chunks[index] = entry->next;
+        free_chunk((ChunkedBlock*)((FlatPtr)entry & ChunkedBlock::block_mask), entry);
+    }
+    cache.chunk_counts[index] -= number_of_chunks_to_move_at_once;
+}
+#endif
+
+static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
+{
+    if (s_log_malloc)
+        dbgln("LibC: malloc({})", size);
+
+    if (!size) {
+        // Legally we could just return a null pointer here, but this is more
+        // compatible with existing software.
+        size = 1;
+    }
+
+    size_t good_size;
+    auto* allocator = allocator_for_size(size, good_size);
+
+    if (!allocator) {
+        size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
+        {
+            Threading::Locker locker(malloc_lock());
+            g_malloc_stats.number_of_malloc_calls++;
+#ifdef RECYCLE_BIG_ALLOCATIONS
+            if (auto* allocator = big_allocator_for_size(real_size)) {
+                if (!allocator->blocks.is_empty()) {
+                    g_malloc_stats.number_of_big_allocator_hits++;
+                    auto* block = allocator->blocks.take_last();
+                    int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
+                    bool this_block_was_purged = rc == 1;
+                    if (rc < 0) {
+                        perror("madvise");
+                        VERIFY_NOT_REACHED();
+                    }
+                    if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
+                        perror("mprotect");
+                        VERIFY_NOT_REACHED();
+                    }
+                    if (this_block_was_purged) {
+                        g_malloc_stats.number_of_big_allocator_purge_hits++;
+                        new (block) BigAllocationBlock(real_size);
+                    }
+
+                    ue_notify_malloc(&block->m_slot[0], size);
+                    return &block->m_slot[0];
+                }
+            }
+#endif
+            g_malloc_stats.number_of_big_allocs++;
+        }
+        // Nobody else can see this block yet, so there's no need to hold the lock while mapping it.
+        auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
+        new (block) BigAllocationBlock(real_size);
+        ue_notify_malloc(&block->m_slot[0], size);
+        return &block->m_slot[0];
+    }
+
+    void* ptr = nullptr;
+#ifdef USE_THREAD_CACHES
+    if (auto index = thread_cache_index_for(*allocator); index.has_value())
+        ptr = malloc_from_thread_cache(*allocator, index.value());
+#endif
+    if (!ptr) {
+        Threading::Locker locker(malloc_lock());
+        g_malloc_stats.number_of_malloc_calls++;
+        ptr = allocate_chunk(*allocator);
+    }
+
+    if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
+        memset(ptr, MALLOC_SCRUB_BYTE, good_size);
+
+    ue_notify_malloc(ptr, size);
+    return ptr;
+}
+
+static void free_impl(void* ptr)
+{
+    ScopedValueRollback rollback(errno);
+
+    if (!ptr)
+        return;
+
+    // The header of the block can't change while one of its chunks is allocated,
+    // so it's fine to look at it without the lock.
+    void* block_base = (void*)((FlatPtr)ptr & ChunkedBlock::ChunkedBlock::block_mask);
+    size_t magic = *(size_t*)block_base;
+
+#ifdef USE_THREAD_CACHES
+    if (magic == MAGIC_PAGE_HEADER) {
+        auto* block = (ChunkedBlock*)block_base;
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
+        if (auto index = thread_cache_index_for(*allocator); index.has_value()) {
+            if (s_scrub_free)
+                memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
+            free_to_thread_cache(ptr, index.value());
+            return;
+        }
+    }
+#endif
+
+    g_malloc_stats.number_of_free_calls++;
+
+    if (magic == MAGIC_BIGALLOC_HEADER) {
+        auto* block = (BigAllocationBlock*)block_base;
+        {
+            Threading::Locker locker(malloc_lock());
+#ifdef RECYCLE_BIG_ALLOCATIONS
+            if (auto* allocator = big_allocator_for_size(block->m_size)) {
+                if (allocator->blocks.size() < number_of_big_blocks_to_keep_around_per_size_class) {
+                    g_malloc_stats.number_of_big_allocator_keeps++;
+                    allocator->blocks.append(block);
+                    size_t this_block_size = block->m_size;
+                    if (mprotect(block, this_block_size, PROT_NONE) < 0) {
+                        perror("mprotect");
+                        VERIFY_NOT_REACHED();
+                    }
+                    if (madvise(block, this_block_size, MADV_SET_VOLATILE) != 0) {
+                        perror("madvise");
+                        VERIFY_NOT_REACHED();
+                    }
+                    return;
+                }
+            }
+#endif
+            g_malloc_stats.number_of_big_allocator_frees++;
+        }
+        os_free(block, block->m_size);
+        return;
+    }
+
+    assert(magic == MAGIC_PAGE_HEADER);
+    auto* block = (ChunkedBlock*)block_base;
+
+    Threading::Locker locker(malloc_lock());
+
+    dbgln_if(MALLOC_DEBUG, "LibC: freeing {:p} in allocator {:p} (size={}, used={})", ptr, block, block->bytes_per_chunk(), block->used_chunks());
+
+    if (s_scrub_free)
+        memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
+
+    free_chunk(block, ptr);
+}
+
 [[gnu::flatten]] void* malloc(size_t size)
 {
     void* ptr = malloc_impl(size, CallerWillInitializeMemory::No);
@@ -484,6 +650,11 @@ void __malloc_init()
     }
 
     new (&big_allocators()[0])(BigAllocator);
+
+#ifdef USE_THREAD_CACHES
+    if (!s_in_userspace_emulator)
+        __pthread_key_create(&s_thread_cache_key, flush_thread_cache);
+#endif
 }
 
 void serenity_dump_malloc_stats()
@@ -509,5 +680,8 @@ void serenity_dump_malloc_stats()
     dbgln("number of hot keeps: {}", g_malloc_stats.number_of_hot_keeps);
     dbgln("number of cold keeps: {}", g_malloc_stats.number_of_cold_keeps);
     dbgln("number of frees: {}", g_malloc_stats.number_of_frees);
+    dbgln();
+    dbgln("thread cache refills: {}", g_malloc_stats.number_of_thread_cache_refills);
+    dbgln("thread cache flushes: {}", g_malloc_stats.number_of_thread_cache_flushes);
 }
 }
@@ -9,7 +9,7 @@
 #include <AK/Vector.h>
 #include <bits/pthread_integration.h>
 #include <errno.h>
-#include <sched.h>
+#include <serenity.h>
 #include <unistd.h>
 
 namespace {
@@ -91,23 +91,49 @@ int __pthread_self()
 
 int pthread_self() __attribute__((weak, alias("__pthread_self")));
 
+// The lock word of a mutex is one of these. Unlocking only has to enter the kernel to wake
+// someone up if a thread announced that it is going to sleep.
+enum MutexState : u32 {
+    MutexUnlocked = 0,
+    MutexLocked = 1,
+    MutexLockedWithWaiters = 2,
+};
+
+// How many times to check whether a contended mutex became free before going to sleep on it.
+// Most critical sections are short, and the holder releasing the mutex while we spin is a lot
+// cheaper than a round trip through the scheduler.
+static constexpr int mutex_spin_count = 100;
+
+static void mutex_lock_slow(pthread_mutex_t* mutex)
+{
+    for (int i = 0; i < mutex_spin_count; ++i) {
+        u32 expected = MutexUnlocked;
+        if (AK::atomic_load(&mutex->lock, AK::memory_order_relaxed) == MutexUnlocked
+            && AK::atomic_compare_exchange_strong(&mutex->lock, expected, (u32)MutexLocked, AK::memory_order_acquire))
+            return;
+        __builtin_ia32_pause();
+    }
+
+    // We can't tell whether anyone else is still sleeping once we get the mutex this way,
+    // so it stays marked as having waiters and the next unlock wakes somebody up.
+    while (AK::atomic_exchange(&mutex->lock, (u32)MutexLockedWithWaiters, AK::memory_order_acquire) != MutexUnlocked)
+        futex(&mutex->lock, FUTEX_WAIT | FUTEX_PRIVATE_FLAG, MutexLockedWithWaiters, nullptr, nullptr, 0);
+}
+
 int __pthread_mutex_lock(pthread_mutex_t* mutex)
 {
     pthread_t this_thread = __pthread_self();
-    for (;;) {
-        u32 expected = 0;
-        if (!AK::atomic_compare_exchange_strong(&mutex->lock, expected, 1u, AK::memory_order_acquire)) {
-            if (mutex->type == __PTHREAD_MUTEX_RECURSIVE && mutex->owner == this_thread) {
-                mutex->level++;
-                return 0;
-            }
-            sched_yield();
-            continue;
+    u32 expected = MutexUnlocked;
+    if (!AK::atomic_compare_exchange_strong(&mutex->lock, expected, (u32)MutexLocked, AK::memory_order_acquire)) {
+        if (mutex->type == __PTHREAD_MUTEX_RECURSIVE && mutex->owner == this_thread) {
+            mutex->level++;
+            return 0;
         }
-        mutex->owner = this_thread;
-        mutex->level = 0;
-        return 0;
+        mutex_lock_slow(mutex);
     }
+    mutex->owner = this_thread;
+    mutex->level = 0;
+    return 0;
 }
 
 int pthread_mutex_lock(pthread_mutex_t*) __attribute__((weak, alias("__pthread_mutex_lock")));
@@ -119,7 +145,8 @@ int __pthread_mutex_unlock(pthread_mutex_t* mutex)
         return 0;
     }
     mutex->owner = 0;
-    AK::atomic_store(&mutex->lock, 0u, AK::memory_order_release);
+    if (AK::atomic_exchange(&mutex->lock, (u32)MutexUnlocked, AK::memory_order_release) == MutexLockedWithWaiters)
+        futex(&mutex->lock, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, 1, nullptr, nullptr, 0);
     return 0;
 }
 
@@ -127,8 +154,8 @@ int pthread_mutex_unlock(pthread_mutex_t*) __attribute__((weak, alias("__pthread
 
 int __pthread_mutex_trylock(pthread_mutex_t* mutex)
 {
-    u32 expected = 0;
-    if (!AK::atomic_compare_exchange_strong(&mutex->lock, expected, 1u, AK::memory_order_acquire)) {
+    u32 expected = MutexUnlocked;
+    if (!AK::atomic_compare_exchange_strong(&mutex->lock, expected, (u32)MutexLocked, AK::memory_order_acquire)) {
         if (mutex->type == __PTHREAD_MUTEX_RECURSIVE && mutex->owner == pthread_self()) {
             mutex->level++;
             return 0;
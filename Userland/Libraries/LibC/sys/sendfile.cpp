@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <sys/sendfile.h>
+#include <unistd.h>
+
+extern "C" {
+
+ssize_t sendfile(int out_fd, int in_fd, off_t* offset, size_t count)
+{
+    // The kernel does the copying in copy_file_range(), which writes at the output's
+    // current offset when it isn't given one. That is all sendfile() needs.
+    return copy_file_range(in_fd, offset, out_fd, nullptr, count, 0);
+}
+}
@@ -35,6 +35,10 @@
 #include <time.h>
 #include <unistd.h>
 
+#ifdef __serenity__
+#    include <sys/epoll.h>
+#endif
+
 namespace Core {
 
 class InspectorServerConnection;
@@ -65,6 +69,60 @@ static HashTable<Notifier*>* s_notifiers;
 int EventLoop::s_wake_pipe_fds[2];
 static RefPtr<InspectorServerConnection> s_inspector_server_connection;
 
+#ifdef __serenity__
+// The kernel keeps the set of watched fds, so waiting doesn't have to hand it over every time.
+static int s_epoll_fd = -1;
+static HashMap<int, Vector<Notifier*, 1>>* s_notifiers_by_fd;
+
+static void update_epoll_interest(int fd)
+{
+    if (s_epoll_fd < 0)
+        return;
+
+    epoll_event event {};
+    event.data.fd = fd;
+    if (auto it = s_notifiers_by_fd->find(fd); it != s_notifiers_by_fd->end()) {
+        for (auto* notifier : it->value) {
+            if (notifier->event_mask() & Notifier::Read)
+                event.events |= EPOLLIN;
+            if (notifier->event_mask() & Notifier::Write)
+                event.events |= EPOLLOUT;
+            if (notifier->event_mask() & Notifier::Exceptional)
+                VERIFY_NOT_REACHED();
+        }
+    } else {
+        // The fd may have been closed already, which removed it from the set for us.
+        (void)epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        return;
+    }
+
+    // NOTE: Our idea of what's registered can be stale if the fd was closed and reused
+    //       behind our back, so fall back to the other operation.
+    if (epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event) == 0)
+        return;
+    if (errno == ENOENT && epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0)
+        return;
+    dbgln("Core::EventLoop: Failed to watch fd {}: {}", fd, strerror(errno));
+}
+
+static void create_epoll_fd(int wake_pipe_fd)
+{
+    if (s_epoll_fd >= 0)
+        close(s_epoll_fd);
+    s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    VERIFY(s_epoll_fd >= 0);
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = wake_pipe_fd;
+    int rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, event.data.fd, &event);
+    VERIFY(rc == 0);
+
+    for (auto& it : *s_notifiers_by_fd)
+        update_epoll_interest(it.key);
+}
+#endif
+
 class SignalHandlers : public RefCounted<SignalHandlers> {
     AK_MAKE_NONCOPYABLE(SignalHandlers);
     AK_MAKE_NONMOVABLE(SignalHandlers);
@@ -260,6 +318,9 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
         s_event_loop_stack = new Vector<EventLoop&>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
         s_notifiers = new HashTable<Notifier*>;
+#ifdef __serenity__
+        s_notifiers_by_fd = new HashMap<int, Vector<Notifier*, 1>>;
+#endif
     }
 
     if (!s_main_event_loop) {
@@ -275,6 +336,9 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
 #endif
         VERIFY(rc == 0);
         s_event_loop_stack->append(*this);
+#ifdef __serenity__
+        create_epoll_fd(s_wake_pipe_fds[0]);
+#endif
 
 #ifdef __serenity__
         if (getuid() != 0
@@ -555,6 +619,14 @@ void EventLoop::notify_forked(ForkEvent event)
         s_event_loop_stack->clear();
         s_timers->clear();
         s_notifiers->clear();
+#ifdef __serenity__
+        // The child shares the parent's epoll description, so it mustn't touch it.
+        if (s_epoll_fd >= 0) {
+            close(s_epoll_fd);
+            s_epoll_fd = -1;
+        }
+        s_notifiers_by_fd->clear();
+#endif
         if (auto* info = signals_info<false>()) {
             info->signal_handlers.clear();
             info->next_signal_id = 0;
@@ -571,6 +643,10 @@ void EventLoop::notify_forked(ForkEvent event)
 
 void EventLoop::wait_for_event(WaitMode mode)
 {
+#ifdef __serenity__
+    epoll_event events[32];
+retry:
+#else
     fd_set rfds;
     fd_set wfds;
 retry:
@@ -595,6 +671,7 @@ retry:
         if (notifier->event_mask() & Notifier::Exceptional)
             VERIFY_NOT_REACHED();
     }
+#endif
 
     bool queued_events_is_empty;
     {
@@ -622,8 +699,15 @@ retry:
         }
     }
 
+#ifdef __serenity__
+    // Round up, so that we don't wake up just before the next timer fires.
+    int timeout_ms = should_wait_forever ? -1 : timeout.tv_sec * 1000 + (timeout.tv_usec + 999) / 1000;
+try_select_again:
+    int marked_fd_count = epoll_wait(s_epoll_fd, events, array_size(events), timeout_ms);
+#else
 try_select_again:
     int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+#endif
     if (marked_fd_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
@@ -634,7 +718,16 @@ try_select_again:
         dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop::wait_for_event: {} ({}: {})", marked_fd_count, saved_errno, strerror(saved_errno));
         VERIFY_NOT_REACHED();
     }
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+#ifdef __serenity__
+    bool wake_pipe_is_readable = false;
+    for (int i = 0; i < marked_fd_count; ++i) {
+        if (events[i].data.fd == s_wake_pipe_fds[0])
+            wake_pipe_is_readable = true;
+    }
+#else
+    bool wake_pipe_is_readable = FD_ISSET(s_wake_pipe_fds[0], &rfds);
+#endif
+    if (wake_pipe_is_readable) {
         int wake_events[8];
         auto nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
         if (nread < 0) {
@@ -687,6 +780,21 @@ try_select_again:
     if (!marked_fd_count)
         return;
 
+#ifdef __serenity__
+    for (int i = 0; i < marked_fd_count; ++i) {
+        auto it = s_notifiers_by_fd->find(events[i].data.fd);
+        if (it == s_notifiers_by_fd->end())
+            continue;
+        // Errors and hangups are reported the way select() would, by being readable and writable.
+        bool has_error = events[i].events & (EPOLLERR | EPOLLHUP);
+        for (auto* notifier : it->value) {
+            if ((events[i].events & EPOLLIN || has_error) && notifier->event_mask() & Notifier::Event::Read)
+                post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
+            if ((events[i].events & EPOLLOUT || has_error) && notifier->event_mask() & Notifier::Event::Write)
+                post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
+        }
+    }
+#else
     for (auto& notifier : *s_notifiers) {
         if (FD_ISSET(notifier->fd(), &rfds)) {
             if (notifier->event_mask() & Notifier::Event::Read)
@@ -697,6 +805,7 @@ try_select_again:
                 post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
         }
     }
+#endif
 }
 
 bool EventLoopTimer::has_expired(const timeval& now) const
@@ -759,12 +868,34 @@ bool EventLoop::unregister_timer(int timer_id)
 
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->set(&notifier);
+    if (s_notifiers->set(&notifier) != AK::HashSetResult::InsertedNewEntry)
+        return;
+#ifdef __serenity__
+    s_notifiers_by_fd->ensure(notifier.fd()).append(&notifier);
+    update_epoll_interest(notifier.fd());
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->remove(&notifier);
+    if (!s_notifiers->remove(&notifier))
+        return;
+#ifdef __serenity__
+    auto it = s_notifiers_by_fd->find(notifier.fd());
+    VERIFY(it != s_notifiers_by_fd->end());
+    it->value.remove_first_matching([&](auto* entry) { return entry == &notifier; });
+    if (it->value.is_empty())
+        s_notifiers_by_fd->remove(it);
+    update_epoll_interest(notifier.fd());
+#endif
+}
+
+void EventLoop::update_notifier(Badge<Notifier>, [[maybe_unused]] Notifier& notifier)
+{
+#ifdef __serenity__
+    if (s_notifiers->contains(&notifier))
+        update_epoll_interest(notifier.fd());
+#endif
 }
 
 void EventLoop::wake()
@@ -345,7 +345,25 @@ Result<void, File::CopyError> File::copy_file(const String& dst_path, const stru
             return CopyError { OSError(errno), false };
     }
 
-    for (;;) {
+    bool copied = false;
+#ifdef __serenity__
+    // Let the kernel move the data, so it doesn't have to pass through our address space.
+    for (bool first_call = true;; first_call = false) {
+        ssize_t ncopied = copy_file_range(source.fd(), nullptr, dst_fd, nullptr, 1 * MiB, 0);
+        if (ncopied < 0) {
+            // The kernel can't copy from sources that aren't seekable, like pipes.
+            if (first_call && errno == EINVAL)
+                break;
+            return CopyError { OSError(errno), false };
+        }
+        if (ncopied == 0) {
+            copied = true;
+            break;
+        }
+    }
+#endif
+
+    while (!copied) {
         char buffer[32768];
         ssize_t nread = ::read(source.fd(), buffer, sizeof(buffer));
         if (nread < 0) {
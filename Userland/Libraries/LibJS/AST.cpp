@@ -1684,7 +1684,7 @@ Value ObjectExpression::execute(Interpreter& interpreter, GlobalObject& global_o
         if (property.type() == ObjectProperty::Type::Spread) {
             if (key.is_object() && key.as_object().is_array()) {
                 auto& array_to_spread = static_cast<Array&>(key.as_object());
-                for (auto& entry : array_to_spread.indexed_properties()) {
+                for (auto& entry : static_cast<const Array&>(array_to_spread).indexed_properties()) {
                     object->indexed_properties().put(object, entry.index(), entry.value_and_attributes(&array_to_spread).value);
                     if (interpreter.exception())
                         return {};
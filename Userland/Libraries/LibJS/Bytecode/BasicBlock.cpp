@@ -64,6 +64,35 @@ void BasicBlock::grow(size_t additional_size)
     VERIFY(m_buffer_size <= m_buffer_capacity);
 }
 
+void BasicBlock::append_instructions_from(BasicBlock& other, AK::Function<bool(Instruction const&)> const& should_keep)
+{
+    VERIFY(&other != this);
+    Bytecode::InstructionStreamIterator it(other.instruction_stream());
+    while (!it.at_end()) {
+        auto& instruction = const_cast<Instruction&>(*it);
+        auto length = instruction.length();
+        ++it;
+        if (!should_keep(instruction)) {
+            Instruction::destroy(instruction);
+            continue;
+        }
+        VERIFY(can_grow(length));
+        m_is_terminated = instruction.is_terminator();
+        Instruction::relocate(instruction, next_slot());
+        grow(length);
+    }
+    other.m_buffer_size = 0;
+    other.m_is_terminated = false;
+}
+
+void BasicBlock::swap_instruction_streams(BasicBlock& other)
+{
+    swap(m_buffer, other.m_buffer);
+    swap(m_buffer_capacity, other.m_buffer_capacity);
+    swap(m_buffer_size, other.m_buffer_size);
+    swap(m_is_terminated, other.m_is_terminated);
+}
+
 void InstructionStreamIterator::operator++()
 {
     m_offset += dereference().length();
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Badge.h>
+#include <AK/Function.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/String.h>
 #include <LibJS/Forward.h>
@@ -56,9 +57,15 @@ public:
     ReadonlyBytes instruction_stream() const { return ReadonlyBytes { m_buffer, m_buffer_size }; }
 
     void* next_slot() { return m_buffer + m_buffer_size; }
+    size_t capacity() const { return m_buffer_capacity; }
     bool can_grow(size_t additional_size) const { return m_buffer_size + additional_size <= m_buffer_capacity; }
     void grow(size_t additional_size);
 
+    // Moves the instructions of `other` to the end of this block, leaving `other` empty.
+    // Instructions for which `should_keep` returns false are destroyed instead of moved.
+    void append_instructions_from(BasicBlock& other, AK::Function<bool(Instruction const&)> const& should_keep);
+    void swap_instruction_streams(BasicBlock& other);
+
     void terminate(Badge<Generator>) { m_is_terminated = true; }
     bool is_terminated() const { return m_is_terminated; }
 
@@ -14,6 +14,7 @@
 #include <LibJS/Bytecode/Op.h>
 #include <LibJS/Bytecode/Register.h>
 #include <LibJS/Bytecode/StringTable.h>
+#include <LibJS/Bytecode/ThreadedCode.h>
 #include <LibJS/Forward.h>
 
 namespace JS::Bytecode {
@@ -23,7 +24,17 @@ struct Executable {
     NonnullOwnPtr<StringTable> string_table;
     size_t number_of_registers { 0 };
 
+    // Built on first use by the threaded dispatch loop, and thrown away whenever the blocks are rewritten.
+    mutable OwnPtr<ThreadedCode> cached_threaded_code;
+
     String const& get_string(StringTableIndex index) const { return string_table->get(index); }
+
+    ThreadedCode const& threaded_code() const
+    {
+        if (!cached_threaded_code)
+            cached_threaded_code = ThreadedCode::create(*this);
+        return *cached_threaded_code;
+    }
 };
 
 class Generator {
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/WeakPtr.h>
+#include <LibJS/Runtime/Shape.h>
+
+namespace JS::Bytecode {
+
+struct InlineCacheStatistics {
+    u64 hits { 0 };
+    u64 misses { 0 };
+};
+
+// A small polymorphic cache of (Shape, storage offset) pairs for a single property access instruction.
+// Shapes are immutable once they're shared between objects, so a transition always produces a new Shape
+// and naturally misses in the cache. Unique shapes are mutated in place and must never be cached.
+class PropertyInlineCache {
+public:
+    static constexpr size_t max_entries = 4;
+
+    ALWAYS_INLINE Optional<size_t> lookup(Shape const& shape) const
+    {
+        for (size_t i = 0; i < m_entry_count; ++i) {
+            auto& entry = m_entries[i];
+            // NOTE: The raw pointer comparison is only meaningful while the weak pointer is alive,
+            //       otherwise a new Shape may have been allocated at the same address.
+            if (entry.raw_shape == &shape && !entry.shape.is_null())
+                return entry.offset;
+        }
+        return {};
+    }
+
+    void add(Shape& shape, size_t offset)
+    {
+        VERIFY(!shape.is_unique());
+        size_t index;
+        if (m_entry_count < max_entries) {
+            index = m_entry_count++;
+        } else {
+            // Megamorphic: round-robin replacement is good enough to keep the most recent shapes around.
+            index = m_next_victim;
+            m_next_victim = (m_next_victim + 1) % max_entries;
+        }
+        m_entries[index] = { &shape, shape.make_weak_ptr<Shape>(), offset };
+    }
+
+    size_t entry_count() const { return m_entry_count; }
+
+private:
+    struct Entry {
+        Shape const* raw_shape { nullptr };
+        WeakPtr<Shape> shape;
+        size_t offset { 0 };
+    };
+
+    Entry m_entries[max_entries];
+    u8 m_entry_count { 0 };
+    u8 m_next_victim { 0 };
+};
+
+}
@@ -25,4 +25,61 @@ void Instruction::destroy(Instruction& instruction)
 #undef __BYTECODE_OP
 }
 
+bool Instruction::is_terminator() const
+{
+#define __BYTECODE_OP(op) \
+    case Type::op:        \
+        return Op::op::IsTerminator;
+
+    switch (type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+#undef __BYTECODE_OP
+}
+
+void Instruction::relocate(Instruction& instruction, void* destination)
+{
+    // NOTE: Variable-width instructions keep their trailing operands right after the fixed-size part,
+    //       so those are copied over separately before the source instruction is destroyed.
+    auto length = instruction.length();
+#define __BYTECODE_OP(op)                                                                                          \
+    case Type::op: {                                                                                               \
+        auto& source = static_cast<Op::op&>(instruction);                                                          \
+        new (destination) Op::op(move(source));                                                                    \
+        if (length > sizeof(Op::op))                                                                               \
+            __builtin_memcpy(static_cast<u8*>(destination) + sizeof(Op::op), &source + 1, length - sizeof(Op::op)); \
+        source.~op();                                                                                              \
+        return;                                                                                                    \
+    }
+
+    switch (instruction.type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+#undef __BYTECODE_OP
+}
+
+void Instruction::replace_references(BasicBlock const& from, BasicBlock const& to)
+{
+    switch (type()) {
+    case Type::Jump:
+    case Type::JumpConditional:
+    case Type::JumpNullish:
+        return static_cast<Op::Jump&>(*this).replace_references(from, to);
+    case Type::EnterUnwindContext:
+        return static_cast<Op::EnterUnwindContext&>(*this).replace_references(from, to);
+    case Type::ContinuePendingUnwind:
+        return static_cast<Op::ContinuePendingUnwind&>(*this).replace_references(from, to);
+    case Type::Yield:
+        return static_cast<Op::Yield&>(*this).replace_references(from, to);
+    default:
+        return;
+    }
+}
+
 }
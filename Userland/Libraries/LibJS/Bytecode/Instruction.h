@@ -81,9 +81,12 @@ public:
 
     Type type() const { return m_type; }
     size_t length() const;
+    bool is_terminator() const;
     String to_string(Bytecode::Executable const&) const;
     void execute(Bytecode::Interpreter&) const;
+    void replace_references(BasicBlock const& from, BasicBlock const& to);
     static void destroy(Instruction&);
+    static void relocate(Instruction&, void* destination);
 
 protected:
     explicit Instruction(Type type)
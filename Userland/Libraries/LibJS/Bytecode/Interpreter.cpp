@@ -10,6 +10,7 @@
 #include <LibJS/Bytecode/Instruction.h>
 #include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/PassManager.h>
 #include <LibJS/Runtime/GlobalObject.h>
 
 namespace JS::Bytecode {
@@ -65,53 +66,10 @@ Value Interpreter::run(Executable const& executable, BasicBlock const* entry_poi
         registers()[Register::global_object_index] = Value(&global_object());
     }
 
-    for (;;) {
-        Bytecode::InstructionStreamIterator pc(block->instruction_stream());
-        bool will_jump = false;
-        bool will_return = false;
-        while (!pc.at_end()) {
-            auto& instruction = *pc;
-            instruction.execute(*this);
-            if (vm().exception()) {
-                m_saved_exception = {};
-                if (m_unwind_contexts.is_empty())
-                    break;
-                auto& unwind_context = m_unwind_contexts.last();
-                if (unwind_context.handler) {
-                    block = unwind_context.handler;
-                    unwind_context.handler = nullptr;
-                    accumulator() = vm().exception()->value();
-                    vm().clear_exception();
-                    will_jump = true;
-                } else if (unwind_context.finalizer) {
-                    block = unwind_context.finalizer;
-                    m_unwind_contexts.take_last();
-                    will_jump = true;
-                    m_saved_exception = Handle<Exception>::create(vm().exception());
-                    vm().clear_exception();
-                }
-            }
-            if (m_pending_jump.has_value()) {
-                block = m_pending_jump.release_value();
-                will_jump = true;
-                break;
-            }
-            if (!m_return_value.is_empty()) {
-                will_return = true;
-                break;
-            }
-            ++pc;
-        }
-
-        if (will_return)
-            break;
-
-        if (pc.at_end() && !will_jump)
-            break;
-
-        if (vm().exception())
-            break;
-    }
+    if (m_dispatch_mode == DispatchMode::Threaded)
+        run_with_threaded_dispatch(executable, *block);
+    else
+        run_with_switch_dispatch(*block);
 
     dbgln_if(JS_BYTECODE_DEBUG, "Bytecode::Interpreter did run unit {:p}", &executable);
 
@@ -144,6 +102,118 @@ Value Interpreter::run(Executable const& executable, BasicBlock const* entry_poi
     return return_value;
 }
 
+void Interpreter::run_with_switch_dispatch(BasicBlock const& entry_block)
+{
+    auto* block = &entry_block;
+    for (;;) {
+        Bytecode::InstructionStreamIterator pc(block->instruction_stream());
+        bool will_jump = false;
+        bool will_return = false;
+        while (!pc.at_end()) {
+            auto& instruction = *pc;
+            instruction.execute(*this);
+            if (vm().exception()) {
+                block = unwind_to_handler();
+                if (!block)
+                    return;
+                will_jump = true;
+                break;
+            }
+            if (m_pending_jump.has_value()) {
+                block = m_pending_jump.release_value();
+                will_jump = true;
+                break;
+            }
+            if (!m_return_value.is_empty()) {
+                will_return = true;
+                break;
+            }
+            ++pc;
+        }
+
+        if (will_return || !will_jump)
+            return;
+    }
+}
+
+void Interpreter::run_with_threaded_dispatch(Executable const& executable, BasicBlock const& entry_block)
+{
+    auto& code = executable.threaded_code();
+    auto const* instructions = code.instructions();
+    size_t pc = code.offset_of(entry_block);
+
+    // NOTE: Only the instructions that can actually throw or transfer control pay for checking
+    //       the exception, pending jump and return value state after running.
+    for (;;) {
+        auto& entry = instructions[pc];
+        switch (entry.kind) {
+        case ThreadedInstruction::Kind::Simple:
+            entry.handler(*this, *entry.instruction);
+            ++pc;
+            break;
+        case ThreadedInstruction::Kind::MayThrow:
+            entry.handler(*this, *entry.instruction);
+            if (vm().exception()) {
+                auto* handler = unwind_to_handler();
+                if (!handler)
+                    return;
+                pc = code.offset_of(*handler);
+                break;
+            }
+            ++pc;
+            break;
+        case ThreadedInstruction::Kind::Jump:
+            pc = entry.true_target;
+            break;
+        case ThreadedInstruction::Kind::JumpConditional:
+            pc = accumulator().to_boolean() ? entry.true_target : entry.false_target;
+            break;
+        case ThreadedInstruction::Kind::JumpNullish:
+            pc = accumulator().is_nullish() ? entry.true_target : entry.false_target;
+            break;
+        case ThreadedInstruction::Kind::ControlTransfer:
+            entry.handler(*this, *entry.instruction);
+            if (vm().exception()) {
+                auto* handler = unwind_to_handler();
+                if (!handler)
+                    return;
+                pc = code.offset_of(*handler);
+                break;
+            }
+            if (m_pending_jump.has_value()) {
+                pc = code.offset_of(*m_pending_jump.release_value());
+                break;
+            }
+            return;
+        case ThreadedInstruction::Kind::Exit:
+            return;
+        }
+    }
+}
+
+BasicBlock const* Interpreter::unwind_to_handler()
+{
+    VERIFY(vm().exception());
+    m_saved_exception = {};
+    if (m_unwind_contexts.is_empty())
+        return nullptr;
+
+    auto& unwind_context = m_unwind_contexts.last();
+    if (auto* handler = unwind_context.handler) {
+        unwind_context.handler = nullptr;
+        accumulator() = vm().exception()->value();
+        vm().clear_exception();
+        return handler;
+    }
+    if (auto* finalizer = unwind_context.finalizer) {
+        m_unwind_contexts.take_last();
+        m_saved_exception = Handle<Exception>::create(vm().exception());
+        vm().clear_exception();
+        return finalizer;
+    }
+    return nullptr;
+}
+
 void Interpreter::enter_unwind_context(Optional<Label> handler_target, Optional<Label> finalizer_target)
 {
     m_unwind_contexts.empend(handler_target.has_value() ? &handler_target->block() : nullptr, finalizer_target.has_value() ? &finalizer_target->block() : nullptr);
@@ -154,6 +224,33 @@ void Interpreter::leave_unwind_context()
     m_unwind_contexts.take_last();
 }
 
+PassManager& Interpreter::optimization_pipeline(OptimizationLevel level)
+{
+    auto underlying_level = static_cast<size_t>(level);
+    VERIFY(underlying_level < static_cast<size_t>(OptimizationLevel::__Count));
+    static AK::Array<OwnPtr<PassManager>, static_cast<size_t>(OptimizationLevel::__Count)> pipelines;
+    auto& entry = pipelines[underlying_level];
+    if (entry)
+        return *entry;
+
+    auto pm = make<PassManager>();
+    if (level >= OptimizationLevel::Default) {
+        pm->add<Passes::ThreadJumps>();
+        pm->add<Passes::GenerateCFG>();
+        pm->add<Passes::EliminateUnreachableBlocks>();
+        pm->add<Passes::GenerateCFG>();
+        pm->add<Passes::MergeBlocks>();
+    }
+    if (level >= OptimizationLevel::Aggressive) {
+        pm->add<Passes::EliminateRedundantMoves>();
+        pm->add<Passes::EliminateDeadStores>();
+    }
+
+    auto& passes = *pm;
+    entry = move(pm);
+    return passes;
+}
+
 void Interpreter::continue_pending_unwind(Label const& resume_label)
 {
     if (!m_saved_exception.is_null()) {
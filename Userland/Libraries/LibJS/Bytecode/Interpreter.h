@@ -7,6 +7,7 @@
 #pragma once
 
 #include "Generator.h"
+#include <LibJS/Bytecode/InlineCache.h>
 #include <LibJS/Bytecode/Label.h>
 #include <LibJS/Bytecode/Register.h>
 #include <LibJS/Forward.h>
@@ -17,6 +18,8 @@
 
 namespace JS::Bytecode {
 
+class PassManager;
+
 using RegisterWindow = Vector<Value>;
 
 class Interpreter {
@@ -60,9 +63,40 @@ public:
 
     Executable const& current_executable() { return *m_current_executable; }
 
+    enum class OptimizationLevel {
+        None,
+        Default,
+        Aggressive,
+        __Count,
+    };
+    static PassManager& optimization_pipeline(OptimizationLevel);
+
+    OptimizationLevel optimization_level() const { return m_optimization_level; }
+    void set_optimization_level(OptimizationLevel level) { m_optimization_level = level; }
+
+    bool inline_caches_enabled() const { return m_inline_caches_enabled; }
+    void set_inline_caches_enabled(bool enabled) { m_inline_caches_enabled = enabled; }
+    InlineCacheStatistics& inline_cache_statistics() { return m_inline_cache_statistics; }
+
+    enum class DispatchMode {
+        // Decode and dispatch every instruction straight from the block's instruction stream.
+        Switch,
+        // Run the Executable's pre-decoded ThreadedCode.
+        Threaded,
+    };
+    DispatchMode dispatch_mode() const { return m_dispatch_mode; }
+    void set_dispatch_mode(DispatchMode mode) { m_dispatch_mode = mode; }
+
 private:
     RegisterWindow& registers() { return m_register_windows.last(); }
 
+    void run_with_switch_dispatch(BasicBlock const& entry_block);
+    void run_with_threaded_dispatch(Executable const&, BasicBlock const& entry_block);
+
+    // Points the innermost unwind context at the pending exception. Returns the block to continue in,
+    // or nullptr if the exception has to propagate out of this run.
+    BasicBlock const* unwind_to_handler();
+
     VM& m_vm;
     GlobalObject& m_global_object;
     NonnullOwnPtrVector<RegisterWindow> m_register_windows;
@@ -72,6 +106,10 @@ private:
     Executable const* m_current_executable { nullptr };
     Vector<UnwindInfo> m_unwind_contexts;
     Handle<Exception> m_saved_exception;
+    OptimizationLevel m_optimization_level { OptimizationLevel::None };
+    bool m_inline_caches_enabled { true };
+    InlineCacheStatistics m_inline_cache_statistics;
+    DispatchMode m_dispatch_mode { DispatchMode::Threaded };
 };
 
 }
@@ -13,6 +13,7 @@
 #include <LibJS/Runtime/BigInt.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibJS/Runtime/LexicalEnvironment.h>
+#include <LibJS/Runtime/ProxyObject.h>
 #include <LibJS/Runtime/ScopeObject.h>
 #include <LibJS/Runtime/ScriptFunction.h>
 #include <LibJS/Runtime/Value.h>
@@ -148,16 +149,73 @@ void SetVariable::execute(Bytecode::Interpreter& interpreter) const
     interpreter.vm().set_variable(interpreter.current_executable().get_string(m_identifier), interpreter.accumulator(), interpreter.global_object());
 }
 
+// Returns the storage offset of an own data property if accesses to it can be served from an inline cache.
+static Optional<size_t> cacheable_property_offset(Object const& object, String const& property_name, bool for_put)
+{
+    auto& shape = object.shape();
+    if (shape.is_unique() || is<ProxyObject>(object))
+        return {};
+    auto metadata = shape.lookup(property_name);
+    if (!metadata.has_value())
+        return {};
+    if (for_put && !metadata->attributes.is_writable())
+        return {};
+    auto value = object.get_direct(metadata->offset);
+    if (value.is_accessor() || value.is_native_property())
+        return {};
+    return metadata->offset;
+}
+
 void GetById::execute(Bytecode::Interpreter& interpreter) const
 {
-    if (auto* object = interpreter.accumulator().to_object(interpreter.global_object()))
-        interpreter.accumulator() = object->get(interpreter.current_executable().get_string(m_property));
+    auto* object = interpreter.accumulator().to_object(interpreter.global_object());
+    if (!object)
+        return;
+
+    if (interpreter.inline_caches_enabled()) {
+        if (auto offset = m_cache.lookup(object->shape()); offset.has_value()) {
+            auto value = object->get_direct(*offset);
+            if (!value.is_accessor() && !value.is_native_property()) {
+                ++interpreter.inline_cache_statistics().hits;
+                interpreter.accumulator() = value.value_or(js_undefined());
+                return;
+            }
+        }
+        ++interpreter.inline_cache_statistics().misses;
+    }
+
+    auto& property_name = interpreter.current_executable().get_string(m_property);
+    interpreter.accumulator() = object->get(property_name);
+    if (interpreter.vm().exception() || !interpreter.inline_caches_enabled())
+        return;
+    if (auto offset = cacheable_property_offset(*object, property_name, false); offset.has_value())
+        m_cache.add(object->shape(), *offset);
 }
 
 void PutById::execute(Bytecode::Interpreter& interpreter) const
 {
-    if (auto* object = interpreter.reg(m_base).to_object(interpreter.global_object()))
-        object->put(interpreter.current_executable().get_string(m_property), interpreter.accumulator());
+    auto* object = interpreter.reg(m_base).to_object(interpreter.global_object());
+    if (!object)
+        return;
+
+    if (interpreter.inline_caches_enabled()) {
+        if (auto offset = m_cache.lookup(object->shape()); offset.has_value()) {
+            auto value_here = object->get_direct(*offset);
+            if (!value_here.is_accessor() && !value_here.is_native_property()) {
+                ++interpreter.inline_cache_statistics().hits;
+                object->put_direct(*offset, interpreter.accumulator());
+                return;
+            }
+        }
+        ++interpreter.inline_cache_statistics().misses;
+    }
+
+    auto& property_name = interpreter.current_executable().get_string(m_property);
+    object->put(property_name, interpreter.accumulator());
+    if (interpreter.vm().exception() || !interpreter.inline_caches_enabled())
+        return;
+    if (auto offset = cacheable_property_offset(*object, property_name, true); offset.has_value())
+        m_cache.add(object->shape(), *offset);
 }
 
 void Jump::execute(Bytecode::Interpreter& interpreter) const
@@ -311,6 +369,34 @@ void PutByValue::execute(Bytecode::Interpreter& interpreter) const
     }
 }
 
+void Jump::replace_references(BasicBlock const& from, BasicBlock const& to)
+{
+    if (m_true_target.has_value() && &m_true_target->block() == &from)
+        m_true_target = Label { to };
+    if (m_false_target.has_value() && &m_false_target->block() == &from)
+        m_false_target = Label { to };
+}
+
+void EnterUnwindContext::replace_references(BasicBlock const& from, BasicBlock const& to)
+{
+    if (m_handler_target.has_value() && &m_handler_target->block() == &from)
+        m_handler_target = Label { to };
+    if (m_finalizer_target.has_value() && &m_finalizer_target->block() == &from)
+        m_finalizer_target = Label { to };
+}
+
+void ContinuePendingUnwind::replace_references(BasicBlock const& from, BasicBlock const& to)
+{
+    if (&m_resume_target.block() == &from)
+        m_resume_target = Label { to };
+}
+
+void Yield::replace_references(BasicBlock const& from, BasicBlock const& to)
+{
+    if (m_continuation_label.has_value() && &m_continuation_label->block() == &from)
+        m_continuation_label = Label { to };
+}
+
 String Load::to_string(Bytecode::Executable const&) const
 {
     return String::formatted("Load {}", m_src);
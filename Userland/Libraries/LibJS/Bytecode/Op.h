@@ -9,6 +9,7 @@
 #pragma once
 
 #include <LibCrypto/BigInt/SignedBigInteger.h>
+#include <LibJS/Bytecode/InlineCache.h>
 #include <LibJS/Bytecode/Instruction.h>
 #include <LibJS/Bytecode/Label.h>
 #include <LibJS/Bytecode/Register.h>
@@ -30,6 +31,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Register src() const { return m_src; }
+
 private:
     Register m_src;
 };
@@ -60,6 +63,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Register dst() const { return m_dst; }
+
 private:
     Register m_dst;
 };
@@ -100,6 +105,8 @@ private:
         void execute(Bytecode::Interpreter&) const;             \
         String to_string(Bytecode::Executable const&) const;    \
                                                                 \
+        Register lhs() const { return m_lhs_reg; }              \
+                                                                \
     private:                                                    \
         Register m_lhs_reg;                                     \
     };
@@ -184,6 +191,9 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    size_t length() const { return sizeof(*this) + sizeof(Register) * m_element_count; }
+    Span<Register const> elements() const { return { m_elements, m_element_count }; }
+
 private:
     size_t m_element_count { 0 };
     Register m_elements[];
@@ -200,6 +210,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Register lhs() const { return m_lhs; }
+
 private:
     Register m_lhs;
 };
@@ -247,6 +259,7 @@ public:
 
 private:
     StringTableIndex m_property;
+    mutable PropertyInlineCache m_cache;
 };
 
 class PutById final : public Instruction {
@@ -261,9 +274,12 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Register base() const { return m_base; }
+
 private:
     Register m_base;
     StringTableIndex m_property;
+    mutable PropertyInlineCache m_cache;
 };
 
 class GetByValue final : public Instruction {
@@ -277,6 +293,8 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Register base() const { return m_base; }
+
 private:
     Register m_base;
 };
@@ -293,6 +311,9 @@ public:
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
 
+    Register base() const { return m_base; }
+    Register property() const { return m_property; }
+
 private:
     Register m_base;
     Register m_property;
@@ -322,8 +343,12 @@ public:
         m_false_target = move(false_target);
     }
 
+    Optional<Label> const& true_target() const { return m_true_target; }
+    Optional<Label> const& false_target() const { return m_false_target; }
+
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
+    void replace_references(BasicBlock const&, BasicBlock const&);
 
 protected:
     Optional<Label> m_true_target;
@@ -376,6 +401,10 @@ public:
 
     size_t length() const { return sizeof(*this) + sizeof(Register) * m_argument_count; }
 
+    Register callee() const { return m_callee; }
+    Register this_value() const { return m_this_value; }
+    Span<Register const> arguments() const { return { m_arguments, m_argument_count }; }
+
 private:
     Register m_callee;
     Register m_this_value;
@@ -458,6 +487,10 @@ public:
 
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
+    void replace_references(BasicBlock const&, BasicBlock const&);
+
+    Optional<Label> const& handler_target() const { return m_handler_target; }
+    Optional<Label> const& finalizer_target() const { return m_finalizer_target; }
 
 private:
     Optional<Label> m_handler_target;
@@ -487,6 +520,9 @@ public:
 
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
+    void replace_references(BasicBlock const&, BasicBlock const&);
+
+    Label const& resume_target() const { return m_resume_target; }
 
 private:
     Label m_resume_target;
@@ -509,6 +545,9 @@ public:
 
     void execute(Bytecode::Interpreter&) const;
     String to_string(Bytecode::Executable const&) const;
+    void replace_references(BasicBlock const&, BasicBlock const&);
+
+    Optional<Label> const& continuation() const { return m_continuation_label; }
 
 private:
     Optional<Label> m_continuation_label;
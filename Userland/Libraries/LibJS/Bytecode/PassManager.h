@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Optional.h>
+#include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/Bytecode/Generator.h>
+
+namespace JS::Bytecode {
+
+using ControlFlowGraph = HashMap<BasicBlock const*, HashTable<BasicBlock const*>>;
+
+struct PassPipelineExecutable {
+    Executable& executable;
+    Optional<ControlFlowGraph> cfg {};
+    Optional<ControlFlowGraph> inverted_cfg {};
+};
+
+class Pass {
+public:
+    Pass() = default;
+    virtual ~Pass() = default;
+
+    virtual void perform(PassPipelineExecutable&) = 0;
+};
+
+class PassManager final : public Pass {
+public:
+    PassManager() = default;
+    ~PassManager() override = default;
+
+    void add(NonnullOwnPtr<Pass> pass) { m_passes.append(move(pass)); }
+
+    template<typename PassT, typename... Args>
+    void add(Args&&... args) { m_passes.append(make<PassT>(forward<Args>(args)...)); }
+
+    void perform(Executable& executable)
+    {
+        executable.cached_threaded_code = nullptr;
+        PassPipelineExecutable pipeline_executable { executable };
+        perform(pipeline_executable);
+    }
+
+    virtual void perform(PassPipelineExecutable& executable) override
+    {
+        for (auto& pass : m_passes)
+            pass.perform(executable);
+    }
+
+    bool is_empty() const { return m_passes.is_empty(); }
+
+private:
+    NonnullOwnPtrVector<Pass> m_passes;
+};
+
+namespace Passes {
+
+// Builds the successor and predecessor maps for every block. Every label an instruction refers to
+// (jump targets, unwind handlers and finalizers, yield continuations) counts as an edge.
+class GenerateCFG final : public Pass {
+public:
+    GenerateCFG() = default;
+    ~GenerateCFG() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Removes every block that can't be reached from the entry block.
+class EliminateUnreachableBlocks final : public Pass {
+public:
+    EliminateUnreachableBlocks() = default;
+    ~EliminateUnreachableBlocks() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Retargets references to blocks that do nothing but jump somewhere else.
+class ThreadJumps final : public Pass {
+public:
+    ThreadJumps() = default;
+    ~ThreadJumps() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Appends a block to its only predecessor when that predecessor unconditionally jumps to it.
+class MergeBlocks final : public Pass {
+public:
+    MergeBlocks() = default;
+    ~MergeBlocks() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Removes accumulator/register moves whose effect is already in place or is immediately overwritten.
+class EliminateRedundantMoves final : public Pass {
+public:
+    EliminateRedundantMoves() = default;
+    ~EliminateRedundantMoves() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Removes stores to registers that no instruction in the executable ever reads.
+class EliminateDeadStores final : public Pass {
+public:
+    EliminateDeadStores() = default;
+    ~EliminateDeadStores() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+}
+
+}
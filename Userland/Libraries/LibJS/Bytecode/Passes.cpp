@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Queue.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+template<typename Callback>
+static void for_each_referenced_block(Instruction const& instruction, Callback callback)
+{
+    switch (instruction.type()) {
+    case Instruction::Type::Jump:
+    case Instruction::Type::JumpConditional:
+    case Instruction::Type::JumpNullish: {
+        auto& jump = static_cast<Op::Jump const&>(instruction);
+        if (jump.true_target().has_value())
+            callback(jump.true_target()->block());
+        if (jump.false_target().has_value())
+            callback(jump.false_target()->block());
+        break;
+    }
+    case Instruction::Type::EnterUnwindContext: {
+        auto& enter = static_cast<Op::EnterUnwindContext const&>(instruction);
+        if (enter.handler_target().has_value())
+            callback(enter.handler_target()->block());
+        if (enter.finalizer_target().has_value())
+            callback(enter.finalizer_target()->block());
+        break;
+    }
+    case Instruction::Type::ContinuePendingUnwind:
+        callback(static_cast<Op::ContinuePendingUnwind const&>(instruction).resume_target().block());
+        break;
+    case Instruction::Type::Yield: {
+        auto& yield = static_cast<Op::Yield const&>(instruction);
+        if (yield.continuation().has_value())
+            callback(yield.continuation()->block());
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+template<typename Callback>
+static void for_each_instruction(BasicBlock const& block, Callback callback)
+{
+    InstructionStreamIterator it(block.instruction_stream());
+    while (!it.at_end()) {
+        callback(const_cast<Instruction&>(*it));
+        ++it;
+    }
+}
+
+static Instruction const* last_instruction(BasicBlock const& block)
+{
+    Instruction const* last = nullptr;
+    for_each_instruction(block, [&](auto& instruction) { last = &instruction; });
+    return last;
+}
+
+// Returns the target of a block that consists of nothing but an unconditional jump.
+static BasicBlock const* trampoline_target(BasicBlock const& block)
+{
+    InstructionStreamIterator it(block.instruction_stream());
+    if (it.at_end() || (*it).type() != Instruction::Type::Jump)
+        return nullptr;
+    auto& jump = static_cast<Op::Jump const&>(*it);
+    if (!jump.true_target().has_value())
+        return nullptr;
+    return &jump.true_target()->block();
+}
+
+static void rebuild_block(BasicBlock& block, AK::Function<bool(Instruction const&)> const& should_keep)
+{
+    auto new_block = BasicBlock::create(block.name());
+    new_block->append_instructions_from(block, should_keep);
+    block.swap_instruction_streams(*new_block);
+}
+
+void GenerateCFG::perform(PassPipelineExecutable& executable)
+{
+    ControlFlowGraph cfg;
+    ControlFlowGraph inverted_cfg;
+
+    for (auto& block : executable.executable.basic_blocks) {
+        cfg.ensure(&block);
+        inverted_cfg.ensure(&block);
+    }
+
+    for (auto& block : executable.executable.basic_blocks) {
+        auto& successors = cfg.ensure(&block);
+        for_each_instruction(block, [&](auto& instruction) {
+            for_each_referenced_block(instruction, [&](auto& target) {
+                successors.set(&target);
+                inverted_cfg.ensure(&target).set(&block);
+            });
+        });
+    }
+
+    executable.cfg = move(cfg);
+    executable.inverted_cfg = move(inverted_cfg);
+}
+
+void EliminateUnreachableBlocks::perform(PassPipelineExecutable& executable)
+{
+    VERIFY(executable.cfg.has_value());
+    auto& blocks = executable.executable.basic_blocks;
+    if (blocks.is_empty())
+        return;
+
+    HashTable<BasicBlock const*> reachable;
+    Queue<BasicBlock const*> work_queue;
+    work_queue.enqueue(&blocks.first());
+    reachable.set(&blocks.first());
+    while (!work_queue.is_empty()) {
+        auto* block = work_queue.dequeue();
+        for (auto* successor : executable.cfg->ensure(block)) {
+            if (reachable.set(successor) == AK::HashSetResult::InsertedNewEntry)
+                work_queue.enqueue(successor);
+        }
+    }
+
+    if (reachable.size() == blocks.size())
+        return;
+
+    dbgln_if(JS_BYTECODE_DEBUG, "EliminateUnreachableBlocks: removing {} block(s)", blocks.size() - reachable.size());
+
+    // NOTE: Unreachable blocks may only refer to each other, so they can all be deleted at once.
+    blocks.remove_all_matching([&](auto& block) { return !reachable.contains(block.ptr()); });
+
+    executable.cfg = {};
+    executable.inverted_cfg = {};
+}
+
+void ThreadJumps::perform(PassPipelineExecutable& executable)
+{
+    auto& blocks = executable.executable.basic_blocks;
+
+    HashMap<BasicBlock const*, BasicBlock const*> final_targets;
+    for (auto& block : blocks) {
+        // Follow chains of trampolines, but give up on cycles (e.g. `for (;;) {}`).
+        BasicBlock const* target = &block;
+        size_t hops = 0;
+        while (auto* next = trampoline_target(*target)) {
+            if (next == target || ++hops > blocks.size())
+                break;
+            target = next;
+        }
+        if (target != &block && !trampoline_target(*target))
+            final_targets.set(&block, target);
+    }
+
+    if (final_targets.is_empty())
+        return;
+
+    for (auto& block : blocks) {
+        for_each_instruction(block, [&](auto& instruction) {
+            Vector<BasicBlock const*, 2> referenced_blocks;
+            for_each_referenced_block(instruction, [&](auto& target) { referenced_blocks.append(&target); });
+            for (auto* referenced_block : referenced_blocks) {
+                if (auto target = final_targets.get(referenced_block); target.has_value())
+                    instruction.replace_references(*referenced_block, *target.value());
+            }
+        });
+    }
+
+    executable.cfg = {};
+    executable.inverted_cfg = {};
+}
+
+void MergeBlocks::perform(PassPipelineExecutable& executable)
+{
+    VERIFY(executable.cfg.has_value());
+    VERIFY(executable.inverted_cfg.has_value());
+    auto& blocks = executable.executable.basic_blocks;
+    auto& cfg = *executable.cfg;
+    auto& inverted_cfg = *executable.inverted_cfg;
+
+    auto find_mergeable_successor = [&](BasicBlock& block) -> BasicBlock* {
+        auto* terminator = last_instruction(block);
+        if (!terminator || terminator->type() != Instruction::Type::Jump)
+            return nullptr;
+        auto& jump = static_cast<Op::Jump const&>(*terminator);
+        if (!jump.true_target().has_value())
+            return nullptr;
+        auto& successor = const_cast<BasicBlock&>(jump.true_target()->block());
+        // The entry block may be entered from the outside, so it has to stay where it is.
+        if (&successor == &block || &successor == &blocks.first())
+            return nullptr;
+        auto& predecessors = inverted_cfg.ensure(&successor);
+        if (predecessors.size() != 1)
+            return nullptr;
+        // The successor must only be referenced by the jump we're about to remove.
+        size_t reference_count = 0;
+        for_each_instruction(block, [&](auto& instruction) {
+            for_each_referenced_block(instruction, [&](auto& target) {
+                if (&target == &successor)
+                    ++reference_count;
+            });
+        });
+        if (reference_count != 1)
+            return nullptr;
+        auto merged_size = block.instruction_stream().size() - sizeof(Op::Jump) + successor.instruction_stream().size();
+        if (merged_size > block.capacity())
+            return nullptr;
+        return &successor;
+    };
+
+    for (;;) {
+        BasicBlock* block_to_extend = nullptr;
+        BasicBlock* block_to_absorb = nullptr;
+        for (auto& block : blocks) {
+            if (auto* successor = find_mergeable_successor(block)) {
+                block_to_extend = &block;
+                block_to_absorb = successor;
+                break;
+            }
+        }
+        if (!block_to_extend)
+            break;
+
+        auto* terminator = last_instruction(*block_to_extend);
+        auto merged_block = BasicBlock::create(block_to_extend->name());
+        merged_block->append_instructions_from(*block_to_extend, [&](auto& instruction) { return &instruction != terminator; });
+        merged_block->append_instructions_from(*block_to_absorb, [](auto&) { return true; });
+        block_to_extend->swap_instruction_streams(*merged_block);
+
+        auto successors = move(cfg.ensure(block_to_absorb));
+        cfg.remove(block_to_absorb);
+        for (auto* successor : successors) {
+            auto& predecessors = inverted_cfg.ensure(successor);
+            predecessors.remove(block_to_absorb);
+            predecessors.set(block_to_extend);
+        }
+        cfg.set(block_to_extend, move(successors));
+        inverted_cfg.remove(block_to_absorb);
+
+        blocks.remove_first_matching([&](auto& block) { return block.ptr() == block_to_absorb; });
+    }
+}
+
+void EliminateRedundantMoves::perform(PassPipelineExecutable& executable)
+{
+    auto is_accumulator_load = [](Instruction const& instruction) {
+        return instruction.type() == Instruction::Type::Load || instruction.type() == Instruction::Type::LoadImmediate;
+    };
+
+    for (auto& block : executable.executable.basic_blocks) {
+        Vector<Instruction const*> kept;
+        HashTable<Instruction const*> redundant;
+        for_each_instruction(block, [&](auto& instruction) {
+            if (!kept.is_empty()) {
+                auto& previous = *kept.last();
+                // `Store $x; Load $x` leaves the accumulator unchanged.
+                if (previous.type() == Instruction::Type::Store && instruction.type() == Instruction::Type::Load
+                    && static_cast<Op::Store const&>(previous).dst().index() == static_cast<Op::Load const&>(instruction).src().index()) {
+                    redundant.set(&instruction);
+                    return;
+                }
+                // `Load $x; Store $x` writes back the value the register already holds.
+                if (previous.type() == Instruction::Type::Load && instruction.type() == Instruction::Type::Store
+                    && static_cast<Op::Load const&>(previous).src().index() == static_cast<Op::Store const&>(instruction).dst().index()) {
+                    redundant.set(&instruction);
+                    return;
+                }
+                // A load into the accumulator that is immediately overwritten has no effect.
+                if (is_accumulator_load(previous) && is_accumulator_load(instruction)) {
+                    redundant.set(&previous);
+                    kept.take_last();
+                }
+            }
+            kept.append(&instruction);
+        });
+
+        if (redundant.is_empty())
+            continue;
+        rebuild_block(block, [&](auto& instruction) { return !redundant.contains(&instruction); });
+    }
+}
+
+void EliminateDeadStores::perform(PassPipelineExecutable& executable)
+{
+    HashTable<u32> read_registers;
+    auto read = [&](Register reg) { read_registers.set(reg.index()); };
+
+    for (auto& block : executable.executable.basic_blocks) {
+        for_each_instruction(block, [&](auto& instruction) {
+            switch (instruction.type()) {
+            case Instruction::Type::Load:
+                read(static_cast<Op::Load const&>(instruction).src());
+                break;
+#define __BYTECODE_BINARY_OP(OpTitleCase, op_snake_case)              \
+    case Instruction::Type::OpTitleCase:                              \
+        read(static_cast<Op::OpTitleCase const&>(instruction).lhs()); \
+        break;
+                JS_ENUMERATE_COMMON_BINARY_OPS(__BYTECODE_BINARY_OP)
+#undef __BYTECODE_BINARY_OP
+            case Instruction::Type::ConcatString:
+                read(static_cast<Op::ConcatString const&>(instruction).lhs());
+                break;
+            case Instruction::Type::PutById:
+                read(static_cast<Op::PutById const&>(instruction).base());
+                break;
+            case Instruction::Type::GetByValue:
+                read(static_cast<Op::GetByValue const&>(instruction).base());
+                break;
+            case Instruction::Type::PutByValue:
+                read(static_cast<Op::PutByValue const&>(instruction).base());
+                read(static_cast<Op::PutByValue const&>(instruction).property());
+                break;
+            case Instruction::Type::NewArray:
+                for (auto& element : static_cast<Op::NewArray const&>(instruction).elements())
+                    read(element);
+                break;
+            case Instruction::Type::Call: {
+                auto& call = static_cast<Op::Call const&>(instruction);
+                read(call.callee());
+                read(call.this_value());
+                for (auto& argument : call.arguments())
+                    read(argument);
+                break;
+            }
+            default:
+                break;
+            }
+        });
+    }
+
+    auto is_dead_store = [&](Instruction const& instruction) {
+        if (instruction.type() != Instruction::Type::Store)
+            return false;
+        auto index = static_cast<Op::Store const&>(instruction).dst().index();
+        // The accumulator and the global object register are observable from outside the executable.
+        if (index == Register::accumulator_index || index == Register::global_object_index)
+            return false;
+        return !read_registers.contains(index);
+    };
+
+    for (auto& block : executable.executable.basic_blocks) {
+        bool has_dead_store = false;
+        for_each_instruction(block, [&](auto& instruction) { has_dead_store |= is_dead_store(instruction); });
+        if (has_dead_store)
+            rebuild_block(block, [&](auto& instruction) { return !is_dead_store(instruction); });
+    }
+}
+
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/ThreadedCode.h>
+
+namespace JS::Bytecode {
+
+#define __BYTECODE_OP(op)                                                                \
+    static void execute_##op(Interpreter& interpreter, Instruction const& instruction) \
+    {                                                                                    \
+        static_cast<Op::op const&>(instruction).execute(interpreter);                   \
+    }
+ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+
+static ThreadedInstruction::Handler handler_for(Instruction const& instruction)
+{
+#define __BYTECODE_OP(op) \
+    case Instruction::Type::op:  \
+        return execute_##op;
+
+    switch (instruction.type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+#undef __BYTECODE_OP
+}
+
+static ThreadedInstruction::Kind kind_for(Instruction const& instruction)
+{
+    using Kind = ThreadedInstruction::Kind;
+    switch (instruction.type()) {
+    case Instruction::Type::Load:
+    case Instruction::Type::LoadImmediate:
+    case Instruction::Type::Store:
+    case Instruction::Type::TypedEquals:
+    case Instruction::Type::TypedInequals:
+    case Instruction::Type::Not:
+    case Instruction::Type::Typeof:
+    case Instruction::Type::NewBigInt:
+    case Instruction::Type::NewArray:
+    case Instruction::Type::NewString:
+    case Instruction::Type::NewObject:
+    case Instruction::Type::NewFunction:
+    case Instruction::Type::PushLexicalEnvironment:
+    case Instruction::Type::EnterUnwindContext:
+    case Instruction::Type::LeaveUnwindContext:
+        return Kind::Simple;
+    case Instruction::Type::Jump:
+    case Instruction::Type::JumpConditional:
+    case Instruction::Type::JumpNullish: {
+        auto& jump = static_cast<Op::Jump const&>(instruction);
+        // NOTE: A jump with missing targets falls back to its regular handler, which will complain loudly.
+        if (!jump.true_target().has_value())
+            return Kind::ControlTransfer;
+        if (instruction.type() == Instruction::Type::Jump)
+            return Kind::Jump;
+        if (!jump.false_target().has_value())
+            return Kind::ControlTransfer;
+        return instruction.type() == Instruction::Type::JumpConditional ? Kind::JumpConditional : Kind::JumpNullish;
+    }
+    case Instruction::Type::Return:
+    case Instruction::Type::Throw:
+    case Instruction::Type::Yield:
+    case Instruction::Type::ContinuePendingUnwind:
+        return Kind::ControlTransfer;
+    default:
+        return Kind::MayThrow;
+    }
+}
+
+// NOTE: The optimization passes may splice blocks together, so look at the instructions rather than trusting is_terminated().
+static bool ends_with_terminator(BasicBlock const& block)
+{
+    bool last_was_terminator = false;
+    for (InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it)
+        last_was_terminator = (*it).is_terminator();
+    return last_was_terminator;
+}
+
+NonnullOwnPtr<ThreadedCode> ThreadedCode::create(Executable const& executable)
+{
+    auto code = adopt_own(*new ThreadedCode);
+
+    // First lay out the blocks, so jump targets can be resolved in a single pass afterwards.
+    size_t offset = 0;
+    for (auto& block : executable.basic_blocks) {
+        code->m_block_offsets.set(&block, offset);
+        for (InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it)
+            ++offset;
+        if (!ends_with_terminator(block))
+            ++offset;
+    }
+    code->m_instructions.ensure_capacity(offset);
+
+    for (auto& block : executable.basic_blocks) {
+        for (InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it) {
+            auto& instruction = *it;
+            ThreadedInstruction entry;
+            entry.handler = handler_for(instruction);
+            entry.instruction = &instruction;
+            entry.kind = kind_for(instruction);
+            if (entry.kind == ThreadedInstruction::Kind::Jump
+                || entry.kind == ThreadedInstruction::Kind::JumpConditional
+                || entry.kind == ThreadedInstruction::Kind::JumpNullish) {
+                auto& jump = static_cast<Op::Jump const&>(instruction);
+                entry.true_target = code->offset_of(jump.true_target()->block());
+                if (jump.false_target().has_value())
+                    entry.false_target = code->offset_of(jump.false_target()->block());
+            }
+            code->m_instructions.unchecked_append(entry);
+        }
+        if (!ends_with_terminator(block))
+            code->m_instructions.unchecked_append({});
+    }
+
+    VERIFY(code->m_instructions.size() == offset);
+    return code;
+}
+
+}
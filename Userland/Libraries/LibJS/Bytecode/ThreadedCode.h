@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Vector.h>
+#include <LibJS/Forward.h>
+
+namespace JS::Bytecode {
+
+struct ThreadedInstruction {
+    enum class Kind : u8 {
+        // Can neither throw nor transfer control, so execution simply continues with the next entry.
+        Simple,
+        // May leave an exception behind that has to be unwound.
+        MayThrow,
+        // Jumps are performed by the dispatch loop itself, using the pre-resolved targets.
+        Jump,
+        JumpConditional,
+        JumpNullish,
+        // Return, Throw, Yield and ContinuePendingUnwind: the handler decides where execution goes next.
+        ControlTransfer,
+        // The end of a block that isn't terminated.
+        Exit,
+    };
+
+    using Handler = void (*)(Interpreter&, Instruction const&);
+
+    Handler handler { nullptr };
+    Instruction const* instruction { nullptr };
+    u32 true_target { 0 };
+    u32 false_target { 0 };
+    Kind kind { Kind::Exit };
+};
+
+// A pre-decoded copy of an Executable's control flow: every instruction of every block laid out
+// in a flat array, with its handler resolved and jump targets turned into indices into that array.
+class ThreadedCode {
+public:
+    static NonnullOwnPtr<ThreadedCode> create(Executable const&);
+
+    ThreadedInstruction const* instructions() const { return m_instructions.data(); }
+    size_t size() const { return m_instructions.size(); }
+
+    u32 offset_of(BasicBlock const& block) const
+    {
+        auto it = m_block_offsets.find(&block);
+        VERIFY(it != m_block_offsets.end());
+        return it->value;
+    }
+
+private:
+    ThreadedCode() = default;
+
+    Vector<ThreadedInstruction> m_instructions;
+    HashMap<BasicBlock const*, u32> m_block_offsets;
+};
+
+}
@@ -37,6 +37,39 @@ BlockAllocator::~BlockAllocator()
     }
 }
 
+void BlockAllocator::did_hand_out_block(void* block)
+{
+    auto address = reinterpret_cast<FlatPtr>(block);
+    size_t low = 0;
+    size_t high = m_live_blocks.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (m_live_blocks[middle] < address)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    VERIFY(low == m_live_blocks.size() || m_live_blocks[low] != address);
+    m_live_blocks.insert(low, address);
+    m_lowest_live_block_address = m_live_blocks.first();
+    m_highest_live_block_end = m_live_blocks.last() + HeapBlock::block_size;
+}
+
+void BlockAllocator::did_take_back_block(void* block)
+{
+    size_t index = 0;
+    auto* entry = binary_search(m_live_blocks, reinterpret_cast<FlatPtr>(block), &index);
+    VERIFY(entry);
+    m_live_blocks.remove(index);
+    if (m_live_blocks.is_empty()) {
+        m_lowest_live_block_address = 0;
+        m_highest_live_block_end = 0;
+    } else {
+        m_lowest_live_block_address = m_live_blocks.first();
+        m_highest_live_block_end = m_live_blocks.last() + HeapBlock::block_size;
+    }
+}
+
 void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
 {
     if (!m_blocks.is_empty()) {
@@ -48,6 +81,7 @@ void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
             VERIFY_NOT_REACHED();
         }
 #endif
+        did_hand_out_block(block);
         return block;
     }
 
@@ -58,12 +92,14 @@ void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
     auto* block = (HeapBlock*)aligned_alloc(HeapBlock::block_size, HeapBlock::block_size);
     VERIFY(block);
 #endif
+    did_hand_out_block(block);
     return block;
 }
 
 void BlockAllocator::deallocate_block(void* block)
 {
     VERIFY(block);
+    did_take_back_block(block);
     if (m_blocks.size() >= max_cached_blocks) {
 #ifdef __serenity__
         if (munmap(block, HeapBlock::block_size) < 0) {
@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <AK/BinarySearch.h>
 #include <AK/Vector.h>
 #include <LibJS/Forward.h>
+#include <LibJS/Heap/HeapBlock.h>
 
 namespace JS {
 
@@ -19,10 +21,32 @@ public:
     void* allocate_block(char const* name);
     void deallocate_block(void*);
 
+    // Returns the block that's currently handed out and contains the given address, if any.
+    // This is meant for filtering conservative root candidates, most of which aren't heap pointers at all.
+    ALWAYS_INLINE HeapBlock* live_block_containing(FlatPtr address) const
+    {
+        if (address < m_lowest_live_block_address || address >= m_highest_live_block_end)
+            return nullptr;
+        auto block_address = address & ~(HeapBlock::block_size - 1);
+        if (!binary_search(m_live_blocks, block_address))
+            return nullptr;
+        return reinterpret_cast<HeapBlock*>(block_address);
+    }
+
+    size_t live_block_count() const { return m_live_blocks.size(); }
+
 private:
+    void did_hand_out_block(void*);
+    void did_take_back_block(void*);
+
     static constexpr size_t max_cached_blocks = 64;
 
     Vector<void*, max_cached_blocks> m_blocks;
+
+    // Addresses of all blocks currently handed out, kept sorted.
+    Vector<FlatPtr> m_live_blocks;
+    FlatPtr m_lowest_live_block_address { 0 };
+    FlatPtr m_highest_live_block_end { 0 };
 };
 
 }
@@ -26,6 +26,31 @@ public:
     bool is_marked() const { return m_mark; }
     void set_marked(bool b) { m_mark = b; }
 
+    // Cells that survive a collection are promoted to the old generation, which young collections don't trace through.
+    bool is_old() const { return m_old; }
+    void set_old(bool b) { m_old = b; }
+
+    // Remembered old cells may point into the young generation, so young collections treat them as roots.
+    bool is_remembered() const { return m_remembered; }
+    void set_remembered(bool b) { m_remembered = b; }
+
+    // Cells without write barriers stay remembered for as long as they're old.
+    bool has_write_barriers() const { return m_has_write_barriers; }
+    void set_has_write_barriers(bool b) { m_has_write_barriers = b; }
+
+    ALWAYS_INLINE void write_barrier(Cell const* target)
+    {
+        if (m_old && !m_remembered && target && !target->m_old)
+            remember();
+    }
+
+    // For mutations where it's not practical to tell what was stored.
+    ALWAYS_INLINE void write_barrier()
+    {
+        if (m_old && !m_remembered)
+            remember();
+    }
+
     enum class State {
         Live,
         Dead,
@@ -59,10 +84,20 @@ protected:
     Cell() { }
 
 private:
+    void remember();
+
     bool m_mark : 1 { false };
-    State m_state : 7 { State::Live };
+    bool m_old : 1 { false };
+    bool m_remembered : 1 { false };
+    bool m_has_write_barriers : 1 { false };
+    State m_state : 4 { State::Live };
 };
 
+// Cells whose exact type is listed here report every cell reference they store after construction through
+// Cell::write_barrier(). This is deliberately not inherited, since subclasses usually bring edges of their own.
+template<typename T>
+inline constexpr bool HasWriteBarriers = false;
+
 }
 
 template<>
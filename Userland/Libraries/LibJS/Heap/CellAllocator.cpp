@@ -21,19 +21,45 @@ CellAllocator::~CellAllocator()
 {
 }
 
-Cell* CellAllocator::allocate_cell(Heap& heap)
+Cell* CellAllocator::allocate_cell_slow(Heap& heap)
 {
-    if (m_usable_blocks.is_empty()) {
-        auto block = HeapBlock::create_with_cell_size(heap, m_cell_size);
-        m_usable_blocks.append(*block.leak_ptr());
+    if (m_bump_block)
+        retire_bump_block();
+
+    if (!m_usable_blocks.is_empty()) {
+        auto& block = *m_usable_blocks.last();
+        auto* cell = block.allocate();
+        VERIFY(cell);
+        if (block.is_full())
+            m_full_blocks.append(*m_usable_blocks.last());
+        return cell;
     }
 
-    auto& block = *m_usable_blocks.last();
-    auto* cell = block.allocate();
-    VERIFY(cell);
-    if (block.is_full())
-        m_full_blocks.append(*m_usable_blocks.last());
-    return cell;
+    // Nothing left to reuse, so start bump allocating from a fresh block.
+    auto* block = HeapBlock::create_with_cell_size(heap, m_cell_size).leak_ptr();
+    m_full_blocks.append(*block);
+    block->set_has_young_cells();
+    m_bump_block = block;
+    m_bump_pointer = block->lazy_region_begin();
+    m_bump_end = block->lazy_region_end();
+    return allocate_cell(heap);
+}
+
+void CellAllocator::retire_bump_block()
+{
+    VERIFY(m_bump_block);
+    m_bump_block->did_bump_allocate_until(m_bump_pointer);
+    if (!m_bump_block->is_full())
+        m_usable_blocks.append(*m_bump_block);
+    m_bump_block = nullptr;
+    m_bump_pointer = nullptr;
+    m_bump_end = nullptr;
+}
+
+void CellAllocator::flush_bump_allocation(Badge<Heap>)
+{
+    if (m_bump_block)
+        retire_bump_block();
 }
 
 void CellAllocator::block_did_become_empty(Badge<Heap>, HeapBlock& block)
@@ -21,7 +21,20 @@ public:
 
     size_t cell_size() const { return m_cell_size; }
 
-    Cell* allocate_cell(Heap&);
+    ALWAYS_INLINE Cell* allocate_cell(Heap& heap)
+    {
+        if (m_bump_pointer < m_bump_end) {
+            auto* cell = reinterpret_cast<Cell*>(m_bump_pointer);
+            m_bump_pointer += m_cell_size;
+            ASAN_UNPOISON_MEMORY_REGION(cell, m_cell_size);
+            return cell;
+        }
+        return allocate_cell_slow(heap);
+    }
+
+    // Hands the bump allocation state back to the block it came from. This has to happen before
+    // the heap inspects any blocks, as cells handed out by the fast path are otherwise invisible.
+    void flush_bump_allocation(Badge<Heap>);
 
     template<typename Callback>
     IterationDecision for_each_block(Callback callback)
@@ -41,8 +54,17 @@ public:
     void block_did_become_usable(Badge<Heap>, HeapBlock&);
 
 private:
+    Cell* allocate_cell_slow(Heap&);
+    void retire_bump_block();
+
     const size_t m_cell_size;
 
+    // The fresh block we're currently bump allocating from. It sits in the full list in the meantime,
+    // since nothing else is allowed to allocate from it.
+    HeapBlock* m_bump_block { nullptr };
+    u8* m_bump_pointer { nullptr };
+    u8* m_bump_end { nullptr };
+
     typedef IntrusiveList<HeapBlock, RawPtr<HeapBlock>, &HeapBlock::m_list_node> BlockList;
     BlockList m_full_blocks;
     BlockList m_usable_blocks;
@@ -9,7 +9,6 @@
 #include <AK/HashTable.h>
 #include <AK/StackInfo.h>
 #include <AK/TemporaryChange.h>
-#include <LibCore/ElapsedTimer.h>
 #include <LibJS/Heap/CellAllocator.h>
 #include <LibJS/Heap/Handle.h>
 #include <LibJS/Heap/Heap.h>
@@ -18,6 +17,7 @@
 #include <LibJS/Runtime/Object.h>
 #include <LibJS/Runtime/WeakSet.h>
 #include <setjmp.h>
+#include <time.h>
 
 namespace JS {
 
@@ -35,6 +35,17 @@ Heap::Heap(VM& vm)
     m_allocators.append(make<CellAllocator>(512));
     m_allocators.append(make<CellAllocator>(1024));
     m_allocators.append(make<CellAllocator>(3072));
+    VERIFY(m_allocators.last()->cell_size() == max_cell_size);
+
+    for (size_t size_class = 0; size_class < m_allocator_for_size_class.size(); ++size_class) {
+        auto size = size_class * size_class_granularity;
+        for (auto& allocator : m_allocators) {
+            if (allocator->cell_size() >= size) {
+                m_allocator_for_size_class[size_class] = allocator.ptr();
+                break;
+            }
+        }
+    }
 }
 
 Heap::~Heap()
@@ -44,21 +55,22 @@ Heap::~Heap()
 
 ALWAYS_INLINE CellAllocator& Heap::allocator_for_size(size_t cell_size)
 {
-    for (auto& allocator : m_allocators) {
-        if (allocator->cell_size() >= cell_size)
-            return *allocator;
+    auto size_class = (cell_size + size_class_granularity - 1) / size_class_granularity;
+    if (size_class >= m_allocator_for_size_class.size()) {
+        dbgln("Cannot get CellAllocator for cell size {}, largest available is {}!", cell_size, max_cell_size);
+        VERIFY_NOT_REACHED();
     }
-    dbgln("Cannot get CellAllocator for cell size {}, largest available is {}!", cell_size, m_allocators.last()->cell_size());
-    VERIFY_NOT_REACHED();
+    return *m_allocator_for_size_class[size_class];
 }
 
 Cell* Heap::allocate_cell(size_t size)
 {
     if (should_collect_on_every_allocation()) {
-        collect_garbage();
+        // Alternate between both kinds of collection, so missing roots and missing write barriers both get caught.
+        collect_garbage(m_allocations_since_last_gc++ % 2 ? CollectionType::CollectGarbage : CollectionType::CollectYoungGeneration);
     } else if (m_allocations_since_last_gc > m_max_allocations_between_gc) {
         m_allocations_since_last_gc = 0;
-        collect_garbage();
+        collect_garbage(CollectionType::CollectYoungGeneration);
     } else {
         ++m_allocations_since_last_gc;
     }
@@ -67,23 +79,39 @@ Cell* Heap::allocate_cell(size_t size)
     return allocator.allocate_cell(*this);
 }
 
+static Time monotonic_time()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return Time::from_timespec(now);
+}
+
 void Heap::collect_garbage(CollectionType collection_type, bool print_report)
 {
     VERIFY(!m_collecting_garbage);
     TemporaryChange change(m_collecting_garbage, true);
 
-    Core::ElapsedTimer collection_measurement_timer;
-    collection_measurement_timer.start();
-    if (collection_type == CollectionType::CollectGarbage) {
-        if (m_gc_deferrals) {
-            m_should_gc_when_deferral_ends = true;
-            return;
-        }
+    auto collection_start_time = monotonic_time();
+
+    if (collection_type == CollectionType::CollectYoungGeneration && m_promotions_since_last_full_gc > m_max_promotions_between_full_gc)
+        collection_type = CollectionType::CollectGarbage;
+
+    if (collection_type != CollectionType::CollectEverything && m_gc_deferrals) {
+        if (!m_should_gc_when_deferral_ends || collection_type == CollectionType::CollectGarbage)
+            m_collection_type_when_deferral_ends = collection_type;
+        m_should_gc_when_deferral_ends = true;
+        return;
+    }
+
+    for (auto& allocator : m_allocators)
+        allocator->flush_bump_allocation({});
+
+    if (collection_type != CollectionType::CollectEverything) {
         HashTable<Cell*> roots;
         gather_roots(roots);
-        mark_live_cells(roots);
+        mark_live_cells(roots, collection_type);
     }
-    sweep_dead_cells(print_report, collection_measurement_timer);
+    sweep_dead_cells(print_report, collection_type, collection_start_time);
 }
 
 void Heap::gather_roots(HashTable<Cell*>& roots)
@@ -117,70 +145,119 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
     jmp_buf buf;
     setjmp(buf);
 
-    HashTable<FlatPtr> possible_pointers;
+    auto add_possible_value = [&](FlatPtr possible_pointer) {
+        auto* possible_heap_block = m_block_allocator.live_block_containing(possible_pointer);
+        if (!possible_heap_block)
+            return;
+        dbgln_if(HEAP_DEBUG, "  ? {}", (const void*)possible_pointer);
+        if (auto* cell = possible_heap_block->cell_from_possible_pointer(possible_pointer)) {
+            if (cell->state() == Cell::State::Live) {
+                dbgln_if(HEAP_DEBUG, "  ?-> {}", (const void*)cell);
+                roots.set(cell);
+            } else {
+                dbgln_if(HEAP_DEBUG, "  #-> {}", (const void*)cell);
+            }
+        }
+    };
 
     auto* raw_jmp_buf = reinterpret_cast<FlatPtr const*>(buf);
 
-    for (size_t i = 0; i < ((size_t)sizeof(buf)) / sizeof(FlatPtr); i += sizeof(FlatPtr))
-        possible_pointers.set(raw_jmp_buf[i]);
+    for (size_t i = 0; i < ((size_t)sizeof(buf)) / sizeof(FlatPtr); ++i)
+        add_possible_value(raw_jmp_buf[i]);
 
     auto stack_reference = bit_cast<FlatPtr>(&dummy);
     auto& stack_info = m_vm.stack_info();
 
     for (FlatPtr stack_address = stack_reference; stack_address < stack_info.top(); stack_address += sizeof(FlatPtr)) {
         auto data = *reinterpret_cast<FlatPtr*>(stack_address);
-        possible_pointers.set(data);
-    }
-
-    HashTable<HeapBlock*> all_live_heap_blocks;
-    for_each_block([&](auto& block) {
-        all_live_heap_blocks.set(&block);
-        return IterationDecision::Continue;
-    });
-
-    for (auto possible_pointer : possible_pointers) {
-        if (!possible_pointer)
-            continue;
-        dbgln_if(HEAP_DEBUG, "  ? {}", (const void*)possible_pointer);
-        auto* possible_heap_block = HeapBlock::from_cell(reinterpret_cast<const Cell*>(possible_pointer));
-        if (all_live_heap_blocks.contains(possible_heap_block)) {
-            if (auto* cell = possible_heap_block->cell_from_possible_pointer(possible_pointer)) {
-                if (cell->state() == Cell::State::Live) {
-                    dbgln_if(HEAP_DEBUG, "  ?-> {}", (const void*)cell);
-                    roots.set(cell);
-                } else {
-                    dbgln_if(HEAP_DEBUG, "  #-> {}", (const void*)cell);
-                }
-            }
-        }
+        add_possible_value(data);
     }
 }
 
 class MarkingVisitor final : public Cell::Visitor {
 public:
-    MarkingVisitor() { }
+    explicit MarkingVisitor(bool young_generation_only)
+        : m_young_generation_only(young_generation_only)
+    {
+    }
 
     virtual void visit_impl(Cell& cell)
     {
         if (cell.is_marked())
             return;
+        // Old cells are known to be alive during a young collection, and anything young they point to
+        // is reachable through the remembered set.
+        if (m_young_generation_only && cell.is_old())
+            return;
         dbgln_if(HEAP_DEBUG, "  ! {}", &cell);
         cell.set_marked(true);
         cell.visit_edges(*this);
     }
+
+private:
+    bool m_young_generation_only { false };
 };
 
-void Heap::mark_live_cells(const HashTable<Cell*>& roots)
+void Heap::mark_live_cells(const HashTable<Cell*>& roots, CollectionType collection_type)
 {
     dbgln_if(HEAP_DEBUG, "mark_live_cells:");
-    MarkingVisitor visitor;
+    bool is_young_collection = collection_type == CollectionType::CollectYoungGeneration;
+    MarkingVisitor visitor(is_young_collection);
     for (auto* root : roots)
         visitor.visit(root);
+
+    if (!is_young_collection)
+        return;
+    for (auto* cell : m_remembered_cells)
+        cell->visit_edges(visitor);
+    for (auto* cell : m_permanently_remembered_cells)
+        cell->visit_edges(visitor);
+}
+
+void Cell::remember()
+{
+    VERIFY(is_old());
+    HeapBlock::from_cell(this)->heap().did_remember_cell({}, *this);
 }
 
-void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measurement_timer)
+void Heap::did_remember_cell(Badge<Cell>, Cell& cell)
+{
+    VERIFY(!cell.is_remembered());
+    cell.set_remembered(true);
+    m_remembered_cells.append(&cell);
+}
+
+void Heap::forget_remembered_cells()
+{
+    // NOTE: Every young cell that survives a collection gets promoted, so there can't be any pointers
+    //       from the old generation into the young one once a collection is over.
+    for (auto* cell : m_remembered_cells)
+        cell->set_remembered(false);
+    m_remembered_cells.clear_with_capacity();
+}
+
+void Heap::promote(Cell& cell)
+{
+    VERIFY(!cell.is_old());
+    cell.set_old(true);
+    ++m_promotions_since_last_full_gc;
+    // NOTE: Only the exact types that opt into HasWriteBarriers can be left out of young collections. That's
+    //       plain objects, arrays, functions, environments, shapes and primitives; every other subclass
+    //       of Object (prototypes, constructors, wrappers, ...) stays remembered for as long as it lives.
+    if (!cell.has_write_barriers()) {
+        cell.set_remembered(true);
+        m_permanently_remembered_cells.set(&cell);
+    }
+}
+
+void Heap::sweep_dead_cells(bool print_report, CollectionType collection_type, Time const& collection_start_time)
 {
     dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
+    bool is_young_collection = collection_type == CollectionType::CollectYoungGeneration;
+
+    // NOTE: This has to happen before sweeping, as remembered cells may be about to die.
+    forget_remembered_cells();
+
     Vector<HeapBlock*, 32> empty_blocks;
     Vector<HeapBlock*, 32> full_blocks_that_became_usable;
     Vector<Cell*> sweeped_cells;
@@ -192,11 +269,20 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
 
     auto should_store_sweeped_cells = !m_weak_sets.is_empty();
     for_each_block([&](auto& block) {
+        if (is_young_collection && !block.has_young_cells())
+            return IterationDecision::Continue;
+        block.clear_has_young_cells();
         bool block_has_live_cells = false;
         bool block_was_full = block.is_full();
         block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
+            if (is_young_collection && cell->is_old()) {
+                block_has_live_cells = true;
+                return;
+            }
             if (!cell->is_marked()) {
                 dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
+                if (cell->is_remembered())
+                    m_permanently_remembered_cells.remove(cell);
                 if (should_store_sweeped_cells)
                     sweeped_cells.append(cell);
                 block.deallocate(cell);
@@ -204,6 +290,8 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
                 collected_cell_bytes += block.cell_size();
             } else {
                 cell->set_marked(false);
+                if (!cell->is_old())
+                    promote(*cell);
                 block_has_live_cells = true;
                 ++live_cells;
                 live_cell_bytes += block.cell_size();
@@ -236,22 +324,36 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
         });
     }
 
-    int time_spent = measurement_timer.elapsed();
+    if (!is_young_collection)
+        m_promotions_since_last_full_gc = 0;
+
+    auto pause_time = (monotonic_time() - collection_start_time).to_microseconds();
+    if (collection_type != CollectionType::CollectEverything) {
+        auto& statistics = is_young_collection ? m_young_collection_statistics : m_full_collection_statistics;
+        ++statistics.collections;
+        statistics.total_microseconds += pause_time;
+        statistics.max_microseconds = max(statistics.max_microseconds, pause_time);
+        statistics.last_microseconds = pause_time;
+    }
 
     if (print_report) {
-        size_t live_block_count = 0;
-        for_each_block([&](auto&) {
-            ++live_block_count;
-            return IterationDecision::Continue;
-        });
+        auto live_block_count = m_block_allocator.live_block_count();
+
+        auto average_pause_time = [](PauseTimeStatistics const& statistics) {
+            return statistics.collections ? statistics.total_microseconds / static_cast<i64>(statistics.collections) : 0;
+        };
 
         dbgln("Garbage collection report");
         dbgln("=============================================");
-        dbgln("     Time spent: {} ms", time_spent);
+        dbgln("Collection type: {}", is_young_collection ? "Young generation" : "Full");
+        dbgln("     Time spent: {} ms", pause_time / 1000);
         dbgln("     Live cells: {} ({} bytes)", live_cells, live_cell_bytes);
         dbgln("Collected cells: {} ({} bytes)", collected_cells, collected_cell_bytes);
         dbgln("    Live blocks: {} ({} bytes)", live_block_count, live_block_count * HeapBlock::block_size);
         dbgln("   Freed blocks: {} ({} bytes)", empty_blocks.size(), empty_blocks.size() * HeapBlock::block_size);
+        dbgln(" Remembered set: {} cells without write barriers", m_permanently_remembered_cells.size());
+        dbgln("   Young pauses: {} collections, {} us average, {} us max", m_young_collection_statistics.collections, average_pause_time(m_young_collection_statistics), m_young_collection_statistics.max_microseconds);
+        dbgln("    Full pauses: {} collections, {} us average, {} us max", m_full_collection_statistics.collections, average_pause_time(m_full_collection_statistics), m_full_collection_statistics.max_microseconds);
         dbgln("=============================================");
     }
 }
@@ -304,7 +406,7 @@ void Heap::undefer_gc(Badge<DeferGC>)
 
     if (!m_gc_deferrals) {
         if (m_should_gc_when_deferral_ends)
-            collect_garbage();
+            collect_garbage(m_collection_type_when_deferral_ends);
         m_should_gc_when_deferral_ends = false;
     }
 }
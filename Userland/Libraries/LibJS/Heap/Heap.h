@@ -6,9 +6,11 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/HashTable.h>
 #include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/Time.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCore/Forward.h>
@@ -34,7 +36,10 @@ public:
     {
         auto* memory = allocate_cell(sizeof(T));
         new (memory) T(forward<Args>(args)...);
-        return static_cast<T*>(memory);
+        auto* cell = static_cast<T*>(memory);
+        if constexpr (HasWriteBarriers<T>)
+            cell->set_has_write_barriers(true);
+        return cell;
     }
 
     template<typename T, typename... Args>
@@ -43,6 +48,8 @@ public:
         auto* memory = allocate_cell(sizeof(T));
         new (memory) T(forward<Args>(args)...);
         auto* cell = static_cast<T*>(memory);
+        if constexpr (HasWriteBarriers<T>)
+            cell->set_has_write_barriers(true);
         constexpr bool is_object = IsBaseOf<Object, T>;
         if constexpr (is_object)
             static_cast<Object*>(cell)->disable_transitions();
@@ -54,11 +61,21 @@ public:
 
     enum class CollectionType {
         CollectGarbage,
+        CollectYoungGeneration,
         CollectEverything,
     };
 
     void collect_garbage(CollectionType = CollectionType::CollectGarbage, bool print_report = false);
 
+    struct PauseTimeStatistics {
+        size_t collections { 0 };
+        i64 total_microseconds { 0 };
+        i64 max_microseconds { 0 };
+        i64 last_microseconds { 0 };
+    };
+    PauseTimeStatistics const& young_collection_statistics() const { return m_young_collection_statistics; }
+    PauseTimeStatistics const& full_collection_statistics() const { return m_full_collection_statistics; }
+
     VM& vm() { return m_vm; }
 
     bool should_collect_on_every_allocation() const { return m_should_collect_on_every_allocation; }
@@ -78,13 +95,17 @@ public:
 
     BlockAllocator& block_allocator() { return m_block_allocator; }
 
+    void did_remember_cell(Badge<Cell>, Cell&);
+
 private:
     Cell* allocate_cell(size_t);
 
     void gather_roots(HashTable<Cell*>&);
     void gather_conservative_roots(HashTable<Cell*>&);
-    void mark_live_cells(const HashTable<Cell*>& live_cells);
-    void sweep_dead_cells(bool print_report, const Core::ElapsedTimer&);
+    void mark_live_cells(const HashTable<Cell*>& live_cells, CollectionType);
+    void sweep_dead_cells(bool print_report, CollectionType, Time const& collection_start_time);
+    void promote(Cell&);
+    void forget_remembered_cells();
 
     CellAllocator& allocator_for_size(size_t);
 
@@ -100,21 +121,39 @@ private:
     size_t m_max_allocations_between_gc { 10000 };
     size_t m_allocations_since_last_gc { 0 };
 
+    // A full collection is done instead of a young one once this many cells have been promoted since the last one.
+    size_t m_max_promotions_between_full_gc { 100000 };
+    size_t m_promotions_since_last_full_gc { 0 };
+
     bool m_should_collect_on_every_allocation { false };
 
     VM& m_vm;
 
     Vector<NonnullOwnPtr<CellAllocator>> m_allocators;
+
+    // Maps a cell size, rounded up to the granularity, to the smallest allocator that fits it.
+    static constexpr size_t size_class_granularity = 16;
+    static constexpr size_t max_cell_size = 3072;
+    AK::Array<CellAllocator*, max_cell_size / size_class_granularity + 1> m_allocator_for_size_class {};
     HashTable<HandleImpl*> m_handles;
 
     HashTable<MarkedValueList*> m_marked_value_lists;
 
     HashTable<WeakSet*> m_weak_sets;
 
+    // Old cells that had a young cell stored into them since the last collection.
+    Vector<Cell*> m_remembered_cells;
+    // Old cells without write barriers, which every young collection has to look at.
+    HashTable<Cell*> m_permanently_remembered_cells;
+
+    PauseTimeStatistics m_young_collection_statistics;
+    PauseTimeStatistics m_full_collection_statistics;
+
     BlockAllocator m_block_allocator;
 
     size_t m_gc_deferrals { 0 };
     bool m_should_gc_when_deferral_ends { false };
+    CollectionType m_collection_type_when_deferral_ends { CollectionType::CollectYoungGeneration };
 
     bool m_collecting_garbage { false };
 };
@@ -42,12 +42,24 @@ public:
 
         if (allocated_cell) {
             ASAN_UNPOISON_MEMORY_REGION(allocated_cell, m_cell_size);
+            m_has_young_cells = true;
         }
         return allocated_cell;
     }
 
     void deallocate(Cell*);
 
+    // Bump allocation: the CellAllocator carves cells out of the untouched tail of the block itself,
+    // and reports back how far it got before anyone else looks at the block.
+    u8* lazy_region_begin() { return &m_storage[m_next_lazy_freelist_index * cell_size()]; }
+    u8* lazy_region_end() { return &m_storage[cell_count() * cell_size()]; }
+    void did_bump_allocate_until(u8* pointer)
+    {
+        VERIFY(pointer >= lazy_region_begin() && pointer <= lazy_region_end());
+        m_next_lazy_freelist_index = (pointer - m_storage) / cell_size();
+    }
+    void set_has_young_cells() { m_has_young_cells = true; }
+
     template<typename Callback>
     void for_each_cell(Callback callback)
     {
@@ -67,6 +79,10 @@ public:
 
     Heap& heap() { return m_heap; }
 
+    // Young collections only need to sweep blocks that had cells allocated in them since the last collection.
+    bool has_young_cells() const { return m_has_young_cells; }
+    void clear_has_young_cells() { m_has_young_cells = false; }
+
     static HeapBlock* from_cell(const Cell* cell)
     {
         return reinterpret_cast<HeapBlock*>((FlatPtr)cell & ~(block_size - 1));
@@ -110,6 +126,7 @@ private:
     size_t m_cell_size { 0 };
     size_t m_next_lazy_freelist_index { 0 };
     FreelistEntry* m_freelist { nullptr };
+    bool m_has_young_cells { false };
     alignas(Cell) u8 m_storage[];
 
 public:
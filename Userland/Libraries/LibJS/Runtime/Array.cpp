@@ -64,7 +64,7 @@ Array* Array::typed_this(VM& vm, GlobalObject& global_object)
 
 JS_DEFINE_NATIVE_GETTER(Array::length_getter)
 {
-    auto* array = typed_this(vm, global_object);
+    const auto* array = typed_this(vm, global_object);
     if (!array)
         return {};
     return Value(array->indexed_properties().array_like_size());
@@ -30,4 +30,7 @@ private:
     JS_DECLARE_NATIVE_SETTER(length_setter);
 };
 
+template<>
+inline constexpr bool HasWriteBarriers<Array> = true;
+
 }
@@ -90,7 +90,7 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayConstructor::from)
     auto this_arg = vm.argument(2);
 
     // Array.from() lets you create Arrays from:
-    if (auto size = object->indexed_properties().array_like_size()) {
+    if (auto size = static_cast<const Object*>(object)->indexed_properties().array_like_size()) {
         // * array-like objects (objects with a length property and indexed elements)
         MarkedValueList elements(vm.heap());
         elements.ensure_capacity(size);
@@ -49,7 +49,7 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayIteratorPrototype::next)
     auto index = iterator.index();
     auto iteration_kind = iterator.iteration_kind();
     // FIXME: Typed array check
-    auto length = array.indexed_properties().array_like_size();
+    auto length = static_cast<const Object&>(array).indexed_properties().array_like_size();
 
     if (index >= length) {
         iterator.m_array = js_undefined();
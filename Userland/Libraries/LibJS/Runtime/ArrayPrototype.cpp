@@ -8,6 +8,7 @@
 
 #include <AK/Function.h>
 #include <AK/HashTable.h>
+#include <AK/QuickSort.h>
 #include <AK/ScopeGuard.h>
 #include <AK/StringBuilder.h>
 #include <LibJS/Runtime/Array.h>
@@ -88,6 +89,38 @@ static Function* callback_from_args(GlobalObject& global_object, const String& n
     return &callback.as_function();
 }
 
+// Holes are looked up on the prototype chain, so they can only be treated as missing elements
+// when nothing on that chain has indexed properties of its own.
+static bool prototype_chain_has_indexed_properties(const Object& object)
+{
+    for (auto* prototype = object.prototype(); prototype; prototype = prototype->prototype()) {
+        if (prototype->has_exotic_indexed_properties() || !prototype->indexed_properties().is_empty())
+            return true;
+    }
+    return false;
+}
+
+// Returns the simple storage of an Array if reading its elements directly is indistinguishable from a [[Get]]
+// of each index. Any call into user code may change this, so callers have to ask again after every callback.
+static const SimpleIndexedPropertyStorage* fast_element_storage(const Object& object)
+{
+    if (!is<Array>(object))
+        return nullptr;
+    auto* storage = object.indexed_properties().simple_storage();
+    if (!storage)
+        return nullptr;
+    if (is_holey(storage->element_kind()) && prototype_chain_has_indexed_properties(object))
+        return nullptr;
+    return storage;
+}
+
+static Value get_element(Object& object, size_t index)
+{
+    if (auto* storage = fast_element_storage(object); storage && index < storage->array_like_size())
+        return storage->elements()[index];
+    return object.get(index);
+}
+
 static void for_each_item(VM& vm, GlobalObject& global_object, const String& name, AK::Function<IterationDecision(size_t index, Value value, Value callback_result)> callback, bool skip_empty = true)
 {
     auto* this_object = vm.this_value(global_object).to_object(global_object);
@@ -105,7 +138,7 @@ static void for_each_item(VM& vm, GlobalObject& global_object, const String& nam
     auto this_value = vm.argument(1);
 
     for (size_t i = 0; i < initial_length; ++i) {
-        auto value = this_object->get(i);
+        auto value = get_element(*this_object, i);
         if (vm.exception())
             return;
         if (value.is_empty()) {
@@ -150,6 +183,22 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::map)
     auto initial_length = length_of_array_like(global_object, *this_object);
     if (vm.exception())
         return {};
+
+    // Mapping a packed array produces a packed array. Nothing can observe the new array before we return it,
+    // so it can be built up from empty instead of starting out with `initial_length` holes.
+    auto* source_storage = fast_element_storage(*this_object);
+    if (source_storage && !is_holey(source_storage->element_kind())) {
+        auto* new_array = Array::create(global_object);
+        for_each_item(vm, global_object, "map", [&](auto index, auto, auto callback_result) {
+            new_array->indexed_properties().put(new_array, index, callback_result);
+            return IterationDecision::Continue;
+        });
+        if (vm.exception())
+            return {};
+        new_array->indexed_properties().set_array_like_size(initial_length);
+        return Value(new_array);
+    }
+
     auto* new_array = Array::create(global_object, initial_length);
     if (vm.exception())
         return {};
@@ -352,7 +401,7 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::concat)
         return {};
 
     auto* new_array = Array::create(global_object);
-    new_array->indexed_properties().append_all(array, array->indexed_properties());
+    new_array->indexed_properties().append_all(array, static_cast<const Array*>(array)->indexed_properties());
     if (vm.exception())
         return {};
 
@@ -360,7 +409,7 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::concat)
         auto argument = vm.argument(i);
         if (argument.is_array(global_object)) {
             auto& argument_object = argument.as_object();
-            new_array->indexed_properties().append_all(&argument_object, argument_object.indexed_properties());
+            new_array->indexed_properties().append_all(&argument_object, static_cast<const Object&>(argument_object).indexed_properties());
             continue;
         }
         if (vm.exception())
@@ -379,13 +428,13 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::slice)
 
     auto* new_array = Array::create(global_object);
     if (vm.argument_count() == 0) {
-        new_array->indexed_properties().append_all(array, array->indexed_properties());
+        new_array->indexed_properties().append_all(array, static_cast<const Array*>(array)->indexed_properties());
         if (vm.exception())
             return {};
         return new_array;
     }
 
-    ssize_t array_size = static_cast<ssize_t>(array->indexed_properties().array_like_size());
+    ssize_t array_size = static_cast<ssize_t>(static_cast<const Array*>(array)->indexed_properties().array_like_size());
     auto start_slice = vm.argument(0).to_i32(global_object);
     if (vm.exception())
         return {};
@@ -416,6 +465,37 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::slice)
     return new_array;
 }
 
+static i32 index_of_in_element_storage(const SimpleIndexedPropertyStorage& storage, Value search_element, i32 from_index, i32 length)
+{
+    auto& elements = storage.elements();
+    auto kind = storage.element_kind();
+    // Anything past the end of the storage is missing, and missing elements never compare equal.
+    auto end = min(length, static_cast<i32>(storage.array_like_size()));
+
+    if (!search_element.is_number()) {
+        if (has_only_numbers(kind))
+            return -1;
+        for (i32 i = from_index; i < end; ++i) {
+            if (strict_eq(elements[i], search_element))
+                return i;
+        }
+        return -1;
+    }
+
+    auto number = search_element.as_double();
+    if (has_only_int32s(kind)) {
+        // NOTE: This also rejects NaN, which is never strictly equal to anything.
+        if (!(number >= NumericLimits<i32>::min() && number <= NumericLimits<i32>::max()) || static_cast<i32>(number) != number)
+            return -1;
+    }
+    for (i32 i = from_index; i < end; ++i) {
+        auto& element = elements[i];
+        if (element.is_number() && element.as_double() == number)
+            return i;
+    }
+    return -1;
+}
+
 JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::index_of)
 {
     auto* this_object = vm.this_value(global_object).to_object(global_object);
@@ -437,6 +517,8 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::index_of)
             from_index = max(length + from_index, 0);
     }
     auto search_element = vm.argument(0);
+    if (auto* storage = fast_element_storage(*this_object))
+        return Value(index_of_in_element_storage(*storage, search_element, from_index, length));
     for (i32 i = from_index; i < length; ++i) {
         auto element = this_object->get(i);
         if (vm.exception())
@@ -469,7 +551,7 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::reduce)
     } else {
         bool start_found = false;
         while (!start_found && start < initial_length) {
-            auto value = this_object->get(start);
+            auto value = get_element(*this_object, start);
             if (vm.exception())
                 return {};
             start_found = !value.is_empty();
@@ -486,7 +568,7 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::reduce)
     auto this_value = js_undefined();
 
     for (size_t i = start; i < initial_length; ++i) {
-        auto value = this_object->get(i);
+        auto value = get_element(*this_object, i);
         if (vm.exception())
             return {};
         if (value.is_empty())
@@ -559,11 +641,12 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::reverse)
     if (!array)
         return {};
 
-    if (array->indexed_properties().is_empty())
+    auto& indexed_properties = static_cast<const Array*>(array)->indexed_properties();
+    if (indexed_properties.is_empty())
         return array;
 
     MarkedValueList array_reverse(vm.heap());
-    auto size = array->indexed_properties().array_like_size();
+    auto size = indexed_properties.array_like_size();
     array_reverse.ensure_capacity(size);
 
     for (ssize_t i = size - 1; i >= 0; --i) {
@@ -684,6 +767,40 @@ static void array_merge_sort(VM& vm, GlobalObject& global_object, Function* comp
     }
 }
 
+// Without a compare function, numbers are sorted by their string representations. Converting every element
+// once up front saves creating two strings per comparison, and nothing about it can be observed by user code.
+static void sort_numbers_by_string_keys(Array& array, const SimpleIndexedPropertyStorage& storage)
+{
+    struct SortKey {
+        String string;
+        Value value;
+        size_t index;
+    };
+
+    auto& elements = storage.elements();
+    auto length = storage.array_like_size();
+    Vector<SortKey> keys;
+    keys.ensure_capacity(length);
+    for (size_t i = 0; i < length; ++i) {
+        if (!elements[i].is_empty())
+            keys.unchecked_append({ elements[i].to_string_without_side_effects(), elements[i], keys.size() });
+    }
+
+    // Tie-breaking on the original position keeps the sort stable (e.g. for 0 and -0).
+    quick_sort(keys, [](auto& a, auto& b) {
+        if (a.string == b.string)
+            return a.index < b.index;
+        return a.string < b.string;
+    });
+
+    // The holes all end up at the end.
+    auto& indexed_properties = array.indexed_properties();
+    for (size_t i = 0; i < keys.size(); ++i)
+        indexed_properties.put(&array, i, keys[i].value);
+    for (size_t i = keys.size(); i < length; ++i)
+        indexed_properties.remove(i);
+}
+
 JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::sort)
 {
     auto* array = vm.this_value(global_object).to_object(global_object);
@@ -700,6 +817,15 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::sort)
     if (vm.exception())
         return {};
 
+    if (callback.is_undefined()) {
+        auto* storage = fast_element_storage(*array);
+        if (storage && has_only_numbers(storage->element_kind()) && original_length == storage->array_like_size()
+            && (!is_holey(storage->element_kind()) || array->is_extensible())) {
+            sort_numbers_by_string_keys(static_cast<Array&>(*array), *storage);
+            return array;
+        }
+    }
+
     MarkedValueList values_to_sort(vm.heap());
 
     for (size_t i = 0; i < original_length; ++i) {
@@ -25,6 +25,9 @@ private:
     Crypto::SignedBigInteger m_big_integer;
 };
 
+template<>
+inline constexpr bool HasWriteBarriers<BigInt> = true;
+
 BigInt* js_bigint(Heap&, Crypto::SignedBigInteger);
 
 }
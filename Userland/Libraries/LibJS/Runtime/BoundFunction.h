@@ -45,4 +45,7 @@ private:
     i32 m_length { 0 };
 };
 
+template<>
+inline constexpr bool HasWriteBarriers<BoundFunction> = true;
+
 }
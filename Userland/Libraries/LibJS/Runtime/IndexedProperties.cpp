@@ -17,6 +17,45 @@ SimpleIndexedPropertyStorage::SimpleIndexedPropertyStorage(Vector<Value>&& initi
     : m_array_size(initial_values.size())
     , m_packed_elements(move(initial_values))
 {
+    for (auto& value : m_packed_elements)
+        did_store(value);
+}
+
+void SimpleIndexedPropertyStorage::did_store(Value value)
+{
+    switch (value.type()) {
+    case Value::Type::Empty:
+        did_create_hole();
+        return;
+    case Value::Type::Int32:
+        return;
+    case Value::Type::Double:
+        if (m_element_kind == ElementKind::PackedInt32)
+            m_element_kind = ElementKind::PackedDouble;
+        else if (m_element_kind == ElementKind::HoleyInt32)
+            m_element_kind = ElementKind::HoleyDouble;
+        return;
+    default:
+        m_element_kind = is_holey(m_element_kind) ? ElementKind::HoleyAny : ElementKind::PackedAny;
+        return;
+    }
+}
+
+void SimpleIndexedPropertyStorage::did_create_hole()
+{
+    switch (m_element_kind) {
+    case ElementKind::PackedInt32:
+        m_element_kind = ElementKind::HoleyInt32;
+        break;
+    case ElementKind::PackedDouble:
+        m_element_kind = ElementKind::HoleyDouble;
+        break;
+    case ElementKind::PackedAny:
+        m_element_kind = ElementKind::HoleyAny;
+        break;
+    default:
+        break;
+    }
 }
 
 bool SimpleIndexedPropertyStorage::has_index(u32 index) const
@@ -44,21 +83,29 @@ void SimpleIndexedPropertyStorage::put(u32 index, Value value, PropertyAttribute
     VERIFY(attributes == default_attributes);
 
     if (index >= m_array_size) {
+        if (index > m_array_size)
+            did_create_hole();
         m_array_size = index + 1;
         grow_storage_if_needed();
     }
+    did_store(value);
     m_packed_elements[index] = value;
 }
 
 void SimpleIndexedPropertyStorage::remove(u32 index)
 {
-    if (index < m_array_size)
+    if (index < m_array_size) {
+        did_create_hole();
         m_packed_elements[index] = {};
+    }
 }
 
 void SimpleIndexedPropertyStorage::insert(u32 index, Value value, PropertyAttributes attributes)
 {
     VERIFY(attributes == default_attributes);
+    if (index > m_array_size)
+        did_create_hole();
+    did_store(value);
     m_array_size++;
     m_packed_elements.insert(index, value);
 }
@@ -79,6 +126,10 @@ ValueAndAttributes SimpleIndexedPropertyStorage::take_last()
 
 void SimpleIndexedPropertyStorage::set_array_like_size(size_t new_size)
 {
+    if (new_size == 0)
+        m_element_kind = ElementKind::PackedInt32;
+    else if (new_size > m_array_size)
+        did_create_hole();
     m_array_size = new_size;
     m_packed_elements.resize(new_size);
 }
@@ -21,6 +21,22 @@ class IndexedProperties;
 class IndexedPropertyIterator;
 class GenericIndexedPropertyStorage;
 
+// What simple storage knows about all of its elements. A kind only ever becomes more general:
+// Int32 -> Double -> Any, and Packed -> Holey. Emptying the storage resets it to PackedInt32.
+// "Double" elements are still stored as Int32 Values whenever they happen to be integral.
+enum class ElementKind : u8 {
+    PackedInt32,
+    PackedDouble,
+    PackedAny,
+    HoleyInt32,
+    HoleyDouble,
+    HoleyAny,
+};
+
+constexpr bool is_holey(ElementKind kind) { return kind >= ElementKind::HoleyInt32; }
+constexpr bool has_only_numbers(ElementKind kind) { return kind != ElementKind::PackedAny && kind != ElementKind::HoleyAny; }
+constexpr bool has_only_int32s(ElementKind kind) { return kind == ElementKind::PackedInt32 || kind == ElementKind::HoleyInt32; }
+
 class IndexedPropertyStorage {
 public:
     virtual ~IndexedPropertyStorage() {};
@@ -61,14 +77,18 @@ public:
 
     virtual bool is_simple_storage() const override { return true; }
     const Vector<Value>& elements() const { return m_packed_elements; }
+    ElementKind element_kind() const { return m_element_kind; }
 
 private:
     friend GenericIndexedPropertyStorage;
 
     void grow_storage_if_needed();
+    void did_store(Value);
+    void did_create_hole();
 
     size_t m_array_size { 0 };
     Vector<Value> m_packed_elements;
+    ElementKind m_element_kind { ElementKind::PackedInt32 };
 };
 
 class GenericIndexedPropertyStorage final : public IndexedPropertyStorage {
@@ -144,6 +164,14 @@ public:
 
     Vector<u32> indices() const;
 
+    // Returns nullptr once the elements have moved to generic storage.
+    const SimpleIndexedPropertyStorage* simple_storage() const
+    {
+        if (!m_storage->is_simple_storage())
+            return nullptr;
+        return static_cast<const SimpleIndexedPropertyStorage*>(m_storage.ptr());
+    }
+
     template<typename Callback>
     void for_each_value(Callback callback)
     {
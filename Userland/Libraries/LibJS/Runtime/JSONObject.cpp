@@ -221,7 +221,7 @@ String JSONObject::serialize_json_object(GlobalObject& global_object, StringifyS
                 return {};
         }
     } else {
-        for (auto& entry : object.indexed_properties()) {
+        for (auto& entry : static_cast<const Object&>(object).indexed_properties()) {
             auto value_and_attributes = entry.value_and_attributes(&object);
             if (!value_and_attributes.attributes.is_enumerable())
                 continue;
@@ -467,7 +467,7 @@ Value JSONObject::internalize_json_property(GlobalObject& global_object, Object*
                     return {};
             }
         } else {
-            for (auto& entry : value_object.indexed_properties()) {
+            for (auto& entry : static_cast<const Object&>(value_object).indexed_properties()) {
                 auto value_and_attributes = entry.value_and_attributes(&value_object);
                 if (!value_and_attributes.attributes.is_enumerable())
                     continue;
@@ -59,6 +59,7 @@ Optional<Variable> LexicalEnvironment::get_from_scope(const FlyString& name) con
 
 void LexicalEnvironment::put_to_scope(const FlyString& name, Variable variable)
 {
+    write_barrier(variable.value);
     m_variables.set(name, variable);
 }
 
@@ -67,6 +68,12 @@ bool LexicalEnvironment::delete_from_scope(FlyString const& name)
     return m_variables.remove(name);
 }
 
+void LexicalEnvironment::set_current_function(Function& function)
+{
+    write_barrier(&function);
+    m_current_function = &function;
+}
+
 bool LexicalEnvironment::has_super_binding() const
 {
     return m_environment_record_type == EnvironmentRecordType::Function && this_binding_status() != ThisBindingStatus::Lexical && m_home_object.is_object();
@@ -112,6 +119,7 @@ void LexicalEnvironment::bind_this_value(GlobalObject& global_object, Value this
         vm().throw_exception<ReferenceError>(global_object, ErrorType::ThisIsAlreadyInitialized);
         return;
     }
+    write_barrier(this_value);
     m_this_value = this_value;
     m_this_binding_status = ThisBindingStatus::Initialized;
 }
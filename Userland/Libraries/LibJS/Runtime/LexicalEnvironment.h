@@ -47,7 +47,11 @@ public:
 
     const HashMap<FlyString, Variable>& variables() const { return m_variables; }
 
-    void set_home_object(Value object) { m_home_object = object; }
+    void set_home_object(Value object)
+    {
+        write_barrier(object);
+        m_home_object = object;
+    }
     bool has_super_binding() const;
     Value get_super_base();
 
@@ -55,13 +59,21 @@ public:
     void bind_this_value(GlobalObject&, Value this_value);
 
     // Not a standard operation.
-    void replace_this_binding(Value this_value) { m_this_value = this_value; }
+    void replace_this_binding(Value this_value)
+    {
+        write_barrier(this_value);
+        m_this_value = this_value;
+    }
 
     Value new_target() const { return m_new_target; };
-    void set_new_target(Value new_target) { m_new_target = new_target; }
+    void set_new_target(Value new_target)
+    {
+        write_barrier(new_target);
+        m_new_target = new_target;
+    }
 
     Function* current_function() const { return m_current_function; }
-    void set_current_function(Function& function) { m_current_function = &function; }
+    void set_current_function(Function&);
 
     EnvironmentRecordType type() const { return m_environment_record_type; }
 
@@ -78,4 +90,7 @@ private:
     Function* m_current_function { nullptr };
 };
 
+template<>
+inline constexpr bool HasWriteBarriers<LexicalEnvironment> = true;
+
 }
@@ -40,4 +40,7 @@ private:
     AK::Function<Value(VM&, GlobalObject&)> m_native_function;
 };
 
+template<>
+inline constexpr bool HasWriteBarriers<NativeFunction> = true;
+
 }
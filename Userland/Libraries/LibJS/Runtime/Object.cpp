@@ -136,7 +136,7 @@ bool Object::set_prototype(Object* new_prototype)
     if (shape.is_unique())
         shape.set_prototype_without_transition(new_prototype);
     else
-        m_shape = shape.create_prototype_transition(new_prototype);
+        set_shape(*shape.create_prototype_transition(new_prototype));
     return true;
 }
 
@@ -166,6 +166,7 @@ bool Object::set_integrity_level(IntegrityLevel level)
             auto value_and_attributes = m_indexed_properties.get(nullptr, property_name.as_number(), false).value();
             auto value = value_and_attributes.value;
             auto attributes = value_and_attributes.attributes.bits() & new_attributes;
+            write_barrier(value);
             m_indexed_properties.put(nullptr, property_name.as_number(), value, attributes, false);
         } else {
             auto metadata = shape().lookup(property_name.to_string_or_symbol()).value();
@@ -444,6 +445,7 @@ Value Object::get_own_property_descriptor_object(const PropertyName& property_na
 
 void Object::set_shape(Shape& new_shape)
 {
+    write_barrier(&new_shape);
     m_storage.resize(new_shape.property_count());
     m_shape = &new_shape;
 }
@@ -586,6 +588,7 @@ bool Object::put_own_property(const StringOrSymbol& property_name, Value value,
     //       Transitions are primarily interesting when scripts add properties to objects.
     if (!m_transitions_enabled && !m_shape->is_unique()) {
         m_shape->add_property_without_transition(property_name, attributes);
+        write_barrier(value);
         m_storage.resize(m_shape->property_count());
         m_storage[m_shape->property_count() - 1] = value;
         return true;
@@ -602,9 +605,10 @@ bool Object::put_own_property(const StringOrSymbol& property_name, Value value,
     }
 
     if (new_property) {
-        if (!m_shape->is_unique() && shape().property_count() > 100) {
-            // If you add more than 100 properties to an object, let's stop doing
-            // transitions to avoid filling up the heap with shapes.
+        if (!m_shape->is_unique() && (shape().property_count() > 100 || (m_transitions_enabled && !m_shape->can_create_put_transition(property_name, attributes)))) {
+            // If you add more than 100 properties to an object, or its shape has already been extended
+            // in too many different ways, let's stop doing transitions to avoid filling up the heap with shapes.
+            // The object keeps its own property table from here on, like a dictionary.
             ensure_shape_is_unique();
         }
 
@@ -653,6 +657,7 @@ bool Object::put_own_property(const StringOrSymbol& property_name, Value value,
     if (value_here.is_native_property()) {
         call_native_property_setter(value_here.as_native_property(), this, value);
     } else {
+        write_barrier(value);
         m_storage[metadata.value().offset] = value;
     }
     return true;
@@ -701,6 +706,7 @@ bool Object::put_own_property_by_index(u32 property_index, Value value, Property
     if (value_here.is_native_property()) {
         call_native_property_setter(value_here.as_native_property(), this, value);
     } else {
+        write_barrier(value);
         m_indexed_properties.put(this, property_index, value, attributes, mode == PutOwnPropertyMode::Put);
     }
     return true;
@@ -739,7 +745,7 @@ void Object::ensure_shape_is_unique()
     if (shape().is_unique())
         return;
 
-    m_shape = m_shape->create_unique_clone();
+    set_shape(*m_shape->create_unique_clone());
 }
 
 Value Object::get_by_index(u32 property_index) const
@@ -106,6 +106,10 @@ public:
     virtual bool is_string_object() const { return false; }
     virtual bool is_global_object() const { return false; }
 
+    // Whether indexed properties can come from anywhere but indexed_properties(), e.g. an overridden get() or get_by_index().
+    // Fast paths that read elements directly also have to look at the prototype chain, and bail out when this is true.
+    virtual bool has_exotic_indexed_properties() const { return false; }
+
     virtual const char* class_name() const override { return "Object"; }
     virtual void visit_edges(Cell::Visitor&) override;
 
@@ -124,10 +128,25 @@ public:
     virtual Value ordinary_to_primitive(Value::PreferredType preferred_type) const;
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value)
+    {
+        write_barrier(value);
+        m_storage[index] = value;
+    }
 
     const IndexedProperties& indexed_properties() const { return m_indexed_properties; }
-    IndexedProperties& indexed_properties() { return m_indexed_properties; }
-    void set_indexed_property_elements(Vector<Value>&& values) { m_indexed_properties = IndexedProperties(move(values)); }
+    IndexedProperties& indexed_properties()
+    {
+        // NOTE: We can't see what the caller is going to store, so assume the worst.
+        //       Callers that only read should go through the const overload instead.
+        write_barrier();
+        return m_indexed_properties;
+    }
+    void set_indexed_property_elements(Vector<Value>&& values)
+    {
+        write_barrier();
+        m_indexed_properties = IndexedProperties(move(values));
+    }
 
     [[nodiscard]] Value invoke_internal(const StringOrSymbol& property_name, Optional<MarkedValueList> arguments);
 
@@ -157,9 +176,17 @@ protected:
     explicit Object(GlobalObjectTag);
     Object(ConstructWithoutPrototypeTag, GlobalObject&);
 
+    // NOTE: Overriding this means overriding has_exotic_indexed_properties() as well.
     virtual Value get_by_index(u32 property_index) const;
     virtual bool put_by_index(u32 property_index, Value);
 
+    using Cell::write_barrier;
+    void write_barrier(Value value)
+    {
+        if (value.is_cell())
+            Cell::write_barrier(&value.as_cell());
+    }
+
 private:
     bool put_own_property(const StringOrSymbol& property_name, Value, PropertyAttributes attributes, PutOwnPropertyMode = PutOwnPropertyMode::Put, bool throw_exceptions = true);
     bool put_own_property_by_index(u32 property_index, Value, PropertyAttributes attributes, PutOwnPropertyMode = PutOwnPropertyMode::Put, bool throw_exceptions = true);
@@ -176,6 +203,9 @@ private:
     IndexedProperties m_indexed_properties;
 };
 
+template<>
+inline constexpr bool HasWriteBarriers<Object> = true;
+
 template<>
 [[nodiscard]] ALWAYS_INLINE Value Object::invoke(const StringOrSymbol& property_name, MarkedValueList arguments) { return invoke_internal(property_name, move(arguments)); }
 
@@ -24,6 +24,9 @@ private:
     String m_string;
 };
 
+template<>
+inline constexpr bool HasWriteBarriers<PrimitiveString> = true;
+
 PrimitiveString* js_string(Heap&, String);
 PrimitiveString* js_string(VM&, String);
 
@@ -46,6 +46,7 @@ private:
     virtual void visit_edges(Visitor&) override;
 
     virtual bool is_function() const override { return m_target.is_function(); }
+    virtual bool has_exotic_indexed_properties() const override { return true; }
 
     Object& m_target;
     Object& m_handler;
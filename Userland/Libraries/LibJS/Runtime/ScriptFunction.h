@@ -59,4 +59,7 @@ private:
     bool m_is_class_constructor { false };
 };
 
+template<>
+inline constexpr bool HasWriteBarriers<ScriptFunction> = true;
+
 }
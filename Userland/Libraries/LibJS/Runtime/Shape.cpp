@@ -10,6 +10,49 @@
 
 namespace JS {
 
+NonnullRefPtr<PropertyTable> PropertyTable::clone_prefix(size_t property_count) const
+{
+    auto table = create();
+    table->m_keys_in_order.ensure_capacity(property_count);
+    for (size_t i = 0; i < property_count; ++i) {
+        auto& key = m_keys_in_order[i];
+        table->m_keys_in_order.unchecked_append(key);
+        table->m_properties.set(key, m_properties.get(key).value());
+    }
+    return table;
+}
+
+void PropertyTable::append(const StringOrSymbol& key, PropertyAttributes attributes)
+{
+    auto result = m_properties.set(key, { m_keys_in_order.size(), attributes });
+    VERIFY(result == AK::HashSetResult::InsertedNewEntry);
+    m_keys_in_order.append(key);
+}
+
+void PropertyTable::set_attributes(const StringOrSymbol& key, PropertyAttributes attributes)
+{
+    auto it = m_properties.find(key);
+    VERIFY(it != m_properties.end());
+    it->value.attributes = attributes;
+}
+
+void PropertyTable::remove(const StringOrSymbol& key)
+{
+    auto it = m_properties.find(key);
+    VERIFY(it != m_properties.end());
+    auto offset = it->value.offset;
+    m_properties.remove(it);
+    m_keys_in_order.remove(offset);
+    for (size_t i = offset; i < m_keys_in_order.size(); ++i)
+        m_properties.find(m_keys_in_order[i])->value.offset = i;
+}
+
+void PropertyTable::visit_keys(Cell::Visitor& visitor, size_t property_count)
+{
+    for (size_t i = 0; i < property_count; ++i)
+        m_keys_in_order[i].visit_edges(visitor);
+}
+
 Shape* Shape::create_unique_clone() const
 {
     VERIFY(m_global_object);
@@ -17,9 +60,8 @@ Shape* Shape::create_unique_clone() const
     new_shape->m_unique = true;
     new_shape->m_prototype = m_prototype;
     ensure_property_table();
-    new_shape->ensure_property_table();
-    (*new_shape->m_property_table) = *m_property_table;
-    new_shape->m_property_count = new_shape->m_property_table->size();
+    new_shape->m_property_table = m_property_table->clone_prefix(m_property_count);
+    new_shape->m_property_count = m_property_count;
     return new_shape;
 }
 
@@ -36,6 +78,24 @@ Shape* Shape::get_or_prune_cached_forward_transition(TransitionKey const& key)
     return it->value;
 }
 
+bool Shape::can_create_put_transition(const StringOrSymbol& property_name, PropertyAttributes attributes)
+{
+    if (m_forward_transitions.size() < max_forward_transitions)
+        return true;
+    if (get_or_prune_cached_forward_transition({ property_name, attributes }))
+        return true;
+
+    // Make room by pruning all the transitions to shapes that have been garbage collected.
+    Vector<TransitionKey> stale_keys;
+    for (auto& it : m_forward_transitions) {
+        if (!it.value)
+            stale_keys.append(it.key);
+    }
+    for (auto& key : stale_keys)
+        m_forward_transitions.remove(key);
+    return m_forward_transitions.size() < max_forward_transitions;
+}
+
 Shape* Shape::create_put_transition(const StringOrSymbol& property_name, PropertyAttributes attributes)
 {
     TransitionKey key { property_name, attributes };
@@ -101,9 +161,9 @@ void Shape::visit_edges(Cell::Visitor& visitor)
     visitor.visit(m_prototype);
     visitor.visit(m_previous);
     m_property_name.visit_edges(visitor);
-    if (m_property_table) {
-        for (auto& it : *m_property_table)
-            it.key.visit_edges(visitor);
+    // Keys that were added by transitions are kept alive by the shapes in the transition chain.
+    if (m_property_table && (m_unique || m_has_properties_without_transitions)) {
+        m_property_table->visit_keys(visitor, m_property_count);
     }
 }
 
@@ -111,16 +171,8 @@ Optional<PropertyMetadata> Shape::lookup(const StringOrSymbol& property_name) co
 {
     if (m_property_count == 0)
         return {};
-    auto property = property_table().get(property_name);
-    if (!property.has_value())
-        return {};
-    return property;
-}
-
-FLATTEN HashMap<StringOrSymbol, PropertyMetadata> const& Shape::property_table() const
-{
     ensure_property_table();
-    return *m_property_table;
+    return m_property_table->get(property_name, m_property_count);
 }
 
 size_t Shape::property_count() const
@@ -131,10 +183,14 @@ size_t Shape::property_count() const
 Vector<Shape::Property> Shape::property_table_ordered() const
 {
     auto vec = Vector<Shape::Property>();
-    vec.resize(property_count());
+    if (m_property_count == 0)
+        return vec;
 
-    for (auto& it : property_table()) {
-        vec[it.value.offset] = { it.key, it.value };
+    ensure_property_table();
+    vec.ensure_capacity(m_property_count);
+    for (size_t i = 0; i < m_property_count; ++i) {
+        auto& key = m_property_table->key_at(i);
+        vec.unchecked_append({ key, m_property_table->get(key, m_property_count).value() });
     }
 
     return vec;
@@ -144,43 +200,57 @@ void Shape::ensure_property_table() const
 {
     if (m_property_table)
         return;
-    m_property_table = make<HashMap<StringOrSymbol, PropertyMetadata>>();
-
-    u32 next_offset = 0;
 
     Vector<const Shape*, 64> transition_chain;
-    for (auto* shape = m_previous; shape; shape = shape->m_previous) {
+    RefPtr<PropertyTable> table;
+    for (auto* shape = this; shape; shape = shape->m_previous) {
         if (shape->m_property_table) {
-            *m_property_table = *shape->m_property_table;
-            next_offset = shape->m_property_count;
+            table = shape->m_property_table;
             break;
         }
         transition_chain.append(shape);
     }
-    transition_chain.append(this);
+    if (!table)
+        table = PropertyTable::create();
 
+    // Replay the transitions, handing the table to every shape along the way so they can all share it.
     for (ssize_t i = transition_chain.size() - 1; i >= 0; --i) {
         auto* shape = transition_chain[i];
-        if (!shape->m_property_name.is_valid()) {
-            // Ignore prototype transitions as they don't affect the key map.
-            continue;
-        }
         if (shape->m_transition_type == TransitionType::Put) {
-            m_property_table->set(shape->m_property_name, { next_offset++, shape->m_attributes });
+            auto previous_property_count = shape->m_property_count - 1;
+            // If some other shape has already appended to the table, we need our own copy.
+            if (table->size() != previous_property_count)
+                table = table->clone_prefix(previous_property_count);
+            table->append(shape->m_property_name, shape->m_attributes);
         } else if (shape->m_transition_type == TransitionType::Configure) {
-            auto it = m_property_table->find(shape->m_property_name);
-            VERIFY(it != m_property_table->end());
-            it->value.attributes = shape->m_attributes;
+            table = table->clone_prefix(shape->m_property_count);
+            table->set_attributes(shape->m_property_name, shape->m_attributes);
         }
+        // NOTE: Prototype transitions don't affect the key map, so they simply share the previous table.
+        shape->m_property_table = table;
     }
 }
 
+void Shape::ensure_property_table_is_appendable()
+{
+    ensure_property_table();
+    if (m_property_table->size() != m_property_count)
+        m_property_table = m_property_table->clone_prefix(m_property_count);
+}
+
+void Shape::set_prototype_without_transition(Object* new_prototype)
+{
+    write_barrier(new_prototype);
+    m_prototype = new_prototype;
+}
+
 void Shape::add_property_to_unique_shape(const StringOrSymbol& property_name, PropertyAttributes attributes)
 {
     VERIFY(is_unique());
     VERIFY(m_property_table);
-    VERIFY(!m_property_table->contains(property_name));
-    m_property_table->set(property_name, { m_property_table->size(), attributes });
+    if (property_name.is_symbol())
+        write_barrier(property_name.as_symbol());
+    m_property_table->append(property_name, attributes);
     ++m_property_count;
 }
 
@@ -188,30 +258,33 @@ void Shape::reconfigure_property_in_unique_shape(const StringOrSymbol& property_
 {
     VERIFY(is_unique());
     VERIFY(m_property_table);
-    auto it = m_property_table->find(property_name);
-    VERIFY(it != m_property_table->end());
-    it->value.attributes = attributes;
-    m_property_table->set(property_name, it->value);
+    m_property_table->set_attributes(property_name, attributes);
 }
 
 void Shape::remove_property_from_unique_shape(const StringOrSymbol& property_name, size_t offset)
 {
     VERIFY(is_unique());
     VERIFY(m_property_table);
-    if (m_property_table->remove(property_name))
-        --m_property_count;
-    for (auto& it : *m_property_table) {
-        VERIFY(it.value.offset != offset);
-        if (it.value.offset > offset)
-            --it.value.offset;
-    }
+    VERIFY(m_property_table->get(property_name, m_property_count).value().offset == offset);
+    m_property_table->remove(property_name);
+    --m_property_count;
 }
 
 void Shape::add_property_without_transition(const StringOrSymbol& property_name, PropertyAttributes attributes)
 {
     ensure_property_table();
-    if (m_property_table->set(property_name, { m_property_count, attributes }) == AK::HashSetResult::InsertedNewEntry)
-        ++m_property_count;
+    if (property_name.is_symbol())
+        write_barrier(property_name.as_symbol());
+    m_has_properties_without_transitions = true;
+    if (m_property_table->get(property_name, m_property_count).has_value()) {
+        // Other shapes may share the table, so we can't change the entry in place.
+        m_property_table = m_property_table->clone_prefix(m_property_count);
+        m_property_table->set_attributes(property_name, attributes);
+        return;
+    }
+    ensure_property_table_is_appendable();
+    m_property_table->append(property_name, attributes);
+    ++m_property_count;
 }
 
 }
@@ -7,7 +7,8 @@
 #pragma once
 
 #include <AK/HashMap.h>
-#include <AK/OwnPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
 #include <AK/WeakPtr.h>
 #include <AK/Weakable.h>
 #include <LibJS/Forward.h>
@@ -33,6 +34,39 @@ struct TransitionKey {
     }
 };
 
+// The property keys of a shape and of everything along its chain of transitions. A table is shared by all
+// shapes in a chain of put transitions: each shape only sees the entries below its own property count, and
+// a transition from the shape that owns the end of the table appends to it in place instead of copying it.
+// Unique shapes have a table of their own, which is the only kind that's ever modified rather than appended to.
+class PropertyTable : public RefCounted<PropertyTable> {
+public:
+    static NonnullRefPtr<PropertyTable> create() { return adopt_ref(*new PropertyTable); }
+
+    NonnullRefPtr<PropertyTable> clone_prefix(size_t property_count) const;
+
+    size_t size() const { return m_keys_in_order.size(); }
+    Optional<PropertyMetadata> get(const StringOrSymbol& key, size_t property_count) const
+    {
+        auto it = m_properties.find(key);
+        if (it == m_properties.end() || it->value.offset >= property_count)
+            return {};
+        return it->value;
+    }
+    const StringOrSymbol& key_at(size_t offset) const { return m_keys_in_order[offset]; }
+
+    void append(const StringOrSymbol&, PropertyAttributes);
+    void set_attributes(const StringOrSymbol&, PropertyAttributes);
+    void remove(const StringOrSymbol&);
+
+    void visit_keys(Cell::Visitor&, size_t property_count);
+
+private:
+    PropertyTable() = default;
+
+    HashMap<StringOrSymbol, PropertyMetadata> m_properties;
+    Vector<StringOrSymbol> m_keys_in_order;
+};
+
 class Shape final
     : public Cell
     , public Weakable<Shape> {
@@ -53,6 +87,11 @@ public:
     Shape(Shape& previous_shape, const StringOrSymbol& property_name, PropertyAttributes attributes, TransitionType);
     Shape(Shape& previous_shape, Object* new_prototype);
 
+    // Every shape only keeps a limited number of forward transitions. Objects that would need one more
+    // are better off with a unique shape, as they're most likely being used as dictionaries.
+    static constexpr size_t max_forward_transitions = 1024;
+    bool can_create_put_transition(const StringOrSymbol&, PropertyAttributes attributes);
+
     Shape* create_put_transition(const StringOrSymbol&, PropertyAttributes attributes);
     Shape* create_configure_transition(const StringOrSymbol&, PropertyAttributes attributes);
     Shape* create_prototype_transition(Object* new_prototype);
@@ -68,7 +107,6 @@ public:
     const Object* prototype() const { return m_prototype; }
 
     Optional<PropertyMetadata> lookup(const StringOrSymbol&) const;
-    const HashMap<StringOrSymbol, PropertyMetadata>& property_table() const;
     size_t property_count() const;
 
     struct Property {
@@ -78,7 +116,7 @@ public:
 
     Vector<Property> property_table_ordered() const;
 
-    void set_prototype_without_transition(Object* new_prototype) { m_prototype = new_prototype; }
+    void set_prototype_without_transition(Object* new_prototype);
 
     void remove_property_from_unique_shape(const StringOrSymbol&, size_t offset);
     void add_property_to_unique_shape(const StringOrSymbol&, PropertyAttributes attributes);
@@ -90,14 +128,17 @@ private:
 
     Shape* get_or_prune_cached_forward_transition(TransitionKey const&);
     void ensure_property_table() const;
+    void ensure_property_table_is_appendable();
 
     PropertyAttributes m_attributes { 0 };
-    TransitionType m_transition_type : 6 { TransitionType::Invalid };
+    TransitionType m_transition_type : 5 { TransitionType::Invalid };
     bool m_unique : 1 { false };
+    // Set if this shape's table has keys that aren't the property name of any shape in its transition chain.
+    bool m_has_properties_without_transitions : 1 { false };
 
     Object* m_global_object { nullptr };
 
-    mutable OwnPtr<HashMap<StringOrSymbol, PropertyMetadata>> m_property_table;
+    mutable RefPtr<PropertyTable> m_property_table;
 
     HashMap<TransitionKey, WeakPtr<Shape>> m_forward_transitions;
     Shape* m_previous { nullptr };
@@ -106,6 +147,9 @@ private:
     size_t m_property_count { 0 };
 };
 
+template<>
+inline constexpr bool HasWriteBarriers<Shape> = true;
+
 }
 
 template<>
@@ -77,7 +77,7 @@ JS_DEFINE_NATIVE_FUNCTION(StringConstructor::raw)
         return js_string(vm, "");
 
     auto* array = static_cast<Array*>(raw.to_object(global_object));
-    auto& raw_array_elements = array->indexed_properties();
+    auto& raw_array_elements = static_cast<const Array*>(array)->indexed_properties();
     StringBuilder builder;
 
     for (size_t i = 0; i < raw_array_elements.array_like_size(); ++i) {
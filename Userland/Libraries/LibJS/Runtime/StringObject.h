@@ -28,6 +28,7 @@ public:
 
 private:
     virtual bool is_string_object() const final { return true; }
+    virtual bool has_exotic_indexed_properties() const final { return true; }
     virtual void visit_edges(Visitor&) override;
 
     PrimitiveString& m_string;
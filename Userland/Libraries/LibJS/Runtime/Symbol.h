@@ -30,6 +30,9 @@ private:
     bool m_is_global;
 };
 
+template<>
+inline constexpr bool HasWriteBarriers<Symbol> = true;
+
 Symbol* js_symbol(Heap&, String description, bool is_global);
 Symbol* js_symbol(VM&, String description, bool is_global);
 
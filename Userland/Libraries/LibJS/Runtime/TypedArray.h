@@ -41,6 +41,7 @@ protected:
     ArrayBuffer* m_viewed_array_buffer { nullptr };
 
 private:
+    virtual bool has_exotic_indexed_properties() const final { return true; }
     virtual void visit_edges(Visitor&) override;
 };
 
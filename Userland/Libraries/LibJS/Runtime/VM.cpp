@@ -287,7 +287,7 @@ void VM::assign(const NonnullRefPtr<BindingPattern>& target, Value value, Global
             if (property.is_rest) {
                 auto* rest_object = Object::create_empty(global_object);
                 rest_object->set_prototype(nullptr);
-                for (auto& property : object->shape().property_table()) {
+                for (auto& property : object->shape().property_table_ordered()) {
                     if (!property.value.attributes.has_enumerable())
                         continue;
                     if (seen_names.contains(property.key.to_display_string()))
@@ -7,43 +7,47 @@
 #pragma once
 
 #include <AK/Assertions.h>
-#include <AK/Atomic.h>
 #include <AK/Types.h>
 
 #ifdef __serenity__
-#    include <unistd.h>
+#    include <bits/pthread_integration.h>
 #else
 #    include <pthread.h>
 #endif
 
 namespace Threading {
 
+// A recursive mutex. On Serenity this is the same futex based mutex as pthread_mutex_t,
+// so taking it when nobody else holds it is a single atomic operation, and waiting for
+// it sleeps in the kernel after a short spin.
 class Lock {
 public:
-    Lock() { }
-    ~Lock() { }
+    Lock()
+    {
+#ifndef __serenity__
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&m_mutex, &attributes);
+        pthread_mutexattr_destroy(&attributes);
+#endif
+    }
+    ~Lock()
+    {
+#ifndef __serenity__
+        pthread_mutex_destroy(&m_mutex);
+#endif
+    }
 
     void lock();
     void unlock();
 
 private:
 #ifdef __serenity__
-    using ThreadID = int;
-
-    ALWAYS_INLINE static ThreadID self()
-    {
-        return gettid();
-    }
+    pthread_mutex_t m_mutex { 0, 0, 0, __PTHREAD_MUTEX_RECURSIVE };
 #else
-    using ThreadID = pthread_t;
-
-    ALWAYS_INLINE static ThreadID self()
-    {
-        return pthread_self();
-    }
+    pthread_mutex_t m_mutex;
 #endif
-    Atomic<ThreadID> m_holder { 0 };
-    u32 m_level { 0 };
 };
 
 class Locker {
@@ -63,31 +67,21 @@ private:
 
 ALWAYS_INLINE void Lock::lock()
 {
-    ThreadID tid = self();
-    if (m_holder == tid) {
-        ++m_level;
-        return;
-    }
-    for (;;) {
-        ThreadID expected = 0;
-        if (m_holder.compare_exchange_strong(expected, tid, AK::memory_order_acq_rel)) {
-            m_level = 1;
-            return;
-        }
 #ifdef __serenity__
-        donate(expected);
+    __pthread_mutex_lock(&m_mutex);
+#else
+    pthread_mutex_lock(&m_mutex);
 #endif
-    }
 }
 
 inline void Lock::unlock()
 {
-    VERIFY(m_holder == self());
-    VERIFY(m_level);
-    if (m_level == 1)
-        m_holder.store(0, AK::memory_order_release);
-    else
-        --m_level;
+#ifdef __serenity__
+    VERIFY(m_mutex.owner == __pthread_self());
+    __pthread_mutex_unlock(&m_mutex);
+#else
+    pthread_mutex_unlock(&m_mutex);
+#endif
 }
 
 template<typename T>
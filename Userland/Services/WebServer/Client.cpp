@@ -16,13 +16,14 @@
 #include <LibCore/DateTime.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
-#include <LibCore/FileStream.h>
 #include <LibCore/MimeData.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 #include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
+#include <poll.h>
 #include <stdio.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -131,12 +132,10 @@ void Client::handle_request(ReadonlyBytes raw_request)
         return;
     }
 
-    Core::InputFileStream stream { file };
-
-    send_response(stream, request, Core::guess_mime_type_based_on_filename(real_path));
+    send_file_response(*file, request, Core::guess_mime_type_based_on_filename(real_path));
 }
 
-void Client::send_response(InputStream& response, HTTP::HttpRequest const& request, String const& content_type)
+void Client::send_response_header(HTTP::HttpRequest const& request, String const& content_type)
 {
     StringBuilder builder;
     builder.append("HTTP/1.0 200 OK\r\n");
@@ -151,6 +150,11 @@ void Client::send_response(InputStream& response, HTTP::HttpRequest const& reque
 
     m_socket->write(builder.to_string());
     log_response(200, request);
+}
+
+void Client::send_response(InputStream& response, HTTP::HttpRequest const& request, String const& content_type)
+{
+    send_response_header(request, content_type);
 
     char buffer[PAGE_SIZE];
     do {
@@ -162,6 +166,32 @@ void Client::send_response(InputStream& response, HTTP::HttpRequest const& reque
     } while (true);
 }
 
+void Client::send_file_response(Core::File& file, HTTP::HttpRequest const& request, String const& content_type)
+{
+    send_response_header(request, content_type);
+
+    // Have the kernel copy the file straight into the socket.
+    for (;;) {
+        ssize_t nsent = sendfile(m_socket->fd(), file.fd(), nullptr, 64 * KiB);
+        if (nsent == 0)
+            break;
+        if (nsent > 0)
+            continue;
+        if (errno == EINTR)
+            continue;
+        if (errno != EAGAIN) {
+            perror("sendfile");
+            break;
+        }
+        // The socket is non-blocking, so wait until it has room for more.
+        pollfd pfd { m_socket->fd(), POLLOUT, 0 };
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+    }
+}
+
 void Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
 {
     StringBuilder builder;
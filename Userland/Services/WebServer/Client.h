@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <LibCore/Forward.h>
 #include <LibCore/Object.h>
 #include <LibCore/TCPSocket.h>
 #include <LibHTTP/Forward.h>
@@ -22,7 +23,9 @@ private:
     Client(NonnullRefPtr<Core::TCPSocket>, Core::Object* parent);
 
     void handle_request(ReadonlyBytes);
+    void send_response_header(HTTP::HttpRequest const&, String const& content_type);
     void send_response(InputStream&, HTTP::HttpRequest const&, String const& content_type);
+    void send_file_response(Core::File&, HTTP::HttpRequest const&, String const& content_type);
     void send_redirect(StringView redirect, HTTP::HttpRequest const&);
     void send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
     void die();
@@ -17,6 +17,7 @@
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/Generator.h>
 #include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/PassManager.h>
 #include <LibJS/Console.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Parser.h>
@@ -79,6 +80,7 @@ private:
 static bool s_dump_ast = false;
 static bool s_dump_bytecode = false;
 static bool s_run_bytecode = false;
+static int s_bytecode_optimization_level = 0;
 static bool s_print_last_result = false;
 static RefPtr<Line::Editor> s_editor;
 static String s_history_path = String::formatted("{}/.js-history", Core::StandardPaths::home_directory());
@@ -521,6 +523,8 @@ static bool parse_and_run(JS::Interpreter& interpreter, const StringView& source
     } else {
         if (s_dump_bytecode || s_run_bytecode) {
             auto unit = JS::Bytecode::Generator::generate(*program);
+            auto optimization_level = static_cast<JS::Bytecode::Interpreter::OptimizationLevel>(s_bytecode_optimization_level);
+            JS::Bytecode::Interpreter::optimization_pipeline(optimization_level).perform(unit);
             if (s_dump_bytecode) {
                 for (auto& block : unit.basic_blocks)
                     block.dump(unit);
@@ -532,6 +536,7 @@ static bool parse_and_run(JS::Interpreter& interpreter, const StringView& source
 
             if (s_run_bytecode) {
                 JS::Bytecode::Interpreter bytecode_interpreter(interpreter.global_object());
+                bytecode_interpreter.set_optimization_level(optimization_level);
                 bytecode_interpreter.run(unit);
             } else {
                 return true;
@@ -788,12 +793,18 @@ int main(int argc, char** argv)
     args_parser.add_option(s_dump_ast, "Dump the AST", "dump-ast", 'A');
     args_parser.add_option(s_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
     args_parser.add_option(s_run_bytecode, "Run the bytecode", "run-bytecode", 'b');
+    args_parser.add_option(s_bytecode_optimization_level, "Bytecode optimization level (0: none, 1: control flow cleanup, 2: also eliminate redundant moves and dead stores)", "bytecode-optimization-level", 'O', "level");
     args_parser.add_option(s_print_last_result, "Print last result", "print-last-result", 'l');
     args_parser.add_option(gc_on_every_allocation, "GC on every allocation", "gc-on-every-allocation", 'g');
     args_parser.add_option(disable_syntax_highlight, "Disable live syntax highlighting", "no-syntax-highlight", 's');
     args_parser.add_positional_argument(script_path, "Path to script file", "script", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
+    if (s_bytecode_optimization_level < 0 || s_bytecode_optimization_level >= static_cast<int>(JS::Bytecode::Interpreter::OptimizationLevel::__Count)) {
+        warnln("Invalid bytecode optimization level: {}", s_bytecode_optimization_level);
+        return 1;
+    }
+
     bool syntax_highlight = !disable_syntax_highlight;
 
     vm = JS::VM::create();
@@ -975,7 +986,7 @@ int main(int argc, char** argv)
             Vector<Line::CompletionSuggestion> results;
 
             Function<void(const JS::Shape&, const StringView&)> list_all_properties = [&results, &list_all_properties](const JS::Shape& shape, auto& property_pattern) {
-                for (const auto& descriptor : shape.property_table()) {
+                for (const auto& descriptor : shape.property_table_ordered()) {
                     if (!descriptor.key.is_string())
                         continue;
                     auto key = descriptor.key.as_string();